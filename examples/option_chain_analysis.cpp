@@ -24,8 +24,12 @@
 #include <sstream>
 #include <algorithm>
 #include <cmath>
+#include <limits>
+#include <map>
 
 #include "analytic_bs.hpp"
+#include "arbitrage.hpp"
+#include "implied_forward.hpp"
 #include "iv_solve.hpp"
 #include "monte_carlo_gbm.hpp"
 #include "stats.hpp"
@@ -150,10 +154,54 @@ std::vector<OptionData> load_option_chain_data() {
     return options;
 }
 
+/**
+ * @brief Implied forward of the chain from put-call parity
+ *
+ * Returns the Black implied vol of every option on the implied forward and
+ * discount factor, or an empty vector when the parity fit is not usable.
+ */
+std::vector<double> implied_forward_analysis(const std::vector<OptionData>& options, double S0, double T) {
+    std::cout << "\n=== IMPLIED FORWARD (PUT-CALL PARITY) ===\n";
+
+    std::vector<OptionQuote> quotes;
+    quotes.reserve(options.size());
+    for (const auto& option : options) {
+        quotes.push_back({"CHAIN", T, option.strike, option.type, option.bid, option.ask});
+    }
+    const ImpliedForward fwd = implied_forwards(quotes).front();
+    if (!fwd.valid) {
+        std::cout << "Not enough strikes quoted on both sides; using spot and rate.\n";
+        return {};
+    }
+
+    const std::ios_base::fmtflags flags = std::cout.flags();
+    const std::streamsize precision = std::cout.precision();
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "  Implied Forward: " << fwd.forward << " (" << fwd.strikes_used << " strikes)\n";
+    std::cout << std::setprecision(4);
+    std::cout << "  Discount Factor: " << fwd.discount << "\n";
+    std::cout << "  Implied Rate: " << fwd.rate() * 100.0 << "%\n";
+    std::cout << "  Implied Carry Yield: " << fwd.carry_yield(S0) * 100.0 << "%\n";
+    std::cout << "  Parity Residual RMS: " << fwd.residual_rms << "\n";
+    std::cout.flags(flags);
+    std::cout.precision(precision);
+
+    // Inconsistent quotes can still produce a fit; reject economically implausible ones
+    if (std::abs(fwd.rate()) > 0.5 || std::abs(fwd.forward / S0 - 1.0) > 0.2) {
+        std::cout << "Parity fit rejected as implausible; using spot and rate.\n";
+        return {};
+    }
+    return implied_vols_from_forwards(quotes, {fwd});
+}
+
 /**
  * @brief Analyze individual option
+ *
+ * forward_iv is the implied vol on the parity-implied forward, or NaN to solve
+ * against the given spot and rate.
  */
-OptionAnalysis analyze_option(const OptionData& option, double S0, double r, double T) {
+OptionAnalysis analyze_option(const OptionData& option, double S0, double r, double T,
+                              double forward_iv = std::numeric_limits<double>::quiet_NaN()) {
     OptionAnalysis analysis;
     analysis.market_data = option;
     
@@ -165,7 +213,7 @@ OptionAnalysis analyze_option(const OptionData& option, double S0, double r, dou
     };
     
     // Calculate implied volatility
-    analysis.implied_vol = implied_vol(market_price, bs_price_fn);
+    analysis.implied_vol = std::isfinite(forward_iv) ? forward_iv : implied_vol(market_price, bs_price_fn);
     
     // Calculate theoretical price using implied volatility
     if (std::isfinite(analysis.implied_vol) && analysis.implied_vol > 0.0) {
@@ -359,38 +407,51 @@ void statistical_analysis(const std::vector<OptionAnalysis>& analyses) {
 }
 
 /**
- * @brief Check for arbitrage opportunities
+ * @brief Scan the chain for static arbitrage at the quoted bid/ask
  */
-void arbitrage_analysis(const std::vector<OptionAnalysis>& analyses) {
+void arbitrage_analysis(const std::vector<OptionData>& options, double S0, double r, double T) {
     std::cout << "\n=== ARBITRAGE ANALYSIS ===\n";
-    
-    std::vector<OptionAnalysis> arbitrage_ops;
-    for (const auto& analysis : analyses) {
-        if (analysis.arbitrage_opportunity) {
-            arbitrage_ops.push_back(analysis);
-        }
+
+    std::vector<OptionQuote> quotes;
+    quotes.reserve(options.size());
+    for (const auto& option : options) {
+        quotes.push_back({"CHAIN", T, option.strike, option.type, option.bid, option.ask});
     }
-    
-    if (arbitrage_ops.empty()) {
-        std::cout << "No obvious arbitrage opportunities detected.\n";
-    } else {
-        std::cout << "Potential arbitrage opportunities:\n";
-        std::cout << std::setw(6) << "Type" 
-                  << std::setw(8) << "Strike"
-                  << std::setw(8) << "Ask"
-                  << std::setw(8) << "Theory"
-                  << std::setw(10) << "Profit"
-                  << std::endl;
-        std::cout << std::string(40, '-') << std::endl;
-        
-        for (const auto& arb : arbitrage_ops) {
-            std::cout << std::setw(6) << (arb.market_data.type == OptionType::Call ? "Call" : "Put")
-                      << std::setw(8) << arb.market_data.strike
-                      << std::setw(8) << arb.market_data.ask
-                      << std::setw(8) << arb.theoretical_price
-                      << std::setw(10) << arb.profit_potential
-                      << std::endl;
+    const ArbitrageScanResult scan = scan_option_chain(quotes, {{"CHAIN", S0, r, 0.0}});
+
+    if (scan.violations.empty()) {
+        std::cout << "No static arbitrage at the quoted prices.\n";
+        return;
+    }
+    std::cout << "Static arbitrage violations: " << scan.violations.size() << "\n";
+    std::map<std::string, int> per_check;
+    for (const auto& v : scan.violations) ++per_check[arbitrage_check_name(v.check)];
+    for (const auto& [check, count] : per_check) {
+        std::cout << "  " << std::left << std::setw(18) << check << std::right << count << "\n";
+    }
+
+    // Largest violations first
+    std::vector<ArbitrageViolation> top = scan.violations;
+    std::sort(top.begin(), top.end(), [](const ArbitrageViolation& a, const ArbitrageViolation& b) {
+        return a.size > b.size;
+    });
+    top.resize(std::min<std::size_t>(top.size(), 10));
+
+    std::cout << "\n" << std::setw(18) << "Check"
+              << std::setw(24) << "Legs"
+              << std::setw(10) << "Profit"
+              << std::endl;
+    std::cout << std::string(52, '-') << std::endl;
+    for (const auto& v : top) {
+        std::ostringstream legs;
+        for (std::size_t leg : v.legs) {
+            if (leg == ArbitrageViolation::kNoLeg) continue;
+            legs << (quotes[leg].type == OptionType::Call ? " C" : " P") << quotes[leg].strike;
         }
+        std::cout << std::setw(18) << arbitrage_check_name(v.check)
+                  << std::setw(24) << legs.str()
+                  << std::setw(10) << std::fixed << std::setprecision(2) << v.size
+                  << std::endl;
     }
 }
 
@@ -415,17 +476,21 @@ int main() {
     auto options = load_option_chain_data();
     std::cout << "  Total Options Analyzed: " << options.size() << "\n";
     
+    // Implied vols on the parity-implied forward when the chain supports it
+    const std::vector<double> forward_ivs = implied_forward_analysis(options, S0, T);
+
     // Analyze each option
     std::vector<OptionAnalysis> analyses;
-    for (const auto& option : options) {
-        analyses.push_back(analyze_option(option, S0, r, T));
+    for (std::size_t i = 0; i < options.size(); ++i) {
+        analyses.push_back(forward_ivs.empty() ? analyze_option(options[i], S0, r, T)
+                                               : analyze_option(options[i], S0, r, T, forward_ivs[i]));
     }
     
     // Print comprehensive analysis
     print_analysis(analyses, S0);
     analyze_volatility_smile(analyses, S0);
     statistical_analysis(analyses);
-    arbitrage_analysis(analyses);
+    arbitrage_analysis(options, S0, r, T);
     
     // Monte Carlo validation for selected options
     std::cout << "\n=== MONTE CARLO VALIDATION ===\n";
@@ -0,0 +1,87 @@
+#pragma once
+
+/**
+ * @file accuracy_harness.hpp
+ * @brief Fixed, seeded workload over every pricing engine
+ *
+ * Each engine runs a small deterministic workload (fixed seeds, grids and
+ * inputs) and is checked against an independent reference: a closed form,
+ * a parity relation or a second method. The raw outputs are kept as well, so
+ * two builds can be compared output by output:
+ *
+ * - validate_numerical_accuracy (performance_utils.hpp) requires every
+ *   engine to pass its reference check;
+ * - the fast-math build profile (make fast-math-profile) saves the outputs
+ *   of a strict build and reports, per engine, the speed-up and the worst
+ *   relative change of a build with per-unit fast math;
+ * - the PGO training run (bsm --pgo-training) replays the workload at a
+ *   larger scale, so the profile covers every engine.
+ *
+ * Engines are named after their translation units (src/<engine>.cpp), which
+ * is the granularity at which the Makefile enables fast math.
+ *
+ * @author LN697
+ * @version 1.0
+ */
+
+#include <string>
+#include <vector>
+
+namespace bsm {
+
+struct EngineAccuracy {
+    std::string engine;            ///< Translation unit, e.g. "monte_carlo_gbm"
+    std::string check;             ///< What error measures
+    std::vector<double> values;    ///< Raw outputs of the workload
+    double error{0.0};             ///< Deviation from the engine's reference
+    double tolerance{0.0};         ///< Largest accepted error
+    double elapsed_ms{0.0};        ///< Fastest of the timed repeats
+
+    bool passed() const { return error <= tolerance; }
+};
+
+struct AccuracyHarnessConfig {
+    double scale{1.0};   ///< Multiplies path counts and batch sizes (not grids)
+    int repeats{1};      ///< Timed runs per engine; outputs come from the last
+};
+
+/**
+ * @brief Run every engine's workload and reference check
+ *
+ * Results are in a fixed engine order and do not depend on the thread count.
+ */
+std::vector<EngineAccuracy> run_accuracy_harness(const AccuracyHarnessConfig& config = {});
+
+/**
+ * @brief Write results (times, errors and every output at full precision)
+ * @throws std::runtime_error if the file cannot be written
+ */
+void save_accuracy_results(const std::string& path, const std::vector<EngineAccuracy>& results);
+
+/**
+ * @brief Read results written by save_accuracy_results
+ * @throws std::runtime_error if the file is missing or malformed
+ */
+std::vector<EngineAccuracy> load_accuracy_results(const std::string& path);
+
+/**
+ * @brief One engine of a build compared with a reference build
+ */
+struct EngineAccuracyDelta {
+    std::string engine;
+    double speedup{0.0};           ///< reference time / current time
+    double max_rel_delta{0.0};     ///< Worst |current - reference| / max(|reference|, 1e-6) over the outputs
+    bool passed{false};            ///< Current build also passes its own reference check
+};
+
+/**
+ * @brief Compare two runs engine by engine
+ *
+ * Deltas follow the order of current, then engines only in reference
+ * (reported as failed). An engine missing from either run, an output count
+ * mismatch or a NaN on one side only gives an infinite delta.
+ */
+std::vector<EngineAccuracyDelta> compare_accuracy_results(const std::vector<EngineAccuracy>& reference,
+                                                          const std::vector<EngineAccuracy>& current);
+
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+/**
+ * @file arbitrage.hpp
+ * @brief Static no-arbitrage checks over full option-chain snapshots
+ *
+ * Quotes are grouped by underlying, sorted by (expiry, strike), and each expiry
+ * slice is laid out as contiguous strike/bid/ask arrays. Every check is then a
+ * branch-free loop over neighbouring strikes (or neighbouring expiries) that the
+ * compiler vectorises, followed by a pass that collects the entries above the
+ * tolerance. Underlyings are scanned in parallel under OpenMP.
+ *
+ * All checks are tradeable: they use the bid of what would be sold and the ask
+ * of what would be bought, so a reported size is the riskless profit per unit of
+ * the corresponding static portfolio, net of the model-free bound:
+ *
+ * - Put-call parity:  C - P = S e^{-qT} - K e^{-rT}        (needs the spot)
+ * - Vertical spreads: calls non-increasing and puts non-decreasing in strike,
+ *                     with slopes bounded by e^{-rT}
+ * - Butterflies:      call and put prices convex in strike (non-uniform strikes)
+ * - Calendars:        calls non-decreasing in expiry at equal strike
+ *                     (underlyings without dividend yield)
+ * - Crossed quotes:   bid above ask on a single contract
+ *
+ * Parity and the discounted spread bounds hold for European exercise; for
+ * American quotes treat them as indicative.
+ *
+ * @author LN697
+ * @version 1.0
+ */
+
+#include <array>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "option_types.hpp"
+
+namespace bsm {
+
+/**
+ * @brief Spot and carry of an underlying, used by the parity and slope checks
+ *
+ * Underlyings without an entry are scanned with r = q = 0 and no parity check.
+ */
+struct UnderlyingMarket {
+    std::string underlying;
+    double spot{0.0};
+    double r{0.0};
+    double q{0.0};              ///< Continuous dividend yield
+};
+
+enum class ArbitrageCheck {
+    PutCallParity,          ///< legs: call, put
+    CallSpread,             ///< legs: lower strike, higher strike
+    PutSpread,              ///< legs: lower strike, higher strike
+    CallButterfly,          ///< legs: low, mid, high strike
+    PutButterfly,           ///< legs: low, mid, high strike
+    Calendar,               ///< legs: near expiry, far expiry
+    CrossedQuote            ///< legs: the quote
+};
+
+const char* arbitrage_check_name(ArbitrageCheck check);
+
+struct ArbitrageViolation {
+    static constexpr std::size_t kNoLeg = static_cast<std::size_t>(-1);
+
+    ArbitrageCheck check{ArbitrageCheck::CrossedQuote};
+    double size{0.0};                   ///< Riskless profit per unit at the quoted prices
+    std::array<std::size_t, 3> legs{{kNoLeg, kNoLeg, kNoLeg}};   ///< Indices into the quote vector
+};
+
+struct ArbitrageScanConfig {
+    double tolerance{1e-9};     ///< Smallest size reported (price units)
+    bool put_call_parity{true};
+    bool spreads{true};
+    bool butterflies{true};
+    bool calendars{true};
+    bool crossed_quotes{true};
+};
+
+struct ArbitrageScanResult {
+    std::vector<ArbitrageViolation> violations;   ///< Grouped by underlying, then expiry
+    std::size_t num_underlyings{0};
+    std::size_t num_slices{0};                    ///< (underlying, expiry) pairs
+    double elapsed_ms{0.0};
+};
+
+/**
+ * @brief Scan a market snapshot for static arbitrage
+ *
+ * Several quotes for the same contract are merged into the best bid and best
+ * ask; a violation's legs name the quotes that supplied the prices it uses.
+ *
+ * @par Complexity: O(n log n) for the per-underlying sorts, O(n) for the checks
+ */
+ArbitrageScanResult scan_option_chain(const std::vector<OptionQuote>& quotes,
+                                      const std::vector<UnderlyingMarket>& markets = {},
+                                      const ArbitrageScanConfig& config = {});
+
+/**
+ * @brief Generate an arbitrage-free synthetic snapshot (Black-Scholes with a skew)
+ *
+ * Every underlying lists the same expiry ladder and strikes_per_expiry strikes,
+ * a call and a put each, quoted around the model price with a relative spread.
+ * The matching markets are written to markets when given.
+ */
+std::vector<OptionQuote> generate_sample_option_chain(std::size_t num_underlyings,
+                                                      int strikes_per_expiry = 50,
+                                                      unsigned long seed = 42,
+                                                      std::vector<UnderlyingMarket>* markets = nullptr);
+
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+/**
+ * @file asian.hpp
+ * @brief Closed-form and approximate prices for Asian (average-price) options
+ *
+ * Fixed-strike Asian calls and puts on the average of n equally spaced
+ * fixings t_i = iT/n, i = 1..n (n = 0 denotes continuous averaging over
+ * [0, T]), under Black-Scholes dynamics without dividends.
+ *
+ * - Geometric: exact. ln G is normal with mean ln S0 + (r - σ²/2) t̄ and
+ *   variance σ² T (n+1)(2n+1) / (6n²), t̄ = T (n+1) / (2n).
+ * - Turnbull-Wakeman: lognormal matched to the first two moments of the
+ *   continuous arithmetic average.
+ * - Levy: lognormal matched to the exact first two moments of the discrete
+ *   arithmetic average.
+ *
+ * The geometric price is the expectation of the control variate used by
+ * mc_gbm_asian_price.
+ *
+ * @author LN697
+ * @version 1.0
+ */
+
+#include <cstddef>
+#include <vector>
+#include "option_types.hpp"
+
+namespace bsm {
+
+enum class AsianFormula { Geometric, TurnbullWakeman, Levy };
+
+/**
+ * @brief Structure-of-arrays book of Asian options sharing one rate
+ */
+struct AsianBatch {
+    std::vector<double> spot;
+    std::vector<double> strike;
+    std::vector<double> T;
+    std::vector<double> sigma;
+    std::vector<int> num_fixings;   ///< 0 for continuous averaging
+    std::vector<OptionType> type;
+
+    std::size_t size() const { return spot.size(); }
+    void push_back(double S, double K, double t, double vol, int fixings, OptionType opt) {
+        spot.push_back(S); strike.push_back(K); T.push_back(t); sigma.push_back(vol);
+        num_fixings.push_back(fixings); type.push_back(opt);
+    }
+};
+
+/**
+ * @brief Exact price of a geometric-average Asian option
+ *
+ * @param num_fixings Number of equally spaced fixings; 0 for continuous averaging
+ * @par Complexity: O(1)
+ */
+double asian_geometric_price(double S0, double K, double r, double T, double sigma,
+                             OptionType type, int num_fixings = 0);
+
+/**
+ * @brief Moment-matched lognormal price of an arithmetic-average Asian option
+ *
+ * @param formula TurnbullWakeman or Levy (Geometric returns the geometric price)
+ * @par Complexity: O(1) for continuous averaging and Turnbull-Wakeman, O(n) for Levy
+ */
+double asian_arithmetic_approx(double S0, double K, double r, double T, double sigma,
+                               OptionType type, int num_fixings = 0,
+                               AsianFormula formula = AsianFormula::Levy);
+
+/**
+ * @brief Prices a whole batch with one formula
+ *
+ * @param out Resized to batch.size()
+ * @par Complexity: O(n), chunks run in parallel under OpenMP
+ */
+void asian_price_batch(const AsianBatch& batch, double r, AsianFormula formula,
+                       std::vector<double>& out);
+
+}
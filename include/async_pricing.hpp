@@ -0,0 +1,363 @@
+#pragma once
+
+/**
+ * @file async_pricing.hpp
+ * @brief Asynchronous pricing: prioritised jobs, futures and continuations
+ *
+ * A PricingExecutor owns a few worker threads and a queue ordered by priority,
+ * then submission order. submit() returns a PricingFuture; then() schedules a
+ * continuation on the executor once the value is ready, and when_all() joins
+ * several futures, so a caller can chain price -> Greeks -> aggregate without
+ * blocking a thread of its own. With C++20 coroutines a PricingFuture can also
+ * be co_await-ed; the coroutine resumes on the worker that completed it.
+ *
+ * Jobs are not interrupted once running. Interactive requests overtake bulk
+ * work because bulk helpers such as price_portfolio_async queue one slice at
+ * a time at JobPriority::Batch, so any higher-priority job waiting in the
+ * queue runs before the next slice. Cancellation is cooperative: a job whose
+ * token is cancelled before it starts does not run, and running jobs may poll
+ * the token they receive; either way the future fails with PricingCancelled.
+ *
+ * The engines parallelise internally with OpenMP, so a couple of workers is
+ * enough: one can serve an interactive request while another runs a slice.
+ *
+ * @author LN697
+ * @version 1.0
+ */
+
+#include "portfolio.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <queue>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(__cpp_impl_coroutine) && __cpp_impl_coroutine >= 201902L
+#include <coroutine>
+#define BSM_HAS_COROUTINES 1
+#endif
+
+namespace bsm {
+
+/// Lower values run first
+enum class JobPriority : int { Interactive = 0, Normal = 1, Batch = 2 };
+
+/// Thrown by PricingFuture::get() for a job cancelled through its token
+class PricingCancelled : public std::runtime_error {
+public:
+    PricingCancelled() : std::runtime_error("pricing job cancelled") {}
+};
+
+/// Shared flag; copies refer to the same request
+class CancellationToken {
+public:
+    CancellationToken() : flag_(std::make_shared<std::atomic<bool>>(false)) {}
+
+    void cancel() const { flag_->store(true, std::memory_order_relaxed); }
+    bool cancelled() const { return flag_->load(std::memory_order_relaxed); }
+    void throw_if_cancelled() const {
+        if (cancelled()) throw PricingCancelled();
+    }
+
+private:
+    std::shared_ptr<std::atomic<bool>> flag_;
+};
+
+struct JobOptions {
+    JobPriority priority{JobPriority::Normal};
+    CancellationToken cancel;
+};
+
+template <typename T> class PricingFuture;
+
+class PricingExecutor {
+public:
+    static constexpr int kDefaultWorkers = 2;
+
+    /// @throws std::invalid_argument if workers < 1
+    explicit PricingExecutor(int workers = kDefaultWorkers);
+
+    /// Waits for running jobs; queued jobs are abandoned and their futures fail with PricingCancelled
+    ~PricingExecutor();
+
+    PricingExecutor(const PricingExecutor&) = delete;
+    PricingExecutor& operator=(const PricingExecutor&) = delete;
+
+    /**
+     * @brief Queue fn and return its future
+     *
+     * fn takes no arguments or the job's const CancellationToken& and returns
+     * a value; an exception it throws is rethrown by PricingFuture::get().
+     */
+    template <typename F>
+    auto submit(F&& fn, JobOptions options = {});
+
+    int workers() const { return static_cast<int>(threads_.size()); }
+    std::size_t pending() const;
+
+    /**
+     * @brief Queue a raw job (building block of submit and then)
+     *
+     * run is called on a worker; abandon instead if the executor shuts down
+     * first. Neither may throw.
+     * @throws std::runtime_error after shutdown has started
+     */
+    void post(JobPriority priority, std::function<void()> run, std::function<void()> abandon);
+
+private:
+    struct Job {
+        int priority;
+        std::uint64_t sequence;
+        std::function<void()> run;
+        std::function<void()> abandon;
+    };
+    struct Later {
+        bool operator()(const Job& a, const Job& b) const {
+            return a.priority != b.priority ? a.priority > b.priority : a.sequence > b.sequence;
+        }
+    };
+
+    void worker_loop();
+
+    mutable std::mutex mutex_;
+    std::condition_variable ready_;
+    std::priority_queue<Job, std::vector<Job>, Later> queue_;
+    std::uint64_t next_sequence_{0};
+    bool stopping_{false};
+    std::vector<std::thread> threads_;
+};
+
+/// Process-wide executor with kDefaultWorkers threads, created on first use
+PricingExecutor& default_pricing_executor();
+
+namespace detail {
+
+template <typename T>
+struct FutureState {
+    std::mutex mutex;
+    std::condition_variable done_cv;
+    bool done{false};
+    std::optional<T> value;
+    std::exception_ptr error;
+    std::vector<std::function<void()>> continuations;
+
+    void complete(std::optional<T> v, std::exception_ptr e) {
+        std::vector<std::function<void()>> pending;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (done) return;
+            value = std::move(v);
+            error = e;
+            done = true;
+            pending.swap(continuations);
+        }
+        done_cv.notify_all();
+        for (auto& c : pending) c();
+    }
+
+    /// Runs c now if already complete, otherwise on the completing thread
+    void on_complete(std::function<void()> c) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!done) {
+                continuations.push_back(std::move(c));
+                return;
+            }
+        }
+        c();
+    }
+};
+
+template <typename F>
+decltype(auto) invoke_job(F& fn, const CancellationToken& token) {
+    if constexpr (std::is_invocable_v<F&, const CancellationToken&>) return fn(token);
+    else return fn();
+}
+
+template <typename F>
+using job_result_t = std::decay_t<decltype(invoke_job(std::declval<F&>(), std::declval<const CancellationToken&>()))>;
+
+}
+
+/**
+ * @brief Shared handle to a job's result
+ *
+ * Copies refer to the same result, so several continuations may hang off one
+ * future.
+ */
+template <typename T>
+class PricingFuture {
+public:
+    static_assert(!std::is_void_v<T>, "pricing jobs return a value");
+
+    PricingFuture() = default;
+
+    bool valid() const { return state_ != nullptr; }
+
+    bool ready() const {
+        std::lock_guard<std::mutex> lock(state_->mutex);
+        return state_->done;
+    }
+
+    void wait() const {
+        std::unique_lock<std::mutex> lock(state_->mutex);
+        state_->done_cv.wait(lock, [this] { return state_->done; });
+    }
+
+    template <typename Rep, typename Period>
+    bool wait_for(const std::chrono::duration<Rep, Period>& timeout) const {
+        std::unique_lock<std::mutex> lock(state_->mutex);
+        return state_->done_cv.wait_for(lock, timeout, [this] { return state_->done; });
+    }
+
+    /// Blocks until ready; rethrows the job's exception (PricingCancelled if cancelled)
+    const T& get() const {
+        wait();
+        if (state_->error) std::rethrow_exception(state_->error);
+        return *state_->value;
+    }
+
+    /**
+     * @brief Run fn(value) as a new job once this future is ready
+     *
+     * If this job failed or was cancelled, fn is skipped and the returned
+     * future carries the same exception. fn may also take the continuation's
+     * token as a second argument.
+     */
+    template <typename F>
+    auto then(F&& fn, JobOptions options = {}) const;
+
+#ifdef BSM_HAS_COROUTINES
+    bool await_ready() const { return ready(); }
+    void await_suspend(std::coroutine_handle<> handle) const {
+        state_->on_complete([handle] { handle.resume(); });
+    }
+    const T& await_resume() const { return get(); }
+#endif
+
+private:
+    template <typename U> friend class PricingFuture;
+    friend class PricingExecutor;
+    template <typename U>
+    friend PricingFuture<std::vector<U>> when_all(const std::vector<PricingFuture<U>>& futures);
+    friend PricingFuture<PortfolioValuation> price_portfolio_async(PricingExecutor&, std::vector<PositionSpec>,
+                                                                   const PortfolioPricingConfig&, JobOptions,
+                                                                   std::size_t);
+
+    PricingFuture(std::shared_ptr<detail::FutureState<T>> state, PricingExecutor* executor)
+        : state_(std::move(state)), executor_(executor) {}
+
+    std::shared_ptr<detail::FutureState<T>> state_;
+    PricingExecutor* executor_{nullptr};
+};
+
+template <typename F>
+auto PricingExecutor::submit(F&& fn, JobOptions options) {
+    using R = detail::job_result_t<std::decay_t<F>>;
+    auto state = std::make_shared<detail::FutureState<R>>();
+    auto job = std::make_shared<std::decay_t<F>>(std::forward<F>(fn));
+    const CancellationToken token = options.cancel;
+    post(options.priority,
+         [state, job, token] {
+             if (token.cancelled()) {
+                 state->complete(std::nullopt, std::make_exception_ptr(PricingCancelled()));
+                 return;
+             }
+             try {
+                 state->complete(detail::invoke_job(*job, token), nullptr);
+             } catch (...) {
+                 state->complete(std::nullopt, std::current_exception());
+             }
+         },
+         [state] { state->complete(std::nullopt, std::make_exception_ptr(PricingCancelled())); });
+    return PricingFuture<R>(std::move(state), this);
+}
+
+template <typename T>
+template <typename F>
+auto PricingFuture<T>::then(F&& fn, JobOptions options) const {
+    using Fn = std::decay_t<F>;
+    auto step = [parent = state_, fn = Fn(std::forward<F>(fn))](const CancellationToken& token) mutable {
+        if (parent->error) std::rethrow_exception(parent->error);
+        if constexpr (std::is_invocable_v<Fn&, const T&, const CancellationToken&>) return fn(*parent->value, token);
+        else return fn(*parent->value);
+    };
+    using R = std::decay_t<decltype(step(std::declval<const CancellationToken&>()))>;
+
+    // Queue the continuation only once the parent is done, so it never holds a worker while waiting
+    auto child = std::make_shared<detail::FutureState<R>>();
+    PricingExecutor* executor = executor_;
+    state_->on_complete([executor, child, step = std::move(step), options]() mutable {
+        try {
+            auto queued = executor->submit(std::move(step), options).state_;
+            queued->on_complete([child, queued] { child->complete(queued->value, queued->error); });
+        } catch (...) {
+            child->complete(std::nullopt, std::current_exception());
+        }
+    });
+    return PricingFuture<R>(std::move(child), executor_);
+}
+
+/**
+ * @brief Future of every value, in order; fails with the first exception in order
+ *
+ * Completes on the thread that finishes the last input. Continuations of the
+ * result run on the executor of the first input (the default one if empty).
+ */
+template <typename T>
+PricingFuture<std::vector<T>> when_all(const std::vector<PricingFuture<T>>& futures) {
+    auto joined = std::make_shared<detail::FutureState<std::vector<T>>>();
+    PricingExecutor* executor = futures.empty() ? &default_pricing_executor() : futures.front().executor_;
+    if (futures.empty()) {
+        joined->complete(std::vector<T>{}, nullptr);
+        return PricingFuture<std::vector<T>>(std::move(joined), executor);
+    }
+
+    auto inputs = std::make_shared<std::vector<std::shared_ptr<detail::FutureState<T>>>>();
+    for (const auto& f : futures) inputs->push_back(f.state_);
+    auto remaining = std::make_shared<std::atomic<std::size_t>>(futures.size());
+    for (const auto& input : *inputs) {
+        input->on_complete([joined, inputs, remaining] {
+            if (remaining->fetch_sub(1) != 1) return;
+            std::vector<T> values;
+            values.reserve(inputs->size());
+            for (const auto& s : *inputs) {
+                if (s->error) {
+                    joined->complete(std::nullopt, s->error);
+                    return;
+                }
+                values.push_back(*s->value);
+            }
+            joined->complete(std::move(values), nullptr);
+        });
+    }
+    return PricingFuture<std::vector<T>>(std::move(joined), executor);
+}
+
+/**
+ * @brief price_portfolio as a chain of Batch-priority slices
+ *
+ * Each slice prices whole groups covering about slice_positions positions and
+ * queues the next one when it finishes, so higher-priority jobs run between
+ * slices and a cancelled token stops the book at the next slice. The result
+ * is identical to price_portfolio; elapsed_ms includes time spent queued.
+ *
+ * @param options Priority of every slice (Batch by default) and cancellation
+ */
+PricingFuture<PortfolioValuation> price_portfolio_async(PricingExecutor& executor,
+                                                        std::vector<PositionSpec> positions,
+                                                        const PortfolioPricingConfig& config = {},
+                                                        JobOptions options = {JobPriority::Batch, {}},
+                                                        std::size_t slice_positions = 2048);
+
+}
@@ -4,6 +4,8 @@
 #include <cmath>
 #include <functional>
 #include "slv.hpp"
+#include "svi.hpp"
+#include "isa_dispatch.hpp"
 
 namespace bsm {
 
@@ -44,8 +46,68 @@ struct DupireSurface {
         double v2 = (1 - ws) * v21 + ws * v22;
         return (1 - wt) * v1 + wt * v2;
     }
+
+    // bilinear() at one time for n spots (strictly increasing S grid), through the
+    // dispatched surface interpolation kernel
+    void bilinear_batch(double tt, size_t n, const double* St, double* out) const {
+        if (t.empty() || S.empty()) {
+            std::fill(out, out + n, 0.0);
+            return;
+        }
+        size_t j1 = 0, j2 = 0;
+        double wt = 0.0;
+        if (tt >= t.back()) {
+            j1 = j2 = t.size() - 1;
+        } else if (tt > t.front()) {
+            auto itT = std::upper_bound(t.begin(), t.end(), tt) - t.begin();
+            j1 = std::max<size_t>(1, itT) - 1;
+            j2 = std::min(j1 + 1, t.size() - 1);
+            wt = (tt - t[j1]) / std::max(1e-12, t[j2] - t[j1]);
+        }
+        active_kernels().interp_rows(S.size(), S.data(), sigma[j1].data(), sigma[j2].data(), wt, n, St, out);
+    }
 };
 
+struct DupireExtractionConfig {
+    double min_vol{0.01};
+    double max_vol{3.0};
+    double min_density{1e-3};        ///< Floor of Gatheral's g(k), the denominator
+    double min_variance_rate{1e-6};  ///< Floor of dw/dT, the numerator
+};
+
+struct DupireExtractionStats {
+    size_t points{0};
+    size_t regularised{0};   ///< Points where a floor or a vol bound applied
+    double elapsed_ms{0.0};
+};
+
+/**
+ * @brief Local vol from an SVI surface (Gatheral's form of Dupire's formula)
+ *
+ * For total implied variance w(k, T) at log-forward-moneyness k = ln(S / F(T)),
+ *
+ *   sigma_loc^2 = (dw/dT) / g(k),
+ *   g = (1 - k w' / (2 w))^2 - w'^2 (1 / w + 1/4) / 4 + w'' / 2
+ *
+ * with w', w'' analytic SVI derivatives in k. Between slices w, w' and w'' are
+ * linear in T at fixed k and ln F is linear in T; before the first and after
+ * the last slice the implied vol of that slice is held, so dw/dT = w / T.
+ * Calendar (dw/dT <= 0) and butterfly (g <= 0) arbitrage make the formula
+ * blow up, so both are floored and the result is clamped to
+ * [min_vol, max_vol].
+ *
+ * surface.t and surface.S are the target grid (both strictly increasing,
+ * S > 0); rows of surface.sigma are written in place, in parallel over time,
+ * and keep their storage on reruns.
+ *
+ * @param slices One underlying's slices, e.g. from fit_svi_surface; invalid
+ *        slices are skipped
+ * @throws std::invalid_argument for an empty or unsorted grid, no valid
+ *         slice, or slices of several underlyings
+ */
+DupireExtractionStats extract_dupire_surface(const std::vector<SVISlice>& slices, DupireSurface& surface,
+                                             const DupireExtractionConfig& config = {});
+
 // Intentionally no shortcut leverage approximation in production; use an iterative calibration loop.
 
 }
@@ -0,0 +1,114 @@
+#pragma once
+
+/**
+ * @file engine_tuning.hpp
+ * @brief Per-machine tuning of engine block sizes and thread counts
+ *
+ * The engines read their cache- and thread-related knobs from engine_tuning()
+ * instead of compile-time constants. On first use the settings are loaded from
+ * a tuning profile: an INI-style file with one section per hardware
+ * fingerprint, so a single profile on a shared file system serves every node
+ * of a mixed fleet. Machines without a section keep the built-in defaults.
+ *
+ * Profiles are written by tune_engines() (bsm --tune, or the tune command of
+ * bsm_cli), which times short runs of each engine over a grid of candidate
+ * values. None of the knobs changes results beyond rounding: they only
+ * regroup independent lines or options into tasks. The Monte Carlo path
+ * block sizes are deliberately not tunable, because they define the
+ * per-block random streams and so the simulated prices.
+ *
+ * Profile format:
+ * @code
+ * [Intel(R) Xeon(R) Gold 6338 CPU @ 2.00GHz_64t]
+ * threads = 32
+ * heston_line_block = 16
+ * ...
+ * @endcode
+ *
+ * @author LN697
+ * @version 1.0
+ */
+
+#include <iosfwd>
+#include <string>
+
+namespace bsm {
+
+/// Capacity of the stack buffers of the closed-form batch kernels
+constexpr int kMaxBatchChunk = 256;
+
+struct EngineTuning {
+    int threads{0};                ///< OpenMP threads; 0 keeps the runtime default
+    int heston_line_block{8};      ///< S lines per interleaved Thomas batch (pde_heston_adi)
+    int heston_column_chunk{64};   ///< v lines per task in the v sweep (pde_heston_adi)
+    int basket_line_block{16};     ///< asset-0 lines per transposed block (pde_multi_asset_adi)
+    int basket_column_chunk{64};   ///< interleaved lines per task for assets 1 and 2 (pde_multi_asset_adi)
+    int batch_chunk{256};          ///< Options per task in asian_price_batch and barrier_price_batch
+
+    bool operator==(const EngineTuning& o) const {
+        return threads == o.threads && heston_line_block == o.heston_line_block &&
+               heston_column_chunk == o.heston_column_chunk && basket_line_block == o.basket_line_block &&
+               basket_column_chunk == o.basket_column_chunk && batch_chunk == o.batch_chunk;
+    }
+    bool operator!=(const EngineTuning& o) const { return !(*this == o); }
+};
+
+/**
+ * @brief Active settings; the first call loads this machine's section of the default profile
+ *
+ * A profile thread count is applied with omp_set_num_threads at that point.
+ */
+const EngineTuning& engine_tuning();
+
+/**
+ * @brief Replace the active settings (and apply a non-zero thread count)
+ *
+ * Not synchronised: call before starting parallel work.
+ * @throws std::invalid_argument for non-positive block sizes, a negative
+ *         thread count or batch_chunk above kMaxBatchChunk
+ */
+void set_engine_tuning(const EngineTuning& tuning);
+
+/// Profile key of this machine: CPU model and logical core count, identical in every build
+std::string hardware_fingerprint();
+
+/// $BSM_TUNING_PROFILE if set, otherwise $HOME/.bsm_tuning.ini (./bsm_tuning.ini without HOME)
+std::string default_tuning_profile_path();
+
+/**
+ * @brief Read the section for fingerprint from a profile
+ *
+ * Keys missing from the section keep their values in tuning; unknown keys are ignored.
+ * @return false if the file cannot be read or has no such section
+ * @throws std::invalid_argument if the section holds a malformed or invalid value
+ */
+bool load_tuning_profile(const std::string& path, const std::string& fingerprint, EngineTuning& tuning);
+
+/**
+ * @brief Write the section for fingerprint, keeping the other machines' sections
+ *
+ * The file is replaced by renaming a uniquely named temporary beside it. On
+ * POSIX, saves hold an exclusive flock on path + ".lock" from reading the old
+ * file to the rename, so concurrent saves from several nodes keep each
+ * other's sections.
+ *
+ * @throws std::runtime_error if the file cannot be written
+ */
+void save_tuning_profile(const std::string& path, const std::string& fingerprint, const EngineTuning& tuning);
+
+struct TuneOptions {
+    int repeats{5};           ///< Timed runs per candidate (the fastest counts)
+    double min_gain{0.03};    ///< Relative speed-up a candidate needs to replace the incumbent
+    bool quick{false};        ///< Smaller problems, for a fast first pass
+};
+
+/**
+ * @brief Sweep each knob with short engine benchmarks and make the fastest settings active
+ *
+ * Knobs are tuned one at a time, starting from the active settings, in the
+ * order threads, Heston ADI, basket ADI, batch chunk. Progress goes to log if given.
+ * @return The selected settings (also installed with set_engine_tuning)
+ */
+EngineTuning tune_engines(const TuneOptions& options = {}, std::ostream* log = nullptr);
+
+}
@@ -0,0 +1,159 @@
+#pragma once
+
+/**
+ * @file isa_dispatch.hpp
+ * @brief Runtime instruction-set dispatch for the hot batch kernels
+ *
+ * Each kernel below is compiled into one binary several times, once per
+ * instruction set (generic baseline, SSE4.2, AVX2 + FMA, AVX-512), and the
+ * variant is picked per kernel when the library first uses it, from the
+ * instruction sets the CPU and OS report. A binary built with PORTABLE=1
+ * (baseline x86-64 code everywhere else) therefore runs on every node of a
+ * mixed fleet and still uses the widest vectors each node has.
+ *
+ * Kernels and the engines that run on them:
+ * - BlackScholes:          black_scholes_price_batch; prices and Greeks of
+ *                          the analytic portfolio groups
+ * - ImpliedVol:            black_implied_vol_batch (iv_solve.hpp)
+ * - NormalFill:            fill_standard_normals; portfolio Monte Carlo groups
+ * - PayoffReduction:       gbm_payoff_moments; payoff and Greek sums of the
+ *                          portfolio Monte Carlo groups
+ * - Tridiagonal:           solve_tridiagonal_batch and TridiagonalFactor
+ *                          (tridiagonal.hpp), so the Crank-Nicolson, Heston
+ *                          ADI, multi-asset ADI and portfolio PDE solves
+ * - SurfaceInterpolation:  DupireSurface::bilinear_batch and
+ *                          LeverageGrid::interpolate_batch, used per step by
+ *                          the SLV engines through LocalVolBatchFn
+ *
+ * Single-option engines that draw from RNG (mc_gbm_price, LSM, barrier and
+ * Asian Monte Carlo) keep their scalar loops, so their seeded streams are
+ * unchanged.
+ *
+ * The choice can be overridden for all kernels with the BSM_ISA environment
+ * variable or set_isa() (the --isa option of bsm), and per kernel with
+ * set_kernel_isa(). Overrides are not synchronised: make them before starting
+ * parallel work.
+ *
+ * Results agree across variants to rounding; the reductions use a fixed
+ * number of partial sums, so their summation order does not depend on the
+ * vector width.
+ *
+ * @author LN697
+ * @version 1.0
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "option_types.hpp"
+
+// Per-ISA variants need GCC's target pragmas on x86
+#if defined(__GNUC__) && !defined(__clang__) && (defined(__x86_64__) || defined(__i386__)) && \
+    !defined(BSM_NO_ISA_DISPATCH)
+#define BSM_ISA_VARIANTS 1
+#else
+#define BSM_ISA_VARIANTS 0
+#endif
+
+namespace bsm {
+
+enum class KernelISA { Generic, SSE42, AVX2, AVX512 };
+
+enum class Kernel { BlackScholes, ImpliedVol, NormalFill, PayoffReduction, Tridiagonal, SurfaceInterpolation };
+
+constexpr int kNumKernels = 6;
+
+const char* isa_name(KernelISA isa);
+const char* kernel_name(Kernel kernel);
+
+/**
+ * @brief Parse "generic", "sse4.2", "avx2", "avx512" or "native" (case-insensitive)
+ * @return false for an unknown name
+ */
+bool parse_isa(const std::string& name, KernelISA& isa);
+
+/// Widest variant the CPU and OS can run; Generic when variants are not compiled in
+KernelISA detected_isa();
+
+bool isa_supported(KernelISA isa);
+
+/// Supported variants, narrowest first
+std::vector<KernelISA> supported_isas();
+
+KernelISA kernel_isa(Kernel kernel);
+
+/**
+ * @brief Select the variant of one kernel
+ * @throws std::invalid_argument if isa is not supported on this machine
+ */
+void set_kernel_isa(Kernel kernel, KernelISA isa);
+
+/// Select the variant of every kernel (see set_kernel_isa)
+void set_isa(KernelISA isa);
+
+/**
+ * @brief Function table of one variant, or the per-kernel selection
+ */
+struct KernelTable {
+    void (*black_scholes)(std::size_t n, const double* S, const double* K, double r, const double* T,
+                          const double* sigma, const OptionType* types, double* out);
+    // One spot, expiry and volatility (all positive) for n strikes; sign is +1 for calls, -1 for puts
+    void (*black_scholes_greeks)(std::size_t n, double S, double r, double T, double sigma, const double* K,
+                                 const double* sign, double* price, double* delta, double* gamma, double* vega,
+                                 double* theta);
+    void (*implied_vol)(double F, double D, double T, std::size_t n, const double* strikes,
+                        const double* prices, const OptionType* types, double* vols, double tol, int max_iter);
+    void (*normal_fill)(std::uint64_t seed, std::uint64_t offset, std::size_t n, double* out);
+    void (*payoff_moments)(std::size_t n, const double* z, double S0, double drift, double vol, double K,
+                           OptionType type, bool antithetic, double* sum, double* sum_sq);
+    // Antithetic GBM pairs at z for nK strikes: sums of payoff, payoff^2, pathwise delta and vega
+    // and likelihood-ratio-pathwise gamma terms, written to sums[stat * nK + strike]; scratch holds 2n
+    void (*payoff_greeks)(std::size_t n, const double* z, double S0, double drift, double vol, double sqrt_T,
+                          double sigma_T, std::size_t nK, const double* K, const double* sign, double* scratch,
+                          double* sums);
+    void (*tridiagonal)(int n, int m, const double* a, const double* b, const double* c, double* d,
+                        double* scratch, std::ptrdiff_t stride);
+    // Sweep of a factorised operator (see TridiagonalFactor) over m interleaved right-hand sides
+    void (*factored_tridiagonal)(int n, int m, const double* a, const double* inv_beta, const double* cp,
+                                 double* d, std::ptrdiff_t stride);
+    void (*interp_rows)(std::size_t ns, const double* grid, const double* row0, const double* row1,
+                        double w1, std::size_t n, const double* x, double* out);
+};
+
+/// The selected variant of every kernel
+const KernelTable& active_kernels();
+
+/**
+ * @brief All kernels of one variant, for benchmarking variants side by side
+ * @throws std::invalid_argument if isa is not supported on this machine
+ */
+const KernelTable& kernel_variant(KernelISA isa);
+
+/**
+ * @brief Black-Scholes prices of n options (structure of arrays)
+ *
+ * Same conventions as black_scholes_price: T <= 0 gives the intrinsic value,
+ * sigma <= 0 the discounted forward intrinsic value.
+ */
+void black_scholes_price_batch(std::size_t n, const double* S, const double* K, double r, const double* T,
+                               const double* sigma, const OptionType* types, double* out);
+
+/**
+ * @brief Standard normal variates offset .. offset + n - 1 of a counter-based stream
+ *
+ * Box-Muller on a SplitMix64 hash of (seed, counter), so any sub-range can be
+ * generated independently (per thread or per block) and reproduces the same
+ * numbers.
+ */
+void fill_standard_normals(std::uint64_t seed, std::uint64_t offset, std::size_t n, double* out);
+
+/**
+ * @brief Sum and sum of squares of GBM terminal payoffs max(+-(S0 e^{drift + vol z} - K), 0)
+ *
+ * With antithetic set, each sample is the average of the payoffs at z and -z.
+ */
+void gbm_payoff_moments(std::size_t n, const double* z, double S0, double drift, double vol, double K,
+                        OptionType type, bool antithetic, double& sum, double& sum_sq);
+
+}
@@ -1,6 +1,9 @@
 #pragma once
 #include <functional>
 #include <cmath>
+#include <cstddef>
+#include <limits>
+#include "option_types.hpp"
 
 namespace bsm {
 
@@ -36,4 +39,16 @@ inline double implied_vol(double target_price, std::function<double(double)> pri
     return 0.5 * (a + b);
 }
 
+// Black (forward) implied volatilities of n options sharing one expiry. prices are
+// discounted premiums; F and D are the expiry's forward and discount factor. Each
+// price is reduced to its time value, which parity makes the same for calls and
+// puts, and solved as the out-of-the-money option by safeguarded Newton from the
+// inflection point sqrt(2|ln F/K|), switching to Newton on the log premium far
+// below it. Strikes are solved in lock-step blocks by the runtime-dispatched
+// ImpliedVol kernel (isa_dispatch.hpp). vols[i] is NaN when the time value is
+// not in (0, min(F, K)).
+void black_implied_vol_batch(double F, double D, double T, std::size_t n,
+                             const double* strikes, const double* prices, const OptionType* types,
+                             double* vols, double tol = 1e-12, int max_iter = 100);
+
 }
@@ -4,8 +4,12 @@
 #include <functional>
 #include <algorithm>
 #include <cmath>
+#include <cstddef>
+#include <string>
+#include <utility>
 
 #include "option_types.hpp"
+#include "stats.hpp"
 
 namespace bsm {
 
@@ -14,8 +18,91 @@ struct LSMParams {
     long paths{200000};
     int poly_degree{2};
     unsigned long seed{1234};
+    bool antithetic{false};        // paths m and m + paths/2 use negated increments
+    bool control_variate{false};   // European put at the stopping time as control variate
+    bool use_qmc{false};           // scrambled Halton increments through a Brownian bridge
+    int qmc_replicates{8};         // independent scramblings, used for the standard error
+    Precision precision{Precision::Double};   // regression path storage; fits and moments stay double
+    bool quantize_paths{false};    // store ln(S/S0) as 16-bit integers (PathEncoding::LogReturn16)
+    std::size_t memory_budget{0};  // bytes of path slices kept in RAM; 0 keeps everything in memory
+    std::string spill_dir;         // directory for the spill file; empty uses $TMPDIR or /tmp
 };
 
+// Out-of-core path store. When the regression paths exceed memory_budget they are
+// written time-major to an unlinked memory-mapped file. The backward induction
+// streams them back in reverse, a block of slices at a time, with the next block
+// prefetched. Per-path state (cash flows, stopping dates) stays in memory.
+// Bandwidths are effective: bytes over the time the engine stalled on the file.
+struct LSMSpillStats {
+    bool spilled{false};
+    std::size_t store_bytes{0};          // encoded path slices, unpadded
+    std::size_t bytes_written{0};        // spill file, slices padded to pages
+    std::size_t bytes_read{0};
+    std::size_t peak_resident_bytes{0};  // largest sampled RSS of the mapping (Linux only)
+    double write_seconds{0.0};           // flushing written blocks to the file
+    double read_seconds{0.0};            // faulting blocks back in during induction
+
+    double write_bandwidth() const { return write_seconds > 0.0 ? bytes_written / write_seconds : 0.0; }
+    double read_bandwidth() const { return read_seconds > 0.0 ? bytes_read / read_seconds : 0.0; }
+};
+
+struct LSMResult {
+    double price{0.0};
+    double std_error{0.0};
+    double cv_beta{0.0};           // regression coefficient on the control variate
+    long num_paths{0};
+    LSMSpillStats spill;
+};
+
+// Andersen-Broadie dual estimator settings. Each outer path runs one nested
+// simulation per exercise date to estimate the continuation value of the fitted
+// policy; inner_schedule[n - 1] (n = 1..steps-1) overrides inner_paths per date,
+// so nested work can be concentrated where the exercise decision is made.
+struct LSMDualParams {
+    long outer_paths{500};
+    int inner_paths{200};
+    std::vector<int> inner_schedule;
+    long lower_paths{0};              // independent lower-bound paths; 0 uses LSMParams::paths
+    unsigned long seed{4321};
+};
+
+struct LSMBounds {
+    double lower{0.0};                // out-of-sample value of the fitted exercise policy
+    double lower_se{0.0};
+    double upper{0.0};                // dual (martingale) upper bound
+    double upper_se{0.0};
+    long nested_steps{0};             // inner path-steps simulated for the upper bound
+
+    double gap() const { return upper - lower; }
+    // Conservative interval [lower - z se_l, upper + z se_u]
+    std::pair<double, double> interval(double z = 1.96) const {
+        return {lower - z * lower_se, upper + z * upper_se};
+    }
+};
+
+// Longstaff-Schwartz American put; in-sample price on the regression paths
 double lsm_american_put(double S0, double K, double r, double T, double sigma, const LSMParams& p);
 
+// Same estimator with its standard error. The sampling unit is an antithetic pair
+// when enabled; with QMC the error is the spread over the scrambling replicates.
+// The control variate is the discounted closed-form European put evaluated at each
+// path's stopping time; by optional stopping its mean is the European price at t = 0.
+LSMResult lsm_american_put_estimate(double S0, double K, double r, double T, double sigma,
+                                    const LSMParams& p);
+
+// Price, delta, gamma and vega from one run, with standard errors. Each path is
+// differentiated at its own stopping time with the fitted exercise decisions held
+// fixed (at the optimal boundary their first-order effect vanishes): delta and
+// vega are pathwise, gamma is likelihood-ratio on the first step times the
+// pathwise delta. Price and std_error are those of lsm_american_put_estimate.
+MCResult lsm_american_put_greeks(double S0, double K, double r, double T, double sigma,
+                                 const LSMParams& p);
+
+// Lower and upper bounds for the American put from the same fitted policy: the
+// lower bound re-prices the policy on independent paths, the upper bound is the
+// Andersen-Broadie duality estimate built from nested continuation values.
+// Outer paths run in parallel under OpenMP, each thread with its own sub-path buffers.
+LSMBounds lsm_american_put_bounds(double S0, double K, double r, double T, double sigma,
+                                  const LSMParams& p, const LSMDualParams& dual = {});
+
 }
@@ -10,7 +10,7 @@
  * Features:
  * - Normal distribution CDF and PDF
  * - High-quality random number generation (MT19937-64)
- * - Quasi-Monte Carlo sequences (Halton)
+ * - Quasi-Monte Carlo sequences (Halton, scrambled Halton) and Brownian bridge
  * - Correlated random variable generation
  * - Fast mathematical approximations
  * 
@@ -24,6 +24,7 @@
 #include <utility>
 #include <algorithm>
 #include <limits>
+#include <vector>
 
 #ifndef M_PI
 #define M_PI 3.141592653589793238462643383279502884L
@@ -294,6 +295,131 @@ public:
     void skip(uint64_t skip_count) { n += skip_count; }
 };
 
+/**
+ * @brief Randomly scrambled Halton sequence in arbitrary dimension
+ *
+ * Dimension d uses the d-th prime as base. Every digit level of every
+ * dimension applies its own random permutation of the digits (including the
+ * trailing zeros up to double precision), which removes the correlation
+ * between high-dimensional Halton coordinates and makes each scrambling an
+ * independent randomisation of the point set, so repeated scramblings give a
+ * standard error.
+ */
+class ScrambledHalton {
+private:
+    struct Axis {
+        uint32_t base;
+        int levels;
+        std::vector<uint32_t> perm;   // levels x base
+    };
+    std::vector<Axis> axes;
+
+public:
+    /**
+     * @param dim  Number of coordinates per point
+     * @param seed Seed of the digit permutations
+     */
+    ScrambledHalton(int dim, uint64_t seed) {
+        std::mt19937_64 gen(seed);
+        uint32_t candidate = 2;
+        for (int d = 0; d < dim; ++d) {
+            for (;; ++candidate) {
+                bool prime = true;
+                for (uint32_t q = 2; q * q <= candidate && prime; ++q) prime = candidate % q != 0;
+                if (prime) break;
+            }
+            Axis a;
+            a.base = candidate++;
+            a.levels = static_cast<int>(std::ceil(53.0 / std::log2(static_cast<double>(a.base))));
+            a.perm.resize(static_cast<std::size_t>(a.levels) * a.base);
+            for (int l = 0; l < a.levels; ++l) {
+                uint32_t* row = &a.perm[static_cast<std::size_t>(l) * a.base];
+                for (uint32_t k = 0; k < a.base; ++k) row[k] = k;
+                std::shuffle(row, row + a.base, gen);
+            }
+            axes.push_back(std::move(a));
+        }
+    }
+
+    int dimension() const { return static_cast<int>(axes.size()); }
+
+    /**
+     * @brief Point number `index` of the sequence, written to u[0..dim)
+     * @note Coordinates lie strictly inside (0, 1)
+     */
+    void point(uint64_t index, double* u) const {
+        for (std::size_t d = 0; d < axes.size(); ++d) {
+            const Axis& a = axes[d];
+            const double inv_base = 1.0 / static_cast<double>(a.base);
+            uint64_t n = index;
+            double f = inv_base, result = 0.0;
+            for (int l = 0; l < a.levels; ++l) {
+                result += f * a.perm[static_cast<std::size_t>(l) * a.base + n % a.base];
+                n /= a.base;
+                f *= inv_base;
+            }
+            u[d] = std::min(std::max(result, 1e-16), 1.0 - 1e-16);
+        }
+    }
+};
+
+/**
+ * @brief Brownian-bridge construction of a discretely sampled Brownian path
+ *
+ * Maps n standard normals to the n unit-step increments of a Brownian motion,
+ * spending the first normal on the terminal value and the following ones on
+ * successive midpoints. With low-discrepancy inputs this concentrates the
+ * variance in the leading, best-distributed coordinates.
+ */
+class BrownianBridge {
+private:
+    int n{0};
+    std::vector<int> bridge, left, right;
+    std::vector<double> wl, wr, sd;
+
+public:
+    explicit BrownianBridge(int steps)
+        : n(steps), bridge(steps), left(steps), right(steps), wl(steps), wr(steps), sd(steps) {
+        if (n <= 0) return;
+        std::vector<int> filled(n, 0);
+        filled[n - 1] = 1;
+        bridge[0] = n - 1;
+        sd[0] = std::sqrt(static_cast<double>(n));
+        for (int i = 1, j = 0; i < n; ++i) {
+            while (filled[j]) ++j;
+            int k = j;
+            while (!filled[k]) ++k;
+            const int l = j + ((k - 1 - j) >> 1);
+            filled[l] = 1;
+            bridge[i] = l;
+            left[i] = j;
+            right[i] = k;
+            // Times are t_m = m + 1; the left neighbour is t_{j-1} (0 when j == 0)
+            const double tl = j, tm = l + 1.0, tr = k + 1.0;
+            wl[i] = (tr - tm) / (tr - tl);
+            wr[i] = (tm - tl) / (tr - tl);
+            sd[i] = std::sqrt((tm - tl) * (tr - tm) / (tr - tl));
+            j = k + 1;
+            if (j >= n) j = 0;
+        }
+    }
+
+    int steps() const { return n; }
+
+    /**
+     * @brief Unit-step increments dw[0..n) from normals z[0..n) (scale by √dt)
+     */
+    void increments(const double* z, double* dw) const {
+        if (n <= 0) return;
+        dw[n - 1] = sd[0] * z[0];
+        for (int i = 1; i < n; ++i) {
+            const int j = left[i], k = right[i], l = bridge[i];
+            dw[l] = (j ? wl[i] * dw[j - 1] : 0.0) + wr[i] * dw[k] + sd[i] * z[i];
+        }
+        for (int i = n - 1; i > 0; --i) dw[i] -= dw[i - 1];
+    }
+};
+
 /**
  * @brief Fast hash-based random number generator for indexed access
  * 
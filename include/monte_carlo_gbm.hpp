@@ -1,6 +1,8 @@
 #pragma once
+#include "barrier.hpp"
 #include "option_types.hpp"
 #include "stats.hpp"
+#include <vector>
 
 namespace bsm {
 
@@ -10,4 +12,36 @@ MCResult mc_gbm_price(double S0, double K, double r, double T, double sigma,
                       bool antithetic = true, bool control_variate = true, bool use_qmc = false,
                       bool two_pass_cv = true, bool compute_greeks = true);
 
+// Strike x expiry grid priced from one path set. Each path is simulated once with
+// exact GBM increments between the expiries (sorted ascending in the result) and all
+// strikes are evaluated on the recorded states. The optional control variate is the
+// terminal spot with a per-cell regression beta; Greeks are pathwise (delta, vega) and
+// likelihood-ratio/pathwise (gamma).
+MCResultGrid mc_gbm_price_grid(double S0, const std::vector<double>& strikes,
+                               const std::vector<double>& expiries, double r, double sigma,
+                               long num_paths, OptionType type, unsigned long seed = 12345,
+                               bool antithetic = true, bool control_variate = true,
+                               bool compute_greeks = true);
+
+// Single-barrier option under GBM with exact log-normal steps. Continuous monitoring
+// (monitoring_dates = 0) weights each path by its Brownian-bridge survival probability
+// between steps, so the estimator has no step-monitoring bias; otherwise the barrier is
+// checked on monitoring_dates equally spaced dates (expiry included) and num_steps is
+// rounded up to a multiple of them. The std_error is over antithetic pairs.
+MCResult mc_gbm_barrier_price(double S0, double K, double r, double T, double sigma,
+                              long num_paths, long num_steps, OptionType type,
+                              const BarrierSpec& barrier, unsigned long seed = 12345,
+                              bool antithetic = true, int monitoring_dates = 0);
+
+// Arithmetic-average Asian option on num_fixings equally spaced fixings t_i = iT/n.
+// Paths are simulated in blocks laid out fixing-major so the per-fixing update runs
+// stride-1 across paths. The control variate is the geometric-average option on the
+// same fixings, whose expectation is known in closed form (asian_geometric_price);
+// beta is the regression coefficient estimated from the same sample. With
+// Precision::Float the path state is single precision; payoffs and moments are double.
+MCResult mc_gbm_asian_price(double S0, double K, double r, double T, double sigma,
+                            long num_paths, int num_fixings, OptionType type,
+                            unsigned long seed = 12345, bool antithetic = true,
+                            bool control_variate = true, Precision precision = Precision::Double);
+
 }
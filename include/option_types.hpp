@@ -1,9 +1,44 @@
 #pragma once
 
+#include <string>
+
 namespace bsm {
 
 enum class OptionType { Call, Put };
 
 inline bool is_call(OptionType t) { return t == OptionType::Call; }
 
+enum class ExerciseStyle { European, American };
+
+// Bid/ask quote of one listed option. A side that is not quoted is passed as
+// bid = 0 and ask = +infinity.
+struct OptionQuote {
+    std::string underlying;
+    double T{0.0};              // time to expiry in years
+    double strike{0.0};
+    OptionType type{OptionType::Call};
+    double bid{0.0};
+    double ask{0.0};
+
+    double mid() const { return 0.5 * (bid + ask); }
+};
+
+// Storage and arithmetic type of Monte Carlo path state. Float evolves paths in
+// single precision (half the memory traffic, twice the SIMD width) while payoff
+// moments and regressions are still accumulated in double.
+enum class Precision { Double, Float };
+
+// Continuously monitored single barrier. Knock-out rebates are paid when the
+// barrier is hit; knock-in rebates are paid at expiry if it never was.
+enum class BarrierType { None, DownOut, UpOut, DownIn, UpIn };
+
+struct BarrierSpec {
+    BarrierType type{BarrierType::None};
+    double level{0.0};
+    double rebate{0.0};
+};
+
+inline bool is_knock_in(BarrierType b) { return b == BarrierType::DownIn || b == BarrierType::UpIn; }
+inline bool is_down_barrier(BarrierType b) { return b == BarrierType::DownOut || b == BarrierType::DownIn; }
+
 }
@@ -0,0 +1,129 @@
+#pragma once
+
+/**
+ * @file path_store.hpp
+ * @brief Contiguous, aligned storage for simulated spot paths
+ *
+ * One buffer holds every (path, date) value. Rows are the dates (time-major) or
+ * the paths (path-major), each starting on an alignment boundary (64 bytes by
+ * default) so a row can be handed to vectorised loops as is.
+ *
+ * Encodings:
+ * - Float64 / Float32: the spot itself.
+ * - LogReturn16: the cumulative log-return ln(S / reference) rounded to a 16-bit
+ *   integer with a per-date scale (set_log_range). The relative error per value is
+ *   at most range / 65534 and does not accumulate along the path, since every date
+ *   is quantised independently.
+ *
+ * The buffer is owned, or supplied by the caller (e.g. a memory-mapped file) with
+ * required_bytes() and a matching row alignment.
+ *
+ * @author LN697
+ * @version 1.0
+ */
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace bsm {
+
+enum class PathLayout { TimeMajor, PathMajor };
+enum class PathEncoding { Float64, Float32, LogReturn16 };
+
+/**
+ * @brief Bytes per stored value of an encoding
+ */
+inline std::size_t path_encoding_size(PathEncoding encoding) {
+    switch (encoding) {
+        case PathEncoding::Float64: return 8;
+        case PathEncoding::Float32: return 4;
+        case PathEncoding::LogReturn16: break;
+    }
+    return 2;
+}
+
+class PathStore {
+public:
+    static constexpr std::size_t kAlignment = 64;
+
+    PathStore() = default;
+
+    /**
+     * @param reference Spot the LogReturn16 encoding is relative to (usually S0)
+     * @param external Caller-owned buffer of required_bytes(); nullptr allocates
+     * @param row_alignment Power of two, at least kAlignment
+     */
+    PathStore(long num_paths, int num_dates, PathLayout layout = PathLayout::TimeMajor,
+              PathEncoding encoding = PathEncoding::Float64, double reference = 1.0,
+              void* external = nullptr, std::size_t row_alignment = kAlignment);
+
+    static std::size_t required_bytes(long num_paths, int num_dates, PathLayout layout,
+                                      PathEncoding encoding, std::size_t row_alignment = kAlignment);
+
+    long num_paths() const { return num_paths_; }
+    int num_dates() const { return num_dates_; }
+    PathLayout layout() const { return layout_; }
+    PathEncoding encoding() const { return encoding_; }
+
+    /// Buffer size including row padding
+    std::size_t bytes() const { return row_bytes_ * num_rows(); }
+    /// Encoded values only, without padding
+    std::size_t payload_bytes() const {
+        return static_cast<std::size_t>(num_paths_) * num_dates_ * path_encoding_size(encoding_);
+    }
+
+    /// Rows are dates (time-major) or paths (path-major)
+    std::size_t num_rows() const { return layout_ == PathLayout::TimeMajor ? num_dates_ : num_paths_; }
+    std::size_t row_length() const { return layout_ == PathLayout::TimeMajor ? num_paths_ : num_dates_; }
+    /// Distance between row starts, a multiple of the row alignment
+    std::size_t row_bytes() const { return row_bytes_; }
+
+    /// Aligned start of a row in the stored encoding (double, float or int16_t)
+    void* row_data(std::size_t row) { return data_ + row * row_bytes_; }
+    const void* row_data(std::size_t row) const { return data_ + row * row_bytes_; }
+
+    /**
+     * @brief Quantisation range of date t for LogReturn16: |ln(S / reference)| <= range
+     *
+     * Values outside are clamped. Ignored by the floating-point encodings.
+     */
+    void set_log_range(int t, double range);
+
+    double get(long path, int t) const;
+    void set(long path, int t, double S);
+
+    /// Spot of all paths at date t (num_paths values)
+    template <typename Real> void store_date(int t, const Real* S);
+    template <typename Real> void load_date(int t, Real* S) const;
+
+    /// All dates of one path (num_dates values)
+    template <typename Real> void store_path(long path, const Real* S);
+    template <typename Real> void load_path(long path, Real* S) const;
+
+private:
+    struct AlignedFree { void operator()(unsigned char* p) const; };
+
+    std::size_t offset(long path, int t) const {
+        return layout_ == PathLayout::TimeMajor
+            ? static_cast<std::size_t>(t) * row_bytes_ + static_cast<std::size_t>(path) * value_bytes_
+            : static_cast<std::size_t>(path) * row_bytes_ + static_cast<std::size_t>(t) * value_bytes_;
+    }
+    int16_t quantize(int t, double S) const;
+    double dequantize(int t, int16_t q) const { return reference_ * std::exp(q * scale_[t]); }
+
+    long num_paths_{0};
+    int num_dates_{0};
+    PathLayout layout_{PathLayout::TimeMajor};
+    PathEncoding encoding_{PathEncoding::Float64};
+    double reference_{1.0};
+    std::size_t value_bytes_{8};
+    std::size_t row_bytes_{0};
+    std::vector<double> scale_;             // LogReturn16 step per date
+    std::unique_ptr<unsigned char[], AlignedFree> owned_;
+    unsigned char* data_{nullptr};
+};
+
+}
@@ -9,4 +9,13 @@ namespace bsm {
 double pde_crank_nicolson(double S0, double K, double r, double T, double sigma,
                            int num_S_steps, int num_T_steps, OptionType type);
 
+// Crank-Nicolson for single-barrier options with rebate (knock-out rebate paid at hit,
+// knock-in rebate at expiry). Continuous monitoring puts the barrier on the grid edge;
+// discrete monitoring (monitoring_dates > 0, expiry included) aligns a node with the
+// barrier and resets the knocked region at each date. Each restart of the payoff is
+// smoothed by implicit-Euler half-steps. Knock-ins are priced as vanilla minus knock-out.
+double pde_crank_nicolson_barrier(double S0, double K, double r, double T, double sigma,
+                                  int num_S_steps, int num_T_steps, OptionType type,
+                                  const BarrierSpec& barrier, int monitoring_dates = 0);
+
 }
@@ -0,0 +1,69 @@
+#pragma once
+
+/**
+ * @file pde_heston_adi.hpp
+ * @brief Two-dimensional (S, v) ADI finite-difference pricer for Heston and SLV
+ *
+ * Solves the backward pricing PDE in time-to-expiry tau
+ *
+ *   V_tau = ½L²vS² V_SS + ρξLvS V_Sv + ½ξ²v V_vv + rS V_S + κ(θ-v) V_v - rV
+ *
+ * where L = L(S, t) is the leverage function of a stochastic local volatility
+ * model (L = 1 gives pure Heston). The operator is split as A = A0 + A1 + A2
+ * (mixed term, S direction, v direction) and advanced with one of the
+ * Craig-Sneyd family of ADI schemes, so every implicit stage reduces to
+ * independent tridiagonal solves along grid lines:
+ *
+ * - S lines have per-line coefficients and are solved in blocks of lines
+ *   stored interleaved, so the Thomas recursion vectorises across lines;
+ * - v lines share one operator, which is factorised once and applied to all
+ *   lines of the grid with a stride-1 inner loop.
+ *
+ * Blocks of lines are distributed across OpenMP threads. Both directions use
+ * sinh-stretched grids (concentrated at the strike and at v = 0), the first
+ * steps are damped with implicit half-steps to smooth the payoff kink, and
+ * early exercise is enforced by projection after each step.
+ *
+ * Barriers are monitored continuously: a knock-out barrier becomes the grid
+ * boundary with the rebate as Dirichlet value, and knock-in prices follow
+ * from in-out parity.
+ *
+ * @author LN697
+ * @version 1.0
+ */
+
+#include "option_types.hpp"
+#include "pde_grid.hpp"
+#include "slv.hpp"
+#include "slv_calibration.hpp"
+
+namespace bsm {
+
+struct HestonADIConfig {
+    int num_S{100};                  ///< S intervals
+    int num_v{50};                   ///< v intervals
+    int num_t{100};                  ///< Time steps
+    ADIScheme scheme{ADIScheme::HundsdorferVerwer};
+    double theta{0.0};               ///< Implicitness; 0 selects the scheme default
+    double S_max_multiple{8.0};      ///< S_max = multiple * max(S0, K) without an up barrier
+    double v_max{5.0};
+    int damping_steps{2};            ///< Leading steps replaced by two implicit half-steps
+};
+
+/**
+ * @brief Price a vanilla, American or barrier option under Heston / SLV
+ *
+ * @param leverage Leverage surface L(S, t); nullptr prices under pure Heston
+ * @return Price, delta and gamma at (S0, v0)
+ * @throws std::invalid_argument for American knock-in options or invalid inputs
+ *
+ * @par Complexity: O(num_S * num_v * num_t)
+ */
+PDEResult pde_heston_adi(double S0, double K, double r, double T, OptionType type,
+                         const HestonParams& heston,
+                         const LeverageGrid* leverage = nullptr,
+                         ExerciseStyle style = ExerciseStyle::European,
+                         const BarrierSpec& barrier = {},
+                         const HestonADIConfig& config = {});
+
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+/**
+ * @file pde_multi_asset.hpp
+ * @brief Two- and three-asset ADI finite-difference pricer for baskets and spreads
+ *
+ * Prices European options on a weighted sum of correlated GBM assets,
+ * payoff max(±(Σ w_k S_k - K), 0). A spread is the basket with weights
+ * {1, -1}; K = 0 gives the Margrabe exchange option.
+ *
+ * The PDE is solved in log-spot coordinates, where every directional
+ * operator has the same coefficients on all of its grid lines:
+ *
+ *   V_tau = Σ_k [½σ_k² V_kk + (r - ½σ_k²) V_k] + Σ_{k<l} ρ_kl σ_k σ_l V_kl - rV
+ *
+ * Each direction is therefore factorised once per step size, and the
+ * cross-derivative terms are treated explicitly by Craig-Sneyd type
+ * corrections (Craig-Sneyd, Modified Craig-Sneyd, Hundsdorfer-Verwer).
+ *
+ * Memory layout: values are stored with asset 0 fastest. Sweeps along asset
+ * k > 0 use the grid lines as interleaved right-hand sides, so the Thomas
+ * recursion runs stride-1 across lines; sweeps along asset 0 transpose
+ * cache-sized blocks of lines into the same interleaved form. Blocks and
+ * line chunks are distributed across OpenMP threads.
+ *
+ * @author LN697
+ * @version 1.0
+ */
+
+#include <vector>
+#include "option_types.hpp"
+#include "pde_grid.hpp"
+
+namespace bsm {
+
+struct MultiAssetADIConfig {
+    int num_S{0};              ///< Intervals per asset; 0 selects 160 (2D) or 48 (3D)
+    int num_t{100};            ///< Time steps
+    ADIScheme scheme{ADIScheme::ModifiedCraigSneyd};
+    double theta{0.0};         ///< Implicitness; 0 selects the scheme default
+    double num_std{5.0};       ///< Log-grid half-width in units of σ_k √T
+    double concentration{0.5}; ///< sinh intensity around spot (relative width); <= 0 for uniform
+    int damping_steps{2};      ///< Leading steps replaced by two implicit half-steps
+};
+
+/**
+ * @brief Price and per-asset sensitivities of a multi-asset option
+ */
+struct MultiAssetPDEResult {
+    double price{0.0};
+    std::vector<double> delta;   ///< ∂V/∂S_k
+    std::vector<double> gamma;   ///< ∂²V/∂S_k²
+};
+
+/**
+ * @brief Price a European basket or spread option on 2 or 3 correlated assets
+ *
+ * @param correlation Symmetric d x d correlation matrix
+ * @param weights     Basket weights (negative weights give spreads)
+ * @throws std::invalid_argument for other dimensions or inconsistent inputs
+ *
+ * @par Complexity: O(num_S^d * num_t)
+ */
+MultiAssetPDEResult pde_multi_asset_adi(const std::vector<double>& S0,
+                                        const std::vector<double>& sigma,
+                                        const std::vector<std::vector<double>>& correlation,
+                                        double r, double T,
+                                        const std::vector<double>& weights, double K,
+                                        OptionType type,
+                                        const MultiAssetADIConfig& config = {});
+
+}
@@ -33,7 +33,9 @@
 #elif defined(__linux__)
 #include <sys/sysinfo.h>
 #include <unistd.h>
+#ifdef USE_NUMA
 #include <numa.h>
+#endif
 #elif defined(__APPLE__)
 #include <sys/types.h>
 #include <sys/sysctl.h>
@@ -54,9 +56,13 @@ struct ArchitectureInfo {
     int l1_cache_size;
     int l2_cache_size;
     int l3_cache_size;
+    bool has_sse42;
     bool has_avx;
     bool has_avx2;
     bool has_fma;
+    bool has_avx512f;
+    bool has_avx512dq;
+    bool has_avx512vl;
     bool has_numa;
     int numa_nodes;                 ///< Number of NUMA nodes
     std::vector<int> cpu_topology;  ///< CPU topology per NUMA node
@@ -125,6 +131,9 @@ public:
 
     /**
      * @brief Validate numerical accuracy on current hardware
+     *
+     * Besides the floating-point identities, every engine of the accuracy
+     * harness (accuracy_harness.hpp) must pass its reference check.
      */
     static bool validate_numerical_accuracy(double tolerance = 1e-14);
 
@@ -133,10 +142,17 @@ public:
      */
     static std::vector<std::string> get_optimization_recommendations();
 
+    /**
+     * @brief Detect the vector instruction sets usable by this process
+     *
+     * AVX and AVX-512 are reported only when the OS saves their registers.
+     * Cheap enough for runtime kernel dispatch (isa_dispatch.hpp).
+     */
+    static void detect_instruction_sets(ArchitectureInfo& info);
+
 private:
     static std::string detect_cpu_brand();
     static void detect_cache_info(ArchitectureInfo& info);
-    static void detect_instruction_sets(ArchitectureInfo& info);
     static void detect_numa_topology(ArchitectureInfo& info);
 };
 
@@ -162,6 +178,9 @@ public:
 
     /**
      * @brief Get optimal thread count for workload type
+     *
+     * Compute workloads use the tuned thread count when this machine has a
+     * tuning profile; otherwise the count follows the core topology.
      */
     static int get_optimal_thread_count(const std::string& workload_type = "compute");
 
@@ -0,0 +1,172 @@
+#pragma once
+
+/**
+ * @file result_writer.hpp
+ * @brief Buffered, schema-driven writers for large result sets
+ *
+ * Rows are appended cell by cell against a fixed schema and formatted straight
+ * into a byte buffer with std::to_chars, so no stream state, locale or
+ * temporary strings are involved. Three formats:
+ *
+ * - CSV: header line, then one line per row; text is quoted when needed.
+ * - NDJSON: one JSON object per line, so output can be consumed while it is
+ *   written; non-finite reals become null.
+ * - Binary: columnar row groups (see below), lossless and about 8 bytes per
+ *   numeric cell.
+ *
+ * Reals are written in the shortest form that reads back to the same double,
+ * or in fixed notation with a column's precision. The buffer goes to a file
+ * descriptor with write(2) (POSIX) or to a std::ostream; chunks larger than
+ * the buffer, such as binary column blocks, are written directly without
+ * being copied into it.
+ *
+ * Binary layout (host byte order):
+ * @code
+ * "BSMCOL1\n"  u32 columns  { u8 type, i8 precision, u16 name_bytes, name }...
+ * row group:   u32 rows (> 0), then per column
+ *              Real/Integer: rows x 8 bytes
+ *              Text:         rows x u32 lengths, u32 total, bytes
+ * end:         u32 0
+ * @endcode
+ *
+ * @author LN697
+ * @version 1.0
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace bsm {
+
+enum class ColumnType : std::uint8_t { Text, Integer, Real };
+
+struct ResultColumn {
+    std::string name;
+    ColumnType type{ColumnType::Real};
+    int precision{-1};   ///< Digits after the point for Real; -1 writes the shortest round-trip form
+};
+
+using ResultSchema = std::vector<ResultColumn>;
+
+enum class ResultFormat { CSV, NDJSON, Binary };
+
+/// "csv", "ndjson" (or "jsonl") and "binary"; false for anything else
+bool parse_result_format(const std::string& name, ResultFormat& format);
+
+/// Append s as the body of a JSON string: quotes, backslashes and control characters escaped
+void append_json_escaped(std::string& out, std::string_view s);
+
+class ResultWriter {
+public:
+    static constexpr std::size_t kDefaultBufferBytes = std::size_t(1) << 20;
+    static constexpr std::size_t kBinaryRowGroup = 4096;   ///< Rows per binary row group
+
+    /**
+     * @brief Write to a file; "-" is standard output
+     * @throws std::runtime_error if the file cannot be created
+     * @throws std::invalid_argument for an empty schema
+     */
+    ResultWriter(ResultSchema schema, ResultFormat format, const std::string& path,
+                 std::size_t buffer_bytes = kDefaultBufferBytes);
+
+    /// Write to an open descriptor with write(2); the descriptor stays open (POSIX only)
+    ResultWriter(ResultSchema schema, ResultFormat format, int fd,
+                 std::size_t buffer_bytes = kDefaultBufferBytes);
+
+    /// Write to a stream
+    ResultWriter(ResultSchema schema, ResultFormat format, std::ostream& out,
+                 std::size_t buffer_bytes = kDefaultBufferBytes);
+
+    /// Calls finish(); errors at that point are dropped, so call finish() to see them
+    ~ResultWriter();
+
+    ResultWriter(const ResultWriter&) = delete;
+    ResultWriter& operator=(const ResultWriter&) = delete;
+
+    /**
+     * @brief Append the next cell of the current row
+     * @throws std::invalid_argument if the cell does not match its column's type
+     *         or the row already has every column
+     */
+    ResultWriter& text(std::string_view value);
+    ResultWriter& integer(long long value);
+    ResultWriter& real(double value);
+
+    /// @throws std::invalid_argument if the row is missing cells
+    void end_row();
+
+    /**
+     * @brief Write pending rows (and the binary end marker) and flush the sink
+     *
+     * Further rows are rejected. Idempotent.
+     * @throws std::runtime_error on a write error
+     */
+    void finish();
+
+    const ResultSchema& schema() const { return schema_; }
+    std::size_t rows() const { return rows_; }
+    std::size_t bytes_written() const { return bytes_written_; }
+
+private:
+    void begin();
+    void check_cell(ColumnType type);
+    void put(const char* data, std::size_t n);
+    void put(std::string_view s) { put(s.data(), s.size()); }
+    void put_char(char c);
+    void put_real(double value, int precision);
+    void put_csv_text(std::string_view value);
+    void put_json_text(std::string_view value);
+    void flush_buffer();
+    void write_out(const char* data, std::size_t n);
+    void flush_row_group();
+
+    ResultSchema schema_;
+    ResultFormat format_;
+    std::vector<std::string> json_keys_;   ///< "{\"name\":" then ",\"name\":"
+
+    std::vector<char> buffer_;
+    std::size_t used_{0};
+
+    int fd_{-1};
+    bool owns_fd_{false};
+    std::ostream* out_{nullptr};
+    std::unique_ptr<std::ostream> owned_out_;
+
+    std::size_t column_{0};
+    std::size_t rows_{0};
+    std::size_t bytes_written_{0};
+    bool finished_{false};
+
+    // Binary row group being filled, one entry per column
+    std::vector<std::vector<unsigned char>> fixed_;     ///< Real/Integer cells, 8 bytes each
+    std::vector<std::vector<std::uint32_t>> lengths_;   ///< Text lengths
+    std::vector<std::string> text_bytes_;               ///< Text bytes
+    std::size_t group_rows_{0};
+};
+
+/**
+ * @brief Binary results read back into columns
+ *
+ * Column c holds its values in reals[c], integers[c] or texts[c] according to
+ * its type; the other two are empty.
+ */
+struct ColumnarResults {
+    ResultSchema schema;
+    std::size_t rows{0};
+    std::vector<std::vector<double>> reals;
+    std::vector<std::vector<long long>> integers;
+    std::vector<std::vector<std::string>> texts;
+};
+
+/**
+ * @brief Read a file written in ResultFormat::Binary
+ * @throws std::runtime_error if the file is missing, truncated or not in the format
+ */
+ColumnarResults read_columnar_results(const std::string& path);
+
+}
@@ -0,0 +1,148 @@
+#pragma once
+
+/**
+ * @file shm_cache.hpp
+ * @brief Pricing cache shared by every process on a host
+ *
+ * Workers pricing different books on the same machine often repeat the same
+ * expensive computations: PDE grids and Monte Carlo path sets for the same
+ * underlying and expiry, implied vols of the same quotes. The cache is a POSIX
+ * shared-memory region (shm_open) holding an open-addressing hash table that
+ * every process maps, so a result computed by one worker is reused by the
+ * others.
+ *
+ * - Keys are two independent 64-bit hashes of the normalised inputs, the
+ *   engine name and every configuration value the result depends on
+ *   (CacheKey). A hit needs both to match.
+ * - The table is lock-free: each 128-byte slot is guarded by a sequence
+ *   counter. A writer claims a slot by making the counter odd and publishes by
+ *   making it even again. A reader copies the slot and keeps the copy only if
+ *   the counter was even and unchanged. A writer that finds a slot busy gives
+ *   up rather than waits, since a store is only an optimisation.
+ * - Eviction is epoch based: the shared epoch advances every slots/4 stores,
+ *   hits refresh a slot's epoch, and a store whose probe window is full
+ *   replaces the slot with the oldest epoch.
+ *
+ * A value holds up to kMaxValues doubles. Results that depend on the thread
+ * count must not be cached. The engines only consult the cache when one is
+ * attached (attach_shared_pricing_cache, or BSM_SHM_CACHE=<name> in the
+ * environment); the region outlives the processes until remove() is called.
+ *
+ * @author LN697
+ * @version 1.0
+ */
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace bsm {
+
+/**
+ * @brief Incremental hash of a cache key's fields
+ *
+ * Reals are normalised so -0.0 equals 0.0 and every NaN is the same value;
+ * strings are length-prefixed so field boundaries cannot alias.
+ */
+class CacheKey {
+public:
+    explicit CacheKey(std::string_view engine) { add(engine); }
+
+    CacheKey& add(double value);
+    CacheKey& add(long long value);
+    CacheKey& add(std::string_view value);
+
+    std::uint64_t hash() const;    ///< Never 0 (the empty-slot marker)
+    std::uint64_t check() const;   ///< Second, independent hash
+
+private:
+    void mix(std::uint64_t word);
+
+    std::uint64_t h1_{0x243F6A8885A308D3ULL};
+    std::uint64_t h2_{0x13198A2E03707344ULL};
+};
+
+struct SharedCacheStats {
+    std::uint64_t hits{0};
+    std::uint64_t misses{0};
+    std::uint64_t stores{0};
+    std::uint64_t evictions{0};        ///< Stores that replaced another key
+    std::uint64_t busy{0};             ///< Stores skipped because the slot was being written
+};
+
+class SharedPricingCache {
+public:
+    static constexpr int kMaxValues = 11;
+    static constexpr int kProbeWindow = 16;
+    static constexpr std::size_t kDefaultSlots = std::size_t(1) << 16;   ///< 8 MiB
+
+    /**
+     * @brief Create the region or attach to an existing one
+     *
+     * @param name POSIX shared-memory name, e.g. "/bsm_cache"
+     * @param slots Table size for a new region, rounded up to a power of two;
+     *        an existing region keeps its own size
+     * @throws std::runtime_error if the region cannot be created or mapped, is
+     *         not a cache, or on systems without POSIX shared memory
+     */
+    explicit SharedPricingCache(const std::string& name, std::size_t slots = kDefaultSlots);
+    ~SharedPricingCache();
+
+    SharedPricingCache(const SharedPricingCache&) = delete;
+    SharedPricingCache& operator=(const SharedPricingCache&) = delete;
+
+    /**
+     * @brief Copy the cached values of key into values
+     * @return The number of values stored, or 0 on a miss
+     */
+    int lookup(const CacheKey& key, double* values, int capacity);
+
+    /**
+     * @brief Publish values for key (best effort: a busy slot is skipped)
+     * @throws std::invalid_argument for more than kMaxValues values
+     * @return false if the store was skipped
+     */
+    bool store(const CacheKey& key, const double* values, int count);
+
+    const std::string& name() const { return name_; }
+    std::size_t slots() const { return slots_; }
+    std::uint64_t epoch() const;
+
+    /// Counts of this process's calls (the region itself keeps no per-process state)
+    SharedCacheStats stats() const;
+
+    /// Unlink the region; processes that have it mapped keep using it. False if it did not exist.
+    static bool remove(const std::string& name);
+
+private:
+    struct Header;
+    struct Slot;
+
+    std::string name_;
+    std::size_t slots_{0};
+    std::size_t bytes_{0};
+    void* map_{nullptr};
+    Header* header_{nullptr};
+    Slot* table_{nullptr};
+    std::atomic<std::uint64_t> hits_{0}, misses_{0}, stores_{0}, evictions_{0}, busy_{0};
+};
+
+/**
+ * @brief The cache the engines consult, or nullptr
+ *
+ * The first call attaches to $BSM_SHM_CACHE when it is set.
+ */
+SharedPricingCache* shared_pricing_cache();
+
+/**
+ * @brief Attach (replacing any attached cache) before pricing starts
+ * @throws std::runtime_error as SharedPricingCache
+ */
+void attach_shared_pricing_cache(const std::string& name, std::size_t slots = SharedPricingCache::kDefaultSlots);
+
+/// Stop consulting the cache; not synchronised with pricing in progress
+void detach_shared_pricing_cache();
+
+}
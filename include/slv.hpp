@@ -1,8 +1,10 @@
 #pragma once
 #include <vector>
+#include <cstddef>
 #include <cstdint>
 #include <functional>
 #include <cmath>
+#include "barrier.hpp"
 #include "option_types.hpp"
 #include "stats.hpp"
 
@@ -18,6 +20,12 @@ struct HestonParams {
 
 using LocalVolFn = std::function<double(double, double)>;
 
+// Local volatility of n spots at one time t, written to sigma. Engines that
+// advance a block of paths in lock step call it once per step and block, so
+// grid surfaces can interpolate the whole block in one dispatched kernel
+// (DupireSurface::bilinear_batch, LeverageGrid::interpolate_batch).
+using LocalVolBatchFn = std::function<void(double t, std::size_t n, const double* S, double* sigma)>;
+
 struct CEVLocalVol {
     double alpha{0.20};
     double beta{1.0};
@@ -51,13 +59,27 @@ struct SmileLocalVol {
     }
 };
 
+// Precision::Float evolves spot and variance in single precision; the local
+// volatility is still evaluated in double and the payoff sums are double.
 MCResult mc_slv_price(double S0, double K, double r, double T,
                       long num_paths, long num_steps, OptionType type,
                       const HestonParams& heston,
                       const LocalVolFn& local_vol,
                       unsigned long seed = 987654321UL,
                       bool antithetic = true,
-                      bool use_andersen_qe = true);
+                      bool use_andersen_qe = true,
+                      Precision precision = Precision::Double);
+
+// As above with a batched local volatility; a LocalVolFn gives the same result
+// as evaluating it through this overload one spot at a time.
+MCResult mc_slv_price(double S0, double K, double r, double T,
+                      long num_paths, long num_steps, OptionType type,
+                      const HestonParams& heston,
+                      const LocalVolBatchFn& local_vol,
+                      unsigned long seed = 987654321UL,
+                      bool antithetic = true,
+                      bool use_andersen_qe = true,
+                      Precision precision = Precision::Double);
 
 std::vector<MCResult> mc_slv_multi_seeds(double S0, double K, double r, double T,
                                          long num_paths, long num_steps, OptionType type,
@@ -67,4 +89,31 @@ std::vector<MCResult> mc_slv_multi_seeds(double S0, double K, double r, double T
                                          bool antithetic = true,
                                          bool use_andersen_qe = true);
 
+// Strike x expiry grid from one SLV path set. num_steps covers the last expiry and is
+// spread over the expiry intervals so that every expiry falls on a time step; spot is
+// recorded at each expiry and all strikes are evaluated on the recorded states.
+MCResultGrid mc_slv_price_grid(double S0, const std::vector<double>& strikes,
+                               const std::vector<double>& expiries, double r,
+                               long num_paths, long num_steps, OptionType type,
+                               const HestonParams& heston,
+                               const LocalVolFn& local_vol,
+                               unsigned long seed = 987654321UL,
+                               bool antithetic = true,
+                               bool use_andersen_qe = true);
+
+// Single-barrier option under SLV. Within a step the log-Euler spot is a Brownian
+// motion with variance (L(S,t)^2 v) dt, so continuous monitoring uses the same
+// Brownian-bridge survival estimator as the GBM engine with that step variance.
+// Discrete monitoring checks monitoring_dates equally spaced dates (num_steps is
+// rounded up to a multiple of them).
+MCResult mc_slv_barrier_price(double S0, double K, double r, double T,
+                              long num_paths, long num_steps, OptionType type,
+                              const HestonParams& heston,
+                              const LocalVolFn& local_vol,
+                              const BarrierSpec& barrier,
+                              unsigned long seed = 987654321UL,
+                              bool antithetic = true,
+                              bool use_andersen_qe = true,
+                              int monitoring_dates = 0);
+
 }
@@ -43,6 +43,26 @@ struct LeverageGrid {
         double v2 = (1 - ws) * v21 + ws * v22;
         return (1 - wt) * v1 + wt * v2;
     }
+
+    // interpolate() at one time for n spots (strictly increasing S grid), through
+    // the dispatched surface interpolation kernel
+    void interpolate_batch(double tt, size_t n, const double* St, double* out) const {
+        if (t.empty() || S.empty()) {
+            std::fill(out, out + n, 1.0);
+            return;
+        }
+        size_t j1 = 0, j2 = 0;
+        double wt = 0.0;
+        if (tt >= t.back()) {
+            j1 = j2 = t.size() - 1;
+        } else if (tt > t.front()) {
+            auto itT = std::upper_bound(t.begin(), t.end(), tt) - t.begin();
+            j1 = std::max<size_t>(1, itT) - 1;
+            j2 = std::min(j1 + 1, t.size() - 1);
+            wt = (tt - t[j1]) / std::max(1e-12, t[j2] - t[j1]);
+        }
+        active_kernels().interp_rows(S.size(), S.data(), L[j1].data(), L[j2].data(), wt, n, St, out);
+    }
 };
 
 // Calibration configuration
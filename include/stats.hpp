@@ -69,6 +69,27 @@ struct MCResult {
     }
 };
 
+/**
+ * @brief Matrix of Monte Carlo results over a strike x expiry grid
+ *
+ * All cells are estimated from one shared path set, so their errors are
+ * correlated: differences between neighbouring cells (calendar and strike
+ * spreads) are far more precise than the individual std_error suggests.
+ * Storage is expiry-major.
+ */
+struct MCResultGrid {
+    std::vector<double> strikes;
+    std::vector<double> expiries;
+    std::vector<MCResult> results;
+
+    const MCResult& at(std::size_t expiry_index, std::size_t strike_index) const {
+        return results[expiry_index * strikes.size() + strike_index];
+    }
+    MCResult& at(std::size_t expiry_index, std::size_t strike_index) {
+        return results[expiry_index * strikes.size() + strike_index];
+    }
+};
+
 inline double mean(const std::vector<double>& x) {
     if (x.empty()) return 0.0;
     const double sum = std::accumulate(x.begin(), x.end(), 0.0);
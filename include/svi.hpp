@@ -0,0 +1,113 @@
+#pragma once
+
+/**
+ * @file svi.hpp
+ * @brief SVI implied-volatility smiles in total-variance form
+ *
+ * Each expiry is described by the raw SVI parameterisation of total implied
+ * variance w(k) = sigma_BS(K)^2 T in log-forward-moneyness k = ln(K / F):
+ *
+ *   w(k) = a + b (rho (k - m) + sqrt((k - m)^2 + sigma^2))
+ *
+ * which is linear in the wings (slopes b (1 +- rho), which Lee's moment formula
+ * bounds by 2) and smooth everywhere, so prices can be extrapolated beyond the
+ * quoted strikes and differentiated analytically.
+ *
+ * Fitting uses the quasi-explicit method of Zeliade: for fixed (m, sigma) the
+ * model is linear in (a, b sigma, rho b sigma), solved by least squares over the
+ * domain 0 <= b sigma <= 2 sigma, |rho b sigma| <= min(b sigma, 2 sigma - b sigma),
+ * i.e. b (1 + |rho|) <= 2; the remaining two parameters are found by Nelder-Mead.
+ *
+ * @author LN697
+ * @version 1.0
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "option_types.hpp"
+
+namespace bsm {
+
+struct ImpliedForward;
+
+/**
+ * @brief Raw SVI parameters of one expiry
+ */
+struct SVIParams {
+    double a{0.04};
+    double b{0.0};
+    double rho{0.0};
+    double m{0.0};
+    double sigma{0.1};
+
+    double total_variance(double k) const {
+        const double x = k - m;
+        return a + b * (rho * x + std::sqrt(x * x + sigma * sigma));
+    }
+    /// dw/dk
+    double d1(double k) const {
+        const double x = k - m;
+        return b * (rho + x / std::sqrt(x * x + sigma * sigma));
+    }
+    /// d2w/dk2
+    double d2(double k) const {
+        const double x = k - m, r2 = x * x + sigma * sigma;
+        return b * sigma * sigma / (r2 * std::sqrt(r2));
+    }
+    /**
+     * @brief Gatheral's density factor g(k); the smile is free of butterfly
+     *        arbitrage where g >= 0
+     */
+    double density_factor(double k) const {
+        const double w = total_variance(k), wp = d1(k);
+        const double t = 1.0 - k * wp / (2.0 * w);
+        return t * t - 0.25 * wp * wp * (1.0 / w + 0.25) + 0.5 * d2(k);
+    }
+};
+
+/**
+ * @brief Fitted smile of one (underlying, expiry)
+ */
+struct SVISlice {
+    std::string underlying;
+    double T{0.0};
+    double forward{0.0};
+    double discount{1.0};
+    SVIParams params;
+    double rms_vol_error{0.0};      ///< RMS of fitted minus quoted implied vol
+    std::size_t points{0};
+    bool valid{false};
+
+    double total_variance(double K) const { return params.total_variance(std::log(K / forward)); }
+    double implied_vol(double K) const { return std::sqrt(std::max(total_variance(K), 0.0) / T); }
+};
+
+/**
+ * @brief Fit raw SVI to total variances w_i at log-moneyness k_i
+ *
+ * weights may be empty (equal weights). At least five points are needed.
+ */
+SVIParams fit_svi(const std::vector<double>& k, const std::vector<double>& w,
+                  const std::vector<double>& weights = {});
+
+/**
+ * @brief Fit one SVI slice per valid implied forward of an option chain
+ *
+ * Implied vols come from implied_vols_from_forwards; only out-of-the-money
+ * quotes (puts below the forward, calls above) with a positive bid enter the
+ * fit. Slices are fitted in parallel under OpenMP and returned in the order of
+ * forwards.
+ */
+std::vector<SVISlice> fit_svi_surface(const std::vector<OptionQuote>& quotes,
+                                      const std::vector<ImpliedForward>& forwards);
+
+/**
+ * @brief Undiscounted out-of-the-money Black price for unit forward, strike e^k,
+ *        total variance w (put for k < 0, call for k >= 0), for n points
+ */
+void black_otm_normalized_batch(std::size_t n, const double* k, const double* w, double* out);
+
+}
@@ -0,0 +1,120 @@
+#pragma once
+
+/**
+ * @file tridiagonal.hpp
+ * @brief Tridiagonal (Thomas) solvers for finite-difference engines
+ *
+ * Three layouts are provided:
+ * - a single system,
+ * - a batch of systems with per-line coefficients stored interleaved, so
+ *   that element (row i, line l) lives at index i*stride + l and every
+ *   elimination step is a stride-1 loop over lines (SIMD across lines),
+ * - a batch of systems that share one set of coefficients, where the
+ *   factorisation is done once and only the right-hand sides are swept.
+ *
+ * The batch solvers run on the dispatched Tridiagonal kernel
+ * (isa_dispatch.hpp), so they use the widest vectors of the machine.
+ *
+ * All solvers overwrite the right-hand side with the solution. Systems are
+ * assumed to be diagonally dominant (no pivoting), which holds for the
+ * implicit stages of the PDE schemes in this library.
+ *
+ * @author LN697
+ * @version 1.0
+ */
+
+#include <cstddef>
+#include <vector>
+#include "isa_dispatch.hpp"
+
+namespace bsm {
+
+/**
+ * @brief Solve one tridiagonal system in place
+ *
+ * Row i reads a[i]*x[i-1] + b[i]*x[i] + c[i]*x[i+1] = d[i]; a[0] and c[n-1]
+ * are ignored.
+ *
+ * @param scratch Workspace of at least n doubles
+ * @par Complexity: O(n)
+ */
+inline void solve_tridiagonal(int n, const double* a, const double* b, const double* c,
+                              double* d, double* scratch) {
+    if (n <= 0) return;
+    double beta = b[0];
+    d[0] /= beta;
+    for (int i = 1; i < n; ++i) {
+        scratch[i] = c[i - 1] / beta;
+        beta = b[i] - a[i] * scratch[i];
+        d[i] = (d[i] - a[i] * d[i - 1]) / beta;
+    }
+    for (int i = n - 2; i >= 0; --i) d[i] -= scratch[i + 1] * d[i + 1];
+}
+
+/**
+ * @brief Solve m interleaved tridiagonal systems with per-line coefficients
+ *
+ * Element (row i, line l) of a, b, c and d is at i*stride + l with
+ * stride >= m.
+ *
+ * @param scratch Workspace of at least n*stride doubles
+ * @par Complexity: O(n*m), inner loops vectorise across lines
+ */
+inline void solve_tridiagonal_batch(int n, int m, const double* a, const double* b,
+                                    const double* c, double* d, double* scratch,
+                                    std::ptrdiff_t stride) {
+    // scratch holds 1/beta in row i and c'/beta terms are formed on the fly
+    active_kernels().tridiagonal(n, m, a, b, c, d, scratch, stride);
+}
+
+/**
+ * @brief Pre-factorised tridiagonal operator applied to many right-hand sides
+ *
+ * Useful when every line of a sweep has the same coefficients (e.g. the
+ * variance direction of the Heston operator, or a constant-coefficient
+ * direction of a multi-asset operator).
+ */
+class TridiagonalFactor {
+public:
+    TridiagonalFactor() = default;
+
+    TridiagonalFactor(const std::vector<double>& a, const std::vector<double>& b,
+                      const std::vector<double>& c) {
+        factor(a, b, c);
+    }
+
+    void factor(const std::vector<double>& a, const std::vector<double>& b,
+                const std::vector<double>& c) {
+        const std::size_t n = b.size();
+        a_ = a;
+        inv_beta_.assign(n, 0.0);
+        cp_.assign(n, 0.0);
+        if (n == 0) return;
+        inv_beta_[0] = 1.0 / b[0];
+        for (std::size_t i = 1; i < n; ++i) {
+            cp_[i - 1] = c[i - 1] * inv_beta_[i - 1];
+            inv_beta_[i] = 1.0 / (b[i] - a[i] * cp_[i - 1]);
+        }
+    }
+
+    int size() const { return static_cast<int>(inv_beta_.size()); }
+
+    /**
+     * @brief Solve for m right-hand sides stored interleaved (row stride `stride`)
+     */
+    void solve(double* d, int m, std::ptrdiff_t stride) const {
+        active_kernels().factored_tridiagonal(size(), m, a_.data(), inv_beta_.data(), cp_.data(), d, stride);
+    }
+
+    /**
+     * @brief Solve for one contiguous right-hand side
+     */
+    void solve(double* d) const { solve(d, 1, 1); }
+
+private:
+    std::vector<double> a_;
+    std::vector<double> inv_beta_;
+    std::vector<double> cp_;
+};
+
+}
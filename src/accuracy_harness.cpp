@@ -0,0 +1,533 @@
+/**
+ * @file accuracy_harness.cpp
+ * @brief Per-engine workloads and reference checks of the accuracy harness
+ *
+ * @author LN697
+ * @version 1.0
+ */
+
+#include "accuracy_harness.hpp"
+#include "analytic_bs.hpp"
+#include "arbitrage.hpp"
+#include "asian.hpp"
+#include "barrier.hpp"
+#include "implied_forward.hpp"
+#include "isa_dispatch.hpp"
+#include "iv_solve.hpp"
+#include "lsm.hpp"
+#include "math_utils.hpp"
+#include "monte_carlo_gbm.hpp"
+#include "path_store.hpp"
+#include "pde_cn.hpp"
+#include "pde_cn_american.hpp"
+#include "pde_heston_adi.hpp"
+#include "pde_multi_asset.hpp"
+#include "portfolio.hpp"
+#include "slv.hpp"
+#include "slv_calibration.hpp"
+#include "svi.hpp"
+#include "variance_swap.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+
+namespace bsm {
+
+namespace {
+
+constexpr double kR = 0.05;
+
+using Probe = EngineAccuracy (*)(double scale);
+
+long scaled(long n, double scale) { return std::max(1L, static_cast<long>(n * scale)); }
+
+// Error of an MC estimate in standard errors
+double se_units(double estimate, double se, double reference) {
+    return std::abs(estimate - reference) / std::max(se, 1e-12);
+}
+
+void push_mc(std::vector<double>& v, const MCResult& m) {
+    v.push_back(m.price);
+    v.push_back(m.std_error);
+}
+
+EngineAccuracy analytic_probe(double) {
+    EngineAccuracy e{"analytic_bs", "put-call parity residual", {}, 0.0, 1e-10};
+    for (int i = 0; i < 41; ++i) {
+        const double K = 60.0 + 2.0 * i, T = 0.1 + 0.05 * i, sigma = 0.1 + 0.01 * i;
+        const double c = black_scholes_price(100.0, K, kR, T, sigma, OptionType::Call);
+        const double p = black_scholes_price(100.0, K, kR, T, sigma, OptionType::Put);
+        e.values.insert(e.values.end(), {c, p,
+                                         black_scholes_delta(100.0, K, kR, T, sigma, OptionType::Call),
+                                         black_scholes_gamma(100.0, K, kR, T, sigma),
+                                         black_scholes_vega(100.0, K, kR, T, sigma),
+                                         black_scholes_theta(100.0, K, kR, T, sigma, OptionType::Put),
+                                         black_scholes_rho(100.0, K, kR, T, sigma, OptionType::Call)});
+        e.error = std::max(e.error, std::abs(c - p - (100.0 - K * std::exp(-kR * T))) / 100.0);
+    }
+    return e;
+}
+
+// Batch Black-Scholes and the lock-step implied vol solver (runtime-dispatched kernels)
+EngineAccuracy isa_kernel_probe(double scale) {
+    EngineAccuracy e{"isa_kernels", "batch vs scalar price, recovered vol", {}, 0.0, 1e-8};
+    const std::size_t n = static_cast<std::size_t>(scaled(4096, scale));
+    std::vector<double> S(n, 100.0), K(n), T(n), sigma(n), out(n), vols(n);
+    std::vector<OptionType> types(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        K[i] = 70.0 + 60.0 * static_cast<double>(i % 512) / 511.0;
+        T[i] = 0.25 + 0.25 * static_cast<double>(i % 8);
+        sigma[i] = 0.1 + 0.3 * static_cast<double>(i % 97) / 96.0;
+        types[i] = (i % 2) ? OptionType::Put : OptionType::Call;
+    }
+    black_scholes_price_batch(n, S.data(), K.data(), kR, T.data(), sigma.data(), types.data(), out.data());
+    for (std::size_t i = 0; i < n; ++i) {
+        const double ref = black_scholes_price(S[i], K[i], kR, T[i], sigma[i], types[i]);
+        e.error = std::max(e.error, std::abs(out[i] - ref) / std::max(ref, 1.0));
+    }
+    // One expiry at a time through the forward/discount interface
+    for (std::size_t i0 = 0; i0 < n; i0 += 512) {
+        const std::size_t m = std::min<std::size_t>(512, n - i0);
+        const double t = T[i0], D = std::exp(-kR * t), F = 100.0 / D;
+        std::vector<double> k(m), p(m), s(m);
+        std::vector<OptionType> ty(m);
+        for (std::size_t j = 0; j < m; ++j) {
+            k[j] = K[i0 + j];
+            s[j] = 0.1 + 0.3 * static_cast<double>(j % 97) / 96.0;
+            ty[j] = types[i0 + j];
+            p[j] = black_scholes_price(100.0, k[j], kR, t, s[j], ty[j]);
+        }
+        black_implied_vol_batch(F, D, t, m, k.data(), p.data(), ty.data(), &vols[i0], 1e-12, 100);
+        // In the money the time value is too small to pin the vol down; check out of the money only
+        for (std::size_t j = 0; j < m; ++j) {
+            const bool otm = (ty[j] == OptionType::Call) ? k[j] >= F : k[j] <= F;
+            if (otm && p[j] > 1e-6 * k[j]) e.error = std::max(e.error, std::abs(vols[i0 + j] - s[j]));
+        }
+    }
+    e.values = out;
+    e.values.insert(e.values.end(), vols.begin(), vols.end());
+    return e;
+}
+
+EngineAccuracy monte_carlo_probe(double scale) {
+    EngineAccuracy e{"monte_carlo_gbm", "standard errors from the closed forms", {}, 0.0, 4.0};
+    const long n = scaled(100000, scale);
+    const MCResult euro = mc_gbm_price(100.0, 105.0, kR, 1.0, 0.2, n, OptionType::Call, 12345UL);
+    push_mc(e.values, euro);
+    e.error = se_units(euro.price, euro.std_error, black_scholes_price(100.0, 105.0, kR, 1.0, 0.2, OptionType::Call));
+
+    const MCResult qmc = mc_gbm_price(100.0, 95.0, kR, 0.5, 0.25, n, OptionType::Put, 777UL, true, true, true);
+    push_mc(e.values, qmc);
+
+    const BarrierSpec b{BarrierType::DownOut, 85.0, 1.0};
+    const MCResult barrier = mc_gbm_barrier_price(100.0, 100.0, kR, 1.0, 0.2, n / 4, 50, OptionType::Call, b, 99UL);
+    push_mc(e.values, barrier);
+    e.error = std::max(e.error, se_units(barrier.price, barrier.std_error,
+                                         barrier_price_analytic(100.0, 100.0, kR, 1.0, 0.2, OptionType::Call, b)));
+
+    const MCResult asian = mc_gbm_asian_price(100.0, 100.0, kR, 1.0, 0.2, n / 4, 12, OptionType::Call, 4242UL);
+    push_mc(e.values, asian);
+
+    const MCResultGrid grid = mc_gbm_price_grid(100.0, {90.0, 100.0, 110.0}, {0.5, 1.0}, kR, 0.2, n / 4,
+                                                OptionType::Call, 31UL);
+    for (std::size_t j = 0; j < grid.expiries.size(); ++j)
+        for (std::size_t i = 0; i < grid.strikes.size(); ++i) {
+            const MCResult& m = grid.at(j, i);
+            push_mc(e.values, m);
+            e.error = std::max(e.error, se_units(m.price, m.std_error,
+                                                 black_scholes_price(100.0, grid.strikes[i], kR, grid.expiries[j],
+                                                                     0.2, OptionType::Call)));
+        }
+    return e;
+}
+
+EngineAccuracy lsm_probe(double scale) {
+    EngineAccuracy e{"lsm", "standard errors (plus 0.05) from a fine American PDE", {}, 0.0, 4.0};
+    LSMParams p;
+    p.paths = scaled(40000, scale);
+    p.steps = 50;
+    p.antithetic = true;
+    p.control_variate = true;
+    const LSMResult r = lsm_american_put_estimate(100.0, 100.0, kR, 1.0, 0.2, p);
+    const double ref = pde_crank_nicolson_american(100.0, 100.0, kR, 1.0, 0.2, 800, 800, OptionType::Put);
+    e.values = {r.price, r.std_error, r.cv_beta};
+    // 50 exercise dates price a Bermudan, a few cents below the American; allow that gap on top of the noise
+    e.error = std::max(0.0, std::abs(r.price - ref) - 0.05) / std::max(r.std_error, 1e-12);
+    return e;
+}
+
+EngineAccuracy slv_probe(double scale) {
+    EngineAccuracy e{"slv", "standard errors from Black-Scholes (negligible vol of vol)", {}, 0.0, 4.0};
+    const HestonParams flat{1.5, 0.04, 1e-4, 0.0, 0.04};
+    const auto unit = [](double, double) { return 1.0; };
+    const long n = scaled(40000, scale);
+    const MCResult m = mc_slv_price(100.0, 100.0, kR, 1.0, n, 50, OptionType::Call, flat, unit, 2024UL);
+    push_mc(e.values, m);
+    e.error = se_units(m.price, m.std_error, black_scholes_price(100.0, 100.0, kR, 1.0, 0.2, OptionType::Call));
+
+    // Full Heston with a CEV leverage: outputs only, compared across builds
+    const HestonParams heston{2.0, 0.04, 0.5, -0.7, 0.04};
+    CEVLocalVol cev;
+    push_mc(e.values, mc_slv_price(100.0, 95.0, kR, 1.0, n / 2, 50, OptionType::Put, heston, cev.to_fn(), 11UL));
+    const BarrierSpec b{BarrierType::UpOut, 130.0, 0.0};
+    const MCResult ko = mc_slv_barrier_price(100.0, 100.0, kR, 1.0, n / 2, 50, OptionType::Call, flat, unit, b);
+    push_mc(e.values, ko);
+    e.error = std::max(e.error, se_units(ko.price, ko.std_error,
+                                         barrier_price_analytic(100.0, 100.0, kR, 1.0, 0.2, OptionType::Call, b)));
+    return e;
+}
+
+EngineAccuracy slv_calibration_probe(double) {
+    EngineAccuracy e{"slv_calibration", "leverage outside [0.01, 10] or non-finite", {}, 0.0, 0.0};
+    const DupireSurface dupire = create_sample_dupire_surface();
+    LeverageGrid lev = create_sample_leverage_grid(dupire);
+    calibrate_leverage_iterative(dupire, HestonParams{2.0, 0.04, 0.3, -0.7, 0.04}, lev, 3);
+    for (const auto& row : lev.L)
+        for (double L : row) {
+            e.values.push_back(L);
+            if (!(L >= 0.01 && L <= 10.0)) e.error += 1.0;
+        }
+    return e;
+}
+
+EngineAccuracy pde_cn_probe(double) {
+    EngineAccuracy e{"pde_cn", "absolute error against the closed forms", {}, 0.0, 0.02};
+    for (OptionType type : {OptionType::Call, OptionType::Put})
+        for (double K : {90.0, 100.0, 110.0}) {
+            const double v = pde_crank_nicolson(100.0, K, kR, 1.0, 0.2, 400, 200, type);
+            e.values.push_back(v);
+            e.error = std::max(e.error, std::abs(v - black_scholes_price(100.0, K, kR, 1.0, 0.2, type)));
+        }
+    const BarrierSpec b{BarrierType::DownOut, 85.0, 1.0};
+    const double v = pde_crank_nicolson_barrier(100.0, 100.0, kR, 1.0, 0.2, 400, 200, OptionType::Call, b);
+    e.values.push_back(v);
+    e.error = std::max(e.error, std::abs(v - barrier_price_analytic(100.0, 100.0, kR, 1.0, 0.2, OptionType::Call, b)));
+    return e;
+}
+
+EngineAccuracy pde_american_probe(double) {
+    EngineAccuracy e{"pde_cn_american", "early-exercise premium below zero", {}, 0.0, 1e-8};
+    for (double K : {90.0, 100.0, 110.0}) {
+        const double am = pde_crank_nicolson_american(100.0, K, kR, 1.0, 0.2, 400, 200, OptionType::Put);
+        const double eu = pde_crank_nicolson(100.0, K, kR, 1.0, 0.2, 400, 200, OptionType::Put);
+        e.values.insert(e.values.end(), {am, eu});
+        e.error = std::max(e.error, eu - am);
+    }
+    return e;
+}
+
+EngineAccuracy heston_adi_probe(double) {
+    EngineAccuracy e{"pde_heston_adi", "absolute error against Black-Scholes (negligible vol of vol)", {}, 0.0, 0.02};
+    const HestonParams flat{1.5, 0.04, 0.01, 0.0, 0.04};
+    const PDEResult bs_like = pde_heston_adi(100.0, 100.0, kR, 1.0, OptionType::Call, flat);
+    e.values = {bs_like.price, bs_like.delta, bs_like.gamma};
+    e.error = std::abs(bs_like.price - black_scholes_price(100.0, 100.0, kR, 1.0, 0.2, OptionType::Call));
+
+    const HestonParams heston{2.0, 0.04, 0.5, -0.7, 0.04};
+    const PDEResult am = pde_heston_adi(100.0, 100.0, kR, 1.0, OptionType::Put, heston, nullptr,
+                                        ExerciseStyle::American);
+    const PDEResult ko = pde_heston_adi(100.0, 100.0, kR, 1.0, OptionType::Call, heston, nullptr,
+                                        ExerciseStyle::European, BarrierSpec{BarrierType::UpOut, 130.0, 0.0});
+    e.values.insert(e.values.end(), {am.price, am.delta, ko.price, ko.delta});
+    return e;
+}
+
+EngineAccuracy multi_asset_probe(double) {
+    EngineAccuracy e{"pde_multi_asset", "absolute error against Margrabe's exchange formula", {}, 0.0, 0.02};
+    const std::vector<std::vector<double>> corr2{{1.0, 0.5}, {0.5, 1.0}};
+    const double T = 1.0, s = std::sqrt(0.3 * 0.3 + 0.2 * 0.2 - 2.0 * 0.5 * 0.3 * 0.2);
+    const double d1 = (std::log(100.0 / 95.0) + 0.5 * s * s * T) / (s * std::sqrt(T));
+    const double margrabe = 100.0 * norm_cdf(d1) - 95.0 * norm_cdf(d1 - s * std::sqrt(T));
+    const MultiAssetPDEResult ex = pde_multi_asset_adi({100.0, 95.0}, {0.3, 0.2}, corr2, kR, T, {1.0, -1.0}, 0.0,
+                                                       OptionType::Call);
+    e.values = {ex.price, ex.delta[0], ex.delta[1]};
+    e.error = std::abs(ex.price - margrabe);
+
+    const std::vector<std::vector<double>> corr3{{1.0, 0.5, 0.3}, {0.5, 1.0, 0.4}, {0.3, 0.4, 1.0}};
+    MultiAssetADIConfig cfg;
+    cfg.num_S = 32;
+    cfg.num_t = 25;
+    const MultiAssetPDEResult basket = pde_multi_asset_adi({100.0, 100.0, 100.0}, {0.2, 0.3, 0.25}, corr3, kR, T,
+                                                           {1.0 / 3, 1.0 / 3, 1.0 / 3}, 100.0, OptionType::Call, cfg);
+    e.values.push_back(basket.price);
+    e.values.insert(e.values.end(), basket.delta.begin(), basket.delta.end());
+    return e;
+}
+
+EngineAccuracy barrier_probe(double scale) {
+    EngineAccuracy e{"barrier", "in-out parity residual", {}, 0.0, 1e-10};
+    const long n = scaled(2000, scale);
+    BarrierBatch batch;
+    for (long i = 0; i < n; ++i) {
+        const double K = 80.0 + 40.0 * static_cast<double>(i % 101) / 100.0;
+        const double T = 0.25 + 0.25 * static_cast<double>(i % 7);
+        const double sigma = 0.15 + 0.01 * static_cast<double>(i % 11);
+        const OptionType type = (i % 2) ? OptionType::Put : OptionType::Call;
+        const bool down = (i / 2) % 2 == 0;
+        const double level = down ? 80.0 : 125.0;
+        batch.push_back(100.0, K, T, sigma, type, BarrierSpec{down ? BarrierType::DownOut : BarrierType::UpOut, level, 0.0});
+        batch.push_back(100.0, K, T, sigma, type, BarrierSpec{down ? BarrierType::DownIn : BarrierType::UpIn, level, 0.0});
+    }
+    barrier_price_batch(batch, kR, e.values);
+    for (std::size_t i = 0; i + 1 < e.values.size(); i += 2) {
+        const double vanilla = black_scholes_price(100.0, batch.strike[i], kR, batch.T[i], batch.sigma[i], batch.type[i]);
+        e.error = std::max(e.error, std::abs(e.values[i] + e.values[i + 1] - vanilla) / std::max(vanilla, 1.0));
+    }
+    std::vector<double> discrete;
+    barrier_price_batch(batch, kR, discrete, 52);
+    e.values.insert(e.values.end(), discrete.begin(), discrete.end());
+    return e;
+}
+
+EngineAccuracy asian_probe(double scale) {
+    EngineAccuracy e{"asian", "batch vs scalar price", {}, 0.0, 1e-12};
+    const long n = scaled(2000, scale);
+    AsianBatch batch;
+    for (long i = 0; i < n; ++i)
+        batch.push_back(100.0, 80.0 + 40.0 * static_cast<double>(i % 101) / 100.0,
+                        0.25 + 0.25 * static_cast<double>(i % 7), 0.15 + 0.01 * static_cast<double>(i % 11),
+                        (i % 3) ? 12 : 0, (i % 2) ? OptionType::Put : OptionType::Call);
+    for (AsianFormula f : {AsianFormula::Geometric, AsianFormula::TurnbullWakeman, AsianFormula::Levy}) {
+        std::vector<double> out;
+        asian_price_batch(batch, kR, f, out);
+        for (long i = 0; i < n; i += 37) {
+            const double ref = asian_arithmetic_approx(batch.spot[i], batch.strike[i], kR, batch.T[i], batch.sigma[i],
+                                                       batch.type[i], batch.num_fixings[i], f);
+            e.error = std::max(e.error, std::abs(out[i] - ref) / std::max(ref, 1.0));
+        }
+        e.values.insert(e.values.end(), out.begin(), out.end());
+    }
+    return e;
+}
+
+std::vector<OptionQuote> sample_chain(double scale, std::vector<UnderlyingMarket>& markets) {
+    return generate_sample_option_chain(static_cast<std::size_t>(scaled(4, scale)), 40, 42UL, &markets);
+}
+
+EngineAccuracy arbitrage_probe(double scale) {
+    EngineAccuracy e{"arbitrage", "violations found in an arbitrage-free chain", {}, 0.0, 0.0};
+    std::vector<UnderlyingMarket> markets;
+    const std::vector<OptionQuote> quotes = sample_chain(scale, markets);
+    const ArbitrageScanResult clean = scan_option_chain(quotes, markets);
+    e.error = static_cast<double>(clean.violations.size());
+
+    // Crossed and mispriced copies of a few quotes must be caught
+    std::vector<OptionQuote> dirty = quotes;
+    for (std::size_t i = 0; i < dirty.size(); i += 97) std::swap(dirty[i].bid, dirty[i].ask);
+    const ArbitrageScanResult found = scan_option_chain(dirty, markets);
+    e.values = {static_cast<double>(clean.num_slices), static_cast<double>(found.violations.size())};
+    for (const ArbitrageViolation& v : found.violations) e.values.push_back(v.size);
+    return e;
+}
+
+EngineAccuracy implied_forward_probe(double scale) {
+    EngineAccuracy e{"implied_forward", "relative forward error against spot carry", {}, 0.0, 1e-3};
+    std::vector<UnderlyingMarket> markets;
+    const std::vector<OptionQuote> quotes = sample_chain(scale, markets);
+    const std::vector<ImpliedForward> fwd = implied_forwards(quotes);
+    std::map<std::string, const UnderlyingMarket*> by_name;
+    for (const UnderlyingMarket& m : markets) by_name[m.underlying] = &m;
+    for (const ImpliedForward& f : fwd) {
+        e.values.insert(e.values.end(), {f.forward, f.discount});
+        const UnderlyingMarket* m = by_name[f.underlying];
+        if (!f.valid || !m) { e.error = std::numeric_limits<double>::infinity(); continue; }
+        const double ref = m->spot * std::exp((m->r - m->q) * f.T);
+        e.error = std::max(e.error, std::abs(f.forward - ref) / ref);
+    }
+    // Out-of-the-money quotes only: deep in the money the mid can sit on the
+    // intrinsic bound, where the vol flips between a value and NaN
+    const std::vector<double> vols = implied_vols_from_forwards(quotes, fwd);
+    for (std::size_t i = 0; i < quotes.size(); ++i) {
+        const auto f = std::find_if(fwd.begin(), fwd.end(), [&](const ImpliedForward& x) {
+            return x.underlying == quotes[i].underlying && x.T == quotes[i].T;
+        });
+        if (f == fwd.end()) continue;
+        const bool otm = (quotes[i].type == OptionType::Call) ? quotes[i].strike >= f->forward
+                                                              : quotes[i].strike <= f->forward;
+        if (otm) e.values.push_back(vols[i]);
+    }
+    return e;
+}
+
+EngineAccuracy svi_probe(double scale) {
+    EngineAccuracy e{"svi", "worst RMS implied-vol error of the fitted slices", {}, 0.0, 0.01};
+    std::vector<UnderlyingMarket> markets;
+    const std::vector<OptionQuote> quotes = sample_chain(scale, markets);
+    const std::vector<SVISlice> slices = fit_svi_surface(quotes, implied_forwards(quotes));
+    for (const SVISlice& s : slices) {
+        // Fitted vols rather than raw parameters, which are poorly identified
+        for (double k = -0.3; k <= 0.3001; k += 0.05) e.values.push_back(s.implied_vol(s.forward * std::exp(k)));
+        e.error = std::max(e.error, s.valid ? s.rms_vol_error : std::numeric_limits<double>::infinity());
+    }
+    return e;
+}
+
+EngineAccuracy variance_swap_probe(double scale) {
+    EngineAccuracy e{"variance_swap", "SVI replication of flat smiles against sigma^2", {}, 0.0, 1e-9};
+    for (double vol : {0.1, 0.2, 0.4})
+        for (double T : {0.1, 1.0}) {
+            SVIParams flat;
+            flat.a = vol * vol * T;
+            flat.b = 0.0;
+            const double fair = svi_fair_variance(flat, T);
+            e.values.push_back(fair);
+            e.error = std::max(e.error, std::abs(fair - vol * vol) / (vol * vol));
+        }
+
+    // Replication and the VIX-style strip on a chain: outputs only
+    std::vector<UnderlyingMarket> markets;
+    const std::vector<OptionQuote> quotes = sample_chain(scale, markets);
+    const std::vector<ImpliedForward> fwd = implied_forwards(quotes);
+    const std::vector<VarianceSwapQuote> term = variance_term_structure(quotes, fwd, fit_svi_surface(quotes, fwd));
+    for (const VarianceSwapQuote& q : term) e.values.insert(e.values.end(), {q.fair_variance, q.discrete_variance});
+    if (!markets.empty()) e.values.push_back(vix_style_index(term, markets.front().underlying));
+    return e;
+}
+
+EngineAccuracy portfolio_probe(double scale) {
+    EngineAccuracy e{"portfolio", "grouped vs per-position analytic prices", {}, 0.0, 1e-10};
+    const std::vector<PositionSpec> book = generate_sample_portfolio(static_cast<std::size_t>(scaled(2000, scale)));
+    PortfolioPricingConfig cfg;
+    const PortfolioValuation grouped = price_portfolio(book, cfg);
+    cfg.group_positions = false;
+    const PortfolioValuation single = price_portfolio(book, cfg);
+    for (std::size_t i = 0; i < book.size(); ++i) {
+        const PositionValuation& g = grouped.positions[i];
+        e.values.insert(e.values.end(), {g.price, g.delta, g.gamma, g.vega, g.theta});
+        e.error = std::max(e.error, std::abs(g.price - single.positions[i].price) / std::max(g.price, 1.0));
+    }
+    // Shared PDE grids and MC paths: outputs only
+    PortfolioPricingConfig pde;
+    pde.pde_S_steps = 200;
+    pde.pde_T_steps = 100;
+    pde.mc_paths = 20000;
+    for (PricingModel model : {PricingModel::PDE, PricingModel::MonteCarlo})
+        for (const PositionValuation& v : price_portfolio(generate_sample_portfolio(64, 7UL, model), pde).positions)
+            e.values.push_back(v.price);
+    return e;
+}
+
+EngineAccuracy path_store_probe(double scale) {
+    EngineAccuracy e{"path_store", "relative round-trip error of the 16-bit log-return encoding", {}, 0.0, 1e-4};
+    const long paths = scaled(4096, scale);
+    const int dates = 16;
+    PathStore store(paths, dates, PathLayout::TimeMajor, PathEncoding::LogReturn16, 100.0);
+    std::vector<double> S(static_cast<std::size_t>(paths));
+    for (int t = 0; t < dates; ++t) {
+        store.set_log_range(t, 1.0);
+        fill_standard_normals(5, static_cast<std::uint64_t>(t) * paths, S.size(), S.data());
+        for (double& s : S) s = 100.0 * std::exp(0.2 * std::sqrt((t + 1) / 16.0) * s);
+        for (long p = 0; p < paths; ++p) {
+            store.set(p, t, S[p]);
+            const double back = store.get(p, t);
+            if (std::abs(std::log(S[p] / 100.0)) < 1.0)
+                e.error = std::max(e.error, std::abs(back - S[p]) / S[p]);
+            if (p % 64 == 0) e.values.push_back(back);
+        }
+    }
+    return e;
+}
+
+const Probe kProbes[] = {
+    analytic_probe,    isa_kernel_probe, monte_carlo_probe, lsm_probe,         slv_probe,
+    slv_calibration_probe, pde_cn_probe, pde_american_probe, heston_adi_probe, multi_asset_probe,
+    barrier_probe,     asian_probe,      arbitrage_probe,   implied_forward_probe, svi_probe,
+    variance_swap_probe, portfolio_probe, path_store_probe,
+};
+
+} // namespace
+
+std::vector<EngineAccuracy> run_accuracy_harness(const AccuracyHarnessConfig& config) {
+    std::vector<EngineAccuracy> results;
+    for (Probe probe : kProbes) {
+        EngineAccuracy best;
+        double best_ms = std::numeric_limits<double>::infinity();
+        for (int i = 0; i < std::max(1, config.repeats); ++i) {
+            const auto t0 = std::chrono::steady_clock::now();
+            best = probe(config.scale);
+            best_ms = std::min(best_ms, std::chrono::duration<double, std::milli>(
+                                            std::chrono::steady_clock::now() - t0).count());
+        }
+        best.elapsed_ms = best_ms;
+        results.push_back(std::move(best));
+    }
+    return results;
+}
+
+void save_accuracy_results(const std::string& path, const std::vector<EngineAccuracy>& results) {
+    std::ofstream out(path, std::ios::trunc);
+    if (!out) throw std::runtime_error("save_accuracy_results: cannot write " + path);
+    out << std::setprecision(17);
+    for (const EngineAccuracy& e : results) {
+        out << "engine " << e.engine << " " << e.elapsed_ms << " " << e.error << " " << e.tolerance << " "
+            << e.values.size() << "\n";
+        for (double v : e.values) out << v << "\n";
+    }
+    if (!out) throw std::runtime_error("save_accuracy_results: cannot write " + path);
+}
+
+std::vector<EngineAccuracy> load_accuracy_results(const std::string& path) {
+    std::ifstream in(path);
+    if (!in) throw std::runtime_error("load_accuracy_results: cannot read " + path);
+    std::vector<EngineAccuracy> results;
+    std::string tag;
+    while (in >> tag) {
+        EngineAccuracy e;
+        std::size_t n = 0;
+        std::string error, tolerance;
+        if (tag != "engine" || !(in >> e.engine >> e.elapsed_ms >> error >> tolerance >> n))
+            throw std::runtime_error("load_accuracy_results: malformed file " + path);
+        // Errors may be inf or nan, which operator>> does not parse
+        e.error = std::strtod(error.c_str(), nullptr);
+        e.tolerance = std::strtod(tolerance.c_str(), nullptr);
+        e.values.resize(n);
+        for (double& v : e.values) {
+            std::string s;
+            if (!(in >> s)) throw std::runtime_error("load_accuracy_results: truncated file " + path);
+            v = std::strtod(s.c_str(), nullptr);
+        }
+        results.push_back(std::move(e));
+    }
+    return results;
+}
+
+std::vector<EngineAccuracyDelta> compare_accuracy_results(const std::vector<EngineAccuracy>& reference,
+                                                          const std::vector<EngineAccuracy>& current) {
+    const double inf = std::numeric_limits<double>::infinity();
+    std::vector<EngineAccuracyDelta> deltas;
+    for (const EngineAccuracy& cur : current) {
+        EngineAccuracyDelta d{cur.engine, 0.0, inf, cur.passed()};
+        const auto ref = std::find_if(reference.begin(), reference.end(),
+                                      [&](const EngineAccuracy& r) { return r.engine == cur.engine; });
+        if (ref != reference.end() && ref->values.size() == cur.values.size()) {
+            d.speedup = ref->elapsed_ms / std::max(cur.elapsed_ms, 1e-6);
+            d.max_rel_delta = 0.0;
+            for (std::size_t i = 0; i < cur.values.size(); ++i) {
+                const double a = cur.values[i], b = ref->values[i];
+                if (std::isnan(a) || std::isnan(b)) {
+                    if (std::isnan(a) != std::isnan(b)) d.max_rel_delta = inf;
+                    continue;
+                }
+                if (a == b) continue;   // also equal infinities
+                d.max_rel_delta = std::max(d.max_rel_delta, std::abs(a - b) / std::max(std::abs(b), 1e-6));
+            }
+        }
+        deltas.push_back(d);
+    }
+    for (const EngineAccuracy& ref : reference) {
+        const bool missing = std::none_of(current.begin(), current.end(),
+                                          [&](const EngineAccuracy& c) { return c.engine == ref.engine; });
+        if (missing) deltas.push_back(EngineAccuracyDelta{ref.engine, 0.0, inf, false});
+    }
+    return deltas;
+}
+
+}
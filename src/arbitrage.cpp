@@ -0,0 +1,269 @@
+/**
+ * @file arbitrage.cpp
+ * @brief Vectorised static-arbitrage scanner for option-chain snapshots
+ *
+ * @author LN697
+ * @version 1.0
+ */
+
+#include "arbitrage.hpp"
+#include "analytic_bs.hpp"
+#include "math_utils.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <unordered_map>
+
+namespace bsm {
+
+namespace {
+
+constexpr double kInf = std::numeric_limits<double>::infinity();
+constexpr std::size_t kNoLeg = ArbitrageViolation::kNoLeg;
+
+struct QuoteKey {
+    double T, strike;
+    std::size_t index;
+};
+
+// One expiry of one underlying as structure-of-arrays over distinct strikes.
+// Unquoted sides are bid = -inf, ask = +inf: every check is (bids received) -
+// (asks paid) - bound, so a missing leg yields -inf and never a NaN.
+struct Slice {
+    double T{0.0};
+    std::vector<double> K, cb, ca, pb, pa;
+    std::vector<std::size_t> cbi, cai, pbi, pai;   // quotes supplying each side
+
+    std::size_t size() const { return K.size(); }
+    void add_row(double strike) {
+        K.push_back(strike);
+        cb.push_back(-kInf); ca.push_back(kInf); pb.push_back(-kInf); pa.push_back(kInf);
+        cbi.push_back(kNoLeg); cai.push_back(kNoLeg); pbi.push_back(kNoLeg); pai.push_back(kNoLeg);
+    }
+};
+
+std::vector<Slice> build_slices(const std::vector<std::size_t>& members, const std::vector<OptionQuote>& quotes) {
+    std::vector<QuoteKey> keys(members.size());
+    for (std::size_t m = 0; m < members.size(); ++m) {
+        keys[m] = {quotes[members[m]].T, quotes[members[m]].strike, members[m]};
+    }
+    std::sort(keys.begin(), keys.end(), [](const QuoteKey& a, const QuoteKey& b) {
+        return a.T < b.T || (a.T == b.T && a.strike < b.strike);
+    });
+
+    std::vector<Slice> slices;
+    for (const QuoteKey& k : keys) {
+        if (slices.empty() || slices.back().T != k.T) {
+            slices.emplace_back();
+            slices.back().T = k.T;
+        }
+        Slice& s = slices.back();
+        if (s.size() == 0 || s.K.back() != k.strike) s.add_row(k.strike);
+        const std::size_t i = s.size() - 1;
+        const OptionQuote& q = quotes[k.index];
+        const bool call = q.type == OptionType::Call;
+        double& bid = call ? s.cb[i] : s.pb[i];
+        double& ask = call ? s.ca[i] : s.pa[i];
+        if (q.bid > bid) { bid = q.bid; (call ? s.cbi[i] : s.pbi[i]) = k.index; }
+        if (q.ask < ask) { ask = q.ask; (call ? s.cai[i] : s.pai[i]) = k.index; }
+    }
+    return slices;
+}
+
+// Scans one underlying; v is scratch for the per-strike violation sizes
+class UnderlyingScanner {
+public:
+    UnderlyingScanner(const ArbitrageScanConfig& config, std::vector<ArbitrageViolation>& out)
+        : cfg_(config), out_(out) {}
+
+    void scan(const std::vector<Slice>& slices, const UnderlyingMarket* market) {
+        const double r = market ? market->r : 0.0;
+        const double q = market ? market->q : 0.0;
+        for (std::size_t s = 0; s < slices.size(); ++s) {
+            const Slice& sl = slices[s];
+            const double D = std::exp(-r * sl.T);
+            if (cfg_.crossed_quotes) crossed(sl);
+            if (cfg_.put_call_parity && market) parity(sl, market->spot * std::exp(-q * sl.T), D);
+            if (cfg_.spreads) spreads(sl, D);
+            if (cfg_.butterflies) butterflies(sl);
+            if (cfg_.calendars && q == 0.0 && s + 1 < slices.size()) calendar(sl, slices[s + 1]);
+        }
+    }
+
+private:
+    void emit(ArbitrageCheck check, std::size_t n, std::size_t a, std::size_t b, std::size_t c = kNoLeg) {
+        out_.push_back(ArbitrageViolation{check, v_[n], {{a, b, c}}});
+    }
+
+    void crossed(const Slice& s) {
+        const std::size_t n = s.size();
+        v_.resize(n);
+        for (std::size_t i = 0; i < n; ++i) v_[i] = s.cb[i] - s.ca[i];
+        for (std::size_t i = 0; i < n; ++i) if (v_[i] > cfg_.tolerance) emit(ArbitrageCheck::CrossedQuote, i, s.cbi[i], s.cai[i]);
+        for (std::size_t i = 0; i < n; ++i) v_[i] = s.pb[i] - s.pa[i];
+        for (std::size_t i = 0; i < n; ++i) if (v_[i] > cfg_.tolerance) emit(ArbitrageCheck::CrossedQuote, i, s.pbi[i], s.pai[i]);
+    }
+
+    // Sell the synthetic forward (C - P) against F_disc - K D, or buy it
+    void parity(const Slice& s, double F_disc, double D) {
+        const std::size_t n = s.size();
+        v_.resize(n);
+        for (std::size_t i = 0; i < n; ++i) v_[i] = (s.cb[i] - s.pa[i]) - (F_disc - s.K[i] * D);
+        for (std::size_t i = 0; i < n; ++i) if (v_[i] > cfg_.tolerance) emit(ArbitrageCheck::PutCallParity, i, s.cbi[i], s.pai[i]);
+        for (std::size_t i = 0; i < n; ++i) v_[i] = (F_disc - s.K[i] * D) - (s.ca[i] - s.pb[i]);
+        for (std::size_t i = 0; i < n; ++i) if (v_[i] > cfg_.tolerance) emit(ArbitrageCheck::PutCallParity, i, s.cai[i], s.pbi[i]);
+    }
+
+    // Adjacent strikes: 0 <= C(K1) - C(K2) <= (K2 - K1) D and likewise for puts
+    void spreads(const Slice& s, double D) {
+        const std::size_t n = s.size();
+        if (n < 2) return;
+        const std::size_t m = n - 1;
+        v_.resize(m);
+        for (std::size_t i = 0; i < m; ++i) v_[i] = s.cb[i + 1] - s.ca[i];
+        for (std::size_t i = 0; i < m; ++i) if (v_[i] > cfg_.tolerance) emit(ArbitrageCheck::CallSpread, i, s.cai[i], s.cbi[i + 1]);
+        for (std::size_t i = 0; i < m; ++i) v_[i] = s.cb[i] - s.ca[i + 1] - (s.K[i + 1] - s.K[i]) * D;
+        for (std::size_t i = 0; i < m; ++i) if (v_[i] > cfg_.tolerance) emit(ArbitrageCheck::CallSpread, i, s.cbi[i], s.cai[i + 1]);
+        for (std::size_t i = 0; i < m; ++i) v_[i] = s.pb[i] - s.pa[i + 1];
+        for (std::size_t i = 0; i < m; ++i) if (v_[i] > cfg_.tolerance) emit(ArbitrageCheck::PutSpread, i, s.pbi[i], s.pai[i + 1]);
+        for (std::size_t i = 0; i < m; ++i) v_[i] = s.pb[i + 1] - s.pa[i] - (s.K[i + 1] - s.K[i]) * D;
+        for (std::size_t i = 0; i < m; ++i) if (v_[i] > cfg_.tolerance) emit(ArbitrageCheck::PutSpread, i, s.pai[i], s.pbi[i + 1]);
+    }
+
+    // Middle strike against the chord of its neighbours: w V(K1) + (1 - w) V(K3) >= V(K2)
+    void butterflies(const Slice& s) {
+        const std::size_t n = s.size();
+        if (n < 3) return;
+        const std::size_t m = n - 2;
+        w_.resize(m);
+        v_.resize(m);
+        for (std::size_t i = 0; i < m; ++i) w_[i] = (s.K[i + 2] - s.K[i + 1]) / (s.K[i + 2] - s.K[i]);
+        for (std::size_t i = 0; i < m; ++i) v_[i] = s.cb[i + 1] - w_[i] * s.ca[i] - (1.0 - w_[i]) * s.ca[i + 2];
+        for (std::size_t i = 0; i < m; ++i) if (v_[i] > cfg_.tolerance) emit(ArbitrageCheck::CallButterfly, i, s.cai[i], s.cbi[i + 1], s.cai[i + 2]);
+        for (std::size_t i = 0; i < m; ++i) v_[i] = s.pb[i + 1] - w_[i] * s.pa[i] - (1.0 - w_[i]) * s.pa[i + 2];
+        for (std::size_t i = 0; i < m; ++i) if (v_[i] > cfg_.tolerance) emit(ArbitrageCheck::PutButterfly, i, s.pai[i], s.pbi[i + 1], s.pai[i + 2]);
+    }
+
+    // Strikes listed in both expiries: sell the near call, buy the far one
+    void calendar(const Slice& near, const Slice& far) {
+        std::size_t j = 0;
+        for (std::size_t i = 0; i < near.size(); ++i) {
+            while (j < far.size() && far.K[j] < near.K[i]) ++j;
+            if (j == far.size()) break;
+            if (far.K[j] != near.K[i]) continue;
+            const double size = near.cb[i] - far.ca[j];
+            if (size > cfg_.tolerance) {
+                out_.push_back(ArbitrageViolation{ArbitrageCheck::Calendar, size, {{near.cbi[i], far.cai[j], kNoLeg}}});
+            }
+        }
+    }
+
+    const ArbitrageScanConfig& cfg_;
+    std::vector<ArbitrageViolation>& out_;
+    std::vector<double> v_, w_;
+};
+
+} // namespace
+
+const char* arbitrage_check_name(ArbitrageCheck check) {
+    switch (check) {
+        case ArbitrageCheck::PutCallParity: return "put-call parity";
+        case ArbitrageCheck::CallSpread: return "call spread";
+        case ArbitrageCheck::PutSpread: return "put spread";
+        case ArbitrageCheck::CallButterfly: return "call butterfly";
+        case ArbitrageCheck::PutButterfly: return "put butterfly";
+        case ArbitrageCheck::Calendar: return "calendar";
+        case ArbitrageCheck::CrossedQuote: return "crossed quote";
+    }
+    return "unknown";
+}
+
+ArbitrageScanResult scan_option_chain(const std::vector<OptionQuote>& quotes,
+                                      const std::vector<UnderlyingMarket>& markets,
+                                      const ArbitrageScanConfig& config) {
+    const auto start = std::chrono::steady_clock::now();
+
+    std::unordered_map<std::string, std::size_t> index;
+    std::vector<std::vector<std::size_t>> members;
+    for (std::size_t i = 0; i < quotes.size(); ++i) {
+        auto it = index.find(quotes[i].underlying);
+        if (it == index.end()) {
+            it = index.emplace(quotes[i].underlying, members.size()).first;
+            members.emplace_back();
+        }
+        members[it->second].push_back(i);
+    }
+    std::vector<const UnderlyingMarket*> market_of(members.size(), nullptr);
+    for (const UnderlyingMarket& m : markets) {
+        auto it = index.find(m.underlying);
+        if (it != index.end()) market_of[it->second] = &m;
+    }
+
+    const long num_groups = static_cast<long>(members.size());
+    std::vector<std::vector<ArbitrageViolation>> found(members.size());
+    std::vector<std::size_t> slice_count(members.size(), 0);
+    #ifdef _OPENMP
+    #pragma omp parallel for schedule(dynamic)
+    #endif
+    for (long g = 0; g < num_groups; ++g) {
+        const std::vector<Slice> slices = build_slices(members[g], quotes);
+        slice_count[g] = slices.size();
+        UnderlyingScanner(config, found[g]).scan(slices, market_of[g]);
+    }
+
+    ArbitrageScanResult result;
+    result.num_underlyings = members.size();
+    std::size_t total = 0;
+    for (std::size_t g = 0; g < found.size(); ++g) {
+        total += found[g].size();
+        result.num_slices += slice_count[g];
+    }
+    result.violations.reserve(total);
+    for (const auto& f : found) result.violations.insert(result.violations.end(), f.begin(), f.end());
+    result.elapsed_ms = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+std::vector<OptionQuote> generate_sample_option_chain(std::size_t num_underlyings, int strikes_per_expiry,
+                                                      unsigned long seed,
+                                                      std::vector<UnderlyingMarket>* markets) {
+    constexpr double kExpiryDays[] = {7, 14, 30, 60, 90, 180, 365, 730};
+    constexpr double kRate = 0.03;
+    constexpr double kSpread = 0.02;     // relative half-spread
+    constexpr double kTick = 0.01;
+
+    RNG rng(seed);
+    std::vector<OptionQuote> chain;
+    chain.reserve(num_underlyings * (sizeof(kExpiryDays) / sizeof(kExpiryDays[0])) * strikes_per_expiry * 2);
+    if (markets) markets->clear();
+    for (std::size_t u = 0; u < num_underlyings; ++u) {
+        const std::string symbol = "UND" + std::to_string(u);
+        const double spot = std::round(20.0 + 480.0 * rng.uni());
+        const double atm_vol = 0.15 + 0.35 * rng.uni();
+        if (markets) markets->push_back(UnderlyingMarket{symbol, spot, kRate, 0.0});
+        for (double days : kExpiryDays) {
+            const double T = days / 365.0;
+            for (int k = 0; k < strikes_per_expiry; ++k) {
+                // Strikes from 60% to 140% of spot; mild skew in log-moneyness
+                const double strike = spot * (0.6 + 0.8 * k / std::max(1, strikes_per_expiry - 1));
+                const double vol = atm_vol * (1.0 - 0.1 * std::log(strike / spot));
+                for (OptionType type : {OptionType::Call, OptionType::Put}) {
+                    const double mid = black_scholes_price(spot, strike, kRate, T, vol, type);
+                    OptionQuote q;
+                    q.underlying = symbol;
+                    q.T = T;
+                    q.strike = strike;
+                    q.type = type;
+                    q.bid = std::max(0.0, mid * (1.0 - kSpread) - kTick);
+                    q.ask = mid * (1.0 + kSpread) + kTick;
+                    chain.push_back(std::move(q));
+                }
+            }
+        }
+    }
+    return chain;
+}
+
+}
@@ -0,0 +1,138 @@
+#include "asian.hpp"
+#include "math_utils.hpp"
+#include "engine_tuning.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace bsm {
+
+namespace {
+
+constexpr int kChunk = kMaxBatchChunk;   // capacity of the kernel stack buffers
+
+struct LognormalMoments {
+    double forward;     ///< E[average]
+    double variance;    ///< Var[ln average]
+};
+
+LognormalMoments geometric_moments(double S0, double r, double T, double sigma, int n) {
+    const double t_bar = (n > 0) ? T * (n + 1) / (2.0 * n) : 0.5 * T;
+    const double var = (n > 0) ? sigma * sigma * T * (n + 1) * (2.0 * n + 1) / (6.0 * n * n)
+                               : sigma * sigma * T / 3.0;
+    return {S0 * std::exp((r - 0.5 * sigma * sigma) * t_bar + 0.5 * var), var};
+}
+
+// First two moments of the continuous average (1/T) ∫ S_t dt
+LognormalMoments turnbull_wakeman_moments(double S0, double r, double T, double sigma) {
+    const double s2 = sigma * sigma;
+    const bool small_r = std::abs(r) * T < 1e-8;
+    const double M1 = small_r ? S0 : S0 * std::expm1(r * T) / (r * T);
+    if (s2 <= 0.0) return {M1, 0.0};
+    const double M2 = small_r
+        ? 2.0 * S0 * S0 * (std::expm1(s2 * T) - s2 * T) / (s2 * s2 * T * T)
+        : 2.0 * S0 * S0 * std::exp((2.0 * r + s2) * T) / ((r + s2) * (2.0 * r + s2) * T * T)
+          + 2.0 * S0 * S0 / (r * T * T) * (1.0 / (2.0 * r + s2) - std::exp(r * T) / (r + s2));
+    return {M1, std::log(M2 / (M1 * M1))};
+}
+
+// Σ_{i=1..n} e^{c i}
+inline double exp_series(double c, int n) {
+    return (std::abs(c) < 1e-12) ? n : std::exp(c) * std::expm1(n * c) / std::expm1(c);
+}
+
+// Exact first two moments of the discrete average (1/n) Σ S_{t_i}, using
+// E[S_i S_j] = S0² e^{(r+σ²) t_i + r t_j} for i <= j. With q = e^{r dt} the inner
+// sums are geometric series; near r dt = 0 their difference cancels, so the
+// moments are accumulated term by term instead.
+LognormalMoments levy_moments(double S0, double r, double T, double sigma, int n) {
+    if (n <= 0) return turnbull_wakeman_moments(S0, r, T, sigma);
+    const double dt = T / n, s2dt = sigma * sigma * dt;
+    double m1 = 0.0, m2 = 0.0;
+    if (std::abs(r * dt) > 1e-6) {
+        // Σ_i (q²p)^i + 2 Σ_i (qp)^i (q^{i+1} - q^{n+1}) / (1 - q), p = e^{σ² dt}
+        const double diag = exp_series(2.0 * r * dt + s2dt, n);
+        m1 = exp_series(r * dt, n);
+        m2 = diag + 2.0 * (std::exp(r * dt) * diag - std::exp(r * T + r * dt) * exp_series(r * dt + s2dt, n))
+                    / -std::expm1(r * dt);
+    } else {
+        double tail = 0.0;   // Σ_{j>i} e^{r t_j}
+        for (int i = n; i >= 1; --i) {
+            const double er = std::exp(r * i * dt), es = std::exp(s2dt * i);
+            m1 += er;
+            m2 += er * er * es + 2.0 * er * es * tail;
+            tail += er;
+        }
+    }
+    const double M1 = S0 * m1 / n, M2 = S0 * S0 * m2 / (static_cast<double>(n) * n);
+    return {M1, std::log(M2 / (M1 * M1))};
+}
+
+LognormalMoments moments(AsianFormula formula, double S0, double r, double T, double sigma, int n) {
+    switch (formula) {
+        case AsianFormula::Geometric: return geometric_moments(S0, r, T, sigma, n);
+        case AsianFormula::TurnbullWakeman: return turnbull_wakeman_moments(S0, r, T, sigma);
+        case AsianFormula::Levy: break;
+    }
+    return levy_moments(S0, r, T, sigma, n);
+}
+
+// Prices options [0, n): moments first, then the Black formula on the matched
+// lognormal with the CDFs evaluated over flat arrays
+void asian_kernel(int n, const double* S, const double* K, const double* T, const double* sig,
+                  const int* fixings, const OptionType* type, double r, AsianFormula formula,
+                  double* out) {
+    double fwd[kChunk], df[kChunk], phi[kChunk], sd[kChunk], d1[kChunk], d2[kChunk];
+    for (int i = 0; i < n; ++i) {
+        const LognormalMoments m = moments(formula, S[i], r, T[i], sig[i], fixings[i]);
+        fwd[i] = m.forward;
+        sd[i] = std::sqrt(std::max(m.variance, 1e-300));
+        df[i] = std::exp(-r * T[i]);
+        phi[i] = (type[i] == OptionType::Call) ? 1.0 : -1.0;
+        const double x = (std::log(fwd[i] / K[i]) + 0.5 * sd[i] * sd[i]) / sd[i];
+        d1[i] = phi[i] * x;
+        d2[i] = phi[i] * (x - sd[i]);
+    }
+    for (int i = 0; i < n; ++i) d1[i] = norm_cdf(d1[i]);
+    for (int i = 0; i < n; ++i) d2[i] = norm_cdf(d2[i]);
+    for (int i = 0; i < n; ++i) {
+        out[i] = phi[i] * df[i] * (fwd[i] * d1[i] - K[i] * d2[i]);
+    }
+}
+
+} // namespace
+
+double asian_geometric_price(double S0, double K, double r, double T, double sigma,
+                             OptionType type, int num_fixings) {
+    return asian_arithmetic_approx(S0, K, r, T, sigma, type, num_fixings, AsianFormula::Geometric);
+}
+
+double asian_arithmetic_approx(double S0, double K, double r, double T, double sigma,
+                               OptionType type, int num_fixings, AsianFormula formula) {
+    if (T <= 0.0 || sigma <= 0.0) {
+        const double F = (T > 0.0) ? moments(formula, S0, r, T, 0.0, num_fixings).forward : S0;
+        const double df = std::exp(-r * std::max(T, 0.0));
+        return df * ((type == OptionType::Call) ? std::max(F - K, 0.0) : std::max(K - F, 0.0));
+    }
+    double out = 0.0;
+    asian_kernel(1, &S0, &K, &T, &sigma, &num_fixings, &type, r, formula, &out);
+    return out;
+}
+
+void asian_price_batch(const AsianBatch& batch, double r, AsianFormula formula,
+                       std::vector<double>& out) {
+    const std::size_t n = batch.size();
+    out.resize(n);
+    const std::size_t chunk = static_cast<std::size_t>(engine_tuning().batch_chunk);
+    const int num_chunks = static_cast<int>((n + chunk - 1) / chunk);
+    #ifdef _OPENMP
+    #pragma omp parallel for schedule(static)
+    #endif
+    for (int c = 0; c < num_chunks; ++c) {
+        const std::size_t i0 = static_cast<std::size_t>(c) * chunk;
+        const int m = static_cast<int>(std::min(chunk, n - i0));
+        asian_kernel(m, &batch.spot[i0], &batch.strike[i0], &batch.T[i0], &batch.sigma[i0],
+                     &batch.num_fixings[i0], &batch.type[i0], r, formula, &out[i0]);
+    }
+}
+
+}
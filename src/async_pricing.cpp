@@ -0,0 +1,150 @@
+/**
+ * @file async_pricing.cpp
+ * @brief Priority executor and sliced asynchronous portfolio pricing
+ *
+ * @author LN697
+ * @version 1.0
+ */
+
+#include "async_pricing.hpp"
+#include <algorithm>
+
+namespace bsm {
+
+PricingExecutor::PricingExecutor(int workers) {
+    if (workers < 1) throw std::invalid_argument("PricingExecutor: workers must be at least 1");
+    threads_.reserve(static_cast<std::size_t>(workers));
+    for (int i = 0; i < workers; ++i) threads_.emplace_back([this] { worker_loop(); });
+}
+
+PricingExecutor::~PricingExecutor() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    ready_.notify_all();
+    for (auto& t : threads_) t.join();
+
+    // Workers are gone, so nothing else touches the queue
+    while (!queue_.empty()) {
+        Job job = queue_.top();
+        queue_.pop();
+        job.abandon();
+    }
+}
+
+std::size_t PricingExecutor::pending() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return queue_.size();
+}
+
+void PricingExecutor::post(JobPriority priority, std::function<void()> run, std::function<void()> abandon) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopping_) throw std::runtime_error("PricingExecutor: shutting down");
+        queue_.push(Job{static_cast<int>(priority), next_sequence_++, std::move(run), std::move(abandon)});
+    }
+    ready_.notify_one();
+}
+
+void PricingExecutor::worker_loop() {
+    for (;;) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            ready_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+            if (stopping_) return;
+            job = queue_.top();
+            queue_.pop();
+        }
+        job.run();
+    }
+}
+
+PricingExecutor& default_pricing_executor() {
+    static PricingExecutor executor;
+    return executor;
+}
+
+namespace {
+
+// State of one book, carried from slice to slice
+struct PortfolioJob {
+    PricingExecutor* executor;
+    std::vector<PositionSpec> positions;
+    PortfolioPricingConfig config;
+    JobOptions options;
+    std::size_t slice_positions;
+    std::chrono::steady_clock::time_point start;
+
+    bool planned{false};
+    std::vector<PricingGroup> groups;
+    std::size_t next_group{0};
+    PortfolioValuation valuation;
+    std::shared_ptr<detail::FutureState<PortfolioValuation>> state;
+};
+
+void fail(const std::shared_ptr<PortfolioJob>& job, std::exception_ptr error) {
+    job->state->complete(std::nullopt, error);
+}
+
+void run_slice(const std::shared_ptr<PortfolioJob>& job) {
+    if (job->options.cancel.cancelled()) {
+        fail(job, std::make_exception_ptr(PricingCancelled()));
+        return;
+    }
+    try {
+        if (!job->planned) {
+            job->groups = plan_pricing_groups(job->positions, job->config);
+            job->valuation.positions.resize(job->positions.size());
+            job->valuation.num_groups = job->groups.size();
+            job->planned = true;
+        }
+        // Whole groups up to the slice size, at least one
+        std::size_t end = job->next_group, covered = 0;
+        while (end < job->groups.size() && (covered == 0 || covered + job->groups[end].members.size() <= job->slice_positions))
+            covered += job->groups[end++].members.size();
+        price_pricing_groups(job->positions, job->groups, job->next_group, end, job->config, job->valuation.positions);
+        job->next_group = end;
+    } catch (...) {
+        fail(job, std::current_exception());
+        return;
+    }
+
+    if (job->next_group >= job->groups.size()) {
+        job->valuation.elapsed_ms = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - job->start).count();
+        job->state->complete(std::move(job->valuation), nullptr);
+        return;
+    }
+    try {
+        job->executor->post(job->options.priority, [job] { run_slice(job); },
+                            [job] { fail(job, std::make_exception_ptr(PricingCancelled())); });
+    } catch (...) {
+        fail(job, std::make_exception_ptr(PricingCancelled()));
+    }
+}
+
+}
+
+PricingFuture<PortfolioValuation> price_portfolio_async(PricingExecutor& executor,
+                                                        std::vector<PositionSpec> positions,
+                                                        const PortfolioPricingConfig& config,
+                                                        JobOptions options, std::size_t slice_positions) {
+    if (slice_positions == 0)
+        throw std::invalid_argument("price_portfolio_async: slice_positions must be positive");
+    auto job = std::make_shared<PortfolioJob>();
+    job->executor = &executor;
+    job->positions = std::move(positions);
+    job->config = config;
+    job->options = options;
+    job->slice_positions = slice_positions;
+    job->start = std::chrono::steady_clock::now();
+    job->state = std::make_shared<detail::FutureState<PortfolioValuation>>();
+
+    executor.post(options.priority, [job] { run_slice(job); },
+                  [job] { fail(job, std::make_exception_ptr(PricingCancelled())); });
+    return PricingFuture<PortfolioValuation>(job->state, &executor);
+}
+
+}
@@ -0,0 +1,143 @@
+#include "barrier.hpp"
+#include "math_utils.hpp"
+#include "engine_tuning.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace bsm {
+
+namespace {
+
+constexpr int kChunk = kMaxBatchChunk;   // capacity of the kernel stack buffers
+constexpr double kBGKBeta = 0.5825971579390106;   // -zeta(1/2) / sqrt(2 pi)
+
+// Term weights (A, B, C, D, E, F) of the Reiner-Rubinstein decomposition,
+// indexed by [barrier type][put][strike >= barrier]
+constexpr double kCoeffs[5][2][2][6] = {
+    // None
+    {{{1, 0, 0, 0, 0, 0}, {1, 0, 0, 0, 0, 0}}, {{1, 0, 0, 0, 0, 0}, {1, 0, 0, 0, 0, 0}}},
+    // DownOut
+    {{{0, 1, 0, -1, 0, 1}, {1, 0, -1, 0, 0, 1}}, {{0, 0, 0, 0, 0, 1}, {1, -1, 1, -1, 0, 1}}},
+    // UpOut
+    {{{1, -1, 1, -1, 0, 1}, {0, 0, 0, 0, 0, 1}}, {{1, 0, -1, 0, 0, 1}, {0, 1, 0, -1, 0, 1}}},
+    // DownIn
+    {{{1, -1, 0, 1, 1, 0}, {0, 0, 1, 0, 1, 0}}, {{1, 0, 0, 0, 1, 0}, {0, 1, -1, 1, 1, 0}}},
+    // UpIn
+    {{{0, 1, -1, 1, 1, 0}, {1, 0, 0, 0, 1, 0}}, {{0, 0, 1, 0, 1, 0}, {1, -1, 0, 1, 1, 0}}},
+};
+
+// Prices options [0, n) of the given arrays. All per-option branching is
+// resolved into coefficient rows before the arithmetic passes.
+void barrier_kernel(int n, const double* S, const double* K, const double* T, const double* sig,
+                    const double* level, const double* rebate, const OptionType* type,
+                    const BarrierType* barrier, double r, int monitoring_dates, double* out) {
+    // 10 distinct CDF arguments per option, stored argument-major; the rebate
+    // term's N(η(x2 - σ√T)) is N(±(x2 - σ√T)) of term B and reuses it
+    double arg[10][kChunk], cdf[10][kChunk];
+    double w[7][kChunk];                       // A..F weights and the breached-rebate weight
+    double phi[kChunk], eta[kChunk], df[kChunk];
+    double hs2m1[kChunk], hs2m[kChunk], hsml_p[kChunk], hsml_m[kChunk];
+
+    for (int i = 0; i < n; ++i) {
+        const int b = static_cast<int>(barrier[i]);
+        const bool put = type[i] == OptionType::Put;
+        const BarrierSpec spec{barrier[i], level[i], rebate[i]};
+        const bool down = is_down_barrier(barrier[i]);
+        double H = (barrier[i] == BarrierType::None) ? S[i] : level[i];
+        if (monitoring_dates > 0 && barrier[i] != BarrierType::None) {
+            H *= std::exp((down ? -1.0 : 1.0) * kBGKBeta * sig[i] * std::sqrt(T[i] / monitoring_dates));
+        }
+        const bool breached = barrier_breached(S[i], spec);
+        const double* c = kCoeffs[breached ? 0 : b][put ? 1 : 0][K[i] >= H ? 1 : 0];
+        const bool knocked_out = breached && !is_knock_in(barrier[i]);
+        for (int k = 0; k < 6; ++k) w[k][i] = knocked_out ? 0.0 : c[k];
+        w[6][i] = knocked_out ? 1.0 : 0.0;
+        phi[i] = put ? -1.0 : 1.0;
+        eta[i] = down ? 1.0 : -1.0;
+
+        const double st = sig[i] * std::sqrt(T[i]);
+        const double mu = r / (sig[i] * sig[i]) - 0.5;
+        const double lambda = std::sqrt(mu * mu + 2.0 * r / (sig[i] * sig[i]));
+        const double lnHS = std::log(H / S[i]);
+        df[i] = std::exp(-r * T[i]);
+        const double HS = H / S[i];
+        hs2m[i] = std::exp(2.0 * mu * lnHS);
+        hs2m1[i] = hs2m[i] * HS * HS;
+        hsml_p[i] = std::exp((mu + lambda) * lnHS);
+        hsml_m[i] = hs2m[i] / hsml_p[i];
+
+        const double x1 = std::log(S[i] / K[i]) / st + (1.0 + mu) * st;
+        const double x2 = -lnHS / st + (1.0 + mu) * st;
+        const double y1 = std::log(H * H / (S[i] * K[i])) / st + (1.0 + mu) * st;
+        const double y2 = lnHS / st + (1.0 + mu) * st;
+        const double z = lnHS / st + lambda * st;
+        const double p = phi[i], e = eta[i];
+        arg[0][i] = p * x1;           arg[1][i] = p * (x1 - st);
+        arg[2][i] = p * x2;           arg[3][i] = p * (x2 - st);
+        arg[4][i] = e * y1;           arg[5][i] = e * (y1 - st);
+        arg[6][i] = e * y2;           arg[7][i] = e * (y2 - st);
+        arg[8][i] = e * z;            arg[9][i] = e * (z - 2.0 * lambda * st);
+    }
+
+    for (int a = 0; a < 10; ++a)
+        for (int i = 0; i < n; ++i) cdf[a][i] = norm_cdf(arg[a][i]);
+
+    for (int i = 0; i < n; ++i) {
+        const double p = phi[i], Kd = K[i] * df[i];
+        const double A = p * (S[i] * cdf[0][i] - Kd * cdf[1][i]);
+        const double B = p * (S[i] * cdf[2][i] - Kd * cdf[3][i]);
+        const double C = p * (S[i] * hs2m1[i] * cdf[4][i] - Kd * hs2m[i] * cdf[5][i]);
+        const double D = p * (S[i] * hs2m1[i] * cdf[6][i] - Kd * hs2m[i] * cdf[7][i]);
+        const double n_x2 = (p == eta[i]) ? cdf[3][i] : 1.0 - cdf[3][i];
+        const double E = rebate[i] * df[i] * (n_x2 - hs2m[i] * cdf[7][i]);
+        const double F = rebate[i] * (hsml_p[i] * cdf[8][i] + hsml_m[i] * cdf[9][i]);
+        out[i] = w[0][i] * A + w[1][i] * B + w[2][i] * C + w[3][i] * D + w[4][i] * E + w[5][i] * F
+               + w[6][i] * rebate[i];
+    }
+}
+
+// Expired or zero-volatility option: intrinsic value if alive, else the rebate
+double degenerate_barrier_price(double S0, double K, OptionType type, const BarrierSpec& barrier) {
+    const double intrinsic = (type == OptionType::Call) ? std::max(S0 - K, 0.0) : std::max(K - S0, 0.0);
+    if (barrier.type == BarrierType::None) return intrinsic;
+    const bool hit = barrier_breached(S0, barrier);
+    return (hit == is_knock_in(barrier.type)) ? intrinsic : barrier.rebate;
+}
+
+} // namespace
+
+double barrier_price_analytic(double S0, double K, double r, double T, double sigma,
+                              OptionType type, const BarrierSpec& barrier, int monitoring_dates) {
+    if (T <= 0.0 || sigma <= 0.0) return degenerate_barrier_price(S0, K, type, barrier);
+    double out = 0.0;
+    barrier_kernel(1, &S0, &K, &T, &sigma, &barrier.level, &barrier.rebate, &type, &barrier.type,
+                   r, monitoring_dates, &out);
+    return out;
+}
+
+void barrier_price_batch(const BarrierBatch& batch, double r, std::vector<double>& out,
+                         int monitoring_dates) {
+    const std::size_t n = batch.size();
+    out.resize(n);
+    const std::size_t chunk = static_cast<std::size_t>(engine_tuning().batch_chunk);
+    const int num_chunks = static_cast<int>((n + chunk - 1) / chunk);
+    #ifdef _OPENMP
+    #pragma omp parallel for schedule(static)
+    #endif
+    for (int c = 0; c < num_chunks; ++c) {
+        const std::size_t i0 = static_cast<std::size_t>(c) * chunk;
+        const int m = static_cast<int>(std::min(chunk, n - i0));
+        barrier_kernel(m, &batch.spot[i0], &batch.strike[i0], &batch.T[i0], &batch.sigma[i0],
+                       &batch.level[i0], &batch.rebate[i0], &batch.type[i0], &batch.barrier[i0],
+                       r, monitoring_dates, &out[i0]);
+        // The kernel assumes T > 0 and sigma > 0; rare degenerate rows are redone as in the scalar path
+        for (std::size_t i = i0; i < i0 + static_cast<std::size_t>(m); ++i) {
+            if (batch.T[i] <= 0.0 || batch.sigma[i] <= 0.0) {
+                out[i] = degenerate_barrier_price(batch.spot[i], batch.strike[i], batch.type[i],
+                                                  BarrierSpec{batch.barrier[i], batch.level[i], batch.rebate[i]});
+            }
+        }
+    }
+}
+
+}
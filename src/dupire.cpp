@@ -0,0 +1,144 @@
+/**
+ * @file dupire.cpp
+ * @brief Local volatility surface extraction from SVI total variance
+ *
+ * @author LN697
+ * @version 1.0
+ */
+
+#include "dupire.hpp"
+#include <chrono>
+#include <stdexcept>
+
+namespace bsm {
+
+namespace {
+
+// w, dw/dk and d2w/dk2 of one slice, sharing the square root
+struct SmileDerivatives {
+    double w, wk, wkk;
+};
+
+inline SmileDerivatives smile_at(const SVIParams& p, double k) {
+    const double x = k - p.m;
+    const double r2 = x * x + p.sigma * p.sigma;
+    const double r = std::sqrt(r2);
+    return SmileDerivatives{p.a + p.b * (p.rho * x + r), p.b * (p.rho + x / r), p.b * p.sigma * p.sigma / (r2 * r)};
+}
+
+bool strictly_increasing(const std::vector<double>& v) {
+    for (size_t i = 1; i < v.size(); ++i)
+        if (!(v[i] > v[i - 1])) return false;
+    return true;
+}
+
+} // namespace
+
+DupireExtractionStats extract_dupire_surface(const std::vector<SVISlice>& slices, DupireSurface& surface,
+                                             const DupireExtractionConfig& config) {
+    const auto start = std::chrono::steady_clock::now();
+    if (surface.t.empty() || surface.S.empty() || !strictly_increasing(surface.t) ||
+        !strictly_increasing(surface.S) || surface.S.front() <= 0.0)
+        throw std::invalid_argument("extract_dupire_surface: t and S must be non-empty, increasing, with S > 0");
+
+    std::vector<const SVISlice*> smile;
+    for (const SVISlice& s : slices) {
+        if (!s.valid || s.T <= 0.0 || s.forward <= 0.0) continue;
+        if (!smile.empty() && s.underlying != smile.front()->underlying)
+            throw std::invalid_argument("extract_dupire_surface: slices of several underlyings");
+        smile.push_back(&s);
+    }
+    if (smile.empty()) throw std::invalid_argument("extract_dupire_surface: no valid slice");
+    std::sort(smile.begin(), smile.end(), [](const SVISlice* a, const SVISlice* b) { return a->T < b->T; });
+
+    const size_t Nt = surface.t.size(), Ns = surface.S.size();
+    std::vector<double> log_S(Ns);
+    for (size_t j = 0; j < Ns; ++j) log_S[j] = std::log(surface.S[j]);
+    surface.sigma.resize(Nt);
+    for (auto& row : surface.sigma) row.resize(Ns);
+
+    const double var_floor = config.min_variance_rate;
+    const double g_floor = config.min_density;
+    const double lo = config.min_vol, hi = config.max_vol;
+    size_t regularised = 0;
+    const long rows = static_cast<long>(Nt);
+    #ifdef _OPENMP
+    #pragma omp parallel for schedule(static) reduction(+ : regularised)
+    #endif
+    for (long it = 0; it < rows; ++it) {
+        const double t = std::max(surface.t[it], 1e-8);
+
+        // Bracketing slices and weights; outside the quoted expiries one slice
+        // is scaled in time (constant implied vol)
+        const SVISlice* a = smile.front();
+        const SVISlice* b = a;
+        double wa = 1.0, wb = 0.0, dT = 0.0;
+        if (t >= smile.back()->T) {
+            a = b = smile.back();
+        } else if (t > smile.front()->T) {
+            const auto upper = std::upper_bound(smile.begin(), smile.end(), t,
+                                                [](double x, const SVISlice* s) { return x < s->T; });
+            b = *upper;
+            a = *(upper - 1);
+            dT = b->T - a->T;
+            wb = (t - a->T) / dT;
+            wa = 1.0 - wb;
+        }
+        const bool scaled = (a == b);
+        const double scale = scaled ? t / a->T : 1.0;
+        const double log_F = wa * std::log(a->forward) + wb * std::log(b->forward);
+
+        double* out = surface.sigma[it].data();
+        for (size_t j = 0; j < Ns; ++j) {
+            const double k = log_S[j] - log_F;
+            const SmileDerivatives da = smile_at(a->params, k);
+            double w, wk, wkk, w_T;
+            if (scaled) {
+                w = scale * da.w;
+                wk = scale * da.wk;
+                wkk = scale * da.wkk;
+                w_T = da.w / a->T;
+            } else {
+                const SmileDerivatives db = smile_at(b->params, k);
+                w = wa * da.w + wb * db.w;
+                wk = wa * da.wk + wb * db.wk;
+                wkk = wa * da.wkk + wb * db.wkk;
+                w_T = (db.w - da.w) / dT;
+            }
+
+            double local_var;
+            bool clamped = false;
+            if (w <= 0.0) {
+                local_var = lo * lo;
+                clamped = true;
+            } else {
+                const double u = 1.0 - 0.5 * k * wk / w;
+                double g = u * u - 0.25 * wk * wk * (1.0 / w + 0.25) + 0.5 * wkk;
+                if (g < g_floor) {
+                    g = g_floor;
+                    clamped = true;
+                }
+                if (w_T < var_floor) {
+                    w_T = var_floor;
+                    clamped = true;
+                }
+                local_var = w_T / g;
+            }
+            double vol = std::sqrt(local_var);
+            if (vol < lo || vol > hi) {
+                vol = std::clamp(vol, lo, hi);
+                clamped = true;
+            }
+            out[j] = vol;
+            regularised += clamped ? 1 : 0;
+        }
+    }
+
+    DupireExtractionStats stats;
+    stats.points = Nt * Ns;
+    stats.regularised = regularised;
+    stats.elapsed_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return stats;
+}
+
+}
@@ -0,0 +1,380 @@
+/**
+ * @file engine_tuning.cpp
+ * @brief Tuning profiles and the engine knob sweep
+ *
+ * @author LN697
+ * @version 1.0
+ */
+
+#include "engine_tuning.hpp"
+#include "asian.hpp"
+#include "barrier.hpp"
+#include "pde_heston_adi.hpp"
+#include "pde_multi_asset.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <limits>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace bsm {
+
+namespace {
+
+struct Knob {
+    const char* key;
+    int EngineTuning::*field;
+};
+
+const Knob kKnobs[] = {
+    {"threads", &EngineTuning::threads},
+    {"heston_line_block", &EngineTuning::heston_line_block},
+    {"heston_column_chunk", &EngineTuning::heston_column_chunk},
+    {"basket_line_block", &EngineTuning::basket_line_block},
+    {"basket_column_chunk", &EngineTuning::basket_column_chunk},
+    {"batch_chunk", &EngineTuning::batch_chunk},
+};
+
+void validate(const EngineTuning& t, const char* func) {
+    if (t.threads < 0)
+        throw std::invalid_argument(std::string(func) + ": threads must be non-negative");
+    if (t.heston_line_block < 1 || t.heston_column_chunk < 1 || t.basket_line_block < 1 ||
+        t.basket_column_chunk < 1 || t.batch_chunk < 1)
+        throw std::invalid_argument(std::string(func) + ": block sizes must be positive");
+    if (t.batch_chunk > kMaxBatchChunk)
+        throw std::invalid_argument(std::string(func) + ": batch_chunk exceeds kMaxBatchChunk");
+}
+
+void apply_threads(const EngineTuning& t) {
+#ifdef _OPENMP
+    if (t.threads > 0) omp_set_num_threads(t.threads);
+#else
+    (void)t;
+#endif
+}
+
+std::string trim(const std::string& s) {
+    const auto b = s.find_first_not_of(" \t\r");
+    if (b == std::string::npos) return "";
+    const auto e = s.find_last_not_of(" \t\r");
+    return s.substr(b, e - b + 1);
+}
+
+// Section name of a "[...]" line; the fingerprint itself may contain brackets
+bool section_name(const std::string& line, std::string& name) {
+    if (line.size() < 2 || line.front() != '[' || line.back() != ']') return false;
+    name = line.substr(1, line.size() - 2);
+    return true;
+}
+
+#if defined(__unix__) || defined(__APPLE__)
+// Exclusive flock on "<profile>.lock" for a whole read-merge-rename. The
+// profile itself cannot carry the lock: the rename replaces its inode.
+class ProfileLock {
+public:
+    explicit ProfileLock(const std::string& path) {
+        const std::string name = path + ".lock";
+        fd_ = open(name.c_str(), O_RDWR | O_CREAT, 0644);
+        if (fd_ < 0) throw std::runtime_error("save_tuning_profile: cannot open " + name);
+        while (flock(fd_, LOCK_EX) != 0) {
+            if (errno != EINTR) {
+                close(fd_);
+                throw std::runtime_error("save_tuning_profile: cannot lock " + name);
+            }
+        }
+    }
+    ~ProfileLock() { close(fd_); }   // Closing releases the lock
+    ProfileLock(const ProfileLock&) = delete;
+    ProfileLock& operator=(const ProfileLock&) = delete;
+
+private:
+    int fd_{-1};
+};
+#endif
+
+struct State {
+    EngineTuning active;
+
+    State() {
+        // A damaged or foreign profile must not stop the engines: keep the defaults
+        try {
+            EngineTuning t;
+            if (load_tuning_profile(default_tuning_profile_path(), hardware_fingerprint(), t)) active = t;
+        } catch (const std::exception&) {
+        }
+        apply_threads(active);
+    }
+};
+
+State& state() {
+    static State s;
+    return s;
+}
+
+using Clock = std::chrono::steady_clock;
+
+template <class F>
+double best_time_ms(int repeats, F&& run) {
+    double best = std::numeric_limits<double>::infinity();
+    for (int i = 0; i < std::max(1, repeats); ++i) {
+        const auto t0 = Clock::now();
+        run();
+        best = std::min(best, std::chrono::duration<double, std::milli>(Clock::now() - t0).count());
+    }
+    return best;
+}
+
+// Times every candidate of one knob with the others held at best, and keeps a
+// candidate only if it beats the incumbent by min_gain
+template <class F>
+void sweep(const char* key, int EngineTuning::*field, const std::vector<int>& candidates,
+           EngineTuning& best, const TuneOptions& opt, std::ostream* log, F&& run) {
+    set_engine_tuning(best);
+    run();   // warm-up: page in buffers, spin up the thread pool
+    const double incumbent_ms = best_time_ms(opt.repeats, run);
+    if (log) *log << "  " << key << " = " << best.*field << ": " << incumbent_ms << " ms (current)\n";
+
+    int winner = best.*field;
+    double winner_ms = incumbent_ms;
+    for (int c : candidates) {
+        if (c == best.*field) continue;
+        EngineTuning trial = best;
+        trial.*field = c;
+        set_engine_tuning(trial);
+        const double ms = best_time_ms(opt.repeats, run);
+        if (log) *log << "  " << key << " = " << c << ": " << ms << " ms\n";
+        if (ms < winner_ms) { winner = c; winner_ms = ms; }
+    }
+    if (winner_ms < (1.0 - opt.min_gain) * incumbent_ms) best.*field = winner;
+    set_engine_tuning(best);
+    if (log) *log << "  -> " << key << " = " << best.*field << "\n";
+}
+
+} // namespace
+
+const EngineTuning& engine_tuning() { return state().active; }
+
+void set_engine_tuning(const EngineTuning& tuning) {
+    validate(tuning, "set_engine_tuning");
+    state().active = tuning;
+    apply_threads(tuning);
+}
+
+// Same key in every build: it must not depend on PERFORMANCE=1 or NUMA support
+std::string hardware_fingerprint() {
+    std::string brand = "unknown";
+    std::ifstream cpuinfo("/proc/cpuinfo");
+    for (std::string line; std::getline(cpuinfo, line);) {
+        if (line.compare(0, 10, "model name") == 0) {
+            const auto colon = line.find(':');
+            if (colon != std::string::npos) brand = trim(line.substr(colon + 1));
+            break;
+        }
+    }
+    return brand + "_" + std::to_string(std::thread::hardware_concurrency()) + "t";
+}
+
+std::string default_tuning_profile_path() {
+    if (const char* env = std::getenv("BSM_TUNING_PROFILE")) {
+        if (*env) return env;
+    }
+    if (const char* home = std::getenv("HOME")) {
+        if (*home) return std::string(home) + "/.bsm_tuning.ini";
+    }
+    return "bsm_tuning.ini";
+}
+
+bool load_tuning_profile(const std::string& path, const std::string& fingerprint, EngineTuning& tuning) {
+    std::ifstream in(path);
+    if (!in) return false;
+
+    EngineTuning t = tuning;
+    bool found = false, inside = false;
+    for (std::string raw; std::getline(in, raw);) {
+        const std::string line = trim(raw);
+        if (line.empty() || line[0] == '#' || line[0] == ';') continue;
+        std::string name;
+        if (section_name(line, name)) {
+            inside = (name == fingerprint);
+            found = found || inside;
+            continue;
+        }
+        if (!inside) continue;
+        const auto eq = line.find('=');
+        if (eq == std::string::npos)
+            throw std::invalid_argument("load_tuning_profile: expected key = value, got '" + line + "'");
+        const std::string key = trim(line.substr(0, eq));
+        const std::string value = trim(line.substr(eq + 1));
+        for (const Knob& k : kKnobs) {
+            if (key != k.key) continue;
+            std::size_t used = 0;
+            int v = 0;
+            try {
+                v = std::stoi(value, &used);
+            } catch (const std::exception&) {
+                used = 0;
+            }
+            if (used == 0 || used != value.size())
+                throw std::invalid_argument("load_tuning_profile: bad value for " + key + ": '" + value + "'");
+            t.*k.field = v;
+        }
+    }
+    if (!found) return false;
+    validate(t, "load_tuning_profile");
+    tuning = t;
+    return true;
+}
+
+void save_tuning_profile(const std::string& path, const std::string& fingerprint, const EngineTuning& tuning) {
+    validate(tuning, "save_tuning_profile");
+#if defined(__unix__) || defined(__APPLE__)
+    // Tuners on several nodes may save into one shared profile at once
+    const ProfileLock lock(path);
+#endif
+
+    // Keep every other machine's section (and comments) as they are
+    std::vector<std::string> kept;
+    {
+        std::ifstream in(path);
+        bool skipping = false;
+        for (std::string raw; std::getline(in, raw);) {
+            std::string name;
+            if (section_name(trim(raw), name)) skipping = (name == fingerprint);
+            if (!skipping) kept.push_back(raw);
+        }
+    }
+    while (!kept.empty() && trim(kept.back()).empty()) kept.pop_back();
+
+    std::ostringstream text;
+    for (const std::string& line : kept) text << line << "\n";
+    if (!kept.empty()) text << "\n";
+    text << "[" << fingerprint << "]\n";
+    for (const Knob& k : kKnobs) text << k.key << " = " << tuning.*k.field << "\n";
+    const std::string contents = text.str();
+
+    // Write a uniquely named file beside the target and rename, so concurrent
+    // readers never see a partial file
+#if defined(__unix__) || defined(__APPLE__)
+    std::string tmp = path + ".XXXXXX";
+    const int fd = mkstemp(tmp.data());
+    if (fd < 0) throw std::runtime_error("save_tuning_profile: cannot create a temporary file beside " + path);
+    bool written = fchmod(fd, 0644) == 0;
+    for (std::size_t done = 0; written && done < contents.size();) {
+        const ssize_t n = write(fd, contents.data() + done, contents.size() - done);
+        if (n < 0 && errno == EINTR) continue;
+        written = n > 0;
+        if (written) done += static_cast<std::size_t>(n);
+    }
+    written = (close(fd) == 0) && written;
+    if (!written) {
+        std::remove(tmp.c_str());
+        throw std::runtime_error("save_tuning_profile: cannot write " + tmp);
+    }
+#else
+    const std::string tmp = path + ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::trunc);
+        out << contents;
+        if (!out) throw std::runtime_error("save_tuning_profile: cannot write " + tmp);
+    }
+#endif
+    if (std::rename(tmp.c_str(), path.c_str()) != 0) {
+        std::remove(tmp.c_str());
+        throw std::runtime_error("save_tuning_profile: cannot replace " + path);
+    }
+}
+
+EngineTuning tune_engines(const TuneOptions& options, std::ostream* log) {
+    EngineTuning best = engine_tuning();
+    const double scale = options.quick ? 0.5 : 1.0;
+    const auto sized = [scale](int n) { return std::max(8, static_cast<int>(n * scale)); };
+
+    // Threads, timed on the Heston ADI solver (the heaviest parallel engine)
+    HestonADIConfig heston_cfg;
+    heston_cfg.num_S = sized(160);
+    heston_cfg.num_v = sized(80);
+    heston_cfg.num_t = sized(40);
+    const HestonParams heston;
+    const auto run_heston = [&] {
+        pde_heston_adi(100.0, 100.0, 0.03, 1.0, OptionType::Put, heston, nullptr,
+                       ExerciseStyle::European, {}, heston_cfg);
+    };
+#ifdef _OPENMP
+    if (log) *log << "Threads (Heston ADI " << heston_cfg.num_S << "x" << heston_cfg.num_v << "):\n";
+    const int procs = omp_get_num_procs();
+    if (best.threads == 0) best.threads = omp_get_max_threads();
+    std::vector<int> threads;
+    for (int t = 1; t < procs; t *= 2) threads.push_back(t);
+    threads.push_back(procs);
+    sweep("threads", &EngineTuning::threads, threads, best, options, log, run_heston);
+#else
+    if (log) *log << "Threads: OpenMP is not enabled in this build, skipped\n";
+#endif
+
+    if (log) *log << "Heston ADI (" << heston_cfg.num_S << "x" << heston_cfg.num_v << "):\n";
+    sweep("heston_line_block", &EngineTuning::heston_line_block, {4, 8, 16, 32}, best, options, log, run_heston);
+    sweep("heston_column_chunk", &EngineTuning::heston_column_chunk, {16, 32, 64, 128, 256}, best, options, log,
+          run_heston);
+
+    // Basket ADI in 2D and 3D: the 3D problem exercises both strided sweeps
+    MultiAssetADIConfig cfg2, cfg3;
+    cfg2.num_S = sized(200);
+    cfg2.num_t = sized(20);
+    cfg3.num_S = sized(48);
+    cfg3.num_t = sized(10);
+    const std::vector<std::vector<double>> corr2 = {{1.0, 0.5}, {0.5, 1.0}};
+    const std::vector<std::vector<double>> corr3 = {{1.0, 0.5, 0.3}, {0.5, 1.0, 0.4}, {0.3, 0.4, 1.0}};
+    const auto run_basket = [&] {
+        pde_multi_asset_adi({100.0, 100.0}, {0.2, 0.3}, corr2, 0.03, 1.0, {0.5, 0.5}, 100.0,
+                            OptionType::Call, cfg2);
+        pde_multi_asset_adi({100.0, 100.0, 100.0}, {0.2, 0.3, 0.25}, corr3, 0.03, 1.0,
+                            {1.0 / 3, 1.0 / 3, 1.0 / 3}, 100.0, OptionType::Call, cfg3);
+    };
+    if (log) *log << "Basket ADI (2D " << cfg2.num_S << "^2, 3D " << cfg3.num_S << "^3):\n";
+    sweep("basket_line_block", &EngineTuning::basket_line_block, {8, 16, 32, 64}, best, options, log, run_basket);
+    sweep("basket_column_chunk", &EngineTuning::basket_column_chunk, {16, 32, 64, 128, 256}, best, options, log,
+          run_basket);
+
+    // Closed-form batches share one chunk size
+    const int n = options.quick ? 20000 : 100000;
+    AsianBatch asian;
+    BarrierBatch barrier;
+    for (int i = 0; i < n; ++i) {
+        const double K = 80.0 + 40.0 * (i % 101) / 100.0;
+        const double T = 0.25 + (i % 7) * 0.25;
+        const OptionType type = (i % 2) ? OptionType::Put : OptionType::Call;
+        asian.push_back(100.0, K, T, 0.2 + 0.01 * (i % 11), (i % 3) ? 12 : 0, type);
+        barrier.push_back(100.0, K, T, 0.2 + 0.01 * (i % 11), type,
+                          BarrierSpec{(i % 2) ? BarrierType::UpOut : BarrierType::DownIn,
+                                      (i % 2) ? 130.0 : 75.0, 1.0});
+    }
+    std::vector<double> out;
+    const auto run_batch = [&] {
+        asian_price_batch(asian, 0.03, AsianFormula::Levy, out);
+        barrier_price_batch(barrier, 0.03, out);
+    };
+    if (log) *log << "Closed-form batches (" << n << " Asian + " << n << " barrier options):\n";
+    sweep("batch_chunk", &EngineTuning::batch_chunk, {32, 64, 128, 256}, best, options, log, run_batch);
+
+    return best;
+}
+
+}
@@ -0,0 +1,178 @@
+/**
+ * @file implied_forward.cpp
+ * @brief Robust put-call parity regression per expiry and forward-based implied vols
+ *
+ * @author LN697
+ * @version 1.0
+ */
+
+#include "implied_forward.hpp"
+#include "iv_solve.hpp"
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <unordered_map>
+#include <utility>
+
+namespace bsm {
+
+namespace {
+
+// Quote indices sorted by (underlying, expiry, strike) and the [begin, end)
+// ranges of each (underlying, expiry)
+struct ExpiryGroups {
+    std::vector<std::size_t> order;
+    std::vector<std::pair<std::size_t, std::size_t>> ranges;
+};
+
+ExpiryGroups group_by_expiry(const std::vector<OptionQuote>& quotes) {
+    std::unordered_map<std::string, std::size_t> id_of;
+    std::vector<std::size_t> id(quotes.size());
+    for (std::size_t i = 0; i < quotes.size(); ++i) {
+        id[i] = id_of.emplace(quotes[i].underlying, id_of.size()).first->second;
+    }
+    ExpiryGroups g;
+    g.order.resize(quotes.size());
+    for (std::size_t i = 0; i < quotes.size(); ++i) g.order[i] = i;
+    std::sort(g.order.begin(), g.order.end(), [&](std::size_t a, std::size_t b) {
+        if (id[a] != id[b]) return id[a] < id[b];
+        if (quotes[a].T != quotes[b].T) return quotes[a].T < quotes[b].T;
+        return quotes[a].strike < quotes[b].strike;
+    });
+    for (std::size_t i = 0; i < g.order.size();) {
+        std::size_t j = i + 1;
+        while (j < g.order.size() && id[g.order[j]] == id[g.order[i]] && quotes[g.order[j]].T == quotes[g.order[i]].T) ++j;
+        g.ranges.emplace_back(i, j);
+        i = j;
+    }
+    return g;
+}
+
+double median(std::vector<double> v) {
+    const std::size_t mid = v.size() / 2;
+    std::nth_element(v.begin(), v.begin() + mid, v.end());
+    if (v.size() % 2) return v[mid];
+    return 0.5 * (v[mid] + *std::max_element(v.begin(), v.begin() + mid));
+}
+
+ImpliedForward fit_expiry(const std::vector<OptionQuote>& quotes, const std::size_t* idx, std::size_t n,
+                          const ImpliedForwardConfig& cfg) {
+    ImpliedForward out;
+    out.underlying = quotes[idx[0]].underlying;
+    out.T = quotes[idx[0]].T;
+
+    // Best bid and ask per (strike, type); strikes arrive sorted
+    const double inf = std::numeric_limits<double>::infinity();
+    std::vector<double> K, y, base;
+    for (std::size_t a = 0; a < n;) {
+        const double strike = quotes[idx[a]].strike;
+        double cb = -inf, ca = inf, pb = -inf, pa = inf;
+        for (; a < n && quotes[idx[a]].strike == strike; ++a) {
+            const OptionQuote& q = quotes[idx[a]];
+            if (is_call(q.type)) { cb = std::max(cb, q.bid); ca = std::min(ca, q.ask); }
+            else { pb = std::max(pb, q.bid); pa = std::min(pa, q.ask); }
+        }
+        if (!std::isfinite(cb) || !std::isfinite(ca) || !std::isfinite(pb) || !std::isfinite(pa)) continue;
+        // A zero bid only bounds the price, so its mid is biased upwards
+        if (cfg.skip_zero_bids && (cb <= 0.0 || pb <= 0.0)) continue;
+        const double spread = std::max((ca - cb) + (pa - pb), 1e-8 * strike);
+        K.push_back(strike);
+        y.push_back(0.5 * (cb + ca) - 0.5 * (pb + pa));
+        base.push_back(cfg.spread_weights ? 1.0 / (spread * spread) : 1.0);
+    }
+    const std::size_t m = K.size();
+    out.strikes_used = m;
+    if (m < std::max<std::size_t>(2, cfg.min_strikes)) return out;
+
+    // y = a + b (K - Kc), centred for conditioning; IRLS with Huber weights
+    double Kc = 0.0;
+    for (double k : K) Kc += k;
+    Kc /= m;
+    std::vector<double> w = base, u(m);
+    double a = 0.0, b = 0.0;
+    for (int it = 0; it < std::max(1, cfg.max_iterations); ++it) {
+        double sw = 0.0, sx = 0.0, sy = 0.0, sxx = 0.0, sxy = 0.0;
+        for (std::size_t i = 0; i < m; ++i) {
+            const double x = K[i] - Kc;
+            sw += w[i]; sx += w[i] * x; sy += w[i] * y[i]; sxx += w[i] * x * x; sxy += w[i] * x * y[i];
+        }
+        const double det = sw * sxx - sx * sx;
+        if (!(det > 0.0)) return out;
+        const double a_new = (sxx * sy - sx * sxy) / det;
+        const double b_new = (sw * sxy - sx * sy) / det;
+        const bool converged = it > 0 && std::abs(a_new - a) <= 1e-12 * (1.0 + std::abs(a)) &&
+                               std::abs(b_new - b) <= 1e-12 * (1.0 + std::abs(b));
+        a = a_new;
+        b = b_new;
+        if (converged) break;
+
+        // Residuals standardised by the spread; scale from their median absolute deviation
+        for (std::size_t i = 0; i < m; ++i) u[i] = std::abs(y[i] - a - b * (K[i] - Kc)) * std::sqrt(base[i]);
+        const double scale = 1.4826 * median(u);
+        if (!(scale > 0.0)) break;
+        const double c = cfg.huber_k * scale;
+        for (std::size_t i = 0; i < m; ++i) w[i] = base[i] * (u[i] <= c ? 1.0 : c / u[i]);
+    }
+
+    double ss = 0.0;
+    for (std::size_t i = 0; i < m; ++i) {
+        const double e = y[i] - a - b * (K[i] - Kc);
+        ss += e * e;
+    }
+    out.residual_rms = std::sqrt(ss / m);
+    out.discount = -b;
+    out.forward = out.discount > 0.0 ? Kc + a / out.discount : 0.0;
+    out.valid = out.discount > 0.0 && out.forward > 0.0;
+    return out;
+}
+
+} // namespace
+
+std::vector<ImpliedForward> implied_forwards(const std::vector<OptionQuote>& quotes,
+                                             const ImpliedForwardConfig& config) {
+    const ExpiryGroups g = group_by_expiry(quotes);
+    std::vector<ImpliedForward> out(g.ranges.size());
+    const long num = static_cast<long>(g.ranges.size());
+    #ifdef _OPENMP
+    #pragma omp parallel for schedule(dynamic)
+    #endif
+    for (long s = 0; s < num; ++s) {
+        const auto& r = g.ranges[s];
+        out[s] = fit_expiry(quotes, g.order.data() + r.first, r.second - r.first, config);
+    }
+    return out;
+}
+
+std::vector<double> implied_vols_from_forwards(const std::vector<OptionQuote>& quotes,
+                                               const std::vector<ImpliedForward>& forwards) {
+    std::map<std::pair<std::string, double>, const ImpliedForward*> by_expiry;
+    for (const ImpliedForward& f : forwards) by_expiry[{f.underlying, f.T}] = &f;
+
+    const ExpiryGroups g = group_by_expiry(quotes);
+    std::vector<double> vols(quotes.size(), std::numeric_limits<double>::quiet_NaN());
+    const long num = static_cast<long>(g.ranges.size());
+    #ifdef _OPENMP
+    #pragma omp parallel for schedule(dynamic)
+    #endif
+    for (long s = 0; s < num; ++s) {
+        const std::size_t begin = g.ranges[s].first, n = g.ranges[s].second - begin;
+        const OptionQuote& head = quotes[g.order[begin]];
+        const auto it = by_expiry.find({head.underlying, head.T});
+        if (it == by_expiry.end() || !it->second->valid) continue;
+
+        std::vector<double> K(n), price(n), vol(n);
+        std::vector<OptionType> type(n);
+        for (std::size_t i = 0; i < n; ++i) {
+            const OptionQuote& q = quotes[g.order[begin + i]];
+            K[i] = q.strike;
+            price[i] = q.mid();
+            type[i] = q.type;
+        }
+        const ImpliedForward& f = *it->second;
+        black_implied_vol_batch(f.forward, f.discount, f.T, n, K.data(), price.data(), type.data(), vol.data());
+        for (std::size_t i = 0; i < n; ++i) vols[g.order[begin + i]] = vol[i];
+    }
+    return vols;
+}
+
+}
@@ -0,0 +1,187 @@
+/**
+ * @file isa_dispatch.cpp
+ * @brief Instruction-set detection and per-kernel variant selection
+ *
+ * @author LN697
+ * @version 1.0
+ */
+
+#include "isa_dispatch.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <stdexcept>
+
+#ifdef USE_PERFORMANCE_UTILS
+#include "performance_utils.hpp"
+#endif
+
+namespace bsm {
+namespace isa_detail {
+extern const KernelTable generic_kernels;
+#if BSM_ISA_VARIANTS
+extern const KernelTable sse42_kernels;
+extern const KernelTable avx2_kernels;
+extern const KernelTable avx512_kernels;
+#endif
+} // namespace isa_detail
+
+namespace {
+
+KernelISA detect() {
+#if BSM_ISA_VARIANTS
+#ifdef USE_PERFORMANCE_UTILS
+    performance::ArchitectureInfo info;
+    performance::ArchitectureOptimizer::detect_instruction_sets(info);
+    if (info.has_avx512f && info.has_avx512dq && info.has_avx512vl && info.has_avx2 && info.has_fma)
+        return KernelISA::AVX512;
+    if (info.has_avx2 && info.has_fma) return KernelISA::AVX2;
+    if (info.has_sse42) return KernelISA::SSE42;
+#else
+    // The builtins also check that the OS saves the wider registers
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512dq") &&
+        __builtin_cpu_supports("avx512vl") && __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+        return KernelISA::AVX512;
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) return KernelISA::AVX2;
+    if (__builtin_cpu_supports("sse4.2")) return KernelISA::SSE42;
+#endif
+#endif
+    return KernelISA::Generic;
+}
+
+const KernelTable& table_of(KernelISA isa) {
+    switch (isa) {
+#if BSM_ISA_VARIANTS
+    case KernelISA::SSE42: return isa_detail::sse42_kernels;
+    case KernelISA::AVX2: return isa_detail::avx2_kernels;
+    case KernelISA::AVX512: return isa_detail::avx512_kernels;
+#endif
+    default: return isa_detail::generic_kernels;
+    }
+}
+
+struct Dispatch {
+    KernelISA detected;
+    KernelISA selected[kNumKernels];
+    KernelTable active;
+
+    Dispatch() : detected(detect()) {
+        KernelISA isa = detected;
+        if (const char* env = std::getenv("BSM_ISA")) {
+            KernelISA requested;
+            if (parse_isa(env, requested) && requested <= detected) isa = requested;
+        }
+        for (int k = 0; k < kNumKernels; ++k) select(static_cast<Kernel>(k), isa);
+    }
+
+    void select(Kernel kernel, KernelISA isa) {
+        const KernelTable& t = table_of(isa);
+        selected[static_cast<int>(kernel)] = isa;
+        switch (kernel) {
+        case Kernel::BlackScholes:
+            active.black_scholes = t.black_scholes;
+            active.black_scholes_greeks = t.black_scholes_greeks;
+            break;
+        case Kernel::ImpliedVol: active.implied_vol = t.implied_vol; break;
+        case Kernel::NormalFill: active.normal_fill = t.normal_fill; break;
+        case Kernel::PayoffReduction:
+            active.payoff_moments = t.payoff_moments;
+            active.payoff_greeks = t.payoff_greeks;
+            break;
+        case Kernel::Tridiagonal:
+            active.tridiagonal = t.tridiagonal;
+            active.factored_tridiagonal = t.factored_tridiagonal;
+            break;
+        case Kernel::SurfaceInterpolation: active.interp_rows = t.interp_rows; break;
+        }
+    }
+};
+
+Dispatch& dispatch() {
+    static Dispatch d;
+    return d;
+}
+
+} // namespace
+
+const char* isa_name(KernelISA isa) {
+    switch (isa) {
+    case KernelISA::Generic: return "generic";
+    case KernelISA::SSE42: return "sse4.2";
+    case KernelISA::AVX2: return "avx2";
+    case KernelISA::AVX512: return "avx512";
+    }
+    return "unknown";
+}
+
+const char* kernel_name(Kernel kernel) {
+    switch (kernel) {
+    case Kernel::BlackScholes: return "black_scholes";
+    case Kernel::ImpliedVol: return "implied_vol";
+    case Kernel::NormalFill: return "normal_fill";
+    case Kernel::PayoffReduction: return "payoff_reduction";
+    case Kernel::Tridiagonal: return "tridiagonal";
+    case Kernel::SurfaceInterpolation: return "surface_interpolation";
+    }
+    return "unknown";
+}
+
+bool parse_isa(const std::string& name, KernelISA& isa) {
+    std::string s(name);
+    std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c) { return std::tolower(c); });
+    if (s == "generic" || s == "scalar") isa = KernelISA::Generic;
+    else if (s == "sse4.2" || s == "sse42") isa = KernelISA::SSE42;
+    else if (s == "avx2") isa = KernelISA::AVX2;
+    else if (s == "avx512" || s == "avx-512") isa = KernelISA::AVX512;
+    else if (s == "native") isa = detected_isa();
+    else return false;
+    return true;
+}
+
+KernelISA detected_isa() { return dispatch().detected; }
+
+bool isa_supported(KernelISA isa) { return isa <= detected_isa(); }
+
+std::vector<KernelISA> supported_isas() {
+    std::vector<KernelISA> isas;
+    for (KernelISA isa : {KernelISA::Generic, KernelISA::SSE42, KernelISA::AVX2, KernelISA::AVX512})
+        if (isa_supported(isa)) isas.push_back(isa);
+    return isas;
+}
+
+KernelISA kernel_isa(Kernel kernel) { return dispatch().selected[static_cast<int>(kernel)]; }
+
+void set_kernel_isa(Kernel kernel, KernelISA isa) {
+    if (!isa_supported(isa))
+        throw std::invalid_argument(std::string("set_kernel_isa: ") + isa_name(isa) + " is not supported on this CPU");
+    dispatch().select(kernel, isa);
+}
+
+void set_isa(KernelISA isa) {
+    for (int k = 0; k < kNumKernels; ++k) set_kernel_isa(static_cast<Kernel>(k), isa);
+}
+
+const KernelTable& active_kernels() { return dispatch().active; }
+
+const KernelTable& kernel_variant(KernelISA isa) {
+    if (!isa_supported(isa))
+        throw std::invalid_argument(std::string("kernel_variant: ") + isa_name(isa) + " is not supported on this CPU");
+    return table_of(isa);
+}
+
+void black_scholes_price_batch(std::size_t n, const double* S, const double* K, double r, const double* T,
+                               const double* sigma, const OptionType* types, double* out) {
+    active_kernels().black_scholes(n, S, K, r, T, sigma, types, out);
+}
+
+void fill_standard_normals(std::uint64_t seed, std::uint64_t offset, std::size_t n, double* out) {
+    active_kernels().normal_fill(seed, offset, n, out);
+}
+
+void gbm_payoff_moments(std::size_t n, const double* z, double S0, double drift, double vol, double K,
+                        OptionType type, bool antithetic, double& sum, double& sum_sq) {
+    active_kernels().payoff_moments(n, z, S0, drift, vol, K, type, antithetic, &sum, &sum_sq);
+}
+
+}
@@ -0,0 +1,67 @@
+/**
+ * @file isa_kernels.cpp
+ * @brief One instantiation of the hot kernels per instruction set
+ *
+ * isa_kernels.inl is included once per variant, each time inside its own
+ * namespace and target pragma. The Makefile compiles this file for baseline
+ * x86-64 with -fno-math-errno -fno-trapping-math, so that sqrt and the
+ * branch-free selects vectorise; nothing here relies on errno or FP traps.
+ *
+ * @author LN697
+ * @version 1.0
+ */
+
+#include "isa_dispatch.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+// Plain aggregate of function addresses: constant-initialised, so usable during static initialisation
+#define BSM_KERNEL_TABLE(ns) \
+    {&ns::bs_price, &ns::bs_greeks, &ns::implied_vol, &ns::normal_fill, &ns::payoff_moments, &ns::payoff_greeks, \
+     &ns::tridiagonal_batch, &ns::factored_tridiagonal, &ns::interp_rows}
+
+namespace bsm {
+namespace isa_detail {
+
+namespace generic {
+#include "isa_kernels.inl"
+}
+extern const KernelTable generic_kernels;
+const KernelTable generic_kernels = BSM_KERNEL_TABLE(generic);
+
+#if BSM_ISA_VARIANTS
+
+#pragma GCC push_options
+#pragma GCC target("sse4.2,popcnt")
+namespace sse42 {
+#include "isa_kernels.inl"
+}
+#pragma GCC pop_options
+extern const KernelTable sse42_kernels;
+const KernelTable sse42_kernels = BSM_KERNEL_TABLE(sse42);
+
+#pragma GCC push_options
+#pragma GCC target("avx2,fma")
+namespace avx2 {
+#include "isa_kernels.inl"
+}
+#pragma GCC pop_options
+extern const KernelTable avx2_kernels;
+const KernelTable avx2_kernels = BSM_KERNEL_TABLE(avx2);
+
+#pragma GCC push_options
+#pragma GCC target("avx512f,avx512dq,avx512vl,avx2,fma,prefer-vector-width=512")
+namespace avx512 {
+#include "isa_kernels.inl"
+}
+#pragma GCC pop_options
+extern const KernelTable avx512_kernels;
+const KernelTable avx512_kernels = BSM_KERNEL_TABLE(avx512);
+
+#endif
+
+} // namespace isa_detail
+}
@@ -0,0 +1,445 @@
+/**
+ * @file isa_kernels.inl
+ * @brief Hot kernel bodies, compiled once per instruction set
+ *
+ * Included by isa_kernels.cpp inside a per-ISA namespace after a target
+ * pragma, so this file must not include headers. Every loop is written
+ * branch-free over plain arrays so that the compiler vectorises it at the
+ * width of the enclosing target. exp, log and the normal CDF are evaluated on
+ * bit patterns rather than through libm, whose scalar calls would stop
+ * vectorisation; they are accurate to a few ulp (the CDF to about 1e-15).
+ *
+ * @author LN697
+ * @version 1.0
+ */
+
+namespace {
+
+constexpr std::size_t kBlock = 64;                  // Lanes of the lock-step kernels
+constexpr int kSumLanes = 8;                        // Partial sums of the reductions (ISA independent)
+constexpr double kShifter = 6755399441055744.0;     // 1.5 * 2^52: x + kShifter rounds x into the low mantissa bits
+constexpr double kLn2Hi = 6.93147180369123816490e-01;
+constexpr double kLn2Lo = 1.90821492927058770002e-10;
+constexpr double kLog2e = 1.4426950408889634074;
+constexpr double kInvSqrt2Pi = 0.3989422804014327;
+
+inline std::uint64_t bits_of(double x) {
+    std::uint64_t u;
+    std::memcpy(&u, &x, sizeof u);
+    return u;
+}
+
+inline double from_bits(std::uint64_t u) {
+    double x;
+    std::memcpy(&x, &u, sizeof x);
+    return x;
+}
+
+// e^x for x clamped to [-708, 709]
+inline double exp_k(double x) {
+    x = x < -708.0 ? -708.0 : x;
+    x = x > 709.0 ? 709.0 : x;
+    const double t = x * kLog2e + kShifter;
+    const double n = t - kShifter;
+    const double r = (x - n * kLn2Hi) - n * kLn2Lo;       // |r| <= ln2 / 2
+    double p = 1.0 / 6227020800.0;
+    p = p * r + 1.0 / 479001600.0;
+    p = p * r + 1.0 / 39916800.0;
+    p = p * r + 1.0 / 3628800.0;
+    p = p * r + 1.0 / 362880.0;
+    p = p * r + 1.0 / 40320.0;
+    p = p * r + 1.0 / 5040.0;
+    p = p * r + 1.0 / 720.0;
+    p = p * r + 1.0 / 120.0;
+    p = p * r + 1.0 / 24.0;
+    p = p * r + 1.0 / 6.0;
+    p = p * r + 0.5;
+    p = p * r + 1.0;
+    p = p * r + 1.0;
+    const std::uint64_t e = bits_of(t) - bits_of(kShifter);    // n as a two's complement integer
+    return p * from_bits((e + 1023) << 52);
+}
+
+// ln x for positive normal x
+inline double log_k(double x) {
+    const std::uint64_t u = bits_of(x);
+    double e = from_bits((u >> 52) | 0x4330000000000000ULL) - (4503599627370496.0 + 1023.0);
+    double m = from_bits((u & 0x000FFFFFFFFFFFFFULL) | 0x3FF0000000000000ULL);
+    const bool high = m > 1.4142135623730951;
+    m = high ? 0.5 * m : m;
+    e = high ? e + 1.0 : e;
+    // ln m = 2 atanh(s), |s| <= 0.1716
+    const double s = (m - 1.0) / (m + 1.0), z = s * s;
+    double p = 1.0 / 23.0;
+    p = p * z + 1.0 / 21.0;
+    p = p * z + 1.0 / 19.0;
+    p = p * z + 1.0 / 17.0;
+    p = p * z + 1.0 / 15.0;
+    p = p * z + 1.0 / 13.0;
+    p = p * z + 1.0 / 11.0;
+    p = p * z + 1.0 / 9.0;
+    p = p * z + 1.0 / 7.0;
+    p = p * z + 1.0 / 5.0;
+    p = p * z + 1.0 / 3.0;
+    return e * kLn2Hi + (2.0 * s + 2.0 * s * z * p + e * kLn2Lo);
+}
+
+// Standard normal CDF (Hart's rational approximation and a continued fraction
+// beyond 7.07, as in West, "Better approximations to cumulative normal functions")
+inline double norm_cdf_k(double x) {
+    const double ax = std::fabs(x);
+    const double g = exp_k(-0.5 * ax * ax);
+    double num = 3.52624965998911e-02 * ax + 0.700383064443688;
+    num = num * ax + 6.37396220353165;
+    num = num * ax + 33.912866078383;
+    num = num * ax + 112.079291497871;
+    num = num * ax + 221.213596169931;
+    num = num * ax + 220.206867912376;
+    double den = 8.83883476483184e-02 * ax + 1.75566716318264;
+    den = den * ax + 16.064177579207;
+    den = den * ax + 86.7807322029461;
+    den = den * ax + 296.564248779674;
+    den = den * ax + 637.333633378831;
+    den = den * ax + 793.826512519948;
+    den = den * ax + 440.413735824752;
+    double cf = ax + 0.65;
+    cf = ax + 4.0 / cf;
+    cf = ax + 3.0 / cf;
+    cf = ax + 2.0 / cf;
+    cf = ax + 1.0 / cf;
+    // Both branches are evaluated so that the select does not guard a division
+    const double near = g * num / den, far = g * kInvSqrt2Pi / cf;
+    double tail = ax < 7.07106781186547 ? near : far;
+    tail = ax > 37.0 ? 0.0 : tail;
+    return x > 0.0 ? 1.0 - tail : tail;
+}
+
+inline std::uint64_t mix64(std::uint64_t z) {
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// Uniform in (0, 1) from 52 random bits
+inline double uniform_k(std::uint64_t h) {
+    return from_bits((h >> 12) | 0x3FF0000000000000ULL) - (1.0 - 0x1.0p-53);
+}
+
+// Box-Muller pair number p of the counter-based stream seed
+inline void normal_pair(std::uint64_t seed, std::uint64_t p, double& z0, double& z1) {
+    const std::uint64_t base = seed + (2 * p + 1) * 0x9E3779B97F4A7C15ULL;
+    const double u1 = uniform_k(mix64(base));
+    const double u2 = uniform_k(mix64(base + 0x9E3779B97F4A7C15ULL));
+    const double radius = std::sqrt(-2.0 * log_k(u1));
+    // 2 pi u2 = q pi/2 + r with |r| <= pi/4
+    const double tq = 4.0 * u2 + kShifter;
+    const double q = tq - kShifter;
+    const double r = (u2 - 0.25 * q) * 6.283185307179586;
+    const double r2 = r * r;
+    double sn = -1.0 / 1307674368000.0;
+    sn = sn * r2 + 1.0 / 6227020800.0;
+    sn = sn * r2 - 1.0 / 39916800.0;
+    sn = sn * r2 + 1.0 / 362880.0;
+    sn = sn * r2 - 1.0 / 5040.0;
+    sn = sn * r2 + 1.0 / 120.0;
+    sn = sn * r2 - 1.0 / 6.0;
+    sn = r + r * r2 * sn;
+    double cs = 1.0 / 20922789888000.0;
+    cs = cs * r2 - 1.0 / 87178291200.0;
+    cs = cs * r2 + 1.0 / 479001600.0;
+    cs = cs * r2 - 1.0 / 3628800.0;
+    cs = cs * r2 + 1.0 / 40320.0;
+    cs = cs * r2 - 1.0 / 720.0;
+    cs = cs * r2 + 1.0 / 24.0;
+    cs = cs * r2 - 0.5;
+    cs = 1.0 + r2 * cs;
+    const std::uint64_t quadrant = (bits_of(tq) - bits_of(kShifter)) & 3;
+    const double c = (quadrant & 1) ? sn : cs;          // cos(q pi/2 + r) up to sign
+    const double s = (quadrant & 1) ? cs : sn;
+    z0 = radius * ((quadrant == 1 || quadrant == 2) ? -c : c);
+    z1 = radius * ((quadrant >= 2) ? -s : s);
+}
+
+// One forward-elimination row of m interleaved lines. Rows are stride >= m
+// apart, so the row being written never overlaps the previous one.
+inline void eliminate_row(int m, const double* a, const double* b, const double* c_prev,
+                          const double* inv_beta_prev, const double* d_prev,
+                          double* __restrict inv_beta, double* __restrict d) {
+    for (int l = 0; l < m; ++l) {
+        const double inv = 1.0 / (b[l] - a[l] * c_prev[l] * inv_beta_prev[l]);
+        inv_beta[l] = inv;
+        d[l] = (d[l] - a[l] * d_prev[l]) * inv;
+    }
+}
+
+} // namespace
+
+void bs_price(std::size_t n, const double* S, const double* K, double r, const double* T,
+              const double* sigma, const OptionType* type, double* out) {
+    for (std::size_t i = 0; i < n; ++i) {
+        const double sgn = type[i] == OptionType::Call ? 1.0 : -1.0;
+        const double t = T[i] > 0.0 ? T[i] : 0.0;
+        const double df = exp_k(-r * t);
+        const double sd = sigma[i] * std::sqrt(t);
+        const bool degenerate = !(sd > 0.0);
+        const double sd_safe = degenerate ? 1.0 : sd;
+        const double d1 = (log_k(S[i] / K[i]) + r * t) / sd_safe + 0.5 * sd_safe;
+        const double d2 = d1 - sd_safe;
+        const double price = sgn * (S[i] * norm_cdf_k(sgn * d1) - K[i] * df * norm_cdf_k(sgn * d2));
+        // Zero time: intrinsic value; zero volatility: discounted forward intrinsic
+        const double limit = std::max(sgn * (S[i] - K[i] * df), 0.0);
+        out[i] = degenerate ? limit : price;
+    }
+}
+
+void bs_greeks(std::size_t n, double S, double r, double T, double sigma, const double* K, const double* sign,
+               double* price, double* delta, double* gamma, double* vega, double* theta) {
+    const double sqrt_T = std::sqrt(T);
+    const double vol_sqrt_T = sigma * sqrt_T;
+    const double inv_vol_sqrt_T = 1.0 / vol_sqrt_T;
+    const double log_S = log_k(S);
+    const double drift = (r + 0.5 * sigma * sigma) * T;
+    const double disc = exp_k(-r * T);
+    const double gamma_scale = 1.0 / (S * vol_sqrt_T);
+    const double vega_scale = S * sqrt_T;
+    const double theta_decay = -S * sigma / (2.0 * sqrt_T);
+    for (std::size_t i = 0; i < n; ++i) {
+        const double s = sign[i];
+        const double d1 = (log_S - log_k(K[i]) + drift) * inv_vol_sqrt_T;
+        const double d2 = d1 - vol_sqrt_T;
+        const double phi = kInvSqrt2Pi * exp_k(-0.5 * d1 * d1);
+        const double Kdisc = K[i] * disc;
+        const double Nd1 = norm_cdf_k(s * d1), Nd2 = norm_cdf_k(s * d2);
+        price[i] = s * (S * Nd1 - Kdisc * Nd2);
+        delta[i] = s * Nd1;
+        gamma[i] = phi * gamma_scale;
+        vega[i] = phi * vega_scale;
+        theta[i] = theta_decay * phi - s * r * Kdisc * Nd2;
+    }
+}
+
+void implied_vol(double F, double D, double T, std::size_t n, const double* strikes, const double* prices,
+                 const OptionType* types, double* vols, double tol, int max_iter) {
+    const double inf = std::numeric_limits<double>::infinity();
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    const double inv_sqrt_T = 1.0 / std::sqrt(T);
+    double K[kBlock], target[kBlock], log_target[kBlock], x[kBlock], sgn[kBlock], s[kBlock], lo[kBlock], hi[kBlock];
+    double use_log[kBlock];
+    int live[kBlock], valid[kBlock];
+    for (std::size_t i0 = 0; i0 < n; i0 += kBlock) {
+        const std::size_t m = std::min(kBlock, n - i0);
+        for (std::size_t l = 0; l < m; ++l) {
+            const double k = strikes[i0 + l];
+            const double call = types[i0 + l] == OptionType::Call ? 1.0 : -1.0;
+            target[l] = prices[i0 + l] / D - std::max(call * (F - k), 0.0);     // out-of-the-money premium
+            valid[l] = k > 0.0 && target[l] > 0.0 && target[l] < std::min(F, k);
+            K[l] = valid[l] ? k : F;
+            sgn[l] = K[l] >= F ? 1.0 : -1.0;
+            x[l] = log_k(F / K[l]);
+            const double start = std::sqrt(2.0 * std::fabs(x[l]));
+            s[l] = start < 1e-8 ? target[l] / (F * kInvSqrt2Pi) : start;    // at the money: Brenner-Subrahmanyam
+            // Far below the inflection point the premium is exponentially small in 1/s and
+            // plain Newton crawls; Newton on its logarithm takes a few steps there
+            const double d1 = x[l] / s[l] + 0.5 * s[l];
+            const double at_start = sgn[l] * (F * norm_cdf_k(sgn[l] * d1) - K[l] * norm_cdf_k(sgn[l] * (d1 - s[l])));
+            use_log[l] = target[l] < 0.01 * at_start ? 1.0 : 0.0;
+            log_target[l] = log_k(valid[l] ? target[l] : 1.0);
+            lo[l] = 0.0;
+            hi[l] = inf;
+            live[l] = valid[l];
+        }
+        // Safeguarded Newton in total volatility, all lanes in lock step
+        for (int it = 0; it < max_iter; ++it) {
+            int any = 0;
+            for (std::size_t l = 0; l < m; ++l) {
+                const double d1 = x[l] / s[l] + 0.5 * s[l], d2 = d1 - s[l];
+                const double price = sgn[l] * (F * norm_cdf_k(sgn[l] * d1) - K[l] * norm_cdf_k(sgn[l] * d2));
+                const double f = price - target[l];
+                const double new_hi = f > 0.0 ? s[l] : hi[l];
+                const double new_lo = f > 0.0 ? lo[l] : s[l];
+                const double vega = F * kInvSqrt2Pi * exp_k(-0.5 * d1 * d1);
+                // Log step (ln p - ln target) p / vega; an underflowed price falls back to bisection
+                const double log_f = price > 1e-300 ? (log_k(price) - log_target[l]) * price : nan;
+                const double step = (use_log[l] > 0.0 ? log_f : f) / vega;
+                double next = vega > 0.0 ? s[l] - step : nan;
+                const bool inside = next > new_lo && next < new_hi;
+                next = inside ? next : (new_hi < inf ? 0.5 * (new_lo + new_hi) : 2.0 * s[l]);
+                // At the root s itself is a bracket end, so a converged step is never strictly inside
+                next = std::fabs(step) <= tol * (1.0 + s[l]) ? s[l] - step : next;
+                const bool done = std::fabs(next - s[l]) <= tol * (1.0 + s[l]);
+                s[l] = live[l] ? next : s[l];
+                lo[l] = live[l] ? new_lo : lo[l];
+                hi[l] = live[l] ? new_hi : hi[l];
+                live[l] = live[l] & !done;
+                any |= live[l];
+            }
+            if (!any) break;
+        }
+        for (std::size_t l = 0; l < m; ++l) vols[i0 + l] = valid[l] ? s[l] * inv_sqrt_T : nan;
+    }
+}
+
+void normal_fill(std::uint64_t seed, std::uint64_t offset, std::size_t n, double* out) {
+    std::size_t i = 0;
+    double z0, z1;
+    if (n > 0 && (offset & 1)) {
+        normal_pair(seed, offset >> 1, z0, z1);
+        out[i++] = z1;
+    }
+    const std::uint64_t first = (offset + i) >> 1;
+    const std::size_t pairs = (n - i) / 2;
+    double* dst = out + i;
+    for (std::size_t p = 0; p < pairs; ++p) {
+        normal_pair(seed, first + p, z0, z1);
+        dst[2 * p] = z0;
+        dst[2 * p + 1] = z1;
+    }
+    i += 2 * pairs;
+    if (i < n) {
+        normal_pair(seed, (offset + i) >> 1, z0, z1);
+        out[i] = z0;
+    }
+}
+
+void payoff_moments(std::size_t n, const double* z, double S0, double drift, double vol, double K,
+                    OptionType type, bool antithetic, double* sum, double* sum_sq) {
+    const double sgn = type == OptionType::Call ? 1.0 : -1.0;
+    const double weight = antithetic ? 0.5 : 1.0, mirror = antithetic ? 1.0 : 0.0;
+    double acc[kSumLanes] = {}, acc_sq[kSumLanes] = {};
+    std::size_t i = 0;
+    for (; i + kSumLanes <= n; i += kSumLanes) {
+        for (int l = 0; l < kSumLanes; ++l) {
+            const double w = vol * z[i + l];
+            const double up = std::max(sgn * (S0 * exp_k(drift + w) - K), 0.0);
+            const double dn = std::max(sgn * (S0 * exp_k(drift - w) - K), 0.0);
+            const double y = weight * (up + mirror * dn);
+            acc[l] += y;
+            acc_sq[l] += y * y;
+        }
+    }
+    for (int l = 0; i < n; ++i, ++l) {
+        const double w = vol * z[i];
+        const double up = std::max(sgn * (S0 * exp_k(drift + w) - K), 0.0);
+        const double dn = std::max(sgn * (S0 * exp_k(drift - w) - K), 0.0);
+        const double y = weight * (up + mirror * dn);
+        acc[l] += y;
+        acc_sq[l] += y * y;
+    }
+    double total = 0.0, total_sq = 0.0;
+    for (int l = 0; l < kSumLanes; ++l) {
+        total += acc[l];
+        total_sq += acc_sq[l];
+    }
+    *sum = total;
+    *sum_sq = total_sq;
+}
+
+void payoff_greeks(std::size_t n, const double* z, double S0, double drift, double vol, double sqrt_T,
+                   double sigma_T, std::size_t nK, const double* K, const double* sign, double* scratch,
+                   double* sums) {
+    double* up = scratch;
+    double* dn = scratch + n;
+    for (std::size_t i = 0; i < n; ++i) {
+        const double w = vol * z[i];
+        up[i] = S0 * exp_k(drift + w);
+        dn[i] = S0 * exp_k(drift - w);
+    }
+    const double inv_vol = 1.0 / vol;
+    for (std::size_t m = 0; m < nK; ++m) {
+        const double k = K[m], s = sign[m];
+        double acc[5][kSumLanes] = {};
+        // Lane l of every statistic takes samples l, l + kSumLanes, ... whatever the vector width
+        auto add = [&](std::size_t i, int l) {
+            const double pu = std::max(s * (up[i] - k), 0.0);
+            const double pd = std::max(s * (dn[i] - k), 0.0);
+            const double iu = pu > 0.0 ? s * up[i] : 0.0;
+            const double id = pd > 0.0 ? s * dn[i] : 0.0;
+            const double p = 0.5 * (pu + pd);
+            acc[0][l] += p;
+            acc[1][l] += p * p;
+            acc[2][l] += 0.5 * (iu + id);
+            acc[3][l] += 0.5 * (iu * (z[i] * sqrt_T - sigma_T) + id * (-z[i] * sqrt_T - sigma_T));
+            acc[4][l] += 0.5 * (iu * (z[i] * inv_vol - 1.0) + id * (-z[i] * inv_vol - 1.0));
+        };
+        std::size_t i = 0;
+        for (; i + kSumLanes <= n; i += kSumLanes)
+            for (int l = 0; l < kSumLanes; ++l) add(i + l, l);
+        for (int l = 0; i < n; ++i, ++l) add(i, l);
+        for (int q = 0; q < 5; ++q) {
+            double total = 0.0;
+            for (int l = 0; l < kSumLanes; ++l) total += acc[q][l];
+            sums[q * nK + m] = total;
+        }
+    }
+}
+
+void tridiagonal_batch(int n, int m, const double* a, const double* b, const double* c, double* d,
+                       double* scratch, std::ptrdiff_t stride) {
+    if (n <= 0 || m <= 0) return;
+    double* inv_beta = scratch;
+    for (int l = 0; l < m; ++l) {
+        inv_beta[l] = 1.0 / b[l];
+        d[l] *= inv_beta[l];
+    }
+    for (int i = 1; i < n; ++i) {
+        const std::ptrdiff_t row = i * stride, prev = row - stride;
+        eliminate_row(m, a + row, b + row, c + prev, inv_beta + prev, d + prev, inv_beta + row, d + row);
+    }
+    for (int i = n - 2; i >= 0; --i) {
+        const std::ptrdiff_t row = i * stride, next = row + stride;
+        for (int l = 0; l < m; ++l) d[row + l] -= c[row + l] * inv_beta[row + l] * d[next + l];
+    }
+}
+
+void factored_tridiagonal(int n, int m, const double* a, const double* inv_beta, const double* cp, double* d,
+                          std::ptrdiff_t stride) {
+    if (n <= 0) return;
+    for (int l = 0; l < m; ++l) d[l] *= inv_beta[0];
+    for (int i = 1; i < n; ++i) {
+        double* __restrict row = d + i * stride;
+        const double* prev = row - stride;
+        const double ai = a[i], ib = inv_beta[i];
+        for (int l = 0; l < m; ++l) row[l] = (row[l] - ai * prev[l]) * ib;
+    }
+    for (int i = n - 2; i >= 0; --i) {
+        double* __restrict row = d + i * stride;
+        const double* next = row + stride;
+        const double cpi = cp[i];
+        for (int l = 0; l < m; ++l) row[l] -= cpi * next[l];
+    }
+}
+
+void interp_rows(std::size_t ns, const double* grid, const double* row0, const double* row1, double w1,
+                 std::size_t n, const double* x, double* out) {
+    if (ns == 0) return;
+    const std::int64_t last = static_cast<std::int64_t>(ns) - 1;
+    if (last == 0) {
+        for (std::size_t i = 0; i < n; ++i) out[i] = (1.0 - w1) * row0[0] + w1 * row1[0];
+        return;
+    }
+    std::int64_t top = 1;
+    while (top * 2 <= last) top *= 2;
+    std::int64_t pos[kBlock];
+    double xc[kBlock];
+    for (std::size_t i0 = 0; i0 < n; i0 += kBlock) {
+        const std::size_t m = std::min(kBlock, n - i0);
+        for (std::size_t l = 0; l < m; ++l) {
+            xc[l] = std::min(std::max(x[i0 + l], grid[0]), grid[last]);     // flat extrapolation
+            pos[l] = 0;
+        }
+        // Branch-free binary search: one gather per halving, across all lanes
+        for (std::int64_t step = top; step > 0; step /= 2) {
+            for (std::size_t l = 0; l < m; ++l) {
+                const std::int64_t cand = std::min(pos[l] + step, last);
+                pos[l] = grid[cand] <= xc[l] ? cand : pos[l];
+            }
+        }
+        for (std::size_t l = 0; l < m; ++l) {
+            const std::int64_t j = std::min(pos[l], last - 1);
+            const double w = (xc[l] - grid[j]) / (grid[j + 1] - grid[j]);
+            const double v0 = row0[j] + w * (row0[j + 1] - row0[j]);
+            const double v1 = row1[j] + w * (row1[j + 1] - row1[j]);
+            out[i0 + l] = v0 + w1 * (v1 - v0);
+        }
+    }
+}
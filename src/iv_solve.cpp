@@ -0,0 +1,20 @@
+#include "iv_solve.hpp"
+#include "math_utils.hpp"
+#include "isa_dispatch.hpp"
+#include <algorithm>
+
+namespace bsm {
+
+void black_implied_vol_batch(double F, double D, double T, std::size_t n,
+                             const double* strikes, const double* prices, const OptionType* types,
+                             double* vols, double tol, int max_iter) {
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    if (!(F > 0.0) || !(D > 0.0) || !(T > 0.0)) {
+        std::fill(vols, vols + n, nan);
+        return;
+    }
+    // Lock-step Newton over blocks of strikes, in the widest instruction set available
+    active_kernels().implied_vol(F, D, T, n, strikes, prices, types, vols, tol, max_iter);
+}
+
+}
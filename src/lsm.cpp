@@ -1,95 +1,729 @@
 #include "lsm.hpp"
+#include "analytic_bs.hpp"
+#include "math_utils.hpp"
+#include "path_store.hpp"
+#include <chrono>
+#include <cctype>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
 #include <random>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
 
 namespace bsm {
 
-double lsm_american_put(double S0, double K, double r, double T, double sigma, const LSMParams& p) {
-    int N = p.steps;
-    long M = p.paths;
-    double dt = T / N;
-    std::mt19937_64 gen(p.seed);
-    std::normal_distribution<double> nd(0.0, 1.0);
-
-    // Simulate paths
-    std::vector<std::vector<double>> S(N + 1, std::vector<double>(M));
-    for (long m = 0; m < M; ++m) S[0][m] = S0;
-    double drift = (r - 0.5 * sigma * sigma) * dt;
-    double vol = sigma * std::sqrt(dt);
-    for (int n = 1; n <= N; ++n) {
-        for (long m = 0; m < M; ++m) {
-            double Z = nd(gen);
-            S[n][m] = S[n - 1][m] * std::exp(drift + vol * Z);
+namespace {
+
+// Continuation-value regressions of a fitted exercise policy, one row of
+// coefficients per exercise date on the basis {1, x, x^2, ...}, x = S/K
+struct ExercisePolicy {
+    int steps{0};
+    int cols{0};
+    double K{0.0};
+    std::vector<double> beta;      // (steps + 1) x cols
+    std::vector<char> fitted;      // dates with enough in-the-money paths to regress
+
+    double continuation(int n, double S) const {
+        const double x = S / K;
+        const double* b = &beta[static_cast<std::size_t>(n) * cols];
+        double cont = 0.0, pow = 1.0;
+        for (int k = 0; k < cols; ++k) { cont += b[k] * pow; pow *= x; }
+        return cont;
+    }
+
+    // Exercise at date n (1..steps) given the immediate payoff
+    bool exercise(int n, double S, double payoff) const {
+        if (payoff <= 0.0) return false;
+        if (n == steps) return true;
+        return fitted[n] && payoff > continuation(n, S);
+    }
+};
+
+// Solve the normal equations XtX * beta = Xty in place (Gauss-Jordan, partial pivoting)
+void solve_normal_equations(std::vector<double>& XtX, std::vector<double>& Xty, int cols) {
+    for (int i = 0; i < cols; ++i) {
+        int piv = i;
+        for (int rrow = i + 1; rrow < cols; ++rrow) if (std::abs(XtX[rrow * cols + i]) > std::abs(XtX[piv * cols + i])) piv = rrow;
+        if (piv != i) {
+            for (int c = 0; c < cols; ++c) std::swap(XtX[i * cols + c], XtX[piv * cols + c]);
+            std::swap(Xty[i], Xty[piv]);
+        }
+        double diag = XtX[i * cols + i];
+        if (std::abs(diag) < 1e-14) continue;
+        double invd = 1.0 / diag;
+        for (int c = i; c < cols; ++c) XtX[i * cols + c] *= invd;
+        Xty[i] *= invd;
+        for (int rrow = 0; rrow < cols; ++rrow) if (rrow != i) {
+            double f = XtX[rrow * cols + i];
+            for (int c = i; c < cols; ++c) XtX[rrow * cols + c] -= f * XtX[i * cols + c];
+            Xty[rrow] -= f * Xty[i];
+        }
+    }
+}
+
+// Number of base paths (antithetic partners excluded) and QMC replicate of base path b
+long base_paths(const LSMParams& p) { return p.antithetic ? std::max(1L, p.paths / 2) : p.paths; }
+int qmc_replicate(const LSMParams& p, long b) {
+    const int R = std::max(1, p.qmc_replicates);
+    return static_cast<int>(b * R / base_paths(p));
+}
+
+// Time slices of the regression paths: slice n holds S_n of all M paths, in a
+// time-major PathStore. The encoding is that of Real, or LogReturn16 with
+// LSMParams::quantize_paths, in which case the writer keeps the exact spot for
+// the next step (quantisation errors do not compound) and read_slice decodes.
+// Within LSMParams::memory_budget the store is one aligned buffer. Past it the
+// store sits on an unlinked, memory-mapped spill file in blocks of whole slices,
+// each slice padded to a page so blocks can be prefetched and dropped with
+// madvise. At most two blocks are resident: the one being written (read) and its
+// predecessor (the prefetched one).
+// Spill file and its mapping. SliceStore holds it as a member, so a constructor
+// that throws after creating either still releases it.
+struct SpillMapping {
+    int fd{-1};
+    unsigned char* data{nullptr};
+    std::size_t bytes{0};
+
+    SpillMapping() = default;
+    SpillMapping(const SpillMapping&) = delete;
+    SpillMapping& operator=(const SpillMapping&) = delete;
+    ~SpillMapping() {
+#if defined(__unix__) || defined(__APPLE__)
+        if (data) munmap(data, bytes);
+        if (fd >= 0) close(fd);
+#endif
+    }
+};
+
+template <typename Real>
+class SliceStore {
+public:
+    SliceStore(int slices, long paths, double S0, double r, double T, double sigma, const LSMParams& p)
+        : slices_(slices) {
+        const PathEncoding enc = p.quantize_paths ? PathEncoding::LogReturn16
+            : (sizeof(Real) == sizeof(float) ? PathEncoding::Float32 : PathEncoding::Float64);
+        native_ = !p.quantize_paths;
+        stats_.store_bytes = static_cast<std::size_t>(paths) * slices * path_encoding_size(enc);
+        if (p.memory_budget == 0 || stats_.store_bytes <= p.memory_budget) {
+            store_ = PathStore(paths, slices, PathLayout::TimeMajor, enc, S0);
+        } else {
+#if defined(__unix__) || defined(__APPLE__)
+            if (p.use_qmc) {
+                throw std::invalid_argument("lsm: QMC paths are generated path by path and cannot be spilled");
+            }
+            page_ = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+            spill_.bytes = PathStore::required_bytes(paths, slices, PathLayout::TimeMajor, enc, page_);
+            const std::size_t stride_bytes = spill_.bytes / slices;
+            block_ = static_cast<int>(std::max<std::size_t>(1, p.memory_budget / (2 * stride_bytes)));
+
+            std::string path = p.spill_dir;
+            if (path.empty()) {
+                const char* tmp = std::getenv("TMPDIR");
+                path = (tmp && *tmp) ? tmp : "/tmp";
+            }
+            path += "/bsm_lsm_XXXXXX";
+            std::vector<char> name(path.begin(), path.end());
+            name.push_back('\0');
+            spill_.fd = mkstemp(name.data());
+            if (spill_.fd < 0) throw std::runtime_error("lsm: cannot create spill file " + path);
+            unlink(name.data());
+            if (ftruncate(spill_.fd, static_cast<off_t>(spill_.bytes)) != 0)
+                throw std::runtime_error("lsm: cannot size spill file");
+            void* addr = mmap(nullptr, spill_.bytes, PROT_READ | PROT_WRITE, MAP_SHARED, spill_.fd, 0);
+            if (addr == MAP_FAILED) throw std::runtime_error("lsm: cannot map spill file");
+            spill_.data = static_cast<unsigned char*>(addr);
+            store_ = PathStore(paths, slices, PathLayout::TimeMajor, enc, S0, spill_.data, page_);
+            stats_.spilled = true;
+#else
+            throw std::runtime_error("lsm: out-of-core paths need POSIX mmap");
+#endif
+        }
+        if (!native_) {
+            // ln(S_t/S0) is normal with mean (r - sigma^2/2) t and sd sigma sqrt(t);
+            // 8 standard deviations leave clamping at the 1e-15 level
+            for (int n = 0; n < slices; ++n) {
+                const double t = T * n / (slices - 1);
+                store_.set_log_range(n, std::abs(r - 0.5 * sigma * sigma) * t + 8.0 * sigma * std::sqrt(t));
+            }
+            for (auto& s : staging_) s.resize(paths);
+            decoded_.resize(paths);
+        }
+    }
+
+    SliceStore(const SliceStore&) = delete;
+    SliceStore& operator=(const SliceStore&) = delete;
+
+    bool spilled() const { return spill_.data != nullptr; }
+
+    // Slice n for writing, in increasing n; the previous slice stays valid until
+    // the next call. Starting a block drops the one before its predecessor, whose
+    // last slice is no longer needed as the previous step.
+    Real* write_slice(int n) {
+        flush_staged();
+        if (spilled() && n % block_ == 0 && n / block_ >= 2) drop_block(n / block_ - 2, true);
+        if (native_) return row(n);
+        staged_ = n;
+        return staging_[n % 2].data();
+    }
+
+    // Single value, for generators that run path by path (never spilled)
+    void set(int n, long m, double S) {
+        if (native_) row(n)[m] = static_cast<Real>(S);
+        else store_.set(m, n, S);
+    }
+
+    // All slices written: drop what is still resident and wait for the write-back
+    void finish_writes() {
+        flush_staged();
+        if (!spilled()) return;
+#if defined(__unix__) || defined(__APPLE__)
+        const int last = (slices_ - 1) / block_;
+        for (int b = std::max(0, last - 1); b <= last; ++b) drop_block(b, true);
+        const auto t0 = std::chrono::steady_clock::now();
+        msync(spill_.data, spill_.bytes, MS_SYNC);
+        stats_.write_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        stats_.bytes_written = spill_.bytes;
+#endif
+    }
+
+    // Slice n for reading, in decreasing n; valid until the next call. Entering a
+    // block drops the one read before it, faults this one in (timed) and asks the
+    // kernel to prefetch the next.
+    const Real* read_slice(int n) {
+        if (spilled()) {
+            const int b = n / block_;
+            if (b != read_block_) {
+                if (read_block_ >= 0) drop_block(read_block_, false);
+                read_block_ = b;
+                const auto t0 = std::chrono::steady_clock::now();
+#if defined(__unix__) || defined(__APPLE__)
+                if (b > 0) advise_block(b - 1, MADV_WILLNEED);
+#endif
+                const unsigned char* base = block_begin(b);
+                const std::size_t len = block_bytes(b);
+                volatile unsigned char sink = 0;
+                for (std::size_t off = 0; off < len; off += page_) sink = sink + base[off];
+                (void)sink;
+                stats_.read_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+                stats_.bytes_read += len;
+                sample_residency();
+            }
+        }
+        if (native_) return row(n);
+        store_.load_date(n, decoded_.data());
+        return decoded_.data();
+    }
+
+    const LSMSpillStats& stats() const { return stats_; }
+
+private:
+    Real* row(int n) { return static_cast<Real*>(store_.row_data(n)); }
+    void flush_staged() {
+        if (staged_ >= 0) store_.store_date(staged_, staging_[staged_ % 2].data());
+        staged_ = -1;
+    }
+    unsigned char* block_begin(int b) const {
+        return spill_.data + static_cast<std::size_t>(b) * block_ * store_.row_bytes();
+    }
+    std::size_t block_bytes(int b) const {
+        const int first = b * block_, last = std::min(slices_, first + block_);
+        return static_cast<std::size_t>(last - first) * store_.row_bytes();
+    }
+#if defined(__unix__) || defined(__APPLE__)
+    void advise_block(int b, int advice) const {
+        madvise(block_begin(b), block_bytes(b), advice);
+    }
+    // Write back (asynchronously) and drop a block from the resident set
+    void drop_block(int b, bool written) {
+        const auto t0 = std::chrono::steady_clock::now();
+        if (written) {
+            sample_residency();
+            msync(block_begin(b), block_bytes(b), MS_ASYNC);
+        }
+        advise_block(b, MADV_DONTNEED);
+        if (written) {
+            stats_.write_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        }
+    }
+#else
+    void drop_block(int, bool) {}
+#endif
+    // Resident set of the mapping: its Rss line in /proc/self/smaps on Linux. The
+    // pages stay in the page cache after MADV_DONTNEED (mincore would still count
+    // them), but they no longer count against the process.
+    void sample_residency() {
+#if defined(__linux__)
+        std::ifstream smaps("/proc/self/smaps");
+        const unsigned long start = reinterpret_cast<unsigned long>(spill_.data);
+        std::string line;
+        bool in_map = false;
+        while (std::getline(smaps, line)) {
+            if (!line.empty() && std::isxdigit(static_cast<unsigned char>(line[0])) && line.find('-') != std::string::npos) {
+                in_map = std::stoul(line.substr(0, line.find('-')), nullptr, 16) == start;
+            } else if (in_map && line.compare(0, 4, "Rss:") == 0) {
+                const std::size_t kb = std::stoul(line.substr(4));
+                stats_.peak_resident_bytes = std::max(stats_.peak_resident_bytes, kb * 1024);
+                return;
+            }
+        }
+#endif
+    }
+
+    int slices_;
+    SpillMapping spill_;             // before store_, which may point into it
+    PathStore store_;
+    bool native_{true};              // store encoding is Real: rows are used in place
+    std::vector<Real> staging_[2];   // exact slices awaiting encoding (quantised store)
+    std::vector<Real> decoded_;
+    int staged_{-1};
+    std::size_t page_{4096};
+    int block_{1};                   // slices per block
+    int read_block_{-1};
+    LSMSpillStats stats_;
+};
+
+// Fill the slice store with the regression paths. Base path b and its antithetic
+// partner b + B share the same normals with opposite sign. With QMC the base
+// paths are split into replicate blocks, each driven by its own scrambling of
+// the Halton sequence mapped through a Brownian bridge. Real is the storage and
+// step arithmetic type (LSMParams::precision).
+template <typename Real>
+void simulate_paths(SliceStore<Real>& S, double S0, double r, double T, double sigma, const LSMParams& p) {
+    const int N = p.steps;
+    const long B = base_paths(p);
+    const long M = p.antithetic ? 2 * B : B;
+    const double dt = T / N;
+    const double drift = (r - 0.5 * sigma * sigma) * dt;
+    const double vol = sigma * std::sqrt(dt);
+
+    Real* spot0 = S.write_slice(0);
+    for (long m = 0; m < M; ++m) spot0[m] = static_cast<Real>(S0);
+    if (!p.use_qmc) {
+        std::mt19937_64 gen(p.seed);
+        std::normal_distribution<double> nd(0.0, 1.0);
+        const Real drift_r = static_cast<Real>(drift), vol_r = static_cast<Real>(vol);
+        const Real* prev = spot0;
+        for (int n = 1; n <= N; ++n) {
+            Real* cur = S.write_slice(n);
+            for (long b = 0; b < B; ++b) {
+                const Real z = static_cast<Real>(nd(gen));
+                cur[b] = prev[b] * std::exp(drift_r + vol_r * z);
+                if (p.antithetic) cur[b + B] = prev[b + B] * std::exp(drift_r - vol_r * z);
+            }
+            prev = cur;
+        }
+        S.finish_writes();
+        return;
+    }
+
+    const BrownianBridge bridge(N);
+    std::vector<double> u(N), z(N), dw(N);
+    int replicate = -1;
+    long first = 0;
+    std::unique_ptr<ScrambledHalton> seq;
+    for (long b = 0; b < B; ++b) {
+        if (qmc_replicate(p, b) != replicate) {
+            replicate = qmc_replicate(p, b);
+            first = b;
+            seq = std::make_unique<ScrambledHalton>(N, p.seed + 0x9E3779B97F4A7C15ULL * (replicate + 1));
+        }
+        seq->point(static_cast<uint64_t>(b - first + 1), u.data());
+        for (int n = 0; n < N; ++n) z[n] = norm_inv_cdf(u[n]);
+        bridge.increments(z.data(), dw.data());
+        double x_up = 0.0, x_dn = 0.0;
+        for (int n = 1; n <= N; ++n) {
+            x_up += drift + vol * dw[n - 1];
+            S.set(n, b, static_cast<Real>(S0 * std::exp(x_up)));
+            if (p.antithetic) {
+                x_dn += drift - vol * dw[n - 1];
+                S.set(n, b + B, static_cast<Real>(S0 * std::exp(x_dn)));
+            }
         }
     }
+    S.finish_writes();
+}
+
+// Outcome of each regression path under the fitted policy, kept for estimators
+// that reuse the in-sample exercise decisions
+template <typename Real>
+struct StoppedPaths {
+    std::vector<Real> S_stop;      // spot at the stopping date
+    std::vector<Real> S_first;     // spot after the first step
+    std::vector<int> tau;          // exercise date, or steps for maturity
+    std::vector<double> value;     // cash flow discounted to t = 0
+    long M{0};
+    LSMSpillStats spill;
+};
+
+// Per-path samples folded into sampling units: antithetic pairs are averaged
+std::vector<double> sampling_units(const std::vector<double>& v, const LSMParams& p) {
+    const long B = base_paths(p);
+    std::vector<double> u(B);
+    for (long b = 0; b < B; ++b) u[b] = p.antithetic ? 0.5 * (v[b] + v[b + B]) : v[b];
+    return u;
+}
 
-    // Initialize cashflows as immediate put payoff at maturity
+// Mean and standard error of the sampling units. Under QMC the units within a
+// replicate are not independent, so the error is the spread of the replicate means.
+std::pair<double, double> mean_and_error(const std::vector<double>& u, const LSMParams& p) {
+    const long B = static_cast<long>(u.size());
+    double mean = 0.0;
+    for (long b = 0; b < B; ++b) mean += u[b];
+    mean /= B;
+    if (p.use_qmc) {
+        const int R = std::max(1, std::min<int>(p.qmc_replicates, static_cast<int>(B)));
+        if (R < 2) return {mean, 0.0};
+        std::vector<double> sum(R, 0.0);
+        std::vector<long> cnt(R, 0);
+        for (long b = 0; b < B; ++b) {
+            const int q = std::min(R - 1, qmc_replicate(p, b));
+            sum[q] += u[b];
+            ++cnt[q];
+        }
+        // Replicates left without paths (few base paths per scrambling) do not count
+        double ss = 0.0;
+        int used = 0;
+        for (int q = 0; q < R; ++q) {
+            if (cnt[q] == 0) continue;
+            const double d = sum[q] / cnt[q] - mean;
+            ss += d * d;
+            ++used;
+        }
+        if (used < 2) return {mean, 0.0};
+        return {mean, std::sqrt(ss / (used * (used - 1.0)))};
+    }
+    if (B < 2) return {mean, 0.0};
+    double ss = 0.0;
+    for (long b = 0; b < B; ++b) ss += (u[b] - mean) * (u[b] - mean);
+    return {mean, std::sqrt(ss / ((B - 1.0) * B))};
+}
+
+// Fit the policy by backward induction on the regression paths. Each path's cash
+// flow is kept with its exercise date and discounted from there, so out-of-the-money
+// dates need no per-step update. The regressions accumulate in double whatever
+// the path precision.
+template <typename Real>
+ExercisePolicy fit_policy(double S0, double K, double r, double T, double sigma,
+                          const LSMParams& p, double* in_sample_price,
+                          StoppedPaths<Real>* stopped = nullptr) {
+    const int N = p.steps;
+    const double dt = T / N;
+    const long M = p.antithetic ? 2 * base_paths(p) : base_paths(p);
+    SliceStore<Real> S(N + 1, M, S0, r, T, sigma, p);
+    simulate_paths(S, S0, r, T, sigma, p);
+
+    ExercisePolicy policy;
+    policy.steps = N;
+    policy.cols = std::max(1, p.poly_degree) + 1;
+    policy.K = K;
+    policy.beta.assign(static_cast<std::size_t>(N + 1) * policy.cols, 0.0);
+    policy.fitted.assign(N + 1, 0);
+    const int cols = policy.cols;
+
+    // Cash flow at maturity, then backward induction over the exercise dates
     std::vector<double> CF(M);
-    for (long m = 0; m < M; ++m) CF[m] = std::max(K - S[N][m], 0.0);
+    std::vector<int> tau(M, N);
+    const Real* SN = S.read_slice(N);
+    for (long m = 0; m < M; ++m) CF[m] = std::max(K - SN[m], 0.0);
+    std::vector<Real> S_stop(SN, SN + M);
 
-    // Backward induction using polynomial basis in S
+    std::vector<double> phi(cols);
     for (int n = N - 1; n >= 1; --n) {
-        std::vector<long> itm;
-        itm.reserve(M);
-        for (long m = 0; m < M; ++m) if (K - S[n][m] > 0.0) itm.push_back(m);
-        if (itm.size() < 5) continue;
-
-        int d = std::max(1, p.poly_degree);
-        int cols = d + 1;
-        // Build X^T X and X^T y for regression: basis {1, S, S^2, ...}
+        const Real* Sn = S.read_slice(n);
         std::vector<double> XtX(cols * cols, 0.0), Xty(cols, 0.0);
-        double disc = std::exp(-r * dt);
-        for (long idx : itm) {
-            double s = S[n][idx];
-            double y = CF[idx] * disc; // discounted from n+1 to n
-            std::vector<double> phi(cols, 1.0);
-            for (int k = 1; k < cols; ++k) phi[k] = phi[k - 1] * s;
+        long itm = 0;
+        for (long m = 0; m < M; ++m) {
+            if (K - Sn[m] <= 0.0) continue;
+            ++itm;
+            const double y = CF[m] * std::exp(-r * (tau[m] - n) * dt);
+            phi[0] = 1.0;
+            for (int k = 1; k < cols; ++k) phi[k] = phi[k - 1] * (Sn[m] / K);
             for (int i = 0; i < cols; ++i) {
                 Xty[i] += phi[i] * y;
                 for (int j = 0; j < cols; ++j) XtX[i * cols + j] += phi[i] * phi[j];
             }
         }
-        // Solve XtX * beta = Xty (Gaussian elimination)
-        for (int i = 0; i < cols; ++i) {
-            // Pivot
-            int piv = i;
-            for (int rrow = i + 1; rrow < cols; ++rrow) if (std::abs(XtX[rrow * cols + i]) > std::abs(XtX[piv * cols + i])) piv = rrow;
-            if (piv != i) {
-                for (int c = 0; c < cols; ++c) std::swap(XtX[i * cols + c], XtX[piv * cols + c]);
-                std::swap(Xty[i], Xty[piv]);
-            }
-            double diag = XtX[i * cols + i];
-            if (std::abs(diag) < 1e-14) continue;
-            double invd = 1.0 / diag;
-            for (int c = i; c < cols; ++c) XtX[i * cols + c] *= invd;
-            Xty[i] *= invd;
-            for (int rrow = 0; rrow < cols; ++rrow) if (rrow != i) {
-                double f = XtX[rrow * cols + i];
-                for (int c = i; c < cols; ++c) XtX[rrow * cols + c] -= f * XtX[i * cols + c];
-                Xty[rrow] -= f * Xty[i];
-            }
-        }
-        std::vector<double> beta(cols);
-        for (int i = 0; i < cols; ++i) beta[i] = Xty[i];
+        if (itm < 5) continue;
+        solve_normal_equations(XtX, Xty, cols);
+        std::copy(Xty.begin(), Xty.end(), policy.beta.begin() + static_cast<std::ptrdiff_t>(n) * cols);
+        policy.fitted[n] = 1;
 
-        // Exercise decision
         for (long m = 0; m < M; ++m) {
-            double payoff = std::max(K - S[n][m], 0.0);
-            if (payoff <= 0) continue;
-            double s = S[n][m];
-            double cont = 0.0; double pow = 1.0;
-            for (int k = 0; k < cols; ++k) { cont += beta[k] * pow; pow *= s; }
-            if (payoff > cont) CF[m] = payoff; else CF[m] *= std::exp(-r * dt);
+            const double payoff = std::max(K - Sn[m], 0.0);
+            if (policy.exercise(n, Sn[m], payoff)) { CF[m] = payoff; tau[m] = n; S_stop[m] = Sn[m]; }
         }
     }
 
-    // Discount remaining cashflows to t=0 (already discounted stepwise in loop)
     double price = 0.0;
     for (long m = 0; m < M; ++m) {
-        double c = CF[m];
-        price += c;
+        CF[m] *= std::exp(-r * tau[m] * dt);
+        price += CF[m];
+    }
+    if (in_sample_price) *in_sample_price = price / static_cast<double>(M);
+    if (stopped) {
+        const Real* S1 = S.read_slice(1);
+        stopped->S_first.assign(S1, S1 + M);
+        stopped->S_stop = std::move(S_stop);
+        stopped->spill = S.stats();
+        stopped->tau = std::move(tau);
+        stopped->value = std::move(CF);
+        stopped->M = M;
+    }
+    return policy;
+}
+
+// Price and standard error from the stopped regression paths
+template <typename Real>
+LSMResult estimate_price(const StoppedPaths<Real>& paths, double S0, double K, double r, double T,
+                         double sigma, const LSMParams& p) {
+    const long B = base_paths(p);
+    const long M = paths.M;
+    const std::vector<double>& X = paths.value;
+
+    // Control variate: discounted European put at the stopping time, a martingale
+    // sample whose mean is the European price
+    std::vector<double> Y(M, 0.0);
+    if (p.control_variate) {
+        const double dt = T / p.steps;
+        for (long m = 0; m < M; ++m) {
+            const int n = paths.tau[m];
+            const double St = paths.S_stop[m];
+            Y[m] = (n == p.steps) ? X[m]
+                 : std::exp(-r * n * dt) * black_scholes_price(St, K, r, (p.steps - n) * dt, sigma, OptionType::Put);
+        }
+    }
+
+    const std::vector<double> x = sampling_units(X, p), y = sampling_units(Y, p);
+    double mx = 0.0, my = 0.0;
+    for (long b = 0; b < B; ++b) { mx += x[b]; my += y[b]; }
+    mx /= B;
+    my /= B;
+    double vy = 0.0, cxy = 0.0;
+    for (long b = 0; b < B; ++b) {
+        vy += (y[b] - my) * (y[b] - my);
+        cxy += (x[b] - mx) * (y[b] - my);
+    }
+    const double beta = (p.control_variate && vy > 1e-14) ? cxy / vy : 0.0;
+    const double european = black_scholes_price(S0, K, r, T, sigma, OptionType::Put);
+
+    std::vector<double> u(B);
+    for (long b = 0; b < B; ++b) u[b] = x[b] - beta * (y[b] - european);
+    LSMResult res;
+    res.cv_beta = beta;
+    res.num_paths = M;
+    res.spill = paths.spill;
+    std::tie(res.price, res.std_error) = mean_and_error(u, p);
+    return res;
+}
+
+template <typename Real>
+LSMResult estimate_impl(double S0, double K, double r, double T, double sigma, const LSMParams& p) {
+    StoppedPaths<Real> paths;
+    fit_policy(S0, K, r, T, sigma, p, nullptr, &paths);
+    return estimate_price(paths, S0, K, r, T, sigma, p);
+}
+
+template <typename Real>
+MCResult greeks_impl(double S0, double K, double r, double T, double sigma, const LSMParams& p) {
+    StoppedPaths<Real> paths;
+    fit_policy(S0, K, r, T, sigma, p, nullptr, &paths);
+    const LSMResult est = estimate_price(paths, S0, K, r, T, sigma, p);
+
+    // Differentiate each path's discounted cash flow e^{-r t} (K - S_t)^+ at its own
+    // stopping time t, with the exercise decisions held fixed:
+    //   dS_t/dS0 = S_t / S0,  dS_t/dsigma = S_t (W_t - sigma t).
+    // Gamma differentiates the first step's density instead (likelihood ratio) and
+    // the rest of the path pathwise: E[delta_pw (z1 / (sigma sqrt(dt)) - 1) / S0].
+    const int N = p.steps;
+    const long M = paths.M;
+    const double dt = T / N;
+    const double drift = (r - 0.5 * sigma * sigma) * dt;
+    const double vol = sigma * std::sqrt(dt);
+    std::vector<double> delta(M), vega(M), gamma(M);
+    for (long m = 0; m < M; ++m) {
+        const int n = paths.tau[m];
+        const double t = n * dt;
+        const double St = static_cast<double>(paths.S_stop[m]);
+        const double exercised = (K > St) ? std::exp(-r * t) : 0.0;
+        const double W = (std::log(St / S0) - (r - 0.5 * sigma * sigma) * t) / sigma;
+        const double z1 = (std::log(static_cast<double>(paths.S_first[m]) / S0) - drift) / vol;
+        delta[m] = -exercised * St / S0;
+        vega[m] = -exercised * St * (W - sigma * t);
+        gamma[m] = delta[m] * (z1 / vol - 1.0) / S0;
+    }
+
+    MCResult res;
+    res.price = est.price;
+    res.std_error = est.std_error;
+    std::tie(res.delta, res.delta_se) = mean_and_error(sampling_units(delta, p), p);
+    std::tie(res.vega, res.vega_se) = mean_and_error(sampling_units(vega, p), p);
+    std::tie(res.gamma, res.gamma_se) = mean_and_error(sampling_units(gamma, p), p);
+    res.num_paths = M;
+    res.num_steps = N;
+    res.seed = p.seed;
+    return res;
+}
+
+} // namespace
+
+double lsm_american_put(double S0, double K, double r, double T, double sigma, const LSMParams& p) {
+    double price = 0.0;
+    if (p.precision == Precision::Float) {
+        fit_policy<float>(S0, K, r, T, sigma, p, &price);
+    } else {
+        fit_policy<double>(S0, K, r, T, sigma, p, &price);
     }
-    price /= static_cast<double>(M);
     return price;
 }
 
+LSMResult lsm_american_put_estimate(double S0, double K, double r, double T, double sigma,
+                                    const LSMParams& p) {
+    return (p.precision == Precision::Float) ? estimate_impl<float>(S0, K, r, T, sigma, p)
+                                             : estimate_impl<double>(S0, K, r, T, sigma, p);
+}
+
+MCResult lsm_american_put_greeks(double S0, double K, double r, double T, double sigma,
+                                 const LSMParams& p) {
+    return (p.precision == Precision::Float) ? greeks_impl<float>(S0, K, r, T, sigma, p)
+                                             : greeks_impl<double>(S0, K, r, T, sigma, p);
+}
+
+LSMBounds lsm_american_put_bounds(double S0, double K, double r, double T, double sigma,
+                                  const LSMParams& p, const LSMDualParams& dual) {
+    const ExercisePolicy policy = (p.precision == Precision::Float)
+        ? fit_policy<float>(S0, K, r, T, sigma, p, nullptr)
+        : fit_policy<double>(S0, K, r, T, sigma, p, nullptr);
+    const int N = p.steps;
+    const double dt = T / N;
+    const double drift = (r - 0.5 * sigma * sigma) * dt;
+    const double vol = sigma * std::sqrt(dt);
+    std::vector<double> disc(N + 1);
+    for (int n = 0; n <= N; ++n) disc[n] = std::exp(-r * n * dt);
+    auto payoff = [K](double s) { return std::max(K - s, 0.0); };
+
+    LSMBounds out;
+
+    // Lower bound: the fitted policy on independent paths
+    constexpr long kBlock = 1024;
+    const long lower_paths = dual.lower_paths > 0 ? dual.lower_paths : p.paths;
+    const long lower_blocks = (lower_paths + kBlock - 1) / kBlock;
+    double sum = 0.0, sum2 = 0.0;
+    #ifdef _OPENMP
+    #pragma omp parallel for schedule(static) reduction(+:sum,sum2)
+    #endif
+    for (long blk = 0; blk < lower_blocks; ++blk) {
+        RNG rng(dual.seed + 0x9E3779B97F4A7C15ULL * static_cast<unsigned long>(blk + 1));
+        const long n_blk = std::min(kBlock, lower_paths - blk * kBlock);
+        for (long i = 0; i < n_blk; ++i) {
+            double s = S0, value = 0.0;
+            for (int n = 1; n <= N; ++n) {
+                s *= std::exp(drift + vol * rng.gauss());
+                const double h = payoff(s);
+                if (policy.exercise(n, s, h)) { value = h * disc[n]; break; }
+            }
+            sum += value;
+            sum2 += value * value;
+        }
+    }
+    out.lower = sum / lower_paths;
+    out.lower_se = std::sqrt(std::max(0.0, sum2 / lower_paths - out.lower * out.lower) / lower_paths);
+
+    // Upper bound. With L_n the discounted value of following the policy from n
+    // (h_n if it exercises at n) and C_n = E_n[L_{n+1}] estimated by nested paths,
+    // M_{n+1} = M_n + L_{n+1} - C_n is a martingale and E[max_n (h_n - M_n)] an
+    // upper bound. Exercising out of the money is never optimal, so the maximum
+    // and the martingale only need the in-the-money dates and maturity: between
+    // them the policy never stops, L is a martingale, and the increment from one
+    // such date j to the next k is L_k - C_j (Broadie-Cao). This skips the nested
+    // runs at out-of-the-money dates and the noise they would add to M.
+    // C_0 is the policy value, i.e. the lower bound estimate, which shifts every
+    // path by the same amount and so enters only through its error.
+    auto inner_count = [&](int n) {
+        if (n - 1 < static_cast<int>(dual.inner_schedule.size())) return std::max(1, dual.inner_schedule[n - 1]);
+        return std::max(1, dual.inner_paths);
+    };
+    const long outer = std::max(1L, dual.outer_paths);
+    double usum = 0.0, usum2 = 0.0;
+    long nested = 0;
+
+    #ifdef _OPENMP
+    #pragma omp parallel reduction(+:usum,usum2,nested)
+    #endif
+    {
+        // Per-thread buffers: the outer path and the live inner sub-paths
+        std::vector<double> path(N + 1), inner;
+        std::vector<char> alive;
+
+        #ifdef _OPENMP
+        #pragma omp for schedule(dynamic, 4)
+        #endif
+        for (long o = 0; o < outer; ++o) {
+            RNG rng(dual.seed ^ (0xD1B54A32D192ED03ULL * static_cast<unsigned long>(o + 1)));
+            path[0] = S0;
+            for (int n = 1; n <= N; ++n) path[n] = path[n - 1] * std::exp(drift + vol * rng.gauss());
+
+            // Nested estimate of C_n: follow the policy from n + 1 on each sub-path.
+            // The discounted spot at the stopping time has known mean disc_n S_n
+            // (optional stopping) and serves as a regression control variate; it
+            // removes most of the inner noise that would otherwise inflate the bound.
+            auto continuation = [&](int n) {
+                const int m = inner_count(n);
+                inner.assign(m, path[n]);
+                alive.assign(m, 1);
+                double sx = 0.0, sy = 0.0, sxy = 0.0, syy = 0.0;
+                int live = m;
+                for (int j = n + 1; j <= N && live > 0; ++j) {
+                    nested += live;
+                    for (int i = 0; i < m; ++i) {
+                        if (!alive[i]) continue;
+                        inner[i] *= std::exp(drift + vol * rng.gauss());
+                        const double h = payoff(inner[i]);
+                        if (policy.exercise(j, inner[i], h) || j == N) {
+                            const double x = h * disc[j], y = inner[i] * disc[j];
+                            sx += x; sy += y; sxy += x * y; syy += y * y;
+                            alive[i] = 0;
+                            --live;
+                        }
+                    }
+                }
+                const double mx = sx / m, my = sy / m;
+                const double vy = syy / m - my * my;
+                const double b = (vy > 1e-14) ? (sxy / m - mx * my) / vy : 0.0;
+                return mx - b * (my - path[n] * disc[n]);
+            };
+
+            double M = 0.0, C_prev = out.lower, best = -1e300;
+            for (int n = 1; n <= N; ++n) {
+                const double h = payoff(path[n]);
+                if (h <= 0.0 && n < N) continue;
+                double L = h * disc[n], C = 0.0;
+                if (n < N) {
+                    C = continuation(n);
+                    if (!policy.exercise(n, path[n], h)) L = C;
+                }
+                M += L - C_prev;
+                best = std::max(best, h * disc[n] - M);
+                C_prev = C;
+            }
+            usum += best;
+            usum2 += best * best;
+        }
+    }
+
+    const double mean = usum / outer;
+    const double var = std::max(0.0, usum2 / outer - mean * mean);
+    out.upper = mean;
+    out.upper_se = std::sqrt(var / outer + out.lower_se * out.lower_se);
+    out.nested_steps = nested;
+    return out;
+}
+
 }
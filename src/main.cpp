@@ -5,14 +5,35 @@
 #include <chrono>
 #include <sstream>
 #include <cstring>
+#include <algorithm>
+#include <iterator>
 
 #include "option_types.hpp"
 #include "analytic_bs.hpp"
+#include "arbitrage.hpp"
+#include "implied_forward.hpp"
+#include "variance_swap.hpp"
+#include "dupire.hpp"
+#include "isa_dispatch.hpp"
+#include "engine_tuning.hpp"
+#include "accuracy_harness.hpp"
+#include "portfolio.hpp"
+#include "async_pricing.hpp"
+#include "pnl_explain.hpp"
+#include "risk_graph.hpp"
+#include "shm_cache.hpp"
+#include "asian.hpp"
+#include "barrier.hpp"
 #include "monte_carlo_gbm.hpp"
 #include "pde_cn.hpp"
+#include "pde_cn_american.hpp"
+#include "lsm.hpp"
 #include "slv.hpp"
+#include "pde_heston_adi.hpp"
+#include "pde_multi_asset.hpp"
 #include "stats.hpp"
 #include "iv_solve.hpp"
+#include "math_utils.hpp"
 
 #ifdef USE_PERFORMANCE_UTILS
 #include "performance_utils.hpp"
@@ -311,6 +332,1180 @@ namespace {
         std::cout << std::string(70, '-') << "\n";
     }
 
+    /**
+     * @brief Surface-wide SLV repricing: one shared path set vs one run per (K, T)
+     */
+    void run_surface_benchmark(const DemoConfig& config) {
+        Timer timer;
+
+        print_header("Surface Repricing: Shared Path Set");
+
+        HestonParams heston{1.5, 0.04, 0.5, -0.7, 0.04};
+        auto local_vol_fn = SmileLocalVol{0.22, 0.95, 0.25, 0.15, config.S0, 0.01}.to_fn();
+
+        std::vector<double> strikes, expiries;
+        for (int k = 0; k < 40; ++k) strikes.push_back(config.S0 * (0.6 + 0.02 * k));
+        for (double t : {1.0 / 12, 2.0 / 12, 3.0 / 12, 6.0 / 12, 9.0 / 12, 1.0, 1.5, 2.0}) expiries.push_back(t);
+        const long paths = config.slv_paths / 10;
+        const long steps = config.slv_steps * 2;
+
+        timer.start();
+        const MCResultGrid grid = mc_slv_price_grid(config.S0, strikes, expiries, config.r, paths, steps,
+                                                    OptionType::Call, heston, local_vol_fn, 77777UL);
+        const double grid_ms = timer.elapsed_ms();
+
+        // Per-contract cost sampled on a few cells and extrapolated to the full surface
+        const int samples = 4;
+        timer.start();
+        for (int i = 0; i < samples; ++i) {
+            const size_t e = (i * 3) % expiries.size(), k = (i * 11) % strikes.size();
+            (void)mc_slv_price(config.S0, strikes[k], config.r, grid.expiries[e], paths,
+                               grid.at(e, k).num_steps, OptionType::Call, heston, local_vol_fn, 4242UL + i);
+        }
+        const double per_contract_ms = timer.elapsed_ms() / samples;
+        const double naive_ms = per_contract_ms * static_cast<double>(strikes.size() * expiries.size());
+
+        std::cout << std::fixed << std::setprecision(6);
+        std::cout << "Surface:                  " << strikes.size() << " strikes x " << expiries.size()
+                  << " expiries (" << strikes.size() * expiries.size() << " contracts)\n";
+        std::cout << "Paths / Steps:            " << format_number(paths) << " / " << steps << "\n";
+        std::cout << "ATM 1Y Price (SE):        " << grid.at(5, 20).price << " (" << grid.at(5, 20).std_error << ")\n";
+        std::cout << std::setprecision(1);
+        std::cout << "Shared Path Set:          " << grid_ms << " ms\n";
+        std::cout << "Per-Contract (est.):      " << naive_ms << " ms (" << per_contract_ms << " ms x "
+                  << strikes.size() * expiries.size() << ")\n";
+        std::cout << "Speedup:                  " << naive_ms / grid_ms << "x\n";
+        std::cout << std::string(70, '-') << "\n";
+    }
+
+    /**
+     * @brief Compare the Heston/SLV ADI PDE with Monte Carlo at matched accuracy
+     */
+    void run_heston_pde_benchmark(const DemoConfig& config) {
+        Timer timer;
+
+        print_header("Heston/SLV: ADI PDE vs Monte Carlo");
+
+        HestonParams heston{1.5, 0.04, 0.3, -0.9, 0.04};
+        const SmileLocalVol smile{0.20, 1.0, 0.15, 0.10, config.S0, 0.01};
+        LeverageGrid leverage;
+        for (double t : {0.0, 0.5, 1.0, 2.0}) leverage.t.push_back(t);
+        for (int i = 0; i <= 30; ++i) leverage.S.push_back(config.S0 * (0.25 + 0.1 * i));
+        for (double t : leverage.t) {
+            std::vector<double> row;
+            for (double S : leverage.S) row.push_back(smile.sigma(S, t) / 0.2);
+            leverage.L.push_back(row);
+        }
+        const LocalVolFn lv = [&leverage](double S, double t) { return leverage.interpolate(S, t); };
+
+        HestonADIConfig fine;
+        fine.num_S = 400; fine.num_v = 200; fine.num_t = 400;
+        const double reference = pde_heston_adi(config.S0, config.K, config.r, config.T, config.type,
+                                                heston, &leverage, ExerciseStyle::European, {}, fine).price;
+
+        const HestonADIConfig standard;
+        timer.start();
+        const PDEResult pde = pde_heston_adi(config.S0, config.K, config.r, config.T, config.type,
+                                             heston, &leverage);
+        const double pde_ms = timer.elapsed_ms();
+        const double pde_error = std::max(std::abs(pde.price - reference), 1e-6);
+
+        // MC paths needed for a standard error equal to the PDE error, extrapolated from a pilot run
+        const long pilot_paths = std::max(1000L, config.slv_paths / 30);
+        const long steps = std::max(1L, config.slv_steps / 2);
+        timer.start();
+        const MCResult pilot = mc_slv_price(config.S0, config.K, config.r, config.T, pilot_paths, steps,
+                                            config.type, heston, lv, 2024UL);
+        const double pilot_ms = timer.elapsed_ms();
+        const double ratio = pilot.std_error / pde_error;
+        const double matched_paths = static_cast<double>(pilot_paths) * ratio * ratio;
+        const double mc_ms = pilot_ms * matched_paths / static_cast<double>(pilot_paths);
+
+        std::cout << std::fixed << std::setprecision(6);
+        std::cout << "Reference (" << fine.num_S << "x" << fine.num_v << "x" << fine.num_t << " grid): "
+                  << reference << "\n";
+        std::cout << "PDE " << standard.num_S << "x" << standard.num_v << "x" << standard.num_t
+                  << ":         " << pde.price << " (error " << pde_error << ", delta " << pde.delta << ")\n";
+        std::cout << "MC Pilot (" << format_number(pilot_paths) << " pairs):  " << pilot.price
+                  << " (SE " << pilot.std_error << ")\n";
+        std::cout << std::setprecision(1);
+        std::cout << "PDE Time:                 " << pde_ms << " ms\n";
+        std::cout << "MC Time at Matched SE:    " << mc_ms << " ms (est., "
+                  << format_number(static_cast<long>(matched_paths)) << " pairs x " << steps << " steps)\n";
+        std::cout << "Speedup:                  " << mc_ms / pde_ms << "x\n";
+        std::cout << std::string(70, '-') << "\n";
+    }
+
+    /**
+     * @brief Terminal-value Monte Carlo for a European basket (reference for the ADI engine)
+     */
+    MCResult mc_basket_terminal(const std::vector<double>& S0, const std::vector<double>& sigma,
+                                const std::vector<std::vector<double>>& corr, double r, double T,
+                                const std::vector<double>& weights, double K, long paths,
+                                unsigned long seed) {
+        const size_t d = S0.size();
+        std::vector<std::vector<double>> chol(d, std::vector<double>(d, 0.0));
+        for (size_t i = 0; i < d; ++i) {
+            for (size_t j = 0; j <= i; ++j) {
+                double sum = corr[i][j];
+                for (size_t k = 0; k < j; ++k) sum -= chol[i][k] * chol[j][k];
+                chol[i][j] = (i == j) ? std::sqrt(std::max(sum, 0.0)) : sum / chol[j][j];
+            }
+        }
+        RNG rng(seed);
+        std::vector<double> z(d);
+        double sum = 0.0, sum2 = 0.0;
+        for (long p = 0; p < paths; ++p) {
+            for (size_t k = 0; k < d; ++k) z[k] = rng.gauss();
+            double basket = 0.0;
+            for (size_t i = 0; i < d; ++i) {
+                double e = 0.0;
+                for (size_t k = 0; k <= i; ++k) e += chol[i][k] * z[k];
+                basket += weights[i] * S0[i] * std::exp((r - 0.5 * sigma[i] * sigma[i]) * T + sigma[i] * std::sqrt(T) * e);
+            }
+            const double payoff = std::max(basket - K, 0.0);
+            sum += payoff;
+            sum2 += payoff * payoff;
+        }
+        const double mean_payoff = sum / paths;
+        MCResult res;
+        res.price = std::exp(-r * T) * mean_payoff;
+        res.std_error = std::exp(-r * T) * std::sqrt(std::max(0.0, sum2 / paths - mean_payoff * mean_payoff) / paths);
+        return res;
+    }
+
+    /**
+     * @brief Compare the multi-asset ADI engine with Monte Carlo at matched accuracy
+     */
+    void run_multi_asset_benchmark(const DemoConfig& config) {
+        Timer timer;
+
+        print_header("Multi-Asset ADI PDE vs Monte Carlo");
+
+        struct Case {
+            const char* name;
+            std::vector<double> S0, sigma, weights;
+            std::vector<std::vector<double>> corr;
+            double K;
+        };
+        const std::vector<Case> cases = {
+            {"2D exchange (S1 - S2)", {config.S0, config.S0 * 0.95}, {0.30, 0.20}, {1.0, -1.0},
+             {{1.0, 0.5}, {0.5, 1.0}}, 0.0},
+            {"3D basket (equal weights)", {config.S0, config.S0 * 0.9, config.S0 * 1.1}, {0.20, 0.25, 0.30},
+             {1.0 / 3, 1.0 / 3, 1.0 / 3}, {{1.0, 0.5, 0.3}, {0.5, 1.0, 0.4}, {0.3, 0.4, 1.0}}, config.K},
+        };
+
+        for (const Case& c : cases) {
+            MultiAssetADIConfig fine;
+            fine.num_S = (c.S0.size() == 2) ? 480 : 96;
+            const double reference = pde_multi_asset_adi(c.S0, c.sigma, c.corr, config.r, config.T, c.weights,
+                                                         c.K, OptionType::Call, fine).price;
+
+            timer.start();
+            const MultiAssetPDEResult pde = pde_multi_asset_adi(c.S0, c.sigma, c.corr, config.r, config.T,
+                                                                c.weights, c.K, OptionType::Call);
+            const double pde_ms = timer.elapsed_ms();
+            const double pde_error = std::max(std::abs(pde.price - reference), 1e-6);
+
+            const long pilot_paths = std::max(10000L, config.mc_paths / 5);
+            timer.start();
+            const MCResult pilot = mc_basket_terminal(c.S0, c.sigma, c.corr, config.r, config.T, c.weights,
+                                                      c.K, pilot_paths, 31337UL);
+            const double pilot_ms = timer.elapsed_ms();
+            const double ratio = pilot.std_error / pde_error;
+            const double matched_paths = static_cast<double>(pilot_paths) * ratio * ratio;
+            const double mc_ms = pilot_ms * matched_paths / static_cast<double>(pilot_paths);
+
+            std::cout << c.name << "\n";
+            std::cout << std::fixed << std::setprecision(6);
+            std::cout << "  Reference (fine grid):  " << reference << "\n";
+            std::cout << "  PDE:                    " << pde.price << " (error " << pde_error << ")\n";
+            std::cout << "  MC Pilot:               " << pilot.price << " (SE " << pilot.std_error << ", "
+                      << format_number(pilot_paths) << " paths)\n";
+            std::cout << std::setprecision(1);
+            std::cout << "  PDE Time:               " << pde_ms << " ms\n";
+            std::cout << "  MC Time at Matched SE:  " << mc_ms << " ms (est., "
+                      << format_number(static_cast<long>(matched_paths)) << " paths)\n";
+            std::cout << "  Speedup:                " << mc_ms / pde_ms << "x\n";
+        }
+        std::cout << std::string(70, '-') << "\n";
+    }
+
+    /**
+     * @brief Barrier engines: batch closed-form throughput and PDE/MC accuracy
+     */
+    void run_barrier_benchmark(const DemoConfig& config) {
+        Timer timer;
+
+        print_header("Barrier Option Engines");
+
+        // Random book covering all eight knock-in/knock-out cases
+        const std::size_t book_size = 200000;
+        const BarrierType kinds[] = {BarrierType::DownOut, BarrierType::UpOut, BarrierType::DownIn, BarrierType::UpIn};
+        RNG rng(2024);
+        BarrierBatch book;
+        for (std::size_t i = 0; i < book_size; ++i) {
+            const BarrierType kind = kinds[i % 4];
+            const double S = config.S0 * (0.8 + 0.4 * rng.uni());
+            const double H = is_down_barrier(kind) ? S * (0.7 + 0.25 * rng.uni()) : S * (1.05 + 0.25 * rng.uni());
+            book.push_back(S, config.K * (0.8 + 0.4 * rng.uni()), 0.1 + 1.9 * rng.uni(), 0.1 + 0.4 * rng.uni(),
+                           (i / 4) % 2 ? OptionType::Put : OptionType::Call, BarrierSpec{kind, H, 1.0});
+        }
+
+        std::vector<double> batch_prices;
+        timer.start();
+        barrier_price_batch(book, config.r, batch_prices);
+        const double batch_ms = timer.elapsed_ms();
+
+        std::vector<double> scalar_prices(book_size);
+        timer.start();
+        for (std::size_t i = 0; i < book_size; ++i) {
+            scalar_prices[i] = barrier_price_analytic(book.spot[i], book.strike[i], config.r, book.T[i], book.sigma[i],
+                                                      book.type[i], BarrierSpec{book.barrier[i], book.level[i], book.rebate[i]});
+        }
+        const double scalar_ms = timer.elapsed_ms();
+        double max_diff = 0.0;
+        for (std::size_t i = 0; i < book_size; ++i) max_diff = std::max(max_diff, std::abs(batch_prices[i] - scalar_prices[i]));
+
+        std::cout << "Closed form, " << format_number(static_cast<long>(book_size)) << " options\n";
+        std::cout << std::fixed << std::setprecision(1);
+        std::cout << "  Batch Kernel:           " << batch_ms << " ms ("
+                  << format_number(static_cast<long>(book_size / (batch_ms * 1e-3))) << " options/s)\n";
+        std::cout << "  Scalar Loop:            " << scalar_ms << " ms ("
+                  << format_number(static_cast<long>(book_size / (scalar_ms * 1e-3))) << " options/s)\n";
+        std::cout << std::scientific << std::setprecision(2);
+        std::cout << "  Max |batch - scalar|:   " << max_diff << "\n";
+
+        // One down-and-out call through every engine
+        const BarrierSpec down_out{BarrierType::DownOut, 0.9 * config.S0, 0.0};
+        const int dates = 12;
+        std::cout << std::fixed;
+        for (int monitoring : {0, dates}) {
+            const double exact = barrier_price_analytic(config.S0, config.K, config.r, config.T, config.sigma,
+                                                        OptionType::Call, down_out, monitoring);
+            timer.start();
+            const double pde = pde_crank_nicolson_barrier(config.S0, config.K, config.r, config.T, config.sigma,
+                                                          400, 240, OptionType::Call, down_out, monitoring);
+            const double pde_ms = timer.elapsed_ms();
+            timer.start();
+            const MCResult mc = mc_gbm_barrier_price(config.S0, config.K, config.r, config.T, config.sigma,
+                                                     config.mc_paths, 48, OptionType::Call, down_out,
+                                                     12345, true, monitoring);
+            const double mc_ms = timer.elapsed_ms();
+
+            std::cout << (monitoring ? "Down-and-out call, 12 monitoring dates\n" : "Down-and-out call, continuous\n");
+            std::cout << std::setprecision(6);
+            std::cout << "  Closed Form" << (monitoring ? " (BGK):      " : ":            ") << exact << "\n";
+            std::cout << "  CN PDE:                 " << pde << " (" << std::setprecision(2) << pde_ms << " ms)\n";
+            std::cout << std::setprecision(6);
+            std::cout << "  MC (" << (monitoring ? "date checks" : "bridged") << "):" << (monitoring ? "       " : "           ")
+                      << mc.price << " ± " << mc.std_error << " (" << std::setprecision(1) << mc_ms << " ms)\n";
+        }
+        std::cout << std::string(70, '-') << "\n";
+    }
+
+    /**
+     * @brief Asian options: closed-form batch throughput and control-variate MC efficiency
+     */
+    void run_asian_benchmark(const DemoConfig& config) {
+        Timer timer;
+
+        print_header("Asian Options");
+
+        const std::size_t book_size = 100000;
+        const int schedules[] = {0, 12, 52, 252};
+        RNG rng(2024);
+        AsianBatch book;
+        for (std::size_t i = 0; i < book_size; ++i) {
+            book.push_back(config.S0, config.K * (0.8 + 0.4 * rng.uni()), 0.1 + 1.9 * rng.uni(), 0.1 + 0.4 * rng.uni(),
+                           schedules[i % 4], i % 2 ? OptionType::Put : OptionType::Call);
+        }
+        std::cout << "Closed forms, " << format_number(static_cast<long>(book_size)) << " options (mixed schedules)\n";
+        const std::pair<AsianFormula, const char*> formulas[] = {
+            {AsianFormula::Geometric, "Geometric:            "},
+            {AsianFormula::TurnbullWakeman, "Turnbull-Wakeman:     "},
+            {AsianFormula::Levy, "Levy (exact moments): "},
+        };
+        std::vector<double> prices;
+        std::cout << std::fixed << std::setprecision(1);
+        for (const auto& f : formulas) {
+            timer.start();
+            asian_price_batch(book, config.r, f.first, prices);
+            const double ms = timer.elapsed_ms();
+            std::cout << "  " << f.second << " " << ms << " ms ("
+                      << format_number(static_cast<long>(book_size / (ms * 1e-3))) << " options/s)\n";
+        }
+
+        // Arithmetic average over daily fixings
+        const int fixings = 252;
+        const long paths = std::max(2000L, config.mc_paths / 100);
+        timer.start();
+        const MCResult cv = mc_gbm_asian_price(config.S0, config.K, config.r, config.T, config.sigma,
+                                               paths, fixings, OptionType::Call);
+        const double cv_ms = timer.elapsed_ms();
+        timer.start();
+        const MCResult plain = mc_gbm_asian_price(config.S0, config.K, config.r, config.T, config.sigma,
+                                                  paths, fixings, OptionType::Call, 12345, true, false);
+        const double plain_ms = timer.elapsed_ms();
+        const double vrf = (plain.std_error * plain.std_error) / std::max(cv.std_error * cv.std_error, 1e-300);
+
+        std::cout << "Arithmetic Asian call, " << fixings << " fixings, " << format_number(paths) << " paths\n";
+        std::cout << std::setprecision(6);
+        std::cout << "  Levy Approximation:     "
+                  << asian_arithmetic_approx(config.S0, config.K, config.r, config.T, config.sigma,
+                                             OptionType::Call, fixings) << "\n";
+        std::cout << "  MC + Geometric CV:      " << cv.price << " ± " << cv.std_error
+                  << " (" << std::setprecision(1) << cv_ms << " ms)\n";
+        std::cout << std::setprecision(6);
+        std::cout << "  MC Plain:               " << plain.price << " ± " << plain.std_error
+                  << " (" << std::setprecision(1) << plain_ms << " ms)\n";
+        std::cout << "  Variance Reduction:     " << vrf << "x\n";
+        std::cout << "  Plain MC at CV's SE:    " << plain_ms * vrf << " ms (est.)\n";
+        std::cout << std::string(70, '-') << "\n";
+    }
+
+    /**
+     * @brief LSM lower bound and Andersen-Broadie upper bound for an American put
+     */
+    void run_lsm_dual_benchmark(const DemoConfig& config) {
+        Timer timer;
+
+        print_header("LSM Duality Gap (American Put)");
+
+        const double reference = pde_crank_nicolson_american(config.S0, config.K, config.r, config.T, config.sigma,
+                                                             800, 800, OptionType::Put);
+        LSMParams p;
+        p.steps = 50;
+        p.paths = std::max(20000L, config.mc_paths / 10);
+
+        // Uniform nested work versus a schedule that halves it on the first half of the dates
+        LSMDualParams uniform;
+        uniform.outer_paths = 250;
+        uniform.inner_paths = 200;
+        LSMDualParams tapered = uniform;
+        tapered.inner_schedule.assign(p.steps / 2, uniform.inner_paths / 2);
+
+        std::cout << "American PDE Reference:   " << std::fixed << std::setprecision(4) << reference << "\n";
+        const std::pair<const char*, const LSMDualParams*> runs[] = {{"Uniform inner paths", &uniform},
+                                                                    {"Tapered schedule", &tapered}};
+        for (const auto& run : runs) {
+            timer.start();
+            const LSMBounds b = lsm_american_put_bounds(config.S0, config.K, config.r, config.T, config.sigma, p, *run.second);
+            const double ms = timer.elapsed_ms();
+            const auto ci = b.interval();
+            std::cout << run.first << "\n";
+            std::cout << std::setprecision(4);
+            std::cout << "  Lower Bound:            " << b.lower << " ± " << b.lower_se << "\n";
+            std::cout << "  Upper Bound:            " << b.upper << " ± " << b.upper_se << "\n";
+            std::cout << "  Duality Gap:            " << b.gap() << "\n";
+            std::cout << "  95% Interval:           [" << ci.first << ", " << ci.second << "]\n";
+            std::cout << "  Nested Path-Steps:      " << format_number(b.nested_steps) << "\n";
+            std::cout << std::setprecision(1);
+            std::cout << "  Time:                   " << ms << " ms\n";
+        }
+        std::cout << std::string(70, '-') << "\n";
+    }
+
+    /**
+     * @brief LSM standard error with antithetics, European control variate and scrambled QMC
+     */
+    void run_lsm_vr_benchmark(const DemoConfig& config) {
+        Timer timer;
+
+        print_header("LSM Variance Reduction (American Put)");
+
+        LSMParams base;
+        base.steps = 50;
+        base.paths = std::max(20000L, config.mc_paths / 10);
+
+        LSMParams anti = base;
+        anti.antithetic = true;
+        LSMParams cv = anti;
+        cv.control_variate = true;
+        LSMParams qmc = cv;
+        qmc.use_qmc = true;
+
+        const std::pair<const char*, const LSMParams*> runs[] = {
+            {"Plain", &base}, {"Antithetic", &anti}, {"Antithetic + European CV", &cv}, {"Scrambled QMC + CV", &qmc}};
+        double plain_var = 0.0, plain_ms = 0.0;
+        for (const auto& run : runs) {
+            timer.start();
+            const LSMResult res = lsm_american_put_estimate(config.S0, config.K, config.r, config.T, config.sigma, *run.second);
+            const double ms = timer.elapsed_ms();
+            const double var = res.std_error * res.std_error;
+            if (run.second == &base) { plain_var = var; plain_ms = ms; }
+            // Paths the plain estimator needs to match this error; efficiency also charges the extra time
+            const double vrf = plain_var / std::max(var, 1e-300);
+            std::cout << run.first << "\n";
+            std::cout << std::fixed << std::setprecision(4);
+            std::cout << "  Price:                  " << res.price << " ± " << res.std_error << "\n";
+            std::cout << std::setprecision(1);
+            std::cout << "  Variance Reduction:     " << vrf << "x\n";
+            std::cout << "  Equal-SE Plain Paths:   " << format_number(static_cast<long>(vrf * res.num_paths)) << "\n";
+            std::cout << "  Efficiency Gain:        " << vrf * plain_ms / std::max(ms, 1e-9) << "x\n";
+            std::cout << "  Time:                   " << ms << " ms\n";
+        }
+        std::cout << std::string(70, '-') << "\n";
+    }
+
+    /**
+     * @brief Single-run pathwise LSM Greeks versus bump-and-revalue
+     */
+    void run_lsm_greeks_benchmark(const DemoConfig& config) {
+        Timer timer;
+
+        print_header("LSM American Greeks");
+
+        LSMParams p;
+        p.steps = 50;
+        p.paths = std::max(20000L, config.mc_paths / 10);
+        p.poly_degree = 3;
+        p.antithetic = true;
+
+        timer.start();
+        const MCResult g = lsm_american_put_greeks(config.S0, config.K, config.r, config.T, config.sigma, p);
+        const double pathwise_ms = timer.elapsed_ms();
+
+        // Central bumps, each revaluation refitting the regression on its own seed
+        const double h = 0.01 * config.S0;
+        timer.start();
+        LSMParams up = p, down = p;
+        up.seed = p.seed + 1;
+        down.seed = p.seed + 2;
+        const LSMResult pu = lsm_american_put_estimate(config.S0 + h, config.K, config.r, config.T, config.sigma, up);
+        const LSMResult pd = lsm_american_put_estimate(config.S0 - h, config.K, config.r, config.T, config.sigma, down);
+        const double bump_ms = timer.elapsed_ms();
+        const double bump_delta = (pu.price - pd.price) / (2.0 * h);
+        const double bump_se = std::sqrt(pu.std_error * pu.std_error + pd.std_error * pd.std_error) / (2.0 * h);
+
+        std::cout << std::fixed << std::setprecision(4);
+        std::cout << "Pathwise (one run)\n";
+        std::cout << "  Price:                  " << g.price << " ± " << g.std_error << "\n";
+        std::cout << "  Delta:                  " << g.delta << " ± " << g.delta_se << "\n";
+        std::cout << "  Gamma:                  " << g.gamma << " ± " << g.gamma_se << "\n";
+        std::cout << "  Vega:                   " << g.vega << " ± " << g.vega_se << "\n";
+        std::cout << std::setprecision(1);
+        std::cout << "  Time:                   " << pathwise_ms << " ms\n";
+        std::cout << std::setprecision(4);
+        std::cout << "Bump and revalue (independent seeds)\n";
+        std::cout << "  Delta:                  " << bump_delta << " ± " << bump_se << "\n";
+        std::cout << std::setprecision(1);
+        std::cout << "  Time:                   " << bump_ms << " ms\n";
+        std::cout << "  Delta Error Ratio:      " << bump_se / std::max(g.delta_se, 1e-300) << "x\n";
+        std::cout << std::string(70, '-') << "\n";
+    }
+
+    /**
+     * @brief Accuracy and throughput of float versus double path state per MC engine
+     */
+    void run_precision_benchmark(const DemoConfig& config) {
+        Timer timer;
+
+        print_header("Float vs Double Path Precision");
+
+        const HestonParams heston{1.5, 0.04, 0.5, -0.7, 0.04};
+        const LocalVolFn lv = SmileLocalVol{0.22, 0.95, 0.25, 0.15, config.S0, 0.01}.to_fn();
+        LSMParams lsm;
+        lsm.paths = std::max(20000L, config.mc_paths / 5);
+
+        // Each engine runs the same random stream in both precisions, so the price
+        // difference is pure rounding; it is reported in units of the standard error
+        struct Run { double price, std_error, ms; };
+        auto run_engine = [&](Precision precision, int engine) {
+            timer.start();
+            double price = 0.0, se = 0.0;
+            if (engine == 0) {
+                const MCResult r = mc_gbm_asian_price(config.S0, config.K, config.r, config.T, config.sigma,
+                                                      config.mc_paths, 252, config.type, 12345, true, true, precision);
+                price = r.price; se = r.std_error;
+            } else if (engine == 1) {
+                const MCResult r = mc_slv_price(config.S0, config.K, config.r, config.T, config.mc_paths / 50, 100,
+                                                config.type, heston, lv, 987654321UL, true, true, precision);
+                price = r.price; se = r.std_error;
+            } else {
+                LSMParams p = lsm;
+                p.precision = precision;
+                const LSMResult r = lsm_american_put_estimate(config.S0, config.K, config.r, config.T, config.sigma, p);
+                price = r.price; se = r.std_error;
+            }
+            return Run{price, se, timer.elapsed_ms()};
+        };
+
+        const char* names[] = {"GBM Asian (252 fixings)", "SLV European (100 steps)", "LSM American put (50 steps)"};
+        std::cout << std::left << std::setw(30) << "Engine" << std::right << std::setw(12) << "Double"
+                  << std::setw(12) << "Float" << std::setw(12) << "|Diff|/SE" << std::setw(12) << "Speedup" << "\n";
+        for (int engine = 0; engine < 3; ++engine) {
+            const Run d = run_engine(Precision::Double, engine);
+            const Run f = run_engine(Precision::Float, engine);
+            std::cout << std::left << std::setw(30) << names[engine] << std::right << std::fixed
+                      << std::setprecision(5) << std::setw(12) << d.price << std::setw(12) << f.price
+                      << std::setprecision(4) << std::setw(12) << std::abs(f.price - d.price) / std::max(d.std_error, 1e-300)
+                      << std::setprecision(2) << std::setw(11) << d.ms / std::max(f.ms, 1e-9) << "x\n";
+        }
+        const double path_mb = static_cast<double>(lsm.steps + 1) * lsm.paths / (1024.0 * 1024.0);
+        std::cout << std::setprecision(1);
+        std::cout << "LSM path store:                " << 8.0 * path_mb << " MB double, "
+                  << 4.0 * path_mb << " MB float\n";
+        std::cout << "Payoff moments and regressions accumulate in double in both modes; normal\n"
+                  << "generation is shared, so speedups are bounded by its share of the run time.\n";
+        std::cout << std::string(70, '-') << "\n";
+    }
+
+    /**
+     * @brief LSM with the path store spilled to a memory-mapped file under a RAM budget
+     */
+    void run_lsm_spill_benchmark(const DemoConfig& config) {
+        Timer timer;
+
+        print_header("Out-of-Core LSM (Memory-Mapped Spill)");
+
+        LSMParams p;
+        p.steps = 100;
+        p.paths = std::max(200000L, config.mc_paths);
+        p.antithetic = true;
+        p.control_variate = true;
+
+        timer.start();
+        const LSMResult in_memory = lsm_american_put_estimate(config.S0, config.K, config.r, config.T, config.sigma, p);
+        const double memory_ms = timer.elapsed_ms();
+
+        p.memory_budget = 32u << 20;
+        timer.start();
+        const LSMResult spilled = lsm_american_put_estimate(config.S0, config.K, config.r, config.T, config.sigma, p);
+        const double spill_ms = timer.elapsed_ms();
+        const LSMSpillStats& io = spilled.spill;
+
+        const double mb = 1024.0 * 1024.0;
+        std::cout << std::fixed << std::setprecision(1);
+        std::cout << "Paths x Dates:            " << format_number(p.paths) << " x " << p.steps << "\n";
+        std::cout << "Path Store:               " << io.store_bytes / mb << " MB\n";
+        std::cout << "Memory Budget:            " << p.memory_budget / mb << " MB\n";
+        std::cout << "Peak Resident Slices:     " << io.peak_resident_bytes / mb << " MB\n";
+        std::cout << "Spill Write:              " << io.bytes_written / mb << " MB at "
+                  << io.write_bandwidth() / mb << " MB/s\n";
+        std::cout << "Spill Read:               " << io.bytes_read / mb << " MB at "
+                  << io.read_bandwidth() / mb << " MB/s\n";
+        std::cout << "In-Memory Time:           " << memory_ms << " ms\n";
+        std::cout << "Spilled Time:             " << spill_ms << " ms\n";
+        std::cout << std::setprecision(6);
+        std::cout << "Price (memory / spill):   " << in_memory.price << " / " << spilled.price << "\n";
+        std::cout << std::string(70, '-') << "\n";
+    }
+
+    void run_path_store_benchmark(const DemoConfig& config) {
+        Timer timer;
+
+        print_header("LSM Path Store Encodings");
+
+        struct Mode { const char* name; Precision precision; bool quantize; };
+        const Mode modes[] = {
+            {"Float64", Precision::Double, false},
+            {"Float32", Precision::Float, false},
+            {"LogReturn16", Precision::Double, true},
+        };
+
+        LSMParams p;
+        p.steps = 50;
+        p.paths = std::max(200000L, config.mc_paths);
+        std::cout << "Paths x Dates: " << format_number(p.paths) << " x " << p.steps << "\n";
+        std::cout << std::left << std::setw(14) << "Encoding" << std::right
+                  << std::setw(12) << "Store MB" << std::setw(12) << "Time ms"
+                  << std::setw(12) << "Price" << std::setw(12) << "Diff" << std::setw(12) << "Std Err" << "\n";
+
+        double reference = 0.0;
+        for (const Mode& mode : modes) {
+            p.precision = mode.precision;
+            p.quantize_paths = mode.quantize;
+            timer.start();
+            const LSMResult res = lsm_american_put_estimate(config.S0, config.K, config.r, config.T, config.sigma, p);
+            const double ms = timer.elapsed_ms();
+            if (&mode == modes) reference = res.price;
+            std::cout << std::left << std::setw(14) << mode.name << std::right << std::fixed
+                      << std::setprecision(1) << std::setw(12) << res.spill.store_bytes / (1024.0 * 1024.0)
+                      << std::setw(12) << ms << std::setprecision(6) << std::setw(12) << res.price
+                      << std::setw(12) << res.price - reference << std::setw(12) << res.std_error << "\n";
+        }
+        std::cout << std::string(70, '-') << "\n";
+    }
+
+    void run_arbitrage_benchmark(const DemoConfig& /*config*/) {
+        print_header("Option Chain Arbitrage Scan");
+
+        std::vector<UnderlyingMarket> markets;
+        std::vector<OptionQuote> chain = generate_sample_option_chain(1250, 50, 42, &markets);
+
+        // A handful of stale quotes: every tenth underlying has its ATM near call bid lifted
+        const std::size_t per_underlying = chain.size() / markets.size();
+        for (std::size_t u = 0; u < markets.size(); u += 10) {
+            OptionQuote& q = chain[u * per_underlying + 24 * 2];
+            const double lift = 0.25 * q.ask;
+            q.bid += lift;
+            q.ask += lift;
+        }
+
+        const ArbitrageScanResult res = scan_option_chain(chain, markets);
+        std::size_t counts[7] = {0, 0, 0, 0, 0, 0, 0};
+        double largest[7] = {0, 0, 0, 0, 0, 0, 0};
+        for (const auto& v : res.violations) {
+            const int c = static_cast<int>(v.check);
+            ++counts[c];
+            largest[c] = std::max(largest[c], v.size);
+        }
+
+        std::cout << "Quotes:                   " << format_number(static_cast<long>(chain.size())) << "\n";
+        std::cout << "Underlyings x Expiries:   " << res.num_underlyings << " x "
+                  << res.num_slices / std::max<std::size_t>(1, res.num_underlyings) << "\n";
+        std::cout << std::fixed << std::setprecision(1);
+        std::cout << "Scan Time:                " << res.elapsed_ms << " ms ("
+                  << chain.size() / (res.elapsed_ms * 1e3) << " M quotes/s)\n";
+        std::cout << "Violations:               " << res.violations.size() << "\n";
+        std::cout << std::setprecision(4);
+        for (int c = 0; c < 7; ++c) {
+            if (counts[c] == 0) continue;
+            std::cout << "  " << std::left << std::setw(24) << arbitrage_check_name(static_cast<ArbitrageCheck>(c))
+                      << std::right << std::setw(6) << counts[c] << "  largest " << largest[c] << "\n";
+        }
+        std::cout << std::string(70, '-') << "\n";
+    }
+
+    void run_implied_forward_benchmark(const DemoConfig& /*config*/) {
+        Timer timer;
+
+        print_header("Implied Forwards and Batch Implied Vols");
+
+        std::vector<UnderlyingMarket> markets;
+        const std::vector<OptionQuote> chain = generate_sample_option_chain(250, 50, 42, &markets);
+
+        timer.start();
+        const std::vector<ImpliedForward> forwards = implied_forwards(chain);
+        const double fit_ms = timer.elapsed_ms();
+        timer.start();
+        const std::vector<double> vols = implied_vols_from_forwards(chain, forwards);
+        const double batch_ms = timer.elapsed_ms();
+
+        // Reference: the scalar solver on spot and rate, one quote at a time
+        const std::size_t per_underlying = chain.size() / markets.size();
+        std::vector<double> scalar(chain.size());
+        timer.start();
+        for (std::size_t i = 0; i < chain.size(); ++i) {
+            const OptionQuote& q = chain[i];
+            const UnderlyingMarket& m = markets[i / per_underlying];
+            scalar[i] = implied_vol(q.mid(), [&](double v) {
+                return black_scholes_price(m.spot, q.strike, m.r, q.T, v, q.type);
+            });
+        }
+        const double scalar_ms = timer.elapsed_ms();
+
+        double worst_fwd = 0.0, worst_rate = 0.0;
+        for (const ImpliedForward& f : forwards) {
+            const UnderlyingMarket& m = markets[std::stoul(f.underlying.substr(3))];
+            worst_fwd = std::max(worst_fwd, std::abs(f.forward / (m.spot * std::exp(m.r * f.T)) - 1.0));
+            worst_rate = std::max(worst_rate, std::abs(f.rate() - m.r));
+        }
+        std::size_t solved = 0;
+        for (double v : vols) solved += std::isfinite(v) ? 1 : 0;
+
+        std::cout << "Quotes / Expiries:        " << format_number(static_cast<long>(chain.size())) << " / "
+                  << forwards.size() << "\n";
+        std::cout << std::fixed << std::setprecision(1);
+        std::cout << "Parity Fits:              " << fit_ms << " ms\n";
+        std::cout << "Batch Implied Vols:       " << batch_ms << " ms (" << solved << " solved)\n";
+        std::cout << "Scalar implied_vol:       " << scalar_ms << " ms\n";
+        std::cout << std::scientific << std::setprecision(2);
+        std::cout << "Max Forward Error:        " << worst_fwd << " (relative)\n";
+        std::cout << "Max Rate Error:           " << worst_rate << "\n";
+        std::cout << std::fixed << std::string(70, '-') << "\n";
+    }
+
+    /**
+     * @brief Benchmark SVI surface fitting and variance swap replication
+     */
+    void run_variance_swap_benchmark(const DemoConfig& /*config*/) {
+        Timer timer;
+
+        print_header("SVI Surface and Variance Swap Replication");
+
+        const std::vector<OptionQuote> chain = generate_sample_option_chain(250, 50, 42);
+
+        timer.start();
+        const std::vector<ImpliedForward> forwards = implied_forwards(chain);
+        const double fwd_ms = timer.elapsed_ms();
+        timer.start();
+        const std::vector<SVISlice> slices = fit_svi_surface(chain, forwards);
+        const double svi_ms = timer.elapsed_ms();
+        timer.start();
+        const std::vector<VarianceSwapQuote> term = variance_term_structure(chain, forwards, slices);
+        const double var_ms = timer.elapsed_ms();
+
+        double worst_fit = 0.0;
+        std::size_t fitted = 0;
+        for (const SVISlice& s : slices) {
+            if (!s.valid) continue;
+            ++fitted;
+            worst_fit = std::max(worst_fit, s.rms_vol_error);
+        }
+
+        std::cout << "Quotes / Expiries:        " << format_number(static_cast<long>(chain.size())) << " / "
+                  << forwards.size() << "\n";
+        std::cout << std::fixed << std::setprecision(1);
+        std::cout << "Parity Fits:              " << fwd_ms << " ms\n";
+        std::cout << "SVI Fits:                 " << svi_ms << " ms (" << fitted << " slices)\n";
+        std::cout << "Variance Replication:     " << var_ms << " ms\n";
+        std::cout << std::scientific << std::setprecision(2);
+        std::cout << "Max RMS Vol Error:        " << worst_fit << "\n";
+
+        std::cout << "\n" << term.front().underlying << " term structure (vol points):\n";
+        std::cout << std::setw(10) << "Days" << std::setw(12) << "SVI" << std::setw(12) << "Strip"
+                  << std::setw(10) << "Strikes" << std::setw(12) << "GK Error" << "\n";
+        for (const VarianceSwapQuote& v : term) {
+            if (v.underlying != term.front().underlying) break;
+            std::cout << std::fixed << std::setprecision(0) << std::setw(10) << v.T * 365.0
+                      << std::setprecision(2) << std::setw(12) << v.vol_strike()
+                      << std::setw(12) << 100.0 * std::sqrt(v.discrete_variance) << std::setw(10) << v.strikes_used
+                      << std::scientific << std::setw(12) << v.integration_error << "\n";
+        }
+        std::cout << std::fixed << std::setprecision(2);
+        std::cout << "30-day index (strip/SVI): " << vix_style_index(term, term.front().underlying) << " / "
+                  << vix_style_index(term, term.front().underlying, 30.0 / 365.0, false) << "\n";
+
+        // Local vol of the first underlying on a 100 x 200 grid, as rerun on every surface update
+        std::vector<SVISlice> first;
+        for (const SVISlice& s : slices)
+            if (s.underlying == term.front().underlying) first.push_back(s);
+        const double F = first.front().forward;
+        DupireSurface local;
+        for (int i = 1; i <= 100; ++i) local.t.push_back(0.02 * i);
+        for (int j = 0; j < 200; ++j) local.S.push_back(F * (0.5 + 1.5 * j / 199.0));
+        extract_dupire_surface(first, local);
+        constexpr int kReruns = 20;
+        DupireExtractionStats dupire;
+        double dupire_ms = 0.0;
+        for (int k = 0; k < kReruns; ++k) {
+            dupire = extract_dupire_surface(first, local);
+            dupire_ms += dupire.elapsed_ms;
+        }
+        std::cout << std::setprecision(3) << "Dupire Extraction:        " << dupire_ms / kReruns << " ms ("
+                  << format_number(static_cast<long>(dupire.points)) << " points, " << dupire.regularised
+                  << " regularised)\n";
+        std::cout << std::string(70, '-') << "\n";
+    }
+
+    void run_isa_benchmark(const DemoConfig& /*config*/) {
+        Timer timer;
+
+        print_header("Kernel Instruction-Set Variants");
+
+        const std::size_t n = 1 << 20;
+        std::mt19937_64 rng(42);
+        std::uniform_real_distribution<double> u(0.0, 1.0);
+        std::vector<double> S(n), K(n), T(n), sigma(n), price(n), out(n), z(n), one_year(n, 1.0);
+        std::vector<OptionType> types(n);
+        for (std::size_t i = 0; i < n; ++i) {
+            S[i] = 100.0;
+            K[i] = 60.0 + 80.0 * u(rng);
+            T[i] = 0.05 + 2.0 * u(rng);
+            sigma[i] = 0.1 + 0.4 * u(rng);
+            types[i] = i % 2 ? OptionType::Call : OptionType::Put;
+        }
+        black_scholes_price_batch(n, S.data(), K.data(), 0.0, one_year.data(), sigma.data(), types.data(), price.data());
+        fill_standard_normals(7, 0, n, z.data());
+
+        // ADI-sized tridiagonal batch: 200 rows of 512 interleaved lines
+        const int rows = 200, lines = 512;
+        std::vector<double> a(rows * lines, -1.0), b(rows * lines, 4.0), c(rows * lines, -1.0), d(rows * lines);
+        std::vector<double> rhs(rows * lines, 1.0), scratch(rows * lines);
+        std::vector<double> grid(400), row0(400), row1(400);
+        for (std::size_t j = 0; j < grid.size(); ++j) {
+            grid[j] = 20.0 + 0.5 * j;
+            row0[j] = 0.2 + 1e-4 * j;
+            row1[j] = 0.25 - 1e-4 * j;
+        }
+
+        const char* labels[kNumKernels] = {"Black-Scholes", "Implied vol", "Normal fill", "Payoff reduction",
+                                           "Tridiagonal", "Surface interp"};
+        std::cout << "Detected: " << isa_name(detected_isa()) << "; active: "
+                  << isa_name(kernel_isa(Kernel::BlackScholes)) << "\n\n";
+        std::cout << std::setw(18) << "Kernel";
+        const std::vector<KernelISA> isas = supported_isas();
+        for (KernelISA isa : isas) std::cout << std::setw(12) << isa_name(isa);
+        std::cout << "   (M elements/s, speed-up vs generic)\n";
+
+        std::vector<std::vector<double>> rate(kNumKernels);
+        for (KernelISA isa : isas) {
+            const KernelTable& k = kernel_variant(isa);
+            double sum = 0.0, sum_sq = 0.0;
+            auto measure = [&](int kernel, std::size_t elements, auto&& body) {
+                body();     // warm-up
+                timer.start();
+                body();
+                rate[kernel].push_back(elements / (1e3 * std::max(timer.elapsed_ms(), 1e-3)));
+            };
+            measure(0, n, [&] { k.black_scholes(n, S.data(), K.data(), 0.0, T.data(), sigma.data(), types.data(), out.data()); });
+            measure(1, n / 8, [&] {
+                k.implied_vol(100.0, 1.0, 1.0, n / 8, K.data(), price.data(), types.data(), out.data(), 1e-12, 100);
+            });
+            measure(2, n, [&] { k.normal_fill(7, 0, n, out.data()); });
+            measure(3, n, [&] { k.payoff_moments(n, z.data(), 100.0, -0.02, 0.2, 100.0, OptionType::Call, true, &sum, &sum_sq); });
+            measure(4, static_cast<std::size_t>(rows) * lines, [&] {
+                d = rhs;
+                k.tridiagonal(rows, lines, a.data(), b.data(), c.data(), d.data(), scratch.data(), lines);
+            });
+            measure(5, n, [&] { k.interp_rows(grid.size(), grid.data(), row0.data(), row1.data(), 0.3, n, K.data(), out.data()); });
+        }
+        std::cout << std::fixed;
+        for (int kernel = 0; kernel < kNumKernels; ++kernel) {
+            std::cout << std::setw(18) << labels[kernel];
+            for (double r : rate[kernel])
+                std::cout << std::setw(6) << std::setprecision(0) << r << " " << std::setprecision(1) << std::setw(4)
+                          << r / rate[kernel].front() << "x";
+            std::cout << "\n";
+        }
+        std::cout << std::string(70, '-') << "\n";
+    }
+
+    /**
+     * @brief Sweep the engine knobs on this machine and store them in the tuning profile
+     */
+    void run_tune(const std::string& profile, bool quick) {
+        Timer timer;
+
+        print_header("Engine Tuning");
+
+        const std::string fingerprint = hardware_fingerprint();
+        const EngineTuning before = engine_tuning();
+        std::cout << "Machine: " << fingerprint << "\n";
+        std::cout << "Profile: " << profile << "\n\n";
+        std::cout << std::fixed << std::setprecision(2);
+
+        timer.start();
+        TuneOptions options;
+        options.quick = quick;
+        const EngineTuning tuned = tune_engines(options, &std::cout);
+        const double elapsed = timer.elapsed_ms();
+
+        save_tuning_profile(profile, fingerprint, tuned);
+
+        std::cout << "\n" << std::setw(22) << "Setting" << std::setw(10) << "Before" << std::setw(10) << "Tuned" << "\n";
+        const std::pair<const char*, int EngineTuning::*> rows[] = {
+            {"threads", &EngineTuning::threads},
+            {"heston_line_block", &EngineTuning::heston_line_block},
+            {"heston_column_chunk", &EngineTuning::heston_column_chunk},
+            {"basket_line_block", &EngineTuning::basket_line_block},
+            {"basket_column_chunk", &EngineTuning::basket_column_chunk},
+            {"batch_chunk", &EngineTuning::batch_chunk},
+        };
+        for (const auto& row : rows)
+            std::cout << std::setw(22) << row.first << std::setw(10) << before.*row.second
+                      << std::setw(10) << tuned.*row.second << "\n";
+        std::cout << "\nTuned in " << std::setprecision(1) << elapsed / 1000.0 << " s; saved to " << profile << "\n";
+        std::cout << std::string(70, '-') << "\n";
+    }
+
+    /**
+     * @brief Run the accuracy harness; optionally save it or compare it with a reference build
+     *
+     * With a reference, engines listed in fast_math_units (the units this
+     * build compiled with fast math) must stay within max_delta of it.
+     * @return Process exit code: 1 if an engine fails its check or a fast-math unit drifts
+     */
+    int run_accuracy_report(const std::string& save_path, const std::string& reference_path,
+                            const std::string& fast_math_units, double max_delta) {
+        print_header("Engine Accuracy Harness");
+
+        AccuracyHarnessConfig harness;
+        harness.repeats = 5;
+        const std::vector<EngineAccuracy> results = run_accuracy_harness(harness);
+
+        std::istringstream unit_list(fast_math_units);
+        const std::vector<std::string> fast_units{std::istream_iterator<std::string>(unit_list),
+                                                  std::istream_iterator<std::string>()};
+        auto is_fast = [&](const std::string& engine) {
+            return std::find(fast_units.begin(), fast_units.end(), engine) != fast_units.end();
+        };
+
+        int status = 0;
+        std::cout << std::scientific << std::setprecision(2);
+        if (reference_path.empty()) {
+            std::cout << std::setw(18) << "Engine" << std::setw(11) << "Time ms" << std::setw(11) << "Error"
+                      << std::setw(11) << "Tolerance" << "  Check\n";
+            for (const auto& e : results) {
+                std::cout << std::setw(18) << e.engine << std::fixed << std::setprecision(2) << std::setw(11)
+                          << e.elapsed_ms << std::scientific << std::setw(11) << e.error << std::setw(11)
+                          << e.tolerance << "  " << (e.passed() ? "" : "FAILED: ") << e.check << "\n";
+                if (!e.passed()) status = 1;
+            }
+        } else {
+            const std::vector<EngineAccuracyDelta> deltas =
+                compare_accuracy_results(load_accuracy_results(reference_path), results);
+            std::cout << "Reference: " << reference_path << "\n";
+            std::cout << "Fast-math units: " << (fast_units.empty() ? "none" : fast_math_units) << "\n\n";
+            std::cout << std::setw(18) << "Engine" << std::setw(10) << "Speedup" << std::setw(12) << "Max delta"
+                      << "  Verdict\n";
+            for (const auto& d : deltas) {
+                const bool fast = is_fast(d.engine);
+                const bool ok = d.passed && (!fast || d.max_rel_delta <= max_delta);
+                std::cout << std::setw(18) << d.engine << std::fixed << std::setprecision(2) << std::setw(9)
+                          << d.speedup << "x" << std::scientific << std::setw(12) << d.max_rel_delta << "  "
+                          << (ok ? "ok" : "FAILED") << (fast ? " (fast math)" : "") << "\n";
+                if (!ok) status = 1;
+            }
+            std::cout << "\nLimit for fast-math units: " << max_delta << " relative\n";
+        }
+        std::cout << std::defaultfloat;
+
+        if (!save_path.empty()) {
+            save_accuracy_results(save_path, results);
+            std::cout << "Results saved to " << save_path << "\n";
+        }
+        std::cout << std::string(70, '-') << "\n";
+        return status;
+    }
+
+    /**
+     * @brief Training workload for profile-guided optimisation
+     *
+     * Replays the accuracy harness at a larger scale, so every engine and its
+     * batch entry points are profiled, then prices synthetic books with each
+     * portfolio model as the CLI portfolio command does.
+     */
+    void run_pgo_training() {
+        Timer timer;
+        print_header("PGO Training Workload");
+
+        timer.start();
+        AccuracyHarnessConfig harness;
+        harness.scale = 4.0;
+        const std::vector<EngineAccuracy> results = run_accuracy_harness(harness);
+        std::cout << "Engines: " << results.size() << " in " << std::fixed << std::setprecision(1)
+                  << timer.elapsed_ms() << " ms\n";
+
+        const std::pair<const char*, PricingModel> models[] = {
+            {"analytic", PricingModel::Analytic}, {"pde", PricingModel::PDE}, {"mc", PricingModel::MonteCarlo}};
+        PortfolioPricingConfig book_config;
+        book_config.mc_paths = 20000;
+        book_config.pde_S_steps = 200;   // coarse grids: the profile needs the paths, not the accuracy
+        book_config.pde_T_steps = 100;
+        for (const auto& model : models) {
+            timer.start();
+            const auto book = generate_sample_portfolio(20000, 42, model.second);
+            const PortfolioValuation valuation = price_portfolio(book, book_config);
+            std::cout << "Portfolio (" << model.first << "): " << format_number(static_cast<long>(book.size()))
+                      << " positions, " << valuation.num_groups << " groups in " << timer.elapsed_ms() << " ms\n";
+        }
+        std::cout << std::string(70, '-') << "\n";
+    }
+
+    /**
+     * @brief Price a PDE and an MC book cold, then again through a fresh
+     *        mapping of the same shared cache, as a second worker would
+     */
+    void run_shm_cache_benchmark() {
+        Timer timer;
+        print_header("Shared-Memory Pricing Cache");
+
+        const std::string name = "/bsm_cache_bench_" +
+            std::to_string(std::chrono::steady_clock::now().time_since_epoch().count());
+        PortfolioPricingConfig book_config;
+        book_config.mc_paths = 20000;
+        const std::pair<const char*, PricingModel> models[] = {{"pde", PricingModel::PDE},
+                                                              {"mc", PricingModel::MonteCarlo}};
+        std::cout << std::left << std::setw(8) << "Book" << std::right << std::setw(12) << "Cold (ms)"
+                  << std::setw(12) << "Warm (ms)" << std::setw(10) << "Speedup" << std::setw(10) << "Hits"
+                  << std::setw(12) << "Max diff\n";
+        for (const auto& model : models) {
+            const auto book = generate_sample_portfolio(5000, 42, model.second);
+
+            attach_shared_pricing_cache(name);
+            timer.start();
+            const PortfolioValuation cold = price_portfolio(book, book_config);
+            const double cold_ms = timer.elapsed_ms();
+
+            attach_shared_pricing_cache(name);   // New mapping: nothing process-local survives
+            timer.start();
+            const PortfolioValuation warm = price_portfolio(book, book_config);
+            const double warm_ms = timer.elapsed_ms();
+            const SharedCacheStats stats = shared_pricing_cache()->stats();
+
+            double max_diff = 0.0;
+            for (std::size_t i = 0; i < book.size(); ++i)
+                max_diff = std::max(max_diff, std::abs(cold.positions[i].price - warm.positions[i].price));
+            std::cout << std::left << std::setw(8) << model.first << std::right << std::fixed
+                      << std::setprecision(2) << std::setw(12) << cold_ms << std::setw(12) << warm_ms
+                      << std::setprecision(1) << std::setw(9) << cold_ms / std::max(warm_ms, 1e-6) << "x"
+                      << std::setw(10) << stats.hits << std::scientific << std::setprecision(1)
+                      << std::setw(11) << max_diff << "\n";
+        }
+        detach_shared_pricing_cache();
+        SharedPricingCache::remove(name);
+        std::cout << std::string(70, '-') << "\n";
+    }
+
+    /**
+     * @brief Latency of single-option requests while a bulk book is priced
+     *
+     * One worker, so a request can only start between jobs: FIFO queues it
+     * behind the whole book, while the sliced Batch-priority book lets an
+     * Interactive request in after the current slice.
+     */
+    void run_async_benchmark() {
+        using Clock = std::chrono::steady_clock;
+        print_header("Async Pricing: Interactive Latency Under Batch Load");
+
+        const auto book = generate_sample_portfolio(20000, 42, PricingModel::PDE);
+        PortfolioPricingConfig book_config;
+        book_config.pde_S_steps = 200;
+        book_config.pde_T_steps = 100;
+        const LocalVolFn local_vol = CEVLocalVol{}.to_fn();
+        auto request = [&local_vol] {
+            (void)mc_slv_price(100.0, 100.0, 0.05, 0.5, 2000, 50, OptionType::Call, HestonParams{}, local_vol);
+            return Clock::now();
+        };
+        constexpr int kRequests = 10;
+
+        std::cout << std::left << std::setw(26) << "Scheduling" << std::right << std::setw(14) << "Book (ms)"
+                  << std::setw(16) << "Mean req (ms)" << std::setw(15) << "Max req (ms)\n";
+        for (const bool prioritised : {false, true}) {
+            PricingExecutor executor(1);
+            const auto start = Clock::now();
+            PricingFuture<PortfolioValuation> valuation =
+                prioritised ? price_portfolio_async(executor, book, book_config)
+                            : executor.submit([&] { return price_portfolio(book, book_config); });
+
+            std::vector<Clock::time_point> submitted;
+            std::vector<PricingFuture<Clock::time_point>> done;
+            for (int i = 0; i < kRequests; ++i) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(20));
+                submitted.push_back(Clock::now());
+                done.push_back(executor.submit(request, {prioritised ? JobPriority::Interactive : JobPriority::Normal, {}}));
+            }
+            valuation.wait();
+            const double book_ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+            double sum = 0.0, worst = 0.0;
+            for (int i = 0; i < kRequests; ++i) {
+                const double ms = std::chrono::duration<double, std::milli>(done[i].get() - submitted[i]).count();
+                sum += ms;
+                worst = std::max(worst, ms);
+            }
+            std::cout << std::left << std::setw(26) << (prioritised ? "Priorities, 2048-pos slices" : "FIFO, whole book")
+                      << std::right << std::fixed << std::setprecision(1) << std::setw(14) << book_ms
+                      << std::setw(16) << sum / kRequests << std::setw(14) << worst << "\n";
+        }
+        std::cout << std::string(70, '-') << "\n";
+    }
+
+    /**
+     * @brief Intraday update cost of a risk graph against full repricing
+     */
+    void run_risk_graph_benchmark() {
+        Timer timer;
+        print_header("Risk Graph: Incremental Revaluation");
+
+        const auto book = generate_sample_portfolio(20000, 42, PricingModel::PDE);
+        PortfolioPricingConfig config;
+        config.pde_S_steps = 200;
+        config.pde_T_steps = 100;
+
+        timer.start();
+        const PortfolioValuation full = price_portfolio(book, config);
+        const double full_ms = timer.elapsed_ms();
+        timer.start();
+        PortfolioRiskGraph risk(book, config);
+        const double build_ms = timer.elapsed_ms();
+        std::cout << format_number(static_cast<long>(book.size())) << " PDE positions, " << full.num_groups
+                  << " groups, " << risk.graph().size() << " graph nodes\n";
+        std::cout << std::fixed << std::setprecision(1) << "Full reprice: " << full_ms << " ms, graph build: "
+                  << build_ms << " ms\n\n";
+
+        std::cout << std::left << std::setw(30) << "Update" << std::right << std::setw(12) << "Nodes"
+                  << std::setw(12) << "Time (ms)" << std::setw(14) << "vs full\n";
+        auto report = [&](const std::string& label, const RiskRecalcStats& stats) {
+            std::cout << std::left << std::setw(30) << label << std::right << std::setw(12) << stats.recomputed
+                      << std::setw(12) << std::setprecision(2) << stats.elapsed_ms << std::setw(12)
+                      << std::setprecision(1) << 100.0 * stats.elapsed_ms / full_ms << " %\n";
+        };
+
+        const PositionSpec& first = book.front();
+        risk.set_spot(first.underlying, first.spot * 1.001);
+        report("spot of " + first.underlying, risk.recalculate());
+        risk.set_vol(first.underlying, first.T, first.sigma + 0.005);
+        report("one vol node of " + first.underlying, risk.recalculate());
+        for (std::size_t u = 0; u < 5; ++u) {
+            const std::string& name = risk.underlyings()[u];
+            for (const auto& p : book)
+                if (p.underlying == name) {
+                    risk.set_spot(name, p.spot * 0.999);
+                    break;
+                }
+        }
+        report("spots of 5 underlyings", risk.recalculate());
+        risk.set_rate(config.r + 0.0025);
+        report("rate (whole book)", risk.recalculate());
+        std::cout << std::string(70, '-') << "\n";
+    }
+
+    void run_pnl_explain_benchmark() {
+        Timer timer;
+        print_header("P&L Explain: Cached Taylor Coefficients");
+
+        // Mostly closed-form positions with a PDE sleeve
+        auto book = generate_sample_portfolio(100000, 42, PricingModel::Analytic);
+        const auto sleeve = generate_sample_portfolio(2000, 42, PricingModel::PDE);
+        book.insert(book.end(), sleeve.begin(), sleeve.end());
+        PortfolioPricingConfig config;
+        config.pde_S_steps = 200;
+        config.pde_T_steps = 100;
+
+        timer.start();
+        const PortfolioValuation base = price_portfolio(book, config);
+        const double full_ms = timer.elapsed_ms();
+        PnlExplainer explainer(book, config);
+        std::cout << format_number(static_cast<long>(book.size())) << " positions (" << sleeve.size()
+                  << " PDE)\n";
+        std::cout << std::fixed << std::setprecision(1) << "Full reprice: " << full_ms
+                  << " ms, coefficients: " << explainer.setup_ms() << " ms\n\n";
+
+        // A mildly stressed intraday move: spots, vols, rate and one hour of decay
+        MarketMove move;
+        RNG rng(7);
+        for (const auto& name : explainer.underlyings()) {
+            move.spot[name] = 0.4 * rng.gauss();
+            move.vol[name] = 0.003 * rng.gauss();
+        }
+        move.rate = 0.0002;
+        move.dt = 1.0 / (365.0 * 24.0);
+
+        constexpr int kMoves = 20;
+        double explain_ms = 0.0;
+        for (int k = 0; k < kMoves; ++k) explain_ms += explainer.explain(move).elapsed_ms;
+        const PnlExplain e = explainer.explain(move, 1000);
+
+        std::vector<PositionSpec> moved = book;
+        for (auto& p : moved) {
+            p.spot += move.spot[p.underlying];
+            p.sigma += move.vol[p.underlying];
+            p.T = std::max(0.0, p.T - move.dt);
+        }
+        PortfolioPricingConfig moved_config = config;
+        moved_config.r += move.rate;
+        timer.start();
+        const PortfolioValuation after = price_portfolio(moved, moved_config);
+        const double reval_ms = timer.elapsed_ms();
+        double actual = 0.0;
+        for (std::size_t i = 0; i < book.size(); ++i)
+            actual += book[i].quantity * (after.positions[i].price - base.positions[i].price);
+
+        std::cout << std::setprecision(2) << "Explain per move: " << explain_ms / kMoves << " ms ("
+                  << std::setprecision(0) << full_ms / (explain_ms / kMoves) << "x faster than a reprice)\n";
+        std::cout << std::setprecision(2) << "  delta " << e.delta << ", gamma " << e.gamma << ", vega " << e.vega
+                  << ", vanna " << e.vanna << ", volga " << e.volga << ", theta " << e.theta << ", rho " << e.rho
+                  << "\n";
+        std::cout << "Explained:          " << e.explained() << "\n";
+        std::cout << "Full revaluation:   " << actual << " (" << std::setprecision(1) << reval_ms << " ms)\n";
+        std::cout << std::setprecision(2) << "Residual:           " << actual - e.explained()
+                  << " (estimated from a 1,000-position sample: " << e.residual_estimate << ")\n";
+        std::cout << std::string(70, '-') << "\n";
+    }
+
     /**
      * @brief Compare all methods and show analysis
      */
@@ -371,8 +1566,40 @@ int main(int argc, char* argv[]) {
         bool validate_accuracy = false;
         bool run_benchmark_suite = false;
         bool quick_benchmark = false;
+        bool surface_benchmark = false;
+        bool heston_pde_benchmark = false;
+        bool multi_asset_benchmark = false;
+        bool barrier_benchmark = false;
+        bool asian_benchmark = false;
+        bool lsm_dual_benchmark = false;
+        bool lsm_vr_benchmark = false;
+        bool lsm_greeks_benchmark = false;
+        bool precision_benchmark = false;
+        bool lsm_spill_benchmark = false;
+        bool path_store_benchmark = false;
+        bool arbitrage_benchmark = false;
+        bool implied_forward_benchmark = false;
+        bool variance_swap_benchmark = false;
+        bool isa_benchmark = false;
+        bool tune = false;
+        bool tune_quick = false;
+        bool accuracy_harness = false;
+        bool pgo_training = false;
+        bool shm_cache_benchmark = false;
+        bool async_benchmark = false;
+        bool risk_graph_benchmark = false;
+        bool pnl_explain_benchmark = false;
+        std::string accuracy_save;
+        std::string accuracy_reference;
+        std::string fast_math_units;
+        double fast_math_max_delta = 1e-6;
         bool show_arch_info = false;
         bool show_help = false;
+        std::string isa_override;
+        std::string tuning_profile = default_tuning_profile_path();
+
+        // Load this machine's tuning profile first, so --threads still overrides it
+        (void)engine_tuning();
         
         // Parse command line arguments
         for (int i = 1; i < argc; ++i) {
@@ -383,10 +1610,70 @@ int main(int argc, char* argv[]) {
                 run_benchmark_suite = true;
             } else if (arg == "--quick-benchmark") {
                 quick_benchmark = true;
+            } else if (arg == "--surface-benchmark") {
+                surface_benchmark = true;
+            } else if (arg == "--heston-pde-benchmark") {
+                heston_pde_benchmark = true;
+            } else if (arg == "--multi-asset-benchmark") {
+                multi_asset_benchmark = true;
+            } else if (arg == "--barrier-benchmark") {
+                barrier_benchmark = true;
+            } else if (arg == "--asian-benchmark") {
+                asian_benchmark = true;
+            } else if (arg == "--lsm-dual-benchmark") {
+                lsm_dual_benchmark = true;
+            } else if (arg == "--lsm-vr-benchmark") {
+                lsm_vr_benchmark = true;
+            } else if (arg == "--lsm-greeks-benchmark") {
+                lsm_greeks_benchmark = true;
+            } else if (arg == "--precision-benchmark") {
+                precision_benchmark = true;
+            } else if (arg == "--lsm-spill-benchmark") {
+                lsm_spill_benchmark = true;
+            } else if (arg == "--path-store-benchmark") {
+                path_store_benchmark = true;
+            } else if (arg == "--arbitrage-benchmark") {
+                arbitrage_benchmark = true;
+            } else if (arg == "--implied-forward-benchmark") {
+                implied_forward_benchmark = true;
+            } else if (arg == "--variance-swap-benchmark") {
+                variance_swap_benchmark = true;
+            } else if (arg == "--isa-benchmark") {
+                isa_benchmark = true;
+            } else if (arg == "--tune") {
+                tune = true;
+            } else if (arg == "--tune-quick") {
+                tune = tune_quick = true;
+            } else if (arg == "--tuning-profile" && i + 1 < argc) {
+                tuning_profile = argv[++i];
+            } else if (arg == "--accuracy-harness") {
+                accuracy_harness = true;
+            } else if (arg == "--accuracy-save" && i + 1 < argc) {
+                accuracy_save = argv[++i];
+            } else if (arg == "--accuracy-compare" && i + 1 < argc) {
+                accuracy_reference = argv[++i];
+            } else if (arg == "--fast-math-units" && i + 1 < argc) {
+                fast_math_units = argv[++i];
+            } else if (arg == "--max-delta" && i + 1 < argc) {
+                fast_math_max_delta = std::stod(argv[++i]);
+            } else if (arg == "--pgo-training") {
+                pgo_training = true;
+            } else if (arg == "--risk-graph-benchmark") {
+                risk_graph_benchmark = true;
+            } else if (arg == "--pnl-explain-benchmark") {
+                pnl_explain_benchmark = true;
+            } else if (arg == "--async-benchmark") {
+                async_benchmark = true;
+            } else if (arg == "--shm-cache-benchmark") {
+                shm_cache_benchmark = true;
+            } else if (arg == "--shm-cache" && i + 1 < argc) {
+                attach_shared_pricing_cache(argv[++i]);
             } else if (arg == "--arch-info") {
                 show_arch_info = true;
             } else if (arg == "--help" || arg == "-h") {
                 show_help = true;
+            } else if (arg == "--isa" && i + 1 < argc) {
+                isa_override = argv[++i];
             } else if (arg == "--paths" && i + 1 < argc) {
                 config.mc_paths = std::stol(argv[++i]);
             } else if (arg == "--threads" && i + 1 < argc) {
@@ -403,13 +1690,57 @@ int main(int argc, char* argv[]) {
             std::cout << "  --validate-accuracy    Validate numerical accuracy\n";
             std::cout << "  --benchmark-suite      Run comprehensive benchmark suite\n";
             std::cout << "  --quick-benchmark      Run quick performance benchmark\n";
+            std::cout << "  --surface-benchmark    Compare shared-path surface repricing with per-contract runs\n";
+            std::cout << "  --heston-pde-benchmark Compare the Heston/SLV ADI PDE with Monte Carlo at matched accuracy\n";
+            std::cout << "  --multi-asset-benchmark Compare the 2D/3D basket ADI PDE with Monte Carlo\n";
+            std::cout << "  --barrier-benchmark    Barrier option batch throughput and PDE/MC accuracy\n";
+            std::cout << "  --asian-benchmark      Asian closed-form throughput and control-variate MC efficiency\n";
+            std::cout << "  --lsm-dual-benchmark   LSM lower bound and dual upper bound for an American put\n";
+            std::cout << "  --lsm-vr-benchmark     LSM standard error with antithetics, control variate and QMC\n";
+            std::cout << "  --lsm-greeks-benchmark Pathwise LSM delta, gamma and vega versus bump-and-revalue\n";
+            std::cout << "  --precision-benchmark  Float vs double path precision for the GBM, SLV and LSM engines\n";
+            std::cout << "  --lsm-spill-benchmark  LSM with paths spilled to a memory-mapped file under a RAM budget\n";
+            std::cout << "  --path-store-benchmark Compare LSM path store encodings (memory, time, price)\n";
+            std::cout << "  --arbitrage-benchmark  Scan a synthetic 1M-quote snapshot for static arbitrage\n";
+            std::cout << "  --implied-forward-benchmark Fit parity-implied forwards and batch implied vols on a synthetic chain\n";
+            std::cout << "  --variance-swap-benchmark Fit SVI smiles and replicate variance swaps on a synthetic chain\n";
+            std::cout << "  --isa-benchmark        Time each dispatched kernel under every supported instruction set\n";
+            std::cout << "  --tune                 Tune engine block sizes and threads for this machine and save them\n";
+            std::cout << "  --tune-quick           Same as --tune with smaller benchmark problems\n";
+            std::cout << "  --accuracy-harness     Check every engine against its reference and time it\n";
+            std::cout << "  --pgo-training         Run the profile-guided optimisation training workload\n";
+            std::cout << "  --shm-cache-benchmark  Price books cold and then through the shared-memory cache\n";
+            std::cout << "  --async-benchmark      Latency of interactive requests while a bulk book is priced\n";
+            std::cout << "  --risk-graph-benchmark Cost of spot, vol and rate updates through the risk graph\n";
+            std::cout << "  --pnl-explain-benchmark Taylor P&L explain vs full revaluation of a 100k book\n";
             std::cout << "  --arch-info           Show architecture information\n";
+            std::cout << "  --isa <name>          Kernel instruction set: generic, sse4.2, avx2, avx512 or native\n";
+            std::cout << "  --tuning-profile <f>  Tuning profile to write (default $BSM_TUNING_PROFILE or ~/.bsm_tuning.ini)\n";
+            std::cout << "  --accuracy-save <f>   Save the harness results (outputs at full precision)\n";
+            std::cout << "  --accuracy-compare <f> Report speedup and largest output change per engine against saved results\n";
+            std::cout << "  --fast-math-units <l> Engines built with fast math; they fail above --max-delta\n";
+            std::cout << "  --max-delta <x>       Largest relative output change for fast-math units (default 1e-6)\n";
+            std::cout << "  --shm-cache <name>    Attach the shared-memory pricing cache (default $BSM_SHM_CACHE)\n";
             std::cout << "  --paths <n>           Set number of Monte Carlo paths\n";
             std::cout << "  --threads <n>         Set number of threads (OpenMP)\n";
             std::cout << "  --help, -h            Show this help message\n";
             return 0;
         }
 
+        if (!isa_override.empty()) {
+            KernelISA isa;
+            if (!parse_isa(isa_override, isa)) {
+                std::cerr << "Unknown instruction set: " << isa_override << "\n";
+                return 1;
+            }
+            if (!isa_supported(isa)) {
+                std::cerr << "Instruction set " << isa_name(isa) << " is not supported on this CPU (detected "
+                          << isa_name(detected_isa()) << ")\n";
+                return 1;
+            }
+            set_isa(isa);
+        }
+
 #ifndef USE_PERFORMANCE_UTILS
         // Suppress unused variable warnings when performance utils are not compiled
         (void)validate_accuracy;
@@ -428,9 +1759,16 @@ int main(int argc, char* argv[]) {
             std::cout << "L1 cache: " << arch_info.l1_cache_size << " KB\n";
             std::cout << "L2 cache: " << arch_info.l2_cache_size << " KB\n";
             std::cout << "L3 cache: " << arch_info.l3_cache_size << " KB\n";
+            std::cout << "SSE4.2 support: " << (arch_info.has_sse42 ? "Yes" : "No") << "\n";
             std::cout << "AVX support: " << (arch_info.has_avx ? "Yes" : "No") << "\n";
             std::cout << "AVX2 support: " << (arch_info.has_avx2 ? "Yes" : "No") << "\n";
             std::cout << "FMA support: " << (arch_info.has_fma ? "Yes" : "No") << "\n";
+            std::cout << "AVX-512 (F/DQ/VL) support: "
+                      << (arch_info.has_avx512f && arch_info.has_avx512dq && arch_info.has_avx512vl ? "Yes" : "No")
+                      << "\n";
+            std::cout << "Kernel variants: " << bsm::isa_name(bsm::kernel_isa(bsm::Kernel::BlackScholes))
+                      << " (detected " << bsm::isa_name(bsm::detected_isa()) << ")\n";
+            std::cout << "Hardware fingerprint: " << bsm::hardware_fingerprint() << "\n";
             std::cout << "NUMA support: " << (arch_info.has_numa ? "Yes" : "No") << "\n";
             if (arch_info.has_numa) {
                 std::cout << "NUMA nodes: " << arch_info.numa_nodes << "\n";
@@ -542,6 +1880,115 @@ int main(int argc, char* argv[]) {
             return 0;
         }
         
+        if (surface_benchmark) {
+            run_surface_benchmark(config);
+            return 0;
+        }
+
+        if (heston_pde_benchmark) {
+            run_heston_pde_benchmark(config);
+            return 0;
+        }
+
+        if (multi_asset_benchmark) {
+            run_multi_asset_benchmark(config);
+            return 0;
+        }
+
+        if (barrier_benchmark) {
+            run_barrier_benchmark(config);
+            return 0;
+        }
+
+        if (asian_benchmark) {
+            run_asian_benchmark(config);
+            return 0;
+        }
+
+        if (lsm_dual_benchmark) {
+            run_lsm_dual_benchmark(config);
+            return 0;
+        }
+
+        if (lsm_vr_benchmark) {
+            run_lsm_vr_benchmark(config);
+            return 0;
+        }
+
+        if (lsm_greeks_benchmark) {
+            run_lsm_greeks_benchmark(config);
+            return 0;
+        }
+
+        if (precision_benchmark) {
+            run_precision_benchmark(config);
+            return 0;
+        }
+
+        if (lsm_spill_benchmark) {
+            run_lsm_spill_benchmark(config);
+            return 0;
+        }
+
+        if (path_store_benchmark) {
+            run_path_store_benchmark(config);
+            return 0;
+        }
+
+        if (arbitrage_benchmark) {
+            run_arbitrage_benchmark(config);
+            return 0;
+        }
+
+        if (implied_forward_benchmark) {
+            run_implied_forward_benchmark(config);
+            return 0;
+        }
+
+        if (variance_swap_benchmark) {
+            run_variance_swap_benchmark(config);
+            return 0;
+        }
+
+        if (isa_benchmark) {
+            run_isa_benchmark(config);
+            return 0;
+        }
+
+        if (tune) {
+            run_tune(tuning_profile, tune_quick);
+            return 0;
+        }
+
+        if (accuracy_harness) {
+            return run_accuracy_report(accuracy_save, accuracy_reference, fast_math_units, fast_math_max_delta);
+        }
+
+        if (pgo_training) {
+            run_pgo_training();
+            return 0;
+        }
+
+        if (shm_cache_benchmark) {
+            run_shm_cache_benchmark();
+            return 0;
+        }
+
+        if (async_benchmark) {
+            run_async_benchmark();
+            return 0;
+        }
+
+        if (risk_graph_benchmark) {
+            run_risk_graph_benchmark();
+            return 0;
+        }
+
+        if (pnl_explain_benchmark) {
+            run_pnl_explain_benchmark();
+            return 0;
+        }
+        
         // Show configuration
         print_parameters(config);
         print_mc_config(config);
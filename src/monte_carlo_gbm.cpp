@@ -1,7 +1,9 @@
 #include "monte_carlo_gbm.hpp"
+#include "asian.hpp"
 #include "math_utils.hpp"
 #include <algorithm>
 #include <cmath>
+#include <vector>
 
 namespace bsm {
 
@@ -114,4 +116,330 @@ MCResult mc_gbm_price(double S0, double K, double r, double T, double sigma,
     return res;
 }
 
+namespace {
+
+// Sorted, de-duplicated positive expiries
+std::vector<double> normalized_expiries(const std::vector<double>& expiries) {
+    std::vector<double> out;
+    for (double t : expiries) if (t > 0.0) out.push_back(t);
+    std::sort(out.begin(), out.end());
+    out.erase(std::unique(out.begin(), out.end()), out.end());
+    return out;
+}
+
+} // namespace
+
+MCResultGrid mc_gbm_price_grid(double S0, const std::vector<double>& strikes,
+                               const std::vector<double>& expiries, double r, double sigma,
+                               long num_paths, OptionType type, unsigned long seed,
+                               bool antithetic, bool control_variate, bool compute_greeks) {
+    MCResultGrid grid;
+    grid.strikes = strikes;
+    grid.expiries = normalized_expiries(expiries);
+    const std::size_t nK = grid.strikes.size(), nE = grid.expiries.size();
+    grid.results.resize(nK * nE);
+    if (nK == 0 || nE == 0 || num_paths <= 0) return grid;
+
+    const double s = (type == OptionType::Call) ? 1.0 : -1.0;
+    std::vector<double> step_drift(nE), step_sqrt_dt(nE);
+    for (std::size_t e = 0; e < nE; ++e) {
+        const double dt = grid.expiries[e] - (e ? grid.expiries[e - 1] : 0.0);
+        step_drift[e] = (r - 0.5 * sigma * sigma) * dt;
+        step_sqrt_dt[e] = std::sqrt(dt);
+    }
+
+    // One sample is an antithetic pair (or a single path); samples are generated in
+    // fixed-size blocks with their own streams so results do not depend on threading.
+    constexpr long kBlock = 1024;
+    const long samples = antithetic ? std::max(1L, num_paths / 2) : num_paths;
+    const long num_blocks = (samples + kBlock - 1) / kBlock;
+
+    // Per cell: sum X, X^2, XY, delta, vega, gamma; per expiry: sum Y, Y^2 (Y = S_T)
+    constexpr std::size_t kCellStats = 6;
+    const std::size_t cells = nK * nE;
+    std::vector<double> acc(kCellStats * cells + 2 * nE, 0.0);
+    double* acc_ptr = acc.data();
+    const std::size_t acc_len = acc.size();
+    (void)acc_len;
+
+    #ifdef _OPENMP
+    #pragma omp parallel for schedule(static) reduction(+:acc_ptr[:acc_len])
+    #endif
+    for (long blk = 0; blk < num_blocks; ++blk) {
+        const long n = std::min(kBlock, samples - blk * kBlock);
+        RNG rng(seed + 0x9E3779B97F4A7C15ULL * static_cast<unsigned long>(blk + 1));
+        // Recorded states, expiry-major so that the payoff loops are stride-1
+        std::vector<double> W(nE * kBlock), S_up(nE * kBlock), S_dn(nE * kBlock);
+        for (long i = 0; i < n; ++i) {
+            double w = 0.0, x_up = 0.0, x_dn = 0.0;
+            for (std::size_t e = 0; e < nE; ++e) {
+                const double dw = step_sqrt_dt[e] * rng.gauss();
+                w += dw;
+                x_up += step_drift[e] + sigma * dw;
+                x_dn += step_drift[e] - sigma * dw;
+                W[e * kBlock + i] = w;
+                S_up[e * kBlock + i] = S0 * std::exp(x_up);
+                S_dn[e * kBlock + i] = S0 * std::exp(x_dn);
+            }
+        }
+
+        for (std::size_t e = 0; e < nE; ++e) {
+            const double T = grid.expiries[e];
+            const double inv_sigma_T = 1.0 / (sigma * T);
+            const double* We = &W[e * kBlock];
+            const double* Su = &S_up[e * kBlock];
+            const double* Sd = &S_dn[e * kBlock];
+
+            double sy = 0.0, syy = 0.0;
+            for (long i = 0; i < n; ++i) {
+                const double y = antithetic ? 0.5 * (Su[i] + Sd[i]) : Su[i];
+                sy += y;
+                syy += y * y;
+            }
+            acc_ptr[kCellStats * cells + e] += sy;
+            acc_ptr[kCellStats * cells + nE + e] += syy;
+
+            for (std::size_t k = 0; k < nK; ++k) {
+                const double K = grid.strikes[k];
+                double sx = 0.0, sxx = 0.0, sxy = 0.0, sd = 0.0, sv = 0.0, sg = 0.0;
+                for (long i = 0; i < n; ++i) {
+                    const double pu = std::max(s * (Su[i] - K), 0.0);
+                    const double iu = pu > 0.0 ? s * Su[i] : 0.0;
+                    double x = pu, y = Su[i];
+                    double d = iu;
+                    double v = iu * (We[i] - sigma * T);
+                    double g = iu * (We[i] * inv_sigma_T - 1.0);
+                    if (antithetic) {
+                        const double pd = std::max(s * (Sd[i] - K), 0.0);
+                        const double id = pd > 0.0 ? s * Sd[i] : 0.0;
+                        x = 0.5 * (pu + pd);
+                        y = 0.5 * (Su[i] + Sd[i]);
+                        d = 0.5 * (iu + id);
+                        v = 0.5 * (v + id * (-We[i] - sigma * T));
+                        g = 0.5 * (g + id * (-We[i] * inv_sigma_T - 1.0));
+                    }
+                    sx += x;
+                    sxx += x * x;
+                    sxy += x * y;
+                    sd += d;
+                    sv += v;
+                    sg += g;
+                }
+                double* cell = acc_ptr + kCellStats * (e * nK + k);
+                cell[0] += sx;
+                cell[1] += sxx;
+                cell[2] += sxy;
+                if (compute_greeks) {
+                    cell[3] += sd;
+                    cell[4] += sv;
+                    cell[5] += sg;
+                }
+            }
+        }
+    }
+
+    const double ns = static_cast<double>(samples);
+    for (std::size_t e = 0; e < nE; ++e) {
+        const double T = grid.expiries[e];
+        const double disc = std::exp(-r * T);
+        const double mY = acc[kCellStats * cells + e] / ns;
+        const double vY = std::max(0.0, acc[kCellStats * cells + nE + e] / ns - mY * mY);
+        const double EY = S0 * std::exp(r * T);
+        for (std::size_t k = 0; k < nK; ++k) {
+            const double* cell = &acc[kCellStats * (e * nK + k)];
+            const double mX = cell[0] / ns;
+            double vX = std::max(0.0, cell[1] / ns - mX * mX);
+            double mean = mX;
+            if (control_variate && vY > 1e-14) {
+                // Regression control variate: beta = Cov(X,Y)/Var(Y)
+                const double cXY = cell[2] / ns - mX * mY;
+                mean = mX - (cXY / vY) * (mY - EY);
+                vX = std::max(0.0, vX - cXY * cXY / vY);
+            }
+            MCResult& res = grid.at(e, k);
+            res.price = disc * mean;
+            res.std_error = disc * std::sqrt(vX / ns);
+            res.num_paths = num_paths;
+            res.num_steps = static_cast<long>(e + 1);
+            res.seed = seed;
+            if (compute_greeks) {
+                res.delta = disc * cell[3] / (ns * S0);
+                res.vega = disc * cell[4] / ns;
+                res.gamma = disc * cell[5] / (ns * S0 * S0);
+            }
+        }
+    }
+    return grid;
+}
+
+MCResult mc_gbm_barrier_price(double S0, double K, double r, double T, double sigma,
+                              long num_paths, long num_steps, OptionType type,
+                              const BarrierSpec& barrier, unsigned long seed,
+                              bool antithetic, int monitoring_dates) {
+    MCResult res;
+    const bool continuous = monitoring_dates <= 0;
+    const long steps_per_date = continuous ? 1
+        : std::max(1L, (num_steps + monitoring_dates - 1) / monitoring_dates);
+    const long steps = continuous ? std::max(1L, num_steps) : steps_per_date * monitoring_dates;
+    res.num_paths = num_paths;
+    res.num_steps = steps;
+    res.seed = seed;
+    if (num_paths <= 0) return res;
+
+    const double dt = T / static_cast<double>(steps);
+    const double drift = (r - 0.5 * sigma * sigma) * dt;
+    const double vol = sigma * std::sqrt(dt);
+    const double var = vol * vol;
+    const double disc_T = std::exp(-r * T);
+    std::vector<double> step_disc(steps);
+    for (long n = 0; n < steps; ++n) step_disc[n] = std::exp(-r * (n + 1) * dt);
+    auto payoff = [&](double ST) {
+        return (type == OptionType::Call) ? std::max(ST - K, 0.0) : std::max(K - ST, 0.0);
+    };
+    // A spot already beyond the barrier is knocked at t = 0
+    const BarrierPathTracker start = barrier_breached(S0, barrier) ? BarrierPathTracker{0.0, 1.0}
+                                                                   : BarrierPathTracker{};
+
+    // Blocks of samples with their own streams, as in mc_gbm_price_grid
+    constexpr long kBlock = 1024;
+    const long samples = antithetic ? std::max(1L, num_paths / 2) : num_paths;
+    const long num_blocks = (samples + kBlock - 1) / kBlock;
+    double sum = 0.0, sum2 = 0.0;
+
+    #ifdef _OPENMP
+    #pragma omp parallel for schedule(static) reduction(+:sum,sum2)
+    #endif
+    for (long blk = 0; blk < num_blocks; ++blk) {
+        const long n_blk = std::min(kBlock, samples - blk * kBlock);
+        RNG rng(seed + 0x9E3779B97F4A7C15ULL * static_cast<unsigned long>(blk + 1));
+        for (long i = 0; i < n_blk; ++i) {
+            double S_up = S0, S_dn = S0;
+            BarrierPathTracker up = start, dn = start;
+            for (long n = 0; n < steps; ++n) {
+                const double z = rng.gauss();
+                const bool monitored = continuous || (n + 1) % steps_per_date == 0;
+                const double next_up = S_up * std::exp(drift + vol * z);
+                if (monitored) up.step(barrier_step_hit_probability(S_up, next_up, var, barrier, continuous), step_disc[n]);
+                S_up = next_up;
+                if (antithetic) {
+                    const double next_dn = S_dn * std::exp(drift - vol * z);
+                    if (monitored) dn.step(barrier_step_hit_probability(S_dn, next_dn, var, barrier, continuous), step_disc[n]);
+                    S_dn = next_dn;
+                }
+            }
+            double x = up.value(payoff(S_up), disc_T, barrier);
+            if (antithetic) x = 0.5 * (x + dn.value(payoff(S_dn), disc_T, barrier));
+            sum += x;
+            sum2 += x * x;
+        }
+    }
+
+    const double ns = static_cast<double>(samples);
+    const double mean = sum / ns;
+    res.price = mean;
+    res.std_error = std::sqrt(std::max(0.0, sum2 / ns - mean * mean) / ns);
+    return res;
+}
+
+namespace {
+
+// Per-path results of one Asian block, converted to double for the payoff pass
+struct AsianBlockSums {
+    std::vector<double> a_up, a_dn, g;
+    double drift_sum{0.0};   // Σ_f 2·drift·(f+1), the mirror of Σ_f x_f
+};
+
+// Evolves n paths over the fixings in precision Real. Per-path state: log-spot,
+// running arithmetic sum and running log sum. The antithetic log-spot is
+// 2·(cumulative drift) - x, so its spot is a division rather than another exp.
+template <typename Real>
+void asian_block(long n, int n_fix, RNG& rng, double drift, double vol, bool antithetic,
+                 AsianBlockSums& out) {
+    std::vector<Real> z(n), x(n, Real(0)), a_up(n, Real(0)), a_dn(n, Real(0)), g(n, Real(0));
+    const Real drift_r = static_cast<Real>(drift), vol_r = static_cast<Real>(vol);
+    for (int f = 0; f < n_fix; ++f) {
+        const Real mirror = static_cast<Real>(std::exp(2.0 * drift * (f + 1)));
+        out.drift_sum += 2.0 * drift * (f + 1);
+        for (long i = 0; i < n; ++i) z[i] = static_cast<Real>(rng.gauss());
+        for (long i = 0; i < n; ++i) {
+            x[i] += drift_r + vol_r * z[i];
+            const Real e = std::exp(x[i]);
+            a_up[i] += e;
+            if (antithetic) a_dn[i] += mirror / e;
+            g[i] += x[i];
+        }
+    }
+    out.a_up.assign(a_up.begin(), a_up.end());
+    out.a_dn.assign(a_dn.begin(), a_dn.end());
+    out.g.assign(g.begin(), g.end());
+}
+
+} // namespace
+
+MCResult mc_gbm_asian_price(double S0, double K, double r, double T, double sigma,
+                            long num_paths, int num_fixings, OptionType type,
+                            unsigned long seed, bool antithetic, bool control_variate,
+                            Precision precision) {
+    MCResult res;
+    const int n_fix = std::max(1, num_fixings);
+    res.num_paths = num_paths;
+    res.num_steps = n_fix;
+    res.seed = seed;
+    if (num_paths <= 0) return res;
+
+    const double dt = T / n_fix;
+    const double drift = (r - 0.5 * sigma * sigma) * dt;
+    const double vol = sigma * std::sqrt(dt);
+    const double s = (type == OptionType::Call) ? 1.0 : -1.0;
+    const double inv_n = 1.0 / n_fix;
+    const double geo_mean = std::exp(r * T) * asian_geometric_price(S0, K, r, T, sigma, type, n_fix);
+
+    constexpr long kBlock = 1024;
+    const long samples = antithetic ? std::max(1L, num_paths / 2) : num_paths;
+    const long num_blocks = (samples + kBlock - 1) / kBlock;
+    // Sums of X (arithmetic payoff), X², Y (geometric payoff), Y², XY
+    double sx = 0.0, sxx = 0.0, sy = 0.0, syy = 0.0, sxy = 0.0;
+
+    #ifdef _OPENMP
+    #pragma omp parallel for schedule(static) reduction(+:sx,sxx,sy,syy,sxy)
+    #endif
+    for (long blk = 0; blk < num_blocks; ++blk) {
+        const long n = std::min(kBlock, samples - blk * kBlock);
+        RNG rng(seed + 0x9E3779B97F4A7C15ULL * static_cast<unsigned long>(blk + 1));
+        AsianBlockSums sums;
+        if (precision == Precision::Float) {
+            asian_block<float>(n, n_fix, rng, drift, vol, antithetic, sums);
+        } else {
+            asian_block<double>(n, n_fix, rng, drift, vol, antithetic, sums);
+        }
+        for (long i = 0; i < n; ++i) {
+            double x_pay = std::max(s * (S0 * sums.a_up[i] * inv_n - K), 0.0);
+            double y = std::max(s * (S0 * std::exp(sums.g[i] * inv_n) - K), 0.0);
+            if (antithetic) {
+                x_pay = 0.5 * (x_pay + std::max(s * (S0 * sums.a_dn[i] * inv_n - K), 0.0));
+                y = 0.5 * (y + std::max(s * (S0 * std::exp((sums.drift_sum - sums.g[i]) * inv_n) - K), 0.0));
+            }
+            sx += x_pay; sxx += x_pay * x_pay;
+            sy += y; syy += y * y;
+            sxy += x_pay * y;
+        }
+    }
+
+    const double ns = static_cast<double>(samples);
+    const double disc = std::exp(-r * T);
+    const double mX = sx / ns, mY = sy / ns;
+    double vX = std::max(0.0, sxx / ns - mX * mX);
+    double mean = mX;
+    const double vY = std::max(0.0, syy / ns - mY * mY);
+    if (control_variate && vY > 1e-14) {
+        // Optimal beta = Cov(X,Y)/Var(Y); residual variance Var(X)(1 - corr²)
+        const double cXY = sxy / ns - mX * mY;
+        mean = mX - (cXY / vY) * (mY - geo_mean);
+        vX = std::max(0.0, vX - cXY * cXY / vY);
+    }
+    res.price = disc * mean;
+    res.std_error = disc * std::sqrt(vX / ns);
+    return res;
+}
+
 }
@@ -0,0 +1,185 @@
+/**
+ * @file path_store.cpp
+ * @brief Contiguous, aligned path storage with floating-point and quantised encodings
+ *
+ * @author LN697
+ * @version 1.0
+ */
+
+#include "path_store.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+namespace bsm {
+
+namespace {
+
+constexpr double kQuantMax = 32767.0;
+
+std::size_t round_up(std::size_t n, std::size_t a) { return (n + a - 1) / a * a; }
+
+}
+
+void PathStore::AlignedFree::operator()(unsigned char* p) const {
+#ifdef _WIN32
+    _aligned_free(p);
+#else
+    std::free(p);
+#endif
+}
+
+std::size_t PathStore::required_bytes(long num_paths, int num_dates, PathLayout layout,
+                                      PathEncoding encoding, std::size_t row_alignment) {
+    const std::size_t rows = layout == PathLayout::TimeMajor ? num_dates : num_paths;
+    const std::size_t len = layout == PathLayout::TimeMajor ? num_paths : num_dates;
+    return rows * round_up(len * path_encoding_size(encoding), row_alignment);
+}
+
+PathStore::PathStore(long num_paths, int num_dates, PathLayout layout, PathEncoding encoding,
+                     double reference, void* external, std::size_t row_alignment)
+    : num_paths_(num_paths), num_dates_(num_dates), layout_(layout), encoding_(encoding),
+      reference_(reference), value_bytes_(path_encoding_size(encoding)) {
+    if (num_paths <= 0 || num_dates <= 0) {
+        throw std::invalid_argument("PathStore: num_paths and num_dates must be positive");
+    }
+    if (row_alignment < kAlignment || (row_alignment & (row_alignment - 1)) != 0) {
+        throw std::invalid_argument("PathStore: row_alignment must be a power of two >= 64");
+    }
+    if (encoding == PathEncoding::LogReturn16 && !(reference > 0.0)) {
+        throw std::invalid_argument("PathStore: LogReturn16 needs a positive reference spot");
+    }
+    row_bytes_ = round_up(row_length() * value_bytes_, row_alignment);
+    if (encoding == PathEncoding::LogReturn16) scale_.assign(num_dates, 1.0 / kQuantMax);
+
+    if (external) {
+        if (reinterpret_cast<std::uintptr_t>(external) % row_alignment != 0) {
+            throw std::invalid_argument("PathStore: external buffer is not aligned to row_alignment");
+        }
+        data_ = static_cast<unsigned char*>(external);
+        return;
+    }
+    const std::size_t n = bytes();
+#ifdef _WIN32
+    void* p = _aligned_malloc(n, row_alignment);
+#else
+    void* p = std::aligned_alloc(row_alignment, n);
+#endif
+    if (!p) throw std::bad_alloc();
+    owned_.reset(static_cast<unsigned char*>(p));
+    data_ = owned_.get();
+    std::memset(data_, 0, n);
+}
+
+void PathStore::set_log_range(int t, double range) {
+    if (encoding_ != PathEncoding::LogReturn16) return;
+    if (t < 0 || t >= num_dates_ || !(range >= 0.0)) {
+        throw std::invalid_argument("PathStore::set_log_range: bad date or range");
+    }
+    scale_[t] = range / kQuantMax;
+}
+
+int16_t PathStore::quantize(int t, double S) const {
+    if (scale_[t] <= 0.0) return 0;
+    const double q = std::log(S / reference_) / scale_[t];
+    return static_cast<int16_t>(std::lround(std::max(-kQuantMax, std::min(kQuantMax, q))));
+}
+
+double PathStore::get(long path, int t) const {
+    const unsigned char* p = data_ + offset(path, t);
+    switch (encoding_) {
+        case PathEncoding::Float64: { double v; std::memcpy(&v, p, sizeof v); return v; }
+        case PathEncoding::Float32: { float v; std::memcpy(&v, p, sizeof v); return v; }
+        case PathEncoding::LogReturn16: break;
+    }
+    int16_t q;
+    std::memcpy(&q, p, sizeof q);
+    return dequantize(t, q);
+}
+
+void PathStore::set(long path, int t, double S) {
+    unsigned char* p = data_ + offset(path, t);
+    switch (encoding_) {
+        case PathEncoding::Float64: std::memcpy(p, &S, sizeof S); return;
+        case PathEncoding::Float32: { const float v = static_cast<float>(S); std::memcpy(p, &v, sizeof v); return; }
+        case PathEncoding::LogReturn16: break;
+    }
+    const int16_t q = quantize(t, S);
+    std::memcpy(p, &q, sizeof q);
+}
+
+template <typename Real>
+void PathStore::store_date(int t, const Real* S) {
+    if (layout_ == PathLayout::PathMajor) {
+        for (long m = 0; m < num_paths_; ++m) set(m, t, S[m]);
+        return;
+    }
+    void* row = row_data(t);
+    switch (encoding_) {
+        case PathEncoding::Float64: {
+            double* d = static_cast<double*>(row);
+            for (long m = 0; m < num_paths_; ++m) d[m] = S[m];
+            return;
+        }
+        case PathEncoding::Float32: {
+            float* f = static_cast<float*>(row);
+            for (long m = 0; m < num_paths_; ++m) f[m] = static_cast<float>(S[m]);
+            return;
+        }
+        case PathEncoding::LogReturn16: break;
+    }
+    int16_t* q = static_cast<int16_t*>(row);
+    for (long m = 0; m < num_paths_; ++m) q[m] = quantize(t, S[m]);
+}
+
+template <typename Real>
+void PathStore::load_date(int t, Real* S) const {
+    if (layout_ == PathLayout::PathMajor) {
+        for (long m = 0; m < num_paths_; ++m) S[m] = static_cast<Real>(get(m, t));
+        return;
+    }
+    const void* row = row_data(t);
+    switch (encoding_) {
+        case PathEncoding::Float64: {
+            const double* d = static_cast<const double*>(row);
+            for (long m = 0; m < num_paths_; ++m) S[m] = static_cast<Real>(d[m]);
+            return;
+        }
+        case PathEncoding::Float32: {
+            const float* f = static_cast<const float*>(row);
+            for (long m = 0; m < num_paths_; ++m) S[m] = static_cast<Real>(f[m]);
+            return;
+        }
+        case PathEncoding::LogReturn16: break;
+    }
+    const int16_t* q = static_cast<const int16_t*>(row);
+    const double sc = scale_[t];
+    for (long m = 0; m < num_paths_; ++m) S[m] = static_cast<Real>(reference_ * std::exp(q[m] * sc));
+}
+
+template <typename Real>
+void PathStore::store_path(long path, const Real* S) {
+    for (int t = 0; t < num_dates_; ++t) set(path, t, S[t]);
+}
+
+template <typename Real>
+void PathStore::load_path(long path, Real* S) const {
+    for (int t = 0; t < num_dates_; ++t) S[t] = static_cast<Real>(get(path, t));
+}
+
+template void PathStore::store_date<double>(int, const double*);
+template void PathStore::store_date<float>(int, const float*);
+template void PathStore::load_date<double>(int, double*) const;
+template void PathStore::load_date<float>(int, float*) const;
+template void PathStore::store_path<double>(long, const double*);
+template void PathStore::store_path<float>(long, const float*);
+template void PathStore::load_path<double>(long, double*) const;
+template void PathStore::load_path<float>(long, float*) const;
+
+}
@@ -1,4 +1,8 @@
 #include "pde_cn.hpp"
+#include "analytic_bs.hpp"
+#include "barrier.hpp"
+#include "pde_grid.hpp"
+#include "tridiagonal.hpp"
 #include <vector>
 #include <algorithm>
 #include <cmath>
@@ -86,4 +90,118 @@ double pde_crank_nicolson(double S0, double K, double r, double T, double sigma,
     return V[idx] + slope * (S0 - S[idx]);
 }
 
+double pde_crank_nicolson_barrier(double S0, double K, double r, double T, double sigma,
+                                  int num_S_steps, int num_T_steps, OptionType type,
+                                  const BarrierSpec& barrier, int monitoring_dates) {
+    if (barrier.type == BarrierType::None) {
+        return pde_crank_nicolson(S0, K, r, T, sigma, num_S_steps, num_T_steps, type);
+    }
+    const bool knock_in = is_knock_in(barrier.type);
+    const bool down = is_down_barrier(barrier.type);
+    const double B = barrier.level, R = barrier.rebate;
+    if (barrier_breached(S0, barrier)) {
+        return knock_in ? black_scholes_price(S0, K, r, T, sigma, type) : R;
+    }
+
+    // Knock-ins solve W = E[e^{-rT}(payoff - R) 1{no hit}], so KI = vanilla - W
+    const double shift = knock_in ? R : 0.0;
+    const double knocked_value = knock_in ? 0.0 : R;
+    const bool discrete = monitoring_dates > 0;
+    const int num_dates = discrete ? monitoring_dates : 1;
+
+    const double S_far = std::max(4.0 * std::max(K, S0), 2.0 * B);
+    double S_lo = 0.0, dS = 0.0;
+    int N = num_S_steps;
+    if (discrete) {
+        const double nB = std::max(1.0, std::round(B / (S_far / num_S_steps)));
+        dS = B / nB;
+        N = static_cast<int>(std::ceil(S_far / dS));
+    } else {
+        S_lo = down ? B : 0.0;
+        dS = ((down ? S_far : B) - S_lo) / N;
+    }
+    const int steps_per_date = std::max(1, (num_T_steps + num_dates - 1) / num_dates);
+    const double dt = T / num_dates / steps_per_date;
+
+    std::vector<double> S(N + 1), V(N + 1), rhs(N - 1);
+    for (int i = 0; i <= N; ++i) S[i] = S_lo + i * dS;
+
+    auto vanilla_edge = [&](double s, double tau) {
+        const double fwd_K = K * std::exp(-r * tau);
+        return ((type == OptionType::Call) ? std::max(s - fwd_K, 0.0) : std::max(fwd_K - s, 0.0))
+               - shift * std::exp(-r * tau);
+    };
+    // Edge values at time-to-expiry tau, tau_date being the time to the next monitoring date
+    auto edge = [&](bool lower, double tau, double tau_date) {
+        if (lower == down) {
+            return knocked_value * (discrete ? std::exp(-r * tau_date) : 1.0);
+        }
+        return vanilla_edge(lower ? S[0] : S[N], tau);
+    };
+    // The value jumps at B on a monitoring date; the node on the barrier takes the
+    // mean of both sides, which keeps the reset second order in dS
+    const int iB = static_cast<int>(std::lround(B / dS));
+    auto reset = [&]() {
+        for (int i = 0; i <= N; ++i) {
+            if (i == iB) V[i] = 0.5 * (V[i] + knocked_value);
+            else if (down ? i < iB : i > iB) V[i] = knocked_value;
+        }
+    };
+
+    // L V = ½σ²S²V'' + rSV' - rV, central differences; LHS is I - ½dt L
+    std::vector<double> lo(N + 1), mid(N + 1), hi(N + 1);
+    std::vector<double> a(N - 1), b(N - 1), c(N - 1);
+    for (int i = 1; i < N; ++i) {
+        const double diff = 0.5 * sigma * sigma * S[i] * S[i] / (dS * dS);
+        const double conv = 0.5 * r * S[i] / dS;
+        lo[i] = diff - conv;
+        mid[i] = -2.0 * diff - r;
+        hi[i] = diff + conv;
+        a[i - 1] = -0.5 * dt * lo[i];
+        b[i - 1] = 1.0 - 0.5 * dt * mid[i];
+        c[i - 1] = -0.5 * dt * hi[i];
+    }
+    const TridiagonalFactor lhs(a, b, c);
+
+    for (int i = 0; i <= N; ++i) {
+        V[i] = ((type == OptionType::Call) ? std::max(S[i] - K, 0.0) : std::max(K - S[i], 0.0)) - shift;
+    }
+    V[0] = edge(true, 0.0, 0.0);
+    V[N] = edge(false, 0.0, 0.0);
+    if (discrete) reset();
+
+    double tau = 0.0;
+    for (int d = 0; d < num_dates; ++d) {
+        const double tau_date0 = tau;
+        for (int step = 0; step < steps_per_date; ++step) {
+            // Rannacher start-up: the first two steps after a payoff (re)start are
+            // replaced by four implicit-Euler half-steps sharing the CN matrix
+            const bool damped = step < 2;
+            for (int sub = 0; sub < (damped ? 2 : 1); ++sub) {
+                const double h = damped ? 0.5 * dt : dt;
+                const double tau_new = tau + h;
+                const double V0 = edge(true, tau_new, tau_new - tau_date0);
+                const double VN = edge(false, tau_new, tau_new - tau_date0);
+                for (int i = 1; i < N; ++i) {
+                    rhs[i - 1] = damped ? V[i]
+                                        : V[i] + 0.5 * dt * (lo[i] * V[i - 1] + mid[i] * V[i] + hi[i] * V[i + 1]);
+                }
+                rhs[0] += 0.5 * dt * lo[1] * V0;
+                rhs[N - 2] += 0.5 * dt * hi[N - 1] * VN;
+                lhs.solve(rhs.data());
+                V[0] = V0;
+                V[N] = VN;
+                std::copy(rhs.begin(), rhs.end(), V.begin() + 1);
+                tau = tau_new;
+            }
+        }
+        if (discrete && d + 1 < num_dates) reset();
+    }
+
+    const std::size_t i = std::clamp<std::size_t>(
+        static_cast<std::size_t>(std::lround((S0 - S_lo) / dS)), 1, static_cast<std::size_t>(N - 1));
+    const double value = quadratic_fit(S, V.data(), 1, i, S0).value;
+    return knock_in ? black_scholes_price(S0, K, r, T, sigma, type) - value : value;
+}
+
 }
@@ -0,0 +1,393 @@
+#include "pde_heston_adi.hpp"
+#include "tridiagonal.hpp"
+#include "isa_dispatch.hpp"
+#include "engine_tuning.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+namespace bsm {
+
+namespace {
+
+// One knock-out (or vanilla) problem on a fixed grid. Knock-in prices are
+// assembled from two of these by parity.
+struct ADIProblem {
+    double S0, v0, K, r, T;
+    OptionType type;
+    bool american;
+    bool lower_knockout, upper_knockout;
+    double barrier, rebate;
+    double payoff_shift;   // subtracted from the payoff; discounted on far boundaries
+};
+
+class HestonADISolver {
+public:
+    HestonADISolver(const ADIProblem& p, const HestonParams& h, const LeverageGrid* lev,
+                    const HestonADIConfig& cfg)
+        : p_(p), h_(h), lev_(lev), cfg_(cfg), nS_(cfg.num_S), nv_(cfg.num_v),
+          nS1_(cfg.num_S + 1), nv1_(cfg.num_v + 1) {
+        theta_ = (cfg.theta > 0.0) ? cfg.theta : default_adi_theta(cfg.scheme);
+        build_grids();
+        build_v_operator();
+        time_dependent_ = lev_ && lev_->t.size() > 1;
+        if (!time_dependent_) build_S_operator(0.0);
+    }
+
+    PDEResult solve() {
+        const std::size_t N = static_cast<std::size_t>(nS1_) * nv1_;
+        U_.resize(N);
+        Y_.resize(N);
+        a0_.resize(N); a1_.resize(N); a2_.resize(N);
+        b0_.resize(N); b1_.resize(N); b2_.resize(N);
+
+        for (int j = 0; j < nv1_; ++j)
+            for (int i = 0; i < nS1_; ++i) U_[idx(i, j)] = payoff_[i];
+        set_boundary(U_, 0.0);
+
+        const double dt = p_.T / cfg_.num_t;
+        double tau = 0.0;
+        for (int n = 0; n < cfg_.num_t; ++n) {
+            if (n < cfg_.damping_steps) {
+                step(0.5 * dt, tau, 1.0, /*douglas_only=*/true);
+                step(0.5 * dt, tau + 0.5 * dt, 1.0, true);
+            } else {
+                step(dt, tau, theta_, false);
+            }
+            tau += dt;
+            if (p_.american) project();
+        }
+        return read_off();
+    }
+
+private:
+    std::size_t idx(int i, int j) const { return static_cast<std::size_t>(j) * nS1_ + i; }
+
+    void build_grids() {
+        const double S_min = p_.lower_knockout ? p_.barrier : 0.0;
+        const double S_max = p_.upper_knockout ? p_.barrier
+                                               : cfg_.S_max_multiple * std::max(p_.S0, p_.K);
+        const double center = std::clamp(p_.K, S_min, S_max);
+        S_ = make_sinh_grid(S_min, S_max, nS_, center, (p_.K / 5.0) / (S_max - S_min), p_.K);
+        v_ = make_sinh_grid(0.0, cfg_.v_max, nv_, 0.0, 1.0 / 500.0);
+
+        payoff_.resize(nS1_);
+        const double s = (p_.type == OptionType::Call) ? 1.0 : -1.0;
+        for (int i = 0; i < nS1_; ++i) payoff_[i] = std::max(s * (S_[i] - p_.K), 0.0) - p_.payoff_shift;
+    }
+
+    // v direction: ½ξ²v V_vv + κ(θ-v) V_v - ½rV, identical on every S line
+    void build_v_operator() {
+        vl_.assign(nv1_, 0.0); vm_.assign(nv1_, 0.0); vh_.assign(nv1_, 0.0);
+        const double h0 = v_[1] - v_[0];
+        vm_[0] = -h_.kappa * h_.theta / h0 - 0.5 * p_.r;   // degenerate row: κθ V_v, forward
+        vh_[0] = h_.kappa * h_.theta / h0;
+        for (int j = 1; j < nv_; ++j) {
+            const StencilWeights w = convection_diffusion_weights(v_, j, 0.5 * h_.xi * h_.xi * v_[j],
+                                                                  h_.kappa * (h_.theta - v_[j]));
+            vl_[j] = w.lo; vm_[j] = w.mid - 0.5 * p_.r; vh_[j] = w.hi;
+        }
+        // Neumann V_v = 0 at v_max through a mirrored ghost node
+        const double hN = v_[nv_] - v_[nv_ - 1];
+        const double dN = h_.xi * h_.xi * v_[nv_] / (hN * hN);
+        vl_[nv_] = dN;
+        vm_[nv_] = -dN - 0.5 * p_.r;
+
+        wv_.resize(nv1_);
+        for (int j = 1; j < nv_; ++j) {
+            const StencilWeights w = first_derivative_weights(v_, j);
+            wv_[j] = {w.lo * v_[j], w.mid * v_[j], w.hi * v_[j]};
+        }
+    }
+
+    // S direction and mixed-term coefficients at calendar time t
+    void build_S_operator(double t) {
+        const std::size_t N = static_cast<std::size_t>(nS1_) * nv1_;
+        sl_.assign(N, 0.0); sm_.assign(N, 0.0); sh_.assign(N, 0.0);
+        std::vector<double> L2S2(nS1_);
+        mixed_.assign(nS1_, 0.0);
+        wS_.resize(nS1_);
+        for (int i = 1; i < nS_; ++i) {
+            const double L = lev_ ? lev_->interpolate(S_[i], t) : 1.0;
+            L2S2[i] = L * L * S_[i] * S_[i];
+            mixed_[i] = h_.rho * h_.xi * L * S_[i];
+            wS_[i] = first_derivative_weights(S_, i);
+        }
+        #ifdef _OPENMP
+        #pragma omp parallel for schedule(static)
+        #endif
+        for (int j = 0; j < nv1_; ++j) {
+            for (int i = 1; i < nS_; ++i) {
+                const StencilWeights w = convection_diffusion_weights(S_, i, 0.5 * L2S2[i] * v_[j], p_.r * S_[i]);
+                const std::size_t k = idx(i, j);
+                sl_[k] = w.lo; sm_[k] = w.mid - 0.5 * p_.r; sh_[k] = w.hi;
+            }
+        }
+    }
+
+    double lower_value(double tau) const {
+        if (p_.lower_knockout) return p_.rebate;
+        const double df = std::exp(-p_.r * tau);
+        const double v = (p_.type == OptionType::Put) ? (p_.american ? p_.K : p_.K * df) : 0.0;
+        return v - p_.payoff_shift * df;
+    }
+
+    double upper_value(double tau) const {
+        if (p_.upper_knockout) return p_.rebate;
+        const double df = std::exp(-p_.r * tau);
+        const double v = (p_.type == OptionType::Call) ? S_[nS_] - p_.K * df : 0.0;
+        return v - p_.payoff_shift * df;
+    }
+
+    void set_boundary(std::vector<double>& V, double tau) const {
+        const double lo = lower_value(tau), hi = upper_value(tau);
+        for (int j = 0; j < nv1_; ++j) {
+            V[idx(0, j)] = lo;
+            V[idx(nS_, j)] = hi;
+        }
+    }
+
+    void apply_A0(const std::vector<double>& in, std::vector<double>& out) const {
+        #ifdef _OPENMP
+        #pragma omp parallel for schedule(static)
+        #endif
+        for (int j = 0; j < nv1_; ++j) {
+            double* o = &out[idx(0, j)];
+            if (j == 0 || j == nv_) { std::fill(o, o + nS1_, 0.0); continue; }
+            const double* rows[3] = {&in[idx(0, j - 1)], &in[idx(0, j)], &in[idx(0, j + 1)]};
+            const double wv[3] = {wv_[j].lo, wv_[j].mid, wv_[j].hi};
+            o[0] = o[nS_] = 0.0;
+            for (int i = 1; i < nS_; ++i) {
+                double acc = 0.0;
+                for (int b = 0; b < 3; ++b)
+                    acc += wv[b] * (wS_[i].lo * rows[b][i - 1] + wS_[i].mid * rows[b][i] + wS_[i].hi * rows[b][i + 1]);
+                o[i] = mixed_[i] * acc;
+            }
+        }
+    }
+
+    void apply_A1(const std::vector<double>& in, std::vector<double>& out) const {
+        #ifdef _OPENMP
+        #pragma omp parallel for schedule(static)
+        #endif
+        for (int j = 0; j < nv1_; ++j) {
+            const std::size_t row = idx(0, j);
+            const double* u = &in[row];
+            double* o = &out[row];
+            o[0] = o[nS_] = 0.0;
+            for (int i = 1; i < nS_; ++i)
+                o[i] = sl_[row + i] * u[i - 1] + sm_[row + i] * u[i] + sh_[row + i] * u[i + 1];
+        }
+    }
+
+    void apply_A2(const std::vector<double>& in, std::vector<double>& out) const {
+        #ifdef _OPENMP
+        #pragma omp parallel for schedule(static)
+        #endif
+        for (int j = 0; j < nv1_; ++j) {
+            const double* u = &in[idx(0, j)];
+            const double* dn = (j > 0) ? u - nS1_ : u;
+            const double* up = (j < nv_) ? u + nS1_ : u;
+            const double l = vl_[j], m = vm_[j], h = vh_[j];
+            double* o = &out[idx(0, j)];
+            o[0] = o[nS_] = 0.0;
+            for (int i = 1; i < nS_; ++i) o[i] = l * dn[i] + m * u[i] + h * up[i];
+        }
+    }
+
+    // (I - λ A1) Y = d along every S line; boundary rows take their Dirichlet values
+    void solve_S(double lambda, std::vector<double>& d, double tau_new) const {
+        const double g_lo = lower_value(tau_new), g_hi = upper_value(tau_new);
+        const int block = engine_tuning().heston_line_block;   // S lines per interleaved Thomas batch
+        const int num_blocks = (nv1_ + block - 1) / block;
+        #ifdef _OPENMP
+        #pragma omp parallel for schedule(static)
+        #endif
+        for (int blk = 0; blk < num_blocks; ++blk) {
+            const int j0 = blk * block;
+            const int m = std::min(block, nv1_ - j0);
+            const std::size_t len = static_cast<std::size_t>(nS1_) * block;
+            std::vector<double> a(len), b(len), c(len), x(len), scratch(len);
+            for (int i = 0; i < nS1_; ++i) {
+                for (int l = 0; l < m; ++l) {
+                    const std::size_t t = static_cast<std::size_t>(i) * block + l;
+                    const std::size_t k = idx(i, j0 + l);
+                    if (i == 0 || i == nS_) {
+                        a[t] = 0.0; b[t] = 1.0; c[t] = 0.0;
+                        x[t] = (i == 0) ? g_lo : g_hi;
+                    } else {
+                        a[t] = -lambda * sl_[k];
+                        b[t] = 1.0 - lambda * sm_[k];
+                        c[t] = -lambda * sh_[k];
+                        x[t] = d[k];
+                    }
+                }
+            }
+            active_kernels().tridiagonal(nS1_, m, a.data(), b.data(), c.data(), x.data(), scratch.data(), block);
+            for (int i = 0; i < nS1_; ++i)
+                for (int l = 0; l < m; ++l) d[idx(i, j0 + l)] = x[static_cast<std::size_t>(i) * block + l];
+        }
+    }
+
+    // (I - λ A2) Y = d along every interior v line, with one shared factorisation
+    void solve_v(double lambda, std::vector<double>& d) {
+        if (lambda != v_lambda_) {
+            std::vector<double> a(nv1_), b(nv1_), c(nv1_);
+            for (int j = 0; j < nv1_; ++j) {
+                a[j] = -lambda * vl_[j];
+                b[j] = 1.0 - lambda * vm_[j];
+                c[j] = -lambda * vh_[j];
+            }
+            v_factor_.factor(a, b, c);
+            v_lambda_ = lambda;
+        }
+        const int lines = nS_ - 1;
+        const int chunk = engine_tuning().heston_column_chunk;   // v lines per task
+        const int num_chunks = (lines + chunk - 1) / chunk;
+        double* base = d.data();
+        #ifdef _OPENMP
+        #pragma omp parallel for schedule(static)
+        #endif
+        for (int ch = 0; ch < num_chunks; ++ch) {
+            const int i0 = 1 + ch * chunk;
+            const int m = std::min(chunk, nS_ - i0);
+            v_factor_.solve(base + i0, m, nS1_);
+        }
+    }
+
+    // One ADI step from tau to tau + dt; douglas_only stops after the first stage pair
+    void step(double dt, double tau, double th, bool douglas_only) {
+        if (time_dependent_) build_S_operator(std::max(0.0, p_.T - (tau + 0.5 * dt)));
+        const double tau_new = tau + dt;
+        const double ld = th * dt;
+        const std::size_t N = U_.size();
+
+        apply_A0(U_, a0_); apply_A1(U_, a1_); apply_A2(U_, a2_);
+        for (std::size_t k = 0; k < N; ++k)
+            Y_[k] = U_[k] + dt * (a0_[k] + a1_[k] + a2_[k]) - ld * a1_[k];
+        solve_S(ld, Y_, tau_new);
+        for (std::size_t k = 0; k < N; ++k) Y_[k] -= ld * a2_[k];
+        solve_v(ld, Y_);
+        if (douglas_only) { U_.swap(Y_); return; }
+
+        apply_A0(Y_, b0_);
+        const ADIScheme s = cfg_.scheme;
+        if (s != ADIScheme::CraigSneyd) { apply_A1(Y_, b1_); apply_A2(Y_, b2_); }
+        for (std::size_t k = 0; k < N; ++k) {
+            const double aU = a0_[k] + a1_[k] + a2_[k];
+            double z = U_[k] + dt * aU;
+            if (s == ADIScheme::CraigSneyd) {
+                z += 0.5 * dt * (b0_[k] - a0_[k]) - ld * a1_[k];
+            } else if (s == ADIScheme::ModifiedCraigSneyd) {
+                const double bY = b0_[k] + b1_[k] + b2_[k];
+                z += th * dt * (b0_[k] - a0_[k]) + (0.5 - th) * dt * (bY - aU) - ld * a1_[k];
+            } else {
+                const double bY = b0_[k] + b1_[k] + b2_[k];
+                z += 0.5 * dt * (bY - aU) - ld * b1_[k];
+            }
+            Y_[k] = z;   // the Douglas result in Y_ is no longer needed past b*
+        }
+        solve_S(ld, Y_, tau_new);
+        const std::vector<double>& last = (s == ADIScheme::HundsdorferVerwer) ? b2_ : a2_;
+        for (std::size_t k = 0; k < N; ++k) Y_[k] -= ld * last[k];
+        solve_v(ld, Y_);
+        U_.swap(Y_);
+    }
+
+    void project() {
+        for (int j = 0; j < nv1_; ++j) {
+            double* u = &U_[idx(0, j)];
+            for (int i = 1; i < nS_; ++i) u[i] = std::max(u[i], payoff_[i]);
+        }
+    }
+
+    PDEResult read_off() const {
+        std::size_t i = bracket_index(S_, p_.S0, 1, 1);
+        if (i + 1 < static_cast<std::size_t>(nS_) && p_.S0 - S_[i] > S_[i + 1] - p_.S0) ++i;
+        const std::size_t j = bracket_index(v_, p_.v0);
+        const double w = std::clamp((p_.v0 - v_[j]) / (v_[j + 1] - v_[j]), 0.0, 1.0);
+        const QuadraticFit f0 = quadratic_fit(S_, &U_[idx(0, static_cast<int>(j))], 1, i, p_.S0);
+        const QuadraticFit f1 = quadratic_fit(S_, &U_[idx(0, static_cast<int>(j) + 1)], 1, i, p_.S0);
+        PDEResult res;
+        res.price = (1.0 - w) * f0.value + w * f1.value;
+        res.delta = (1.0 - w) * f0.d1 + w * f1.d1;
+        res.gamma = (1.0 - w) * f0.d2 + w * f1.d2;
+        return res;
+    }
+
+    ADIProblem p_;
+    const HestonParams& h_;
+    const LeverageGrid* lev_;
+    HestonADIConfig cfg_;
+    int nS_, nv_, nS1_, nv1_;
+    double theta_;
+    bool time_dependent_{false};
+
+    std::vector<double> S_, v_, payoff_;
+    std::vector<double> sl_, sm_, sh_;            // A1, S-fastest
+    std::vector<double> vl_, vm_, vh_;            // A2, shared by all lines
+    std::vector<double> mixed_;                   // ρξLS per S node
+    std::vector<StencilWeights> wS_, wv_;         // first-derivative weights (wv_ scaled by v)
+    TridiagonalFactor v_factor_;
+    double v_lambda_{-1.0};
+
+    std::vector<double> U_, Y_, a0_, a1_, a2_, b0_, b1_, b2_;
+};
+
+PDEResult solve_problem(const ADIProblem& p, const HestonParams& h, const LeverageGrid* lev,
+                        const HestonADIConfig& cfg) {
+    HestonADISolver solver(p, h, lev, cfg);
+    return solver.solve();
+}
+
+} // namespace
+
+PDEResult pde_heston_adi(double S0, double K, double r, double T, OptionType type,
+                         const HestonParams& heston, const LeverageGrid* leverage,
+                         ExerciseStyle style, const BarrierSpec& barrier,
+                         const HestonADIConfig& config) {
+    if (S0 <= 0.0 || K <= 0.0 || T <= 0.0) {
+        throw std::invalid_argument("pde_heston_adi: S0, K and T must be positive");
+    }
+    if (config.num_S < 4 || config.num_v < 4 || config.num_t < 1 || config.v_max <= 0.0) {
+        throw std::invalid_argument("pde_heston_adi: grid too small");
+    }
+    if (heston.kappa <= 0.0 || heston.v0 < 0.0) {
+        throw std::invalid_argument("pde_heston_adi: invalid Heston parameters");
+    }
+
+    ADIProblem p{S0, heston.v0, K, r, T, type, style == ExerciseStyle::American,
+                 false, false, 0.0, 0.0, 0.0};
+    if (barrier.type == BarrierType::None) return solve_problem(p, heston, leverage, config);
+
+    if (barrier.level <= 0.0) throw std::invalid_argument("pde_heston_adi: barrier level must be positive");
+    const bool knock_in = is_knock_in(barrier.type);
+    if (knock_in && p.american) {
+        throw std::invalid_argument("pde_heston_adi: American knock-in options are not supported");
+    }
+    const bool down = is_down_barrier(barrier.type);
+    const bool breached = down ? S0 <= barrier.level : S0 >= barrier.level;
+    if (breached) {
+        if (knock_in) return solve_problem(p, heston, leverage, config);
+        return {barrier.rebate, 0.0, 0.0};
+    }
+
+    ADIProblem ko = p;
+    ko.lower_knockout = down;
+    ko.upper_knockout = !down;
+    ko.barrier = barrier.level;
+    if (!knock_in) {
+        ko.rebate = barrier.rebate;
+        return solve_problem(ko, heston, leverage, config);
+    }
+
+    // in = vanilla - out, where the out leg carries (payoff - rebate) so that the
+    // rebate is paid exactly on the paths that never touch the barrier
+    ko.payoff_shift = barrier.rebate;
+    const PDEResult vanilla = solve_problem(p, heston, leverage, config);
+    const PDEResult out = solve_problem(ko, heston, leverage, config);
+    return {vanilla.price - out.price, vanilla.delta - out.delta, vanilla.gamma - out.gamma};
+}
+
+}
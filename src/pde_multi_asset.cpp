@@ -0,0 +1,388 @@
+#include "pde_multi_asset.hpp"
+#include "tridiagonal.hpp"
+#include "engine_tuning.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+namespace bsm {
+
+namespace {
+
+constexpr int kMaxDim = 3;
+
+class MultiAssetADISolver {
+public:
+    MultiAssetADISolver(const std::vector<double>& S0, const std::vector<double>& sigma,
+                        const std::vector<std::vector<double>>& corr, double r, double T,
+                        const std::vector<double>& weights, double K, OptionType type,
+                        const MultiAssetADIConfig& cfg)
+        : d_(static_cast<int>(S0.size())), S0_(S0), r_(r), T_(T), K_(K),
+          sign_(type == OptionType::Call ? 1.0 : -1.0), cfg_(cfg) {
+        theta_ = (cfg.theta > 0.0) ? cfg.theta : default_adi_theta(cfg.scheme);
+        const int n = (cfg.num_S > 0) ? cfg.num_S : (d_ == 2 ? 160 : 48);
+        stride_[0] = 1;
+        for (int k = 0; k < kMaxDim; ++k) {
+            n_[k] = (k < d_) ? n + 1 : 1;
+            if (k > 0) stride_[k] = stride_[k - 1] * n_[k - 1];
+        }
+        N_ = static_cast<std::size_t>(stride_[kMaxDim - 1]) * n_[kMaxDim - 1];
+
+        for (int k = 0; k < d_; ++k) build_direction(k, sigma[k]);
+        for (int k = 0; k < d_; ++k)
+            for (int l = k + 1; l < d_; ++l)
+                if (corr[k][l] != 0.0) cross_.push_back({k, l, corr[k][l] * sigma[k] * sigma[l]});
+
+        // Interior rows along asset 0 (all other indices interior)
+        const int lo2 = (d_ == 3) ? 1 : 0, hi2 = (d_ == 3) ? n_[2] - 2 : 0;
+        for (int i2 = lo2; i2 <= hi2; ++i2)
+            for (int i1 = 1; i1 <= n_[1] - 2; ++i1) rows_.push_back({i1, i2});
+
+        // Payoff everywhere and the list of Dirichlet (boundary) nodes
+        basket_.resize(N_);
+        for (std::size_t id = 0; id < N_; ++id) {
+            int i[kMaxDim];
+            unpack(id, i);
+            double b = 0.0;
+            bool boundary = false;
+            for (int k = 0; k < d_; ++k) {
+                b += weights[k] * std::exp(x_[k][i[k]]);
+                boundary = boundary || i[k] == 0 || i[k] == n_[k] - 1;
+            }
+            basket_[id] = b;
+            if (boundary) boundary_.push_back(id);
+        }
+    }
+
+    MultiAssetPDEResult solve() {
+        U_.resize(N_);
+        Y_.resize(N_);
+        a0_.assign(N_, 0.0);
+        b0_.assign(N_, 0.0);
+        for (int k = 0; k < d_; ++k) { ak_[k].assign(N_, 0.0); bk_[k].assign(N_, 0.0); }
+        for (std::size_t id = 0; id < N_; ++id) U_[id] = std::max(sign_ * (basket_[id] - K_), 0.0);
+
+        const double dt = T_ / cfg_.num_t;
+        double tau = 0.0;
+        for (int n = 0; n < cfg_.num_t; ++n) {
+            if (n < cfg_.damping_steps) {
+                step(0.5 * dt, tau, 1.0, /*douglas_only=*/true);
+                step(0.5 * dt, tau + 0.5 * dt, 1.0, true);
+            } else {
+                step(dt, tau, theta_, false);
+            }
+            tau += dt;
+        }
+        return read_off();
+    }
+
+private:
+    struct Row { int i1, i2; };
+    struct Cross { int k, l; double coef; };
+
+    void unpack(std::size_t id, int* i) const {
+        for (int k = 0; k < kMaxDim; ++k) {
+            i[k] = static_cast<int>(id % n_[k]);
+            id /= n_[k];
+        }
+    }
+
+    std::size_t row_base(const Row& row) const {
+        return static_cast<std::size_t>(row.i1) * stride_[1] + static_cast<std::size_t>(row.i2) * stride_[2];
+    }
+
+    // ½σ² V_xx + (r - ½σ²) V_x - (r/d) V on a log grid pinned at ln S0
+    void build_direction(int k, double sigma) {
+        const double x0 = std::log(S0_[k]);
+        const double half_width = cfg_.num_std * sigma * std::sqrt(T_);
+        x_[k] = make_sinh_grid(x0 - half_width, x0 + half_width, n_[k] - 1, x0, cfg_.concentration, x0);
+        center_[k] = static_cast<int>(std::min_element(x_[k].begin(), x_[k].end(), [x0](double a, double b) {
+                                          return std::abs(a - x0) < std::abs(b - x0);
+                                      }) - x_[k].begin());
+        op_[k].assign(n_[k], {});
+        w1_[k].assign(n_[k], {});
+        for (int i = 1; i < n_[k] - 1; ++i) {
+            StencilWeights w = convection_diffusion_weights(x_[k], i, 0.5 * sigma * sigma, r_ - 0.5 * sigma * sigma);
+            w.mid -= r_ / d_;
+            op_[k][i] = w;
+            w1_[k][i] = first_derivative_weights(x_[k], i);
+        }
+        if (k == 0) {
+            op0_lo_.assign(n_[0], 0.0); op0_mid_.assign(n_[0], 0.0); op0_hi_.assign(n_[0], 0.0);
+            w0_lo_.assign(n_[0], 0.0); w0_mid_.assign(n_[0], 0.0); w0_hi_.assign(n_[0], 0.0);
+            for (int i = 1; i < n_[0] - 1; ++i) {
+                op0_lo_[i] = op_[0][i].lo; op0_mid_[i] = op_[0][i].mid; op0_hi_[i] = op_[0][i].hi;
+                w0_lo_[i] = w1_[0][i].lo; w0_mid_[i] = w1_[0][i].mid; w0_hi_[i] = w1_[0][i].hi;
+            }
+        }
+    }
+
+    void set_boundary(std::vector<double>& V, double tau) const {
+        const double df = std::exp(-r_ * tau);
+        for (std::size_t id : boundary_) V[id] = std::max(sign_ * (basket_[id] - K_ * df), 0.0);
+    }
+
+    // Directional operator A_k on interior nodes; boundary entries of `out` stay zero
+    void apply_direction(int k, const std::vector<double>& in, std::vector<double>& out) const {
+        const int nrows = static_cast<int>(rows_.size());
+        const std::ptrdiff_t s = stride_[k];
+        #ifdef _OPENMP
+        #pragma omp parallel for schedule(static)
+        #endif
+        for (int r = 0; r < nrows; ++r) {
+            const std::size_t base = row_base(rows_[r]);
+            const double* u = &in[base];
+            double* o = &out[base];
+            if (k == 0) {
+                const double* lo = op0_lo_.data();
+                const double* mid = op0_mid_.data();
+                const double* hi = op0_hi_.data();
+                for (int i = 1; i < n_[0] - 1; ++i) o[i] = lo[i] * u[i - 1] + mid[i] * u[i] + hi[i] * u[i + 1];
+            } else {
+                const StencilWeights w = op_[k][k == 1 ? rows_[r].i1 : rows_[r].i2];
+                for (int i = 1; i < n_[0] - 1; ++i) o[i] = w.lo * u[i - s] + w.mid * u[i] + w.hi * u[i + s];
+            }
+        }
+    }
+
+    // Explicit cross-derivative operator A0. Pairs with asset 0 read the asset-0
+    // weights as separate arrays; other pairs have constant weights along the row,
+    // so both inner loops vectorise.
+    void apply_cross(const std::vector<double>& in, std::vector<double>& out) const {
+        const int nrows = static_cast<int>(rows_.size());
+        const int n0 = n_[0];
+        #ifdef _OPENMP
+        #pragma omp parallel for schedule(static)
+        #endif
+        for (int r = 0; r < nrows; ++r) {
+            const std::size_t base = row_base(rows_[r]);
+            const int idx_other[kMaxDim] = {0, rows_[r].i1, rows_[r].i2};
+            double* o = &out[base];
+            for (int i = 1; i < n0 - 1; ++i) o[i] = 0.0;
+            for (const Cross& c : cross_) {
+                const std::ptrdiff_t sl = stride_[c.l];
+                const StencilWeights wl = w1_[c.l][idx_other[c.l]];
+                const double wlv[3] = {c.coef * wl.lo, c.coef * wl.mid, c.coef * wl.hi};
+                if (c.k == 0) {
+                    const double* lo = w0_lo_.data();
+                    const double* mid = w0_mid_.data();
+                    const double* hi = w0_hi_.data();
+                    for (int b = 0; b < 3; ++b) {
+                        const double* v = &in[base] + (b - 1) * sl;
+                        const double wb = wlv[b];
+                        for (int i = 1; i < n0 - 1; ++i)
+                            o[i] += wb * (lo[i] * v[i - 1] + mid[i] * v[i] + hi[i] * v[i + 1]);
+                    }
+                } else {
+                    const std::ptrdiff_t sk = stride_[c.k];
+                    const StencilWeights wk = w1_[c.k][idx_other[c.k]];
+                    const double wkv[3] = {wk.lo, wk.mid, wk.hi};
+                    for (int b = 0; b < 3; ++b) {
+                        for (int a = 0; a < 3; ++a) {
+                            const double* v = &in[base] + (b - 1) * sl + (a - 1) * sk;
+                            const double w = wlv[b] * wkv[a];
+                            for (int i = 1; i < n0 - 1; ++i) o[i] += w * v[i];
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    void refactor(double lambda) {
+        if (lambda == lambda_) return;
+        for (int k = 0; k < d_; ++k) {
+            const int n = n_[k];
+            std::vector<double> a(n, 0.0), b(n, 1.0), c(n, 0.0);
+            for (int i = 1; i < n - 1; ++i) {
+                a[i] = -lambda * op_[k][i].lo;
+                b[i] = 1.0 - lambda * op_[k][i].mid;
+                c[i] = -lambda * op_[k][i].hi;
+            }
+            factor_[k].factor(a, b, c);
+        }
+        lambda_ = lambda;
+    }
+
+    // (I - λ A_k) Y = d along every line of asset k; boundary nodes are reset afterwards
+    void solve_direction(int k, std::vector<double>& d, double tau_new) const {
+        set_boundary(d, tau_new);
+        const int n = n_[k];
+        if (k == 0) {
+            const int lines = static_cast<int>(N_ / n);
+            const int block = engine_tuning().basket_line_block;   // lines per transposed block
+            const int num_blocks = (lines + block - 1) / block;
+            #ifdef _OPENMP
+            #pragma omp parallel for schedule(static)
+            #endif
+            for (int blk = 0; blk < num_blocks; ++blk) {
+                const int l0 = blk * block;
+                const int m = std::min(block, lines - l0);
+                std::vector<double> buf(static_cast<std::size_t>(n) * block);
+                for (int l = 0; l < m; ++l) {
+                    const double* src = &d[static_cast<std::size_t>(l0 + l) * n];
+                    for (int i = 0; i < n; ++i) buf[static_cast<std::size_t>(i) * block + l] = src[i];
+                }
+                factor_[0].solve(buf.data(), m, block);
+                for (int l = 0; l < m; ++l) {
+                    double* dst = &d[static_cast<std::size_t>(l0 + l) * n];
+                    for (int i = 0; i < n; ++i) dst[i] = buf[static_cast<std::size_t>(i) * block + l];
+                }
+            }
+        } else {
+            const std::ptrdiff_t s = stride_[k];
+            const int outer = static_cast<int>(N_ / (static_cast<std::size_t>(s) * n));
+            const int chunk = engine_tuning().basket_column_chunk;   // interleaved lines per task
+            const int chunks = static_cast<int>((s + chunk - 1) / chunk);
+            double* base = d.data();
+            #ifdef _OPENMP
+            #pragma omp parallel for schedule(static)
+            #endif
+            for (int t = 0; t < outer * chunks; ++t) {
+                const int o = t / chunks;
+                const std::ptrdiff_t l0 = static_cast<std::ptrdiff_t>(t % chunks) * chunk;
+                const int m = static_cast<int>(std::min<std::ptrdiff_t>(chunk, s - l0));
+                factor_[k].solve(base + static_cast<std::ptrdiff_t>(o) * s * n + l0, m, s);
+            }
+        }
+        set_boundary(d, tau_new);
+    }
+
+    // One ADI step from tau to tau + dt; douglas_only stops after the first stage set
+    void step(double dt, double tau, double th, bool douglas_only) {
+        const double tau_new = tau + dt;
+        const double ld = th * dt;
+        refactor(ld);
+        const long N = static_cast<long>(N_);
+
+        apply_cross(U_, a0_);
+        for (int k = 0; k < d_; ++k) apply_direction(k, U_, ak_[k]);
+        #ifdef _OPENMP
+        #pragma omp parallel for schedule(static)
+        #endif
+        for (long id = 0; id < N; ++id) {
+            double aU = a0_[id];
+            for (int k = 0; k < d_; ++k) aU += ak_[k][id];
+            Y_[id] = U_[id] + dt * aU - ld * ak_[0][id];
+        }
+        for (int k = 0; k < d_; ++k) {
+            if (k > 0)
+                for (long id = 0; id < N; ++id) Y_[id] -= ld * ak_[k][id];
+            solve_direction(k, Y_, tau_new);
+        }
+        if (douglas_only) { U_.swap(Y_); return; }
+
+        const ADIScheme s = cfg_.scheme;
+        apply_cross(Y_, b0_);
+        if (s != ADIScheme::CraigSneyd)
+            for (int k = 0; k < d_; ++k) apply_direction(k, Y_, bk_[k]);
+        #ifdef _OPENMP
+        #pragma omp parallel for schedule(static)
+        #endif
+        for (long id = 0; id < N; ++id) {
+            double aU = a0_[id], bY = b0_[id];
+            for (int k = 0; k < d_; ++k) { aU += ak_[k][id]; bY += bk_[k][id]; }
+            double z = U_[id] + dt * aU;
+            if (s == ADIScheme::CraigSneyd) {
+                z += 0.5 * dt * (b0_[id] - a0_[id]);
+            } else if (s == ADIScheme::ModifiedCraigSneyd) {
+                z += th * dt * (b0_[id] - a0_[id]) + (0.5 - th) * dt * (bY - aU);
+            } else {
+                z += 0.5 * dt * (bY - aU);
+            }
+            Y_[id] = z - ld * ((s == ADIScheme::HundsdorferVerwer) ? bk_[0][id] : ak_[0][id]);
+        }
+        for (int k = 0; k < d_; ++k) {
+            const std::vector<double>& corr = (s == ADIScheme::HundsdorferVerwer) ? bk_[k] : ak_[k];
+            if (k > 0)
+                for (long id = 0; id < N; ++id) Y_[id] -= ld * corr[id];
+            solve_direction(k, Y_, tau_new);
+        }
+        U_.swap(Y_);
+    }
+
+    MultiAssetPDEResult read_off() const {
+        std::size_t c = 0;
+        for (int k = 0; k < d_; ++k) c += static_cast<std::size_t>(center_[k]) * stride_[k];
+        MultiAssetPDEResult res;
+        res.price = U_[c];
+        for (int k = 0; k < d_; ++k) {
+            const double* line = &U_[c - static_cast<std::size_t>(center_[k]) * stride_[k]];
+            const int ic = std::clamp(center_[k], 1, n_[k] - 2);
+            const double x0 = std::log(S0_[k]);
+            const QuadraticFit q = quadratic_fit(x_[k], line, stride_[k], ic, x0);
+            res.delta.push_back(q.d1 / S0_[k]);
+            res.gamma.push_back((q.d2 - q.d1) / (S0_[k] * S0_[k]));
+        }
+        return res;
+    }
+
+    int d_;
+    std::vector<double> S0_;
+    double r_, T_, K_, sign_;
+    MultiAssetADIConfig cfg_;
+    double theta_;
+    int n_[kMaxDim];
+    std::ptrdiff_t stride_[kMaxDim];
+    std::size_t N_;
+    int center_[kMaxDim] = {0, 0, 0};
+
+    std::vector<double> x_[kMaxDim];
+    std::vector<StencilWeights> op_[kMaxDim];   // directional operators (rows 0, n-1 unused)
+    std::vector<StencilWeights> w1_[kMaxDim];   // first-derivative weights for cross terms
+    std::vector<double> op0_lo_, op0_mid_, op0_hi_;   // asset-0 operator and weights as arrays
+    std::vector<double> w0_lo_, w0_mid_, w0_hi_;
+    std::vector<Cross> cross_;
+    std::vector<Row> rows_;
+    std::vector<double> basket_;
+    std::vector<std::size_t> boundary_;
+    TridiagonalFactor factor_[kMaxDim];
+    double lambda_{-1.0};
+
+    std::vector<double> U_, Y_, a0_, b0_;
+    std::vector<double> ak_[kMaxDim], bk_[kMaxDim];
+};
+
+} // namespace
+
+MultiAssetPDEResult pde_multi_asset_adi(const std::vector<double>& S0,
+                                        const std::vector<double>& sigma,
+                                        const std::vector<std::vector<double>>& correlation,
+                                        double r, double T,
+                                        const std::vector<double>& weights, double K,
+                                        OptionType type,
+                                        const MultiAssetADIConfig& config) {
+    const std::size_t d = S0.size();
+    if (d < 2 || d > static_cast<std::size_t>(kMaxDim)) {
+        throw std::invalid_argument("pde_multi_asset_adi: only 2 or 3 assets are supported");
+    }
+    if (sigma.size() != d || weights.size() != d || correlation.size() != d) {
+        throw std::invalid_argument("pde_multi_asset_adi: inconsistent input sizes");
+    }
+    for (std::size_t k = 0; k < d; ++k) {
+        if (S0[k] <= 0.0 || sigma[k] <= 0.0 || correlation[k].size() != d) {
+            throw std::invalid_argument("pde_multi_asset_adi: invalid spot, volatility or correlation row");
+        }
+        for (std::size_t l = 0; l < d; ++l) {
+            const double rho = correlation[k][l];
+            if (std::abs(rho) > 1.0 || rho != correlation[l][k] || (k == l && rho != 1.0)) {
+                throw std::invalid_argument("pde_multi_asset_adi: correlation must be a symmetric unit-diagonal matrix");
+            }
+        }
+    }
+    if (d == 3) {
+        const double a = correlation[0][1], b = correlation[0][2], c = correlation[1][2];
+        if (1.0 + 2.0 * a * b * c - a * a - b * b - c * c < 0.0) {
+            throw std::invalid_argument("pde_multi_asset_adi: correlation matrix is not positive semi-definite");
+        }
+    }
+    if (T <= 0.0 || config.num_t < 1 || (config.num_S != 0 && config.num_S < 4)) {
+        throw std::invalid_argument("pde_multi_asset_adi: invalid maturity or grid size");
+    }
+
+    MultiAssetADISolver solver(S0, sigma, correlation, r, T, weights, K, type, config);
+    return solver.solve();
+}
+
+}
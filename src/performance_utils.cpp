@@ -7,6 +7,8 @@
  */
 
 #include "performance_utils.hpp"
+#include "engine_tuning.hpp"
+#include "accuracy_harness.hpp"
 #include <iostream>
 #include <fstream>
 #include <sstream>
@@ -158,9 +160,11 @@ bool ArchitectureOptimizer::validate_numerical_accuracy(double tolerance) {
             return false;
         }
         
-        if (x > 0) {
+        // exp overflows beyond ~709, and near zero exp(x) keeps only the
+        // leading digits of x, so the round trip is compared in absolute terms
+        if (x > 0 && x < 700.0) {
             double log_exp = std::log(std::exp(x));
-            if (std::abs(log_exp - x) > tolerance * std::abs(x)) {
+            if (std::abs(log_exp - x) > tolerance * std::max(1.0, std::abs(x))) {
                 return false;
             }
         }
@@ -184,7 +188,9 @@ bool ArchitectureOptimizer::validate_numerical_accuracy(double tolerance) {
         return false;
     }
     
-    return true;
+    // End to end: every engine against its closed form, parity or second method
+    const auto engines = run_accuracy_harness();
+    return std::all_of(engines.begin(), engines.end(), [](const EngineAccuracy& e) { return e.passed(); });
 }
 
 std::vector<std::string> ArchitectureOptimizer::get_optimization_recommendations() {
@@ -305,29 +311,51 @@ void ArchitectureOptimizer::detect_cache_info(ArchitectureInfo& info) {
 }
 
 void ArchitectureOptimizer::detect_instruction_sets(ArchitectureInfo& info) {
+    info.has_sse42 = false;
     info.has_avx = false;
     info.has_avx2 = false;
     info.has_fma = false;
+    info.has_avx512f = false;
+    info.has_avx512dq = false;
+    info.has_avx512vl = false;
 
 #if defined(__x86_64__) || defined(_M_X64) || defined(__i386) || defined(_M_IX86)
-    int cpu_info[4];
-    
+    unsigned int ecx1 = 0, ebx7 = 0;
+    unsigned long long xcr0 = 0;
+
 #ifdef _WIN32
+    int cpu_info[4];
     __cpuid(cpu_info, 1);
-    info.has_avx = (cpu_info[2] & (1 << 28)) != 0;
-    info.has_fma = (cpu_info[2] & (1 << 12)) != 0;
-    
-    __cpuid(cpu_info, 7);
-    info.has_avx2 = (cpu_info[1] & (1 << 5)) != 0;
+    ecx1 = static_cast<unsigned int>(cpu_info[2]);
+    if (ecx1 & (1u << 27)) xcr0 = _xgetbv(0);
+
+    __cpuidex(cpu_info, 7, 0);
+    ebx7 = static_cast<unsigned int>(cpu_info[1]);
 #elif defined(__GNUC__)
-    unsigned int eax, ebx, ecx, edx;
-    __get_cpuid(1, &eax, &ebx, &ecx, &edx);
-    info.has_avx = (ecx & (1 << 28)) != 0;
-    info.has_fma = (ecx & (1 << 12)) != 0;
-    
-    __get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx);
-    info.has_avx2 = (ebx & (1 << 5)) != 0;
+    // A leaf the CPU does not report leaves the registers zero: feature absent
+    unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+    if (__get_cpuid(1, &eax, &ebx, &ecx, &edx)) ecx1 = ecx;
+    if (ecx1 & (1u << 27)) {
+        // OSXSAVE: read XCR0 to see which register states the OS saves
+        unsigned int lo, hi;
+        __asm__ volatile("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+        xcr0 = (static_cast<unsigned long long>(hi) << 32) | lo;
+    }
+
+    eax = ebx = ecx = edx = 0;
+    if (__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) ebx7 = ebx;
 #endif
+
+    const bool os_avx = (xcr0 & 0x6) == 0x6;           // XMM and YMM state
+    const bool os_avx512 = (xcr0 & 0xe6) == 0xe6;      // plus opmask and ZMM state
+
+    info.has_sse42 = (ecx1 & (1u << 20)) != 0;
+    info.has_avx = os_avx && (ecx1 & (1u << 28)) != 0;
+    info.has_fma = os_avx && (ecx1 & (1u << 12)) != 0;
+    info.has_avx2 = os_avx && (ebx7 & (1u << 5)) != 0;
+    info.has_avx512f = os_avx512 && (ebx7 & (1u << 16)) != 0;
+    info.has_avx512dq = os_avx512 && (ebx7 & (1u << 17)) != 0;
+    info.has_avx512vl = os_avx512 && (ebx7 & (1u << 31)) != 0;
 #endif
 }
 
@@ -336,7 +364,7 @@ void ArchitectureOptimizer::detect_numa_topology(ArchitectureInfo& info) {
     info.numa_nodes = 1;
     info.cpu_topology.clear();
 
-#ifdef __linux__
+#if defined(__linux__) && defined(USE_NUMA)
     // Check if NUMA is available
     if (numa_available() >= 0) {
         info.has_numa = true;
@@ -404,20 +432,22 @@ bool ThreadManager::set_cpu_affinity(const std::vector<int>& cpu_list) {
 }
 
 bool ThreadManager::set_numa_policy(int policy, const std::vector<int>& nodes) {
-#ifdef __linux__
+#if defined(__linux__) && defined(USE_NUMA)
+    (void)policy;  // Suppress unused parameter warning
     if (numa_available() < 0) return false;
     
+    // Both libnuma calls return void and report failures through numa_error()
     if (nodes.empty()) {
-        return numa_set_localalloc() == 0;
+        numa_set_localalloc();
     } else {
         struct bitmask* nodemask = numa_allocate_nodemask();
         for (int node : nodes) {
             numa_bitmask_setbit(nodemask, node);
         }
-        int result = numa_set_membind(nodemask);
+        numa_set_membind(nodemask);
         numa_free_nodemask(nodemask);
-        return result == 0;
     }
+    return true;
 #elif defined(_WIN32)
     // Windows NUMA implementation
     (void)policy;  // Suppress unused parameter warning
@@ -444,6 +474,11 @@ bool ThreadManager::set_numa_policy(int policy, const std::vector<int>& nodes) {
 }
 
 int ThreadManager::get_optimal_thread_count(const std::string& workload_type) {
+    if ((workload_type == "compute" || workload_type == "cpu") && engine_tuning().threads > 0) {
+        // Measured on this machine by tune_engines
+        return engine_tuning().threads;
+    }
+
     auto arch_info = ArchitectureOptimizer::detect_architecture();
     
     if (workload_type == "compute" || workload_type == "cpu") {
@@ -674,7 +709,7 @@ double MemoryProfiler::estimate_cache_performance() {
 }
 
 void MemoryProfiler::configure_numa_allocation() {
-#ifdef __linux__
+#if defined(__linux__) && defined(USE_NUMA)
     if (numa_available() >= 0) {
         // Set default NUMA policy to local allocation
         numa_set_localalloc();
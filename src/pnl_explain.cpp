@@ -0,0 +1,258 @@
+/**
+ * @file pnl_explain.cpp
+ * @brief Taylor coefficients, vectorised explain and sampled residual
+ *
+ * @author LN697
+ * @version 1.0
+ */
+
+#include "pnl_explain.hpp"
+#include "analytic_bs.hpp"
+#include "math_utils.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <stdexcept>
+
+namespace bsm {
+
+namespace {
+
+constexpr double kVolBump = 1e-2;    // Central volatility bump of numerical groups
+constexpr double kRateBump = 1e-4;   // Central rate bump of numerical groups
+
+// Fused closed form: d1, d2 and phi(d1) feed all eight values
+void analytic_coefficients(const PositionSpec& p, double r, TaylorCoefficients& c, std::size_t i) {
+    const double S = p.spot, K = p.strike, T = p.T, sigma = p.sigma;
+    if (T <= 0.0 || sigma <= 0.0 || S <= 0.0 || K <= 0.0) {
+        c.price[i] = black_scholes_price(S, K, r, T, sigma, p.type);
+        c.delta[i] = black_scholes_delta(S, K, r, T, sigma, p.type);
+        c.gamma[i] = black_scholes_gamma(S, K, r, T, sigma);
+        c.vega[i] = black_scholes_vega(S, K, r, T, sigma);
+        c.vanna[i] = 0.0;
+        c.volga[i] = 0.0;
+        c.theta[i] = black_scholes_theta(S, K, r, T, sigma, p.type);
+        c.rho[i] = black_scholes_rho(S, K, r, T, sigma, p.type);
+        return;
+    }
+
+    const double sqrt_T = std::sqrt(T);
+    const double vol_sqrt_T = sigma * sqrt_T;
+    const double d1 = (std::log(S / K) + (r + 0.5 * sigma * sigma) * T) / vol_sqrt_T;
+    const double d2 = d1 - vol_sqrt_T;
+    const double phi = norm_pdf(d1);
+    const double Kdisc = K * std::exp(-r * T);
+    const double vega = S * phi * sqrt_T;
+    const double decay = -S * phi * sigma / (2.0 * sqrt_T);
+
+    if (p.type == OptionType::Call) {
+        const double Nd1 = norm_cdf(d1), Nd2 = norm_cdf(d2);
+        c.price[i] = S * Nd1 - Kdisc * Nd2;
+        c.delta[i] = Nd1;
+        c.theta[i] = decay - r * Kdisc * Nd2;
+        c.rho[i] = T * Kdisc * Nd2;
+    } else {
+        const double Nmd1 = norm_cdf(-d1), Nmd2 = norm_cdf(-d2);
+        c.price[i] = Kdisc * Nmd2 - S * Nmd1;
+        c.delta[i] = -Nmd1;
+        c.theta[i] = decay + r * Kdisc * Nmd2;
+        c.rho[i] = -T * Kdisc * Nmd2;
+    }
+    c.gamma[i] = phi / (S * vol_sqrt_T);
+    c.vega[i] = vega;
+    c.vanna[i] = -phi * d2 / sigma;
+    c.volga[i] = vega * d1 * d2 / sigma;
+}
+
+// Base valuation of a numerical group plus its vol and rate bumps; members
+// are disjoint across groups, so groups may run concurrently
+void numerical_coefficients(const std::vector<PositionSpec>& positions, const PricingGroup& g,
+                            const PortfolioPricingConfig& config, std::vector<PositionValuation> (&runs)[5],
+                            TaylorCoefficients& c) {
+    price_pricing_group(positions, g, config, runs[0]);
+
+    // Monte Carlo streams depend on the underlying only, so all runs share them
+    const double h = std::min(kVolBump, 0.5 * g.sigma);
+    PricingGroup up = g, down = g;
+    up.sigma += h;
+    down.sigma -= h;
+    price_pricing_group(positions, up, config, runs[1]);
+    price_pricing_group(positions, down, config, runs[2]);
+
+    PortfolioPricingConfig r_up = config, r_down = config;
+    r_up.r += kRateBump;
+    r_down.r -= kRateBump;
+    price_pricing_group(positions, g, r_up, runs[3]);
+    price_pricing_group(positions, g, r_down, runs[4]);
+
+    for (std::size_t i : g.members) {
+        const PositionValuation& v = runs[0][i];
+        c.price[i] = v.price;
+        c.delta[i] = v.delta;
+        c.gamma[i] = v.gamma;
+        c.vega[i] = v.vega;
+        c.theta[i] = v.theta;
+        if (h > 0.0) {
+            c.vanna[i] = (runs[1][i].delta - runs[2][i].delta) / (2.0 * h);
+            c.volga[i] = (runs[1][i].vega - runs[2][i].vega) / (2.0 * h);
+        } else {
+            c.vanna[i] = c.volga[i] = 0.0;
+        }
+        c.rho[i] = (runs[3][i].price - runs[4][i].price) / (2.0 * kRateBump);
+    }
+}
+
+} // namespace
+
+PnlExplainer::PnlExplainer(std::vector<PositionSpec> positions, const PortfolioPricingConfig& config)
+    : positions_(std::move(positions)), config_(config) {
+    if (positions_.empty()) throw std::invalid_argument("PnlExplainer: empty book");
+    const auto start = std::chrono::steady_clock::now();
+
+    const std::size_t n = positions_.size();
+    auto& c = coefficients_;
+    for (auto* column : {&c.price, &c.delta, &c.gamma, &c.vega, &c.vanna, &c.volga, &c.theta, &c.rho, &c.quantity})
+        column->resize(n);
+    c.underlying.resize(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        const auto& p = positions_[i];
+        auto it = underlying_index_.find(p.underlying);
+        if (it == underlying_index_.end()) {
+            it = underlying_index_.emplace(p.underlying, static_cast<std::uint32_t>(underlyings_.size())).first;
+            underlyings_.push_back(p.underlying);
+        }
+        c.underlying[i] = it->second;
+        c.quantity[i] = p.quantity;
+    }
+
+    const long count = static_cast<long>(n);
+    #ifdef _OPENMP
+    #pragma omp parallel for schedule(static)
+    #endif
+    for (long i = 0; i < count; ++i) {
+        if (positions_[i].model == PricingModel::Analytic) analytic_coefficients(positions_[i], config_.r, c, i);
+    }
+
+    // Numerical positions by group, with the groups of price_portfolio
+    const std::vector<PricingGroup> groups = plan_pricing_groups(positions_, config_);
+    std::vector<PositionValuation> runs[5];
+    for (auto& run : runs) run.resize(n);
+    const long num_groups = static_cast<long>(groups.size());
+    #ifdef _OPENMP
+    #pragma omp parallel for schedule(dynamic)
+    #endif
+    for (long gi = 0; gi < num_groups; ++gi) {
+        if (groups[gi].model == PricingModel::PDE)
+            numerical_coefficients(positions_, groups[gi], config_, runs, c);
+    }
+    // Monte Carlo groups parallelise internally
+    for (long gi = 0; gi < num_groups; ++gi) {
+        if (groups[gi].model == PricingModel::MonteCarlo)
+            numerical_coefficients(positions_, groups[gi], config_, runs, c);
+    }
+
+    setup_ms_ = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+PnlExplain PnlExplainer::explain(const MarketMove& move, std::size_t residual_sample, unsigned long seed) const {
+    if (move.dt < 0.0) throw std::invalid_argument("PnlExplainer::explain: dt must be non-negative");
+    const auto start = std::chrono::steady_clock::now();
+
+    // Moves per underlying, gathered by index inside the loop
+    std::vector<double> dS(underlyings_.size(), 0.0), dv(underlyings_.size(), 0.0);
+    auto scatter = [this](const std::map<std::string, double>& changes, std::vector<double>& out) {
+        for (const auto& [name, change] : changes) {
+            const auto it = underlying_index_.find(name);
+            if (it == underlying_index_.end())
+                throw std::invalid_argument("PnlExplainer::explain: unknown underlying " + name);
+            out[it->second] = change;
+        }
+    };
+    scatter(move.spot, dS);
+    scatter(move.vol, dv);
+
+    const auto& c = coefficients_;
+    const std::size_t n = positions_.size();
+    const double dr = move.rate, dt = move.dt;
+    PnlExplain result;
+    result.positions.resize(n);
+    double delta = 0.0, gamma = 0.0, vega = 0.0, vanna = 0.0, volga = 0.0, theta = 0.0, rho = 0.0;
+
+    // Branch-free over columns, so the compiler vectorises it
+    const double* q = c.quantity.data();
+    const std::uint32_t* u = c.underlying.data();
+    double* pnl = result.positions.data();
+    const long count = static_cast<long>(n);
+    #ifdef _OPENMP
+    #pragma omp parallel for schedule(static) reduction(+ : delta, gamma, vega, vanna, volga, theta, rho)
+    #endif
+    for (long i = 0; i < count; ++i) {
+        const double s = dS[u[i]], v = dv[u[i]];
+        const double t_delta = q[i] * c.delta[i] * s;
+        const double t_gamma = 0.5 * q[i] * c.gamma[i] * s * s;
+        const double t_vega = q[i] * c.vega[i] * v;
+        const double t_vanna = q[i] * c.vanna[i] * s * v;
+        const double t_volga = 0.5 * q[i] * c.volga[i] * v * v;
+        const double t_theta = q[i] * c.theta[i] * dt;
+        const double t_rho = q[i] * c.rho[i] * dr;
+        delta += t_delta;
+        gamma += t_gamma;
+        vega += t_vega;
+        vanna += t_vanna;
+        volga += t_volga;
+        theta += t_theta;
+        rho += t_rho;
+        pnl[i] = t_delta + t_gamma + t_vega + t_vanna + t_volga + t_theta + t_rho;
+    }
+    result.delta = delta;
+    result.gamma = gamma;
+    result.vega = vega;
+    result.vanna = vanna;
+    result.volga = volga;
+    result.theta = theta;
+    result.rho = rho;
+    result.elapsed_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    if (residual_sample == 0) return result;
+
+    // Random sample without replacement (partial Fisher-Yates)
+    const std::size_t k = std::min(residual_sample, n);
+    std::vector<std::size_t> order(n);
+    for (std::size_t i = 0; i < n; ++i) order[i] = i;
+    RNG rng(seed);
+    for (std::size_t i = 0; i < k; ++i) {
+        const std::size_t j = i + std::min(n - i - 1, static_cast<std::size_t>(rng.uni() * (n - i)));
+        std::swap(order[i], order[j]);
+    }
+    order.resize(k);
+    std::sort(order.begin(), order.end());
+
+    // Before and after are priced on the same sample, so grid and path
+    // choices that depend on the group cancel out of the difference
+    std::vector<PositionSpec> before(k), after(k);
+    for (std::size_t j = 0; j < k; ++j) {
+        const std::size_t i = order[j];
+        before[j] = positions_[i];
+        after[j] = positions_[i];
+        after[j].spot += dS[c.underlying[i]];
+        after[j].sigma = std::max(0.0, after[j].sigma + dv[c.underlying[i]]);
+        after[j].T = std::max(0.0, after[j].T - dt);
+    }
+    PortfolioPricingConfig moved = config_;
+    moved.r += dr;
+    const PortfolioValuation base = price_portfolio(before, config_);
+    const PortfolioValuation revalued = price_portfolio(after, moved);
+
+    for (std::size_t j = 0; j < k; ++j) {
+        const std::size_t i = order[j];
+        const double actual = positions_[i].quantity * (revalued.positions[j].price - base.positions[j].price);
+        result.sample_actual += actual;
+        result.sample_explained += pnl[i];
+        result.max_abs_residual = std::max(result.max_abs_residual, std::abs(actual - pnl[i]));
+    }
+    result.sampled = k;
+    result.residual_estimate = (result.sample_actual - result.sample_explained) * static_cast<double>(n) / k;
+    return result;
+}
+
+}
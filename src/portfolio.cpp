@@ -0,0 +1,580 @@
+#include "portfolio.hpp"
+#include "analytic_bs.hpp"
+#include "isa_dispatch.hpp"
+#include "math_utils.hpp"
+#include "shm_cache.hpp"
+#include "tridiagonal.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace bsm {
+
+namespace {
+
+// Pays max(sign * (S - K), 0): sign = +1 for calls, -1 for puts
+inline double option_sign(OptionType type) { return type == OptionType::Call ? 1.0 : -1.0; }
+
+// Distinct (strike, type) contracts of a group; members map onto columns so
+// that duplicated contracts are valued once and scattered back afterwards.
+struct GroupColumns {
+    std::vector<double> strike;
+    std::vector<double> sign;
+    std::vector<std::size_t> column_of_member;
+    double K_min{0.0}, K_max{0.0};
+};
+
+GroupColumns build_columns(const PricingGroup& g, const std::vector<PositionSpec>& positions) {
+    // Gather the keys once so the sort does not chase members through the book
+    struct Contract { double strike, sign; std::size_t member; };
+    const std::size_t n = g.members.size();
+    std::vector<Contract> order(n);
+    for (std::size_t m = 0; m < n; ++m) {
+        const auto& p = positions[g.members[m]];
+        order[m] = Contract{p.strike, option_sign(p.type), m};
+    }
+    std::sort(order.begin(), order.end(), [](const Contract& x, const Contract& y) {
+        return x.strike != y.strike ? x.strike < y.strike : x.sign < y.sign;
+    });
+
+    GroupColumns cols;
+    cols.column_of_member.resize(n);
+    for (const Contract& c : order) {
+        if (cols.strike.empty() || c.strike != cols.strike.back() || c.sign != cols.sign.back()) {
+            cols.strike.push_back(c.strike);
+            cols.sign.push_back(c.sign);
+        }
+        cols.column_of_member[c.member] = cols.strike.size() - 1;
+    }
+    cols.K_min = cols.strike.front();
+    cols.K_max = cols.strike.back();
+    return cols;
+}
+
+void scatter_columns(const PricingGroup& g, const GroupColumns& cols,
+                     const std::vector<PositionValuation>& values, std::vector<PositionValuation>& out) {
+    for (std::size_t m = 0; m < g.members.size(); ++m) out[g.members[m]] = values[cols.column_of_member[m]];
+}
+
+// Shared-cache key of a grid or MC group: market inputs, every column's
+// contract and the engine settings; each column is then one entry
+CacheKey group_cache_key(const char* engine, const PricingGroup& g, const GroupColumns& cols, double r) {
+    CacheKey key(engine);
+    key.add(r).add(g.spot).add(g.T).add(g.sigma).add(static_cast<long long>(cols.strike.size()));
+    for (std::size_t m = 0; m < cols.strike.size(); ++m) key.add(cols.strike[m]).add(cols.sign[m]);
+    return key;
+}
+
+constexpr int kCachedFields = 6;
+
+// All columns or nothing, so a group is never half stale
+bool load_cached_columns(SharedPricingCache& cache, const CacheKey& group, std::size_t nK,
+                         std::vector<PositionValuation>& values) {
+    values.resize(nK);
+    double v[kCachedFields];
+    for (std::size_t m = 0; m < nK; ++m) {
+        CacheKey key = group;
+        if (cache.lookup(key.add(static_cast<long long>(m)), v, kCachedFields) != kCachedFields) return false;
+        values[m] = PositionValuation{v[0], v[1], v[2], v[3], v[4], v[5]};
+    }
+    return true;
+}
+
+void store_cached_columns(SharedPricingCache& cache, const CacheKey& group,
+                          const std::vector<PositionValuation>& values) {
+    for (std::size_t m = 0; m < values.size(); ++m) {
+        const auto& x = values[m];
+        const double v[kCachedFields] = {x.price, x.delta, x.gamma, x.vega, x.theta, x.std_error};
+        CacheKey key = group;
+        cache.store(key.add(static_cast<long long>(m)), v, kCachedFields);
+    }
+}
+
+void price_group_analytic(const PricingGroup& g, const std::vector<PositionSpec>& positions,
+                          double r, std::vector<PositionValuation>& out) {
+    const double S = g.spot, T = g.T, sigma = g.sigma;
+    if (T <= 0.0 || sigma <= 0.0 || S <= 0.0) {
+        for (std::size_t idx : g.members) {
+            const auto& p = positions[idx];
+            auto& v = out[idx];
+            v.price = black_scholes_price(S, p.strike, r, T, sigma, p.type);
+            v.delta = black_scholes_delta(S, p.strike, r, T, sigma, p.type);
+            v.gamma = black_scholes_gamma(S, p.strike, r, T, sigma);
+            v.vega = black_scholes_vega(S, p.strike, r, T, sigma);
+            v.theta = black_scholes_theta(S, p.strike, r, T, sigma, p.type);
+        }
+        return;
+    }
+
+    // The dispatched kernel hoists everything that does not depend on the strike
+    const GroupColumns cols = build_columns(g, positions);
+    const std::size_t nK = cols.strike.size();
+    std::vector<double> greeks(5 * nK);
+    double* price = greeks.data();
+    double* delta = price + nK;
+    double* gamma = delta + nK;
+    double* vega = gamma + nK;
+    double* theta = vega + nK;
+    active_kernels().black_scholes_greeks(nK, S, r, T, sigma, cols.strike.data(), cols.sign.data(), price, delta,
+                                          gamma, vega, theta);
+    std::vector<PositionValuation> values(nK);
+    for (std::size_t c = 0; c < nK; ++c) values[c] = PositionValuation{price[c], delta[c], gamma[c], vega[c], theta[c]};
+    scatter_columns(g, cols, values, out);
+}
+
+// Crank-Nicolson march of several European payoffs on one uniform grid.
+// V is row-major with the strike index fastest, (N+1) x nK, so the strikes
+// are interleaved right-hand sides of one factorised Thomas sweep.
+void cn_march_columns(double S_max, int N, int n_steps, double r, double T, double sigma,
+                      const std::vector<double>& K, const std::vector<double>& sign,
+                      std::vector<double>& V) {
+    const std::size_t nK = K.size();
+    const double dS = S_max / N;
+    const double dt = T / n_steps;
+
+    V.assign(static_cast<std::size_t>(N + 1) * nK, 0.0);
+    for (int i = 0; i <= N; ++i) {
+        const double S = i * dS;
+        double* row = &V[i * nK];
+        for (std::size_t m = 0; m < nK; ++m) row[m] = std::max(sign[m] * (S - K[m]), 0.0);
+    }
+
+    // Coefficients and factorisation are independent of the strike and time.
+    // Interior row i (system row i - 1) reads -a x[i-1] + b x[i] + c x[i+1].
+    std::vector<double> a(N + 1), b(N + 1), c(N + 1);
+    for (int i = 1; i < N; ++i) {
+        const double s2i2 = sigma * sigma * i * i;
+        a[i] = 0.25 * dt * (s2i2 - r * i);
+        b[i] = 1.0 + 0.5 * dt * (s2i2 + r);
+        c[i] = 0.25 * dt * (-s2i2 - r * i);
+    }
+    std::vector<double> lower(N - 1), diag(N - 1), upper(N - 1);
+    for (int i = 1; i < N; ++i) {
+        lower[i - 1] = -a[i];
+        diag[i - 1] = b[i];
+        upper[i - 1] = c[i];
+    }
+    const TridiagonalFactor lhs(lower, diag, upper);
+
+    std::vector<double> rhs(V.size());
+    for (int j = n_steps - 1; j >= 0; --j) {
+        const double disc_curr = std::exp(-r * (T - j * dt));
+
+        for (int i = 1; i < N; ++i) {
+            const double* lo = &V[(i - 1) * nK];
+            const double* mid = &V[i * nK];
+            const double* hi = &V[(i + 1) * nK];
+            double* out = &rhs[i * nK];
+            const double ai = a[i], bi = 2.0 - b[i], ci = c[i];
+            for (std::size_t m = 0; m < nK; ++m) out[m] = ai * lo[m] + bi * mid[m] - ci * hi[m];
+        }
+
+        // Implicit-side Dirichlet values at the current time level
+        double* first = &rhs[1 * nK];
+        double* last = &rhs[(N - 1) * nK];
+        for (std::size_t m = 0; m < nK; ++m) {
+            if (sign[m] > 0.0) {
+                last[m] -= c[N - 1] * (S_max - K[m] * disc_curr);
+            } else {
+                first[m] += a[1] * K[m] * disc_curr;
+            }
+        }
+
+        lhs.solve(first, static_cast<int>(nK), static_cast<std::ptrdiff_t>(nK));
+        V.swap(rhs);
+
+        double* v0 = &V[0];
+        double* vN = &V[N * nK];
+        for (std::size_t m = 0; m < nK; ++m) {
+            v0[m] = sign[m] > 0.0 ? 0.0 : K[m] * disc_curr;
+            vN[m] = sign[m] > 0.0 ? S_max - K[m] * disc_curr : 0.0;
+        }
+    }
+}
+
+void price_group_pde(const PricingGroup& g, const std::vector<PositionSpec>& positions,
+                     const PortfolioPricingConfig& cfg, std::vector<PositionValuation>& out) {
+    const double S0 = g.spot, T = g.T, sigma = g.sigma, r = cfg.r;
+    if (T <= 0.0 || sigma <= 0.0 || S0 <= 0.0) {
+        price_group_analytic(g, positions, r, out);
+        return;
+    }
+
+    const GroupColumns cols = build_columns(g, positions);
+    const std::size_t nK = cols.strike.size();
+
+    // Keep the spacing a single-strike solve would use for the smallest strike,
+    // and push the far boundary out to four standard deviations of the spot.
+    const int base_steps = std::max(cfg.pde_S_steps, 8);
+    const double S_max = std::max(3.0 * cols.K_max, S0 * std::exp(4.0 * sigma * std::sqrt(T)));
+    const double dS_target = 3.0 * cols.K_min / base_steps;
+    const int N = std::clamp(static_cast<int>(std::ceil(S_max / dS_target)), base_steps, 8 * base_steps);
+    const int n_steps = std::max(cfg.pde_T_steps, 1);
+    const double dS = S_max / N;
+
+    SharedPricingCache* cache = shared_pricing_cache();
+    CacheKey cache_key = group_cache_key("portfolio_pde", g, cols, r);
+    cache_key.add(static_cast<long long>(N)).add(static_cast<long long>(n_steps));
+    std::vector<PositionValuation> values;
+    if (cache && load_cached_columns(*cache, cache_key, nK, values)) {
+        scatter_columns(g, cols, values, out);
+        return;
+    }
+
+    std::vector<double> V;
+    cn_march_columns(S_max, N, n_steps, r, T, sigma, cols.strike, cols.sign, V);
+
+    const int idx = std::clamp(static_cast<int>(S0 / dS), 1, N - 2);
+    const double w = (S0 - idx * dS) / dS;
+    auto at = [&](const std::vector<double>& grid, int i, std::size_t m) { return grid[i * nK + m]; };
+    values.assign(nK, PositionValuation{});
+    for (std::size_t m = 0; m < nK; ++m) {
+        auto delta_at = [&](int i) { return (at(V, i + 1, m) - at(V, i - 1, m)) / (2.0 * dS); };
+        auto gamma_at = [&](int i) {
+            return (at(V, i + 1, m) - 2.0 * at(V, i, m) + at(V, i - 1, m)) / (dS * dS);
+        };
+        auto& v = values[m];
+        v.price = (1.0 - w) * at(V, idx, m) + w * at(V, idx + 1, m);
+        v.delta = (1.0 - w) * delta_at(idx) + w * delta_at(idx + 1);
+        v.gamma = (1.0 - w) * gamma_at(idx) + w * gamma_at(idx + 1);
+        // Constant-volatility identities: vega = sigma*T*S^2*gamma and the
+        // Black-Scholes PDE itself, theta = rV - rS*delta - 0.5*sigma^2*S^2*gamma
+        v.vega = sigma * T * S0 * S0 * v.gamma;
+        v.theta = r * v.price - r * S0 * v.delta - 0.5 * sigma * sigma * S0 * S0 * v.gamma;
+    }
+    if (cache) store_cached_columns(*cache, cache_key, values);
+    scatter_columns(g, cols, values, out);
+}
+
+void price_group_mc(const PricingGroup& g, const std::vector<PositionSpec>& positions,
+                    const PortfolioPricingConfig& cfg, std::vector<PositionValuation>& out) {
+    const double S0 = g.spot, T = g.T, sigma = g.sigma, r = cfg.r;
+    if (T <= 0.0 || sigma <= 0.0 || S0 <= 0.0 || cfg.mc_paths < 2) {
+        price_group_analytic(g, positions, r, out);
+        return;
+    }
+
+    const GroupColumns cols = build_columns(g, positions);
+    const std::size_t nK = cols.strike.size();
+    const std::vector<double>& K = cols.strike;
+    const std::vector<double>& sign = cols.sign;
+
+    // The stream depends on the seed and the underlying only, so a group has
+    // the same estimate (and cache entry) in any book, and bumped or moved
+    // repricings of it reuse its normals
+    const std::uint64_t stream =
+        CacheKey("portfolio_mc_stream").add(g.underlying).add(static_cast<long long>(cfg.seed)).hash();
+    SharedPricingCache* cache = shared_pricing_cache();
+    CacheKey cache_key = group_cache_key("portfolio_mc", g, cols, r);
+    cache_key.add(static_cast<long long>(cfg.mc_paths)).add(static_cast<long long>(stream));
+    std::vector<PositionValuation> values;
+    if (cache && load_cached_columns(*cache, cache_key, nK, values)) {
+        scatter_columns(g, cols, values, out);
+        return;
+    }
+
+    const double sqrt_T = std::sqrt(T);
+    const double drift = (r - 0.5 * sigma * sigma) * T;
+    const double vol_sqrt_T = sigma * sqrt_T;
+    const double disc = std::exp(-r * T);
+
+    // Antithetic pairs in fixed-size blocks; block b takes normals b * kBlock ..
+    // of the group's counter-based stream and writes its own partial sums,
+    // which are added in block order, so results do not depend on the number
+    // of threads.
+    constexpr long kBlock = 2048;
+    const long pairs = cfg.mc_paths / 2;
+    const long num_blocks = (pairs + kBlock - 1) / kBlock;
+    constexpr std::size_t kStats = 5;   // price, price^2, delta, vega, gamma
+    const std::size_t acc_len = kStats * nK;
+    std::vector<double> partial(static_cast<std::size_t>(num_blocks) * acc_len);
+
+    #ifdef _OPENMP
+    #pragma omp parallel
+    #endif
+    {
+        std::vector<double> Z(kBlock), scratch(2 * kBlock);
+        #ifdef _OPENMP
+        #pragma omp for schedule(static)
+        #endif
+        for (long blk = 0; blk < num_blocks; ++blk) {
+            const long n = std::min(kBlock, pairs - blk * kBlock);
+            fill_standard_normals(stream, static_cast<std::uint64_t>(blk) * kBlock, n, Z.data());
+            // Pathwise delta and vega, likelihood-ratio-pathwise gamma
+            active_kernels().payoff_greeks(n, Z.data(), S0, drift, vol_sqrt_T, sqrt_T, sigma * T, nK, K.data(),
+                                           sign.data(), scratch.data(), partial.data() + blk * acc_len);
+        }
+    }
+    std::vector<double> acc(acc_len, 0.0);
+    for (long blk = 0; blk < num_blocks; ++blk)
+        for (std::size_t q = 0; q < acc_len; ++q) acc[q] += partial[blk * acc_len + q];
+
+    const double n = static_cast<double>(pairs);
+    values.assign(nK, PositionValuation{});
+    for (std::size_t m = 0; m < nK; ++m) {
+        auto& v = values[m];
+        const double mean = acc[m] / n;
+        const double var = std::max(0.0, acc[nK + m] / n - mean * mean);
+        v.price = disc * mean;
+        v.std_error = disc * std::sqrt(var / n);
+        v.delta = disc * acc[2 * nK + m] / (n * S0);
+        v.vega = disc * acc[3 * nK + m] / n;
+        v.gamma = disc * acc[4 * nK + m] / (n * S0 * S0);
+        v.theta = r * v.price - r * S0 * v.delta - 0.5 * sigma * sigma * S0 * S0 * v.gamma;
+    }
+    if (cache) store_cached_columns(*cache, cache_key, values);
+    scatter_columns(g, cols, values, out);
+}
+
+// Keys point into the position vector, which outlives the planning pass
+struct GroupKey {
+    const std::string* underlying;
+    double spot, T, sigma;
+    PricingModel model;
+
+    bool operator==(const GroupKey& o) const {
+        return spot == o.spot && T == o.T && sigma == o.sigma && model == o.model &&
+               *underlying == *o.underlying;
+    }
+};
+
+struct GroupKeyHash {
+    std::size_t operator()(const GroupKey& k) const {
+        std::size_t h = std::hash<std::string>{}(*k.underlying);
+        for (double x : {k.spot, k.T, k.sigma}) {
+            h ^= std::hash<double>{}(x) + 0x9E3779B97F4A7C15ULL + (h << 6) + (h >> 2);
+        }
+        return h ^ static_cast<std::size_t>(k.model);
+    }
+};
+
+} // namespace
+
+std::vector<PricingGroup> plan_pricing_groups(const std::vector<PositionSpec>& positions) {
+    std::unordered_map<GroupKey, std::size_t, GroupKeyHash> index;
+    index.reserve(positions.size() / 4 + 16);
+    std::vector<PricingGroup> groups;
+    for (std::size_t i = 0; i < positions.size(); ++i) {
+        const auto& p = positions[i];
+        GroupKey key{&p.underlying, p.spot, p.T, p.sigma, p.model};
+        auto it = index.find(key);
+        if (it == index.end()) {
+            it = index.emplace(key, groups.size()).first;
+            groups.push_back(PricingGroup{p.underlying, p.spot, p.T, p.sigma, p.model, {}});
+        }
+        groups[it->second].members.push_back(i);
+    }
+    return groups;
+}
+
+std::vector<PricingGroup> plan_pricing_groups(const std::vector<PositionSpec>& positions,
+                                              const PortfolioPricingConfig& config) {
+    if (config.group_positions) return plan_pricing_groups(positions);
+    std::vector<PricingGroup> groups;
+    groups.reserve(positions.size());
+    for (std::size_t i = 0; i < positions.size(); ++i) {
+        const auto& p = positions[i];
+        groups.push_back(PricingGroup{p.underlying, p.spot, p.T, p.sigma, p.model, {i}});
+    }
+    return groups;
+}
+
+void price_pricing_group(const std::vector<PositionSpec>& positions, const PricingGroup& group,
+                         const PortfolioPricingConfig& config, std::vector<PositionValuation>& out) {
+    switch (group.model) {
+    case PricingModel::Analytic: price_group_analytic(group, positions, config.r, out); break;
+    case PricingModel::PDE: price_group_pde(group, positions, config, out); break;
+    case PricingModel::MonteCarlo: price_group_mc(group, positions, config, out); break;
+    }
+}
+
+void price_pricing_groups(const std::vector<PositionSpec>& positions, const std::vector<PricingGroup>& groups,
+                          std::size_t begin, std::size_t end, const PortfolioPricingConfig& config,
+                          std::vector<PositionValuation>& out) {
+    const long first = static_cast<long>(begin);
+    const long last = static_cast<long>(std::min(end, groups.size()));
+
+    // Grid and closed-form groups are independent; MC groups parallelise internally
+    #ifdef _OPENMP
+    #pragma omp parallel for schedule(dynamic)
+    #endif
+    for (long gi = first; gi < last; ++gi) {
+        if (groups[gi].model != PricingModel::MonteCarlo)
+            price_pricing_group(positions, groups[gi], config, out);
+    }
+    for (long gi = first; gi < last; ++gi) {
+        if (groups[gi].model == PricingModel::MonteCarlo)
+            price_pricing_group(positions, groups[gi], config, out);
+    }
+}
+
+PortfolioValuation price_portfolio(const std::vector<PositionSpec>& positions,
+                                   const PortfolioPricingConfig& config) {
+    const auto start = std::chrono::steady_clock::now();
+
+    const std::vector<PricingGroup> groups = plan_pricing_groups(positions, config);
+    PortfolioValuation result;
+    result.positions.resize(positions.size());
+    result.num_groups = groups.size();
+    price_pricing_groups(positions, groups, 0, groups.size(), config, result.positions);
+
+    result.elapsed_ms = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+CompressedBook compress_positions(const std::vector<PositionSpec>& rows, const std::vector<std::string>& accounts) {
+    if (!accounts.empty() && accounts.size() != rows.size())
+        throw std::invalid_argument("compress_positions: need one account per row");
+
+    // Contracts sharing market inputs form a pricing group, so netting is the
+    // column deduplication of each group; hashing only touches the few group keys
+    CompressedBook book;
+    book.contract_of_row.resize(rows.size());
+    book.groups = plan_pricing_groups(rows);
+    for (PricingGroup& g : book.groups) {
+        const GroupColumns cols = build_columns(g, rows);
+        const std::size_t base = book.contracts.size();
+        for (std::size_t c = 0; c < cols.strike.size(); ++c) {
+            book.contracts.push_back(PositionSpec{g.underlying, 0.0, g.spot, cols.strike[c], g.T, g.sigma,
+                                                  cols.sign[c] > 0.0 ? OptionType::Call : OptionType::Put, g.model});
+        }
+        for (std::size_t m = 0; m < g.members.size(); ++m) {
+            const std::size_t c = base + cols.column_of_member[m];
+            book.contracts[c].quantity += rows[g.members[m]].quantity;
+            book.contract_of_row[g.members[m]] = c;
+        }
+        g.members.resize(cols.strike.size());
+        for (std::size_t c = 0; c < cols.strike.size(); ++c) g.members[c] = base + c;
+    }
+
+    std::unordered_map<std::string, std::size_t> account_index;
+    std::vector<std::size_t> account_of_row(rows.size(), 0);
+    if (accounts.empty()) book.accounts.emplace_back();
+    for (std::size_t i = 0; i < accounts.size(); ++i) {
+        // Rows of one account tend to be adjacent
+        if (i > 0 && accounts[i] == accounts[i - 1]) {
+            account_of_row[i] = account_of_row[i - 1];
+            continue;
+        }
+        const auto a = account_index.emplace(accounts[i], book.accounts.size());
+        if (a.second) book.accounts.push_back(accounts[i]);
+        account_of_row[i] = a.first->second;
+    }
+
+    // Counting sort of rows by account, then net within each account
+    book.account_offsets.assign(book.accounts.size() + 1, 0);
+    for (std::size_t a : account_of_row) ++book.account_offsets[a + 1];
+    for (std::size_t a = 0; a < book.accounts.size(); ++a) book.account_offsets[a + 1] += book.account_offsets[a];
+    std::vector<std::size_t> order(rows.size());
+    {
+        std::vector<std::size_t> next(book.account_offsets.begin(), book.account_offsets.end() - 1);
+        for (std::size_t i = 0; i < rows.size(); ++i) order[next[account_of_row[i]]++] = i;
+    }
+    std::vector<std::size_t> entry_of_contract(book.contracts.size(), static_cast<std::size_t>(-1));
+    std::vector<std::size_t> offsets(book.accounts.size() + 1, 0);
+    for (std::size_t a = 0; a < book.accounts.size(); ++a) {
+        const std::size_t first_entry = book.entry_contract.size();
+        for (std::size_t k = book.account_offsets[a]; k < book.account_offsets[a + 1]; ++k) {
+            const std::size_t c = book.contract_of_row[order[k]];
+            if (entry_of_contract[c] == static_cast<std::size_t>(-1) || entry_of_contract[c] < first_entry) {
+                entry_of_contract[c] = book.entry_contract.size();
+                book.entry_contract.push_back(c);
+                book.entry_quantity.push_back(0.0);
+            }
+            book.entry_quantity[entry_of_contract[c]] += rows[order[k]].quantity;
+        }
+        offsets[a + 1] = book.entry_contract.size();
+    }
+    book.account_offsets.swap(offsets);
+    return book;
+}
+
+PortfolioValuation price_compressed(const CompressedBook& book, const PortfolioPricingConfig& config) {
+    if (!config.group_positions) return price_portfolio(book.contracts, config);
+    const auto start = std::chrono::steady_clock::now();
+
+    PortfolioValuation result;
+    result.positions.resize(book.contracts.size());
+    result.num_groups = book.groups.size();
+    price_pricing_groups(book.contracts, book.groups, 0, book.groups.size(), config, result.positions);
+
+    result.elapsed_ms = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+std::vector<PositionValuation> expand_valuations(const CompressedBook& book,
+                                                 const std::vector<PositionValuation>& contract_values) {
+    if (contract_values.size() != book.contracts.size())
+        throw std::invalid_argument("expand_valuations: need one valuation per contract");
+    std::vector<PositionValuation> rows(book.rows());
+    for (std::size_t i = 0; i < rows.size(); ++i) rows[i] = contract_values[book.contract_of_row[i]];
+    return rows;
+}
+
+std::vector<PortfolioRiskTotals> account_totals(const CompressedBook& book,
+                                                const std::vector<PositionValuation>& contract_values) {
+    if (contract_values.size() != book.contracts.size())
+        throw std::invalid_argument("account_totals: need one valuation per contract");
+    std::vector<PortfolioRiskTotals> totals(book.accounts.size());
+    for (std::size_t a = 0; a < book.accounts.size(); ++a) {
+        auto& t = totals[a];
+        for (std::size_t k = book.account_offsets[a]; k < book.account_offsets[a + 1]; ++k) {
+            const double q = book.entry_quantity[k];
+            const auto& v = contract_values[book.entry_contract[k]];
+            t.value += q * v.price;
+            t.delta += q * v.delta;
+            t.gamma += q * v.gamma;
+            t.vega += q * v.vega;
+            t.theta += q * v.theta;
+        }
+    }
+    return totals;
+}
+
+std::vector<PositionSpec> generate_sample_portfolio(std::size_t num_positions, unsigned long seed,
+                                                    PricingModel model) {
+    constexpr int kUnderlyings = 50;
+    constexpr double kExpiryDays[] = {7, 14, 30, 60, 90, 120, 180, 270, 365, 540, 730};
+    constexpr int kExpiries = sizeof(kExpiryDays) / sizeof(kExpiryDays[0]);
+    constexpr int kStrikesPerSide = 12;
+
+    RNG rng(seed);
+    struct Underlying { std::string symbol; double spot; double atm_vol; };
+    std::vector<Underlying> universe(kUnderlyings);
+    for (int u = 0; u < kUnderlyings; ++u) {
+        universe[u].symbol = "UND" + std::to_string(u);
+        universe[u].spot = std::round(20.0 + 480.0 * rng.uni());
+        universe[u].atm_vol = 0.15 + 0.45 * rng.uni();
+    }
+
+    std::vector<PositionSpec> book;
+    book.reserve(num_positions);
+    for (std::size_t i = 0; i < num_positions; ++i) {
+        const auto& und = universe[static_cast<int>(rng.uni() * kUnderlyings)];
+        const int e = static_cast<int>(rng.uni() * kExpiries);
+        const int k = static_cast<int>(rng.uni() * (2 * kStrikesPerSide + 1)) - kStrikesPerSide;
+        const double T = kExpiryDays[e] / 365.0;
+
+        PositionSpec p;
+        p.underlying = und.symbol;
+        p.spot = und.spot;
+        // Listed strikes on a 2.5% ladder, rounded to half a point
+        p.strike = std::max(0.5, std::round(2.0 * und.spot * (1.0 + 0.025 * k)) / 2.0);
+        p.T = T;
+        // Mild term structure per underlying so each (underlying, expiry) has one vol
+        p.sigma = und.atm_vol * (1.0 + 0.1 * std::exp(-4.0 * T));
+        p.type = rng.uni() < 0.5 ? OptionType::Call : OptionType::Put;
+        p.quantity = std::round(200.0 * rng.uni()) - 100.0;
+        if (p.quantity == 0.0) p.quantity = 1.0;
+        p.model = model;
+        book.push_back(std::move(p));
+    }
+    return book;
+}
+
+}
@@ -0,0 +1,453 @@
+/**
+ * @file result_writer.cpp
+ * @brief Buffered CSV, NDJSON and columnar binary result writers
+ *
+ * @author LN697
+ * @version 1.0
+ */
+
+#include "result_writer.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace bsm {
+
+namespace {
+
+constexpr char kMagic[8] = {'B', 'S', 'M', 'C', 'O', 'L', '1', '\n'};
+constexpr int kMaxPrecision = 30;
+constexpr std::size_t kMaxNumberChars = 400;   // fixed notation of DBL_MAX with kMaxPrecision digits
+
+template <typename T>
+void append_raw(std::vector<unsigned char>& out, const T& value) {
+    const auto* p = reinterpret_cast<const unsigned char*>(&value);
+    out.insert(out.end(), p, p + sizeof(T));
+}
+
+template <typename T>
+void read_raw(std::istream& in, T& value) {
+    if (!in.read(reinterpret_cast<char*>(&value), sizeof(T))) {
+        throw std::runtime_error("read_columnar_results: truncated file");
+    }
+}
+
+// Before any file is opened, so a rejected schema leaves nothing behind
+void validate_schema(const ResultSchema& schema) {
+    if (schema.empty()) throw std::invalid_argument("ResultWriter: schema has no columns");
+    for (const auto& c : schema) {
+        if (c.precision < -1 || c.precision > kMaxPrecision) {
+            throw std::invalid_argument("ResultWriter: precision of column " + c.name + " outside [-1, 30]");
+        }
+        if (c.name.size() > 0xFFFF) throw std::invalid_argument("ResultWriter: column name too long");
+    }
+}
+
+bool needs_csv_quotes(std::string_view s) {
+    return s.find_first_of(",\"\r\n") != std::string_view::npos;
+}
+
+bool needs_json_escape(std::string_view s) {
+    return std::any_of(s.begin(), s.end(), [](char c) {
+        return static_cast<unsigned char>(c) < 0x20 || c == '"' || c == '\\';
+    });
+}
+
+}
+
+void append_json_escaped(std::string& out, std::string_view s) {
+    static const char hex[] = "0123456789abcdef";
+    for (char c : s) {
+        const unsigned char ch = static_cast<unsigned char>(c);
+        switch (ch) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (ch < 0x20) {
+                    out += "\\u00";
+                    out += hex[ch >> 4];
+                    out += hex[ch & 15];
+                } else {
+                    out += c;
+                }
+        }
+    }
+}
+
+bool parse_result_format(const std::string& name, ResultFormat& format) {
+    if (name == "csv") {
+        format = ResultFormat::CSV;
+    } else if (name == "ndjson" || name == "jsonl") {
+        format = ResultFormat::NDJSON;
+    } else if (name == "binary") {
+        format = ResultFormat::Binary;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+ResultWriter::ResultWriter(ResultSchema schema, ResultFormat format, const std::string& path,
+                           std::size_t buffer_bytes)
+    : schema_(std::move(schema)), format_(format), buffer_(std::max<std::size_t>(buffer_bytes, kMaxNumberChars)) {
+    validate_schema(schema_);
+#if defined(__unix__) || defined(__APPLE__)
+    if (path == "-") {
+        std::cout.flush();   // keep anything already printed ahead of the rows
+        fd_ = STDOUT_FILENO;
+    } else {
+        fd_ = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd_ < 0) throw std::runtime_error("ResultWriter: cannot create " + path + ": " + std::strerror(errno));
+        owns_fd_ = true;
+    }
+#else
+    if (path == "-") {
+        out_ = &std::cout;
+    } else {
+        owned_out_ = std::make_unique<std::ofstream>(path, std::ios::binary | std::ios::trunc);
+        if (!*owned_out_) throw std::runtime_error("ResultWriter: cannot create " + path);
+        out_ = owned_out_.get();
+    }
+#endif
+    begin();
+}
+
+ResultWriter::ResultWriter(ResultSchema schema, ResultFormat format, int fd, std::size_t buffer_bytes)
+    : schema_(std::move(schema)), format_(format), buffer_(std::max<std::size_t>(buffer_bytes, kMaxNumberChars)) {
+    validate_schema(schema_);
+#if defined(__unix__) || defined(__APPLE__)
+    if (fd < 0) throw std::invalid_argument("ResultWriter: invalid file descriptor");
+    fd_ = fd;
+#else
+    (void)fd;
+    throw std::runtime_error("ResultWriter: file descriptors need POSIX write(2)");
+#endif
+    begin();
+}
+
+ResultWriter::ResultWriter(ResultSchema schema, ResultFormat format, std::ostream& out, std::size_t buffer_bytes)
+    : schema_(std::move(schema)), format_(format), buffer_(std::max<std::size_t>(buffer_bytes, kMaxNumberChars)),
+      out_(&out) {
+    validate_schema(schema_);
+    begin();
+}
+
+ResultWriter::~ResultWriter() {
+    try {
+        finish();
+    } catch (...) {
+    }
+#if defined(__unix__) || defined(__APPLE__)
+    if (owns_fd_) ::close(fd_);
+#endif
+}
+
+void ResultWriter::begin() {
+    switch (format_) {
+        case ResultFormat::CSV:
+            for (std::size_t c = 0; c < schema_.size(); ++c) {
+                if (c) put_char(',');
+                put_csv_text(schema_[c].name);
+            }
+            put_char('\n');
+            break;
+        case ResultFormat::NDJSON:
+            for (std::size_t c = 0; c < schema_.size(); ++c) {
+                std::string key = c ? ",\"" : "{\"";
+                append_json_escaped(key, schema_[c].name);
+                json_keys_.push_back(key + "\":");
+            }
+            break;
+        case ResultFormat::Binary: {
+            std::vector<unsigned char> header(kMagic, kMagic + sizeof kMagic);
+            append_raw(header, static_cast<std::uint32_t>(schema_.size()));
+            for (const auto& c : schema_) {
+                append_raw(header, static_cast<std::uint8_t>(c.type));
+                append_raw(header, static_cast<std::int8_t>(c.precision));
+                append_raw(header, static_cast<std::uint16_t>(c.name.size()));
+                header.insert(header.end(), c.name.begin(), c.name.end());
+            }
+            put(reinterpret_cast<const char*>(header.data()), header.size());
+            fixed_.resize(schema_.size());
+            lengths_.resize(schema_.size());
+            text_bytes_.resize(schema_.size());
+            for (std::size_t c = 0; c < schema_.size(); ++c) {
+                if (schema_[c].type == ColumnType::Text) {
+                    lengths_[c].reserve(kBinaryRowGroup);
+                } else {
+                    fixed_[c].reserve(kBinaryRowGroup * 8);
+                }
+            }
+            break;
+        }
+    }
+}
+
+void ResultWriter::check_cell(ColumnType type) {
+    if (finished_) throw std::invalid_argument("ResultWriter: writer is finished");
+    if (column_ >= schema_.size()) throw std::invalid_argument("ResultWriter: row has more cells than the schema");
+    if (schema_[column_].type != type) {
+        throw std::invalid_argument("ResultWriter: wrong value type for column " + schema_[column_].name);
+    }
+    if (format_ == ResultFormat::CSV && column_) {
+        put_char(',');
+    } else if (format_ == ResultFormat::NDJSON) {
+        put(json_keys_[column_]);
+    }
+}
+
+ResultWriter& ResultWriter::text(std::string_view value) {
+    check_cell(ColumnType::Text);
+    switch (format_) {
+        case ResultFormat::CSV: put_csv_text(value); break;
+        case ResultFormat::NDJSON: put_char('"'); put_json_text(value); put_char('"'); break;
+        case ResultFormat::Binary:
+            lengths_[column_].push_back(static_cast<std::uint32_t>(value.size()));
+            text_bytes_[column_].append(value.data(), value.size());
+            break;
+    }
+    ++column_;
+    return *this;
+}
+
+ResultWriter& ResultWriter::integer(long long value) {
+    check_cell(ColumnType::Integer);
+    if (format_ == ResultFormat::Binary) {
+        append_raw(fixed_[column_], static_cast<std::int64_t>(value));
+    } else {
+        if (buffer_.size() - used_ < 24) flush_buffer();
+        used_ = std::to_chars(buffer_.data() + used_, buffer_.data() + buffer_.size(), value).ptr - buffer_.data();
+    }
+    ++column_;
+    return *this;
+}
+
+ResultWriter& ResultWriter::real(double value) {
+    check_cell(ColumnType::Real);
+    if (format_ == ResultFormat::Binary) {
+        append_raw(fixed_[column_], value);
+    } else if (format_ == ResultFormat::NDJSON && !std::isfinite(value)) {
+        put("null");
+    } else {
+        put_real(value, schema_[column_].precision);
+    }
+    ++column_;
+    return *this;
+}
+
+void ResultWriter::end_row() {
+    if (column_ != schema_.size()) throw std::invalid_argument("ResultWriter: row is missing cells");
+    column_ = 0;
+    ++rows_;
+    switch (format_) {
+        case ResultFormat::CSV: put_char('\n'); break;
+        case ResultFormat::NDJSON: put("}\n"); break;
+        case ResultFormat::Binary:
+            if (++group_rows_ == kBinaryRowGroup) flush_row_group();
+            break;
+    }
+}
+
+void ResultWriter::finish() {
+    if (finished_) return;
+    if (column_ != 0) throw std::invalid_argument("ResultWriter: finish in the middle of a row");
+    finished_ = true;
+    if (format_ == ResultFormat::Binary) {
+        flush_row_group();
+        const std::uint32_t end = 0;
+        put(reinterpret_cast<const char*>(&end), sizeof end);
+    }
+    flush_buffer();
+    if (out_) {
+        out_->flush();
+        if (!*out_) throw std::runtime_error("ResultWriter: stream write failed");
+    }
+}
+
+void ResultWriter::put(const char* data, std::size_t n) {
+    if (n > buffer_.size() - used_) {
+        flush_buffer();
+        if (n >= buffer_.size()) {   // large block: skip the copy
+            write_out(data, n);
+            return;
+        }
+    }
+    std::memcpy(buffer_.data() + used_, data, n);
+    used_ += n;
+}
+
+void ResultWriter::put_char(char c) {
+    if (used_ == buffer_.size()) flush_buffer();
+    buffer_[used_++] = c;
+}
+
+void ResultWriter::put_real(double value, int precision) {
+    if (buffer_.size() - used_ < kMaxNumberChars) flush_buffer();
+    char* first = buffer_.data() + used_;
+    char* last = buffer_.data() + buffer_.size();
+    const std::to_chars_result r = precision < 0 ? std::to_chars(first, last, value)
+                                                 : std::to_chars(first, last, value, std::chars_format::fixed, precision);
+    used_ = r.ptr - buffer_.data();
+}
+
+void ResultWriter::put_csv_text(std::string_view value) {
+    if (!needs_csv_quotes(value)) {
+        put(value);
+        return;
+    }
+    put_char('"');
+    for (char ch : value) {
+        if (ch == '"') put_char('"');
+        put_char(ch);
+    }
+    put_char('"');
+}
+
+void ResultWriter::put_json_text(std::string_view value) {
+    if (!needs_json_escape(value)) {
+        put(value);
+        return;
+    }
+    std::string escaped;
+    append_json_escaped(escaped, value);
+    put(escaped);
+}
+
+void ResultWriter::flush_buffer() {
+    if (used_ == 0) return;
+    write_out(buffer_.data(), used_);
+    used_ = 0;
+}
+
+void ResultWriter::write_out(const char* data, std::size_t n) {
+    bytes_written_ += n;
+    if (out_) {
+        if (!out_->write(data, static_cast<std::streamsize>(n))) {
+            throw std::runtime_error("ResultWriter: stream write failed");
+        }
+        return;
+    }
+#if defined(__unix__) || defined(__APPLE__)
+    while (n > 0) {
+        const ssize_t w = ::write(fd_, data, n);
+        if (w < 0) {
+            if (errno == EINTR) continue;
+            throw std::runtime_error(std::string("ResultWriter: write failed: ") + std::strerror(errno));
+        }
+        data += w;
+        n -= static_cast<std::size_t>(w);
+    }
+#endif
+}
+
+void ResultWriter::flush_row_group() {
+    if (group_rows_ == 0) return;
+    const auto rows = static_cast<std::uint32_t>(group_rows_);
+    put(reinterpret_cast<const char*>(&rows), sizeof rows);
+    for (std::size_t c = 0; c < schema_.size(); ++c) {
+        if (schema_[c].type == ColumnType::Text) {
+            const auto total = static_cast<std::uint32_t>(text_bytes_[c].size());
+            put(reinterpret_cast<const char*>(lengths_[c].data()), lengths_[c].size() * sizeof(std::uint32_t));
+            put(reinterpret_cast<const char*>(&total), sizeof total);
+            put(text_bytes_[c]);
+            lengths_[c].clear();
+            text_bytes_[c].clear();
+        } else {
+            put(reinterpret_cast<const char*>(fixed_[c].data()), fixed_[c].size());
+            fixed_[c].clear();
+        }
+    }
+    group_rows_ = 0;
+}
+
+ColumnarResults read_columnar_results(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) throw std::runtime_error("read_columnar_results: cannot open " + path);
+
+    char magic[sizeof kMagic];
+    if (!in.read(magic, sizeof magic) || std::memcmp(magic, kMagic, sizeof kMagic) != 0) {
+        throw std::runtime_error("read_columnar_results: " + path + " is not a columnar result file");
+    }
+    ColumnarResults results;
+    std::uint32_t columns = 0;
+    read_raw(in, columns);
+    for (std::uint32_t c = 0; c < columns; ++c) {
+        std::uint8_t type = 0;
+        std::int8_t precision = 0;
+        std::uint16_t name_bytes = 0;
+        read_raw(in, type);
+        read_raw(in, precision);
+        read_raw(in, name_bytes);
+        if (type > static_cast<std::uint8_t>(ColumnType::Real)) {
+            throw std::runtime_error("read_columnar_results: unknown column type");
+        }
+        ResultColumn column{std::string(name_bytes, '\0'), static_cast<ColumnType>(type), precision};
+        if (!in.read(&column.name[0], name_bytes)) throw std::runtime_error("read_columnar_results: truncated file");
+        results.schema.push_back(std::move(column));
+    }
+    results.reals.resize(columns);
+    results.integers.resize(columns);
+    results.texts.resize(columns);
+
+    std::vector<std::uint32_t> lengths;
+    std::string bytes;
+    for (;;) {
+        std::uint32_t rows = 0;
+        read_raw(in, rows);
+        if (rows == 0) break;
+        for (std::uint32_t c = 0; c < columns; ++c) {
+            switch (results.schema[c].type) {
+                case ColumnType::Real: {
+                    auto& v = results.reals[c];
+                    v.resize(v.size() + rows);
+                    if (!in.read(reinterpret_cast<char*>(v.data() + v.size() - rows), rows * sizeof(double))) {
+                        throw std::runtime_error("read_columnar_results: truncated file");
+                    }
+                    break;
+                }
+                case ColumnType::Integer: {
+                    for (std::uint32_t i = 0; i < rows; ++i) {
+                        std::int64_t value = 0;
+                        read_raw(in, value);
+                        results.integers[c].push_back(value);
+                    }
+                    break;
+                }
+                case ColumnType::Text: {
+                    lengths.resize(rows);
+                    std::uint32_t total = 0;
+                    if (!in.read(reinterpret_cast<char*>(lengths.data()), rows * sizeof(std::uint32_t))) {
+                        throw std::runtime_error("read_columnar_results: truncated file");
+                    }
+                    read_raw(in, total);
+                    bytes.resize(total);
+                    if (total && !in.read(&bytes[0], total)) throw std::runtime_error("read_columnar_results: truncated file");
+                    std::size_t offset = 0;
+                    for (std::uint32_t len : lengths) {
+                        if (offset + len > bytes.size()) throw std::runtime_error("read_columnar_results: corrupt text column");
+                        results.texts[c].emplace_back(bytes, offset, len);
+                        offset += len;
+                    }
+                    break;
+                }
+            }
+        }
+        results.rows += rows;
+    }
+    return results;
+}
+
+}
@@ -0,0 +1,299 @@
+/**
+ * @file risk_graph.cpp
+ * @brief Incremental recomputation and the portfolio risk graph
+ *
+ * @author LN697
+ * @version 1.0
+ */
+
+#include "risk_graph.hpp"
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <stdexcept>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace bsm {
+
+// --- RiskGraph --------------------------------------------------------------
+
+const RiskGraph::Node& RiskGraph::node(RiskNodeId id) const {
+    if (id >= nodes_.size()) throw std::out_of_range("RiskGraph: unknown node");
+    return nodes_[id];
+}
+
+RiskGraph::Node& RiskGraph::node(RiskNodeId id) {
+    if (id >= nodes_.size()) throw std::out_of_range("RiskGraph: unknown node");
+    return nodes_[id];
+}
+
+RiskNodeId RiskGraph::add(Node n) {
+    if (by_name_.count(n.name)) throw std::invalid_argument("RiskGraph: duplicate node name " + n.name);
+    const RiskNodeId id = nodes_.size();
+    by_name_.emplace(n.name, id);
+    for (RiskNodeId in : n.inputs) nodes_[in].dependents.push_back(id);
+    nodes_.push_back(std::move(n));
+    return id;
+}
+
+RiskNodeId RiskGraph::add_input(const std::string& name, RiskValues value) {
+    Node n;
+    n.name = name;
+    n.value = std::move(value);
+    return add(std::move(n));
+}
+
+RiskNodeId RiskGraph::add_node(const std::string& name, std::vector<RiskNodeId> inputs, RiskCompute compute) {
+    if (!compute) throw std::invalid_argument("RiskGraph::add_node: compute function required");
+    Node n;
+    n.name = name;
+    for (RiskNodeId in : inputs) {
+        if (in >= nodes_.size()) throw std::invalid_argument("RiskGraph::add_node: unknown input of " + name);
+        n.level = std::max(n.level, nodes_[in].level + 1);
+    }
+    n.inputs = std::move(inputs);
+    n.compute = std::move(compute);
+    n.seen.assign(n.inputs.size(), 0);   // Older than any version, so the first evaluate computes
+    if (n.inputs.empty()) n.compute({}, n.value);
+    else evaluate(n);
+    return add(std::move(n));
+}
+
+void RiskGraph::set_input(RiskNodeId id, RiskValues value) {
+    Node& n = node(id);
+    if (n.compute) throw std::invalid_argument("RiskGraph::set_input: " + n.name + " is not an input");
+    if (value == n.value) return;
+    n.value = std::move(value);
+    ++n.version;
+    changed_.push_back(id);
+}
+
+void RiskGraph::set_input(RiskNodeId id, std::size_t element, double value) {
+    RiskValues v = node(id).value;
+    if (element >= v.size()) throw std::out_of_range("RiskGraph::set_input: element past the input's size");
+    v[element] = value;
+    set_input(id, std::move(v));
+}
+
+RiskGraph::Outcome RiskGraph::evaluate(Node& n) {
+    bool moved = false;
+    for (std::size_t k = 0; k < n.inputs.size(); ++k) moved = moved || nodes_[n.inputs[k]].version != n.seen[k];
+    if (!moved) return Outcome::Skipped;
+
+    std::vector<const RiskValues*> inputs(n.inputs.size());
+    for (std::size_t k = 0; k < n.inputs.size(); ++k) inputs[k] = &nodes_[n.inputs[k]].value;
+    RiskValues out;
+    n.compute(inputs, out);
+    for (std::size_t k = 0; k < n.inputs.size(); ++k) n.seen[k] = nodes_[n.inputs[k]].version;
+    if (out == n.value) return Outcome::Unchanged;
+    n.value.swap(out);
+    ++n.version;
+    return Outcome::Changed;
+}
+
+RiskRecalcStats RiskGraph::recalculate() {
+    RiskRecalcStats stats;
+    if (changed_.empty()) return stats;
+    const auto start = std::chrono::steady_clock::now();
+
+    // Everything downstream of the changed inputs, bucketed by level
+    std::vector<char> reached(nodes_.size(), 0);
+    std::vector<std::vector<RiskNodeId>> levels;
+    std::vector<RiskNodeId> stack(changed_.begin(), changed_.end());
+    while (!stack.empty()) {
+        const RiskNodeId id = stack.back();
+        stack.pop_back();
+        for (RiskNodeId d : nodes_[id].dependents) {
+            if (reached[d]) continue;
+            reached[d] = 1;
+            const std::size_t level = nodes_[d].level;
+            if (levels.size() <= level) levels.resize(level + 1);
+            levels[level].push_back(d);
+            stack.push_back(d);
+        }
+    }
+
+    for (auto& bucket : levels) {
+        if (bucket.empty()) continue;
+        ++stats.levels;
+        stats.visited += bucket.size();
+        std::vector<Outcome> outcome(bucket.size(), Outcome::Skipped);
+        std::exception_ptr error;
+        const long count = static_cast<long>(bucket.size());
+
+        // Nodes of one level only read lower levels, so they are independent
+        #ifdef _OPENMP
+        #pragma omp parallel for schedule(dynamic)
+        #endif
+        for (long i = 0; i < count; ++i) {
+            try {
+                outcome[i] = evaluate(nodes_[bucket[i]]);
+            } catch (...) {
+                #ifdef _OPENMP
+                #pragma omp critical(risk_graph_error)
+                #endif
+                if (!error) error = std::current_exception();
+            }
+        }
+        if (error) std::rethrow_exception(error);
+        for (Outcome o : outcome) {
+            stats.recomputed += o != Outcome::Skipped;
+            stats.changed += o == Outcome::Changed;
+        }
+    }
+    changed_.clear();
+
+    stats.elapsed_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return stats;
+}
+
+const RiskValues& RiskGraph::value(RiskNodeId id) {
+    if (!changed_.empty()) recalculate();
+    return node(id).value;
+}
+
+bool RiskGraph::find(const std::string& name, RiskNodeId& id) const {
+    const auto it = by_name_.find(name);
+    if (it == by_name_.end()) return false;
+    id = it->second;
+    return true;
+}
+
+// --- PortfolioRiskGraph -----------------------------------------------------
+
+namespace {
+
+constexpr std::size_t kFields = 6;   // price, delta, gamma, vega, theta, std_error
+
+void accumulate(PortfolioRiskTotals& t, double quantity, const double* v) {
+    t.value += quantity * v[0];
+    t.delta += quantity * v[1];
+    t.gamma += quantity * v[2];
+    t.vega += quantity * v[3];
+    t.theta += quantity * v[4];
+}
+
+RiskValues to_values(const PortfolioRiskTotals& t) { return {t.value, t.delta, t.gamma, t.vega, t.theta}; }
+
+PortfolioRiskTotals from_values(const RiskValues& v) { return {v[0], v[1], v[2], v[3], v[4]}; }
+
+}
+
+PortfolioRiskGraph::PortfolioRiskGraph(std::vector<PositionSpec> positions, const PortfolioPricingConfig& config)
+    : positions_(std::move(positions)), config_(config), groups_(plan_pricing_groups(positions_, config)),
+      slot_of_position_(positions_.size()), scratch_(positions_.size()) {
+    // Market data, checking that the book prices every position off the same nodes
+    rate_ = graph_.add_input("rate", {config_.r});
+    std::map<std::string, std::vector<std::size_t>> groups_of;
+    for (std::size_t gi = 0; gi < groups_.size(); ++gi) {
+        const PricingGroup& g = groups_[gi];
+        auto u = underlying_nodes_.find(g.underlying);
+        if (u == underlying_nodes_.end()) {
+            underlyings_.push_back(g.underlying);
+            u = underlying_nodes_.emplace(g.underlying, UnderlyingNodes{graph_.add_input("spot:" + g.underlying, {g.spot}), 0})
+                    .first;
+        } else if (graph_.value(u->second.spot)[0] != g.spot) {
+            throw std::invalid_argument("PortfolioRiskGraph: positions of " + g.underlying + " disagree on spot");
+        }
+        const auto key = std::make_pair(g.underlying, g.T);
+        auto v = vol_nodes_.find(key);
+        if (v == vol_nodes_.end()) {
+            v = vol_nodes_.emplace(key, graph_.add_input("vol:" + g.underlying + ":" + std::to_string(vol_nodes_.size()), {g.sigma}))
+                    .first;
+        } else if (graph_.value(v->second)[0] != g.sigma) {
+            throw std::invalid_argument("PortfolioRiskGraph: positions of " + g.underlying +
+                                        " disagree on volatility for one expiry");
+        }
+        groups_of[g.underlying].push_back(gi);
+    }
+
+    // One pricing node per group: members' values, kFields each
+    std::vector<RiskNodeId> group_node(groups_.size());
+    for (std::size_t gi = 0; gi < groups_.size(); ++gi) {
+        const PricingGroup& g = groups_[gi];
+        const RiskNodeId spot = underlying_nodes_.at(g.underlying).spot;
+        const RiskNodeId vol = vol_nodes_.at({g.underlying, g.T});
+        group_node[gi] = graph_.add_node(
+            "group:" + std::to_string(gi), {rate_, spot, vol},
+            [this, gi](const std::vector<const RiskValues*>& in, RiskValues& out) {
+                PricingGroup g = groups_[gi];
+                g.spot = (*in[1])[0];
+                g.sigma = (*in[2])[0];
+                PortfolioPricingConfig cfg = config_;
+                cfg.r = (*in[0])[0];
+                price_pricing_group(positions_, g, cfg, scratch_);
+                out.resize(g.members.size() * kFields);
+                for (std::size_t m = 0; m < g.members.size(); ++m) {
+                    const PositionValuation& v = scratch_[g.members[m]];
+                    const double fields[kFields] = {v.price, v.delta, v.gamma, v.vega, v.theta, v.std_error};
+                    std::copy(fields, fields + kFields, out.begin() + m * kFields);
+                }
+            });
+        for (std::size_t m = 0; m < g.members.size(); ++m) slot_of_position_[g.members[m]] = {group_node[gi], m};
+    }
+
+    // Aggregation: underlyings, then the book
+    std::vector<RiskNodeId> totals;
+    for (const std::string& u : underlyings_) {
+        const std::vector<std::size_t> gis = groups_of[u];
+        std::vector<RiskNodeId> inputs;
+        for (std::size_t gi : gis) inputs.push_back(group_node[gi]);
+        const RiskNodeId total = graph_.add_node(
+            "total:" + u, inputs, [this, gis](const std::vector<const RiskValues*>& in, RiskValues& out) {
+                PortfolioRiskTotals t;
+                for (std::size_t k = 0; k < gis.size(); ++k) {
+                    const auto& members = groups_[gis[k]].members;
+                    for (std::size_t m = 0; m < members.size(); ++m)
+                        accumulate(t, positions_[members[m]].quantity, in[k]->data() + m * kFields);
+                }
+                out = to_values(t);
+            });
+        underlying_nodes_.at(u).total = total;
+        totals.push_back(total);
+    }
+    book_ = graph_.add_node("book", totals, [](const std::vector<const RiskValues*>& in, RiskValues& out) {
+        PortfolioRiskTotals t;
+        for (const RiskValues* v : in) accumulate(t, 1.0, v->data());
+        out = to_values(t);
+    });
+}
+
+void PortfolioRiskGraph::set_rate(double r) { graph_.set_input(rate_, {r}); }
+
+void PortfolioRiskGraph::set_spot(const std::string& underlying, double spot) {
+    const auto it = underlying_nodes_.find(underlying);
+    if (it == underlying_nodes_.end())
+        throw std::invalid_argument("PortfolioRiskGraph::set_spot: unknown underlying " + underlying);
+    graph_.set_input(it->second.spot, {spot});
+}
+
+void PortfolioRiskGraph::set_vol(const std::string& underlying, double T, double sigma) {
+    const auto it = vol_nodes_.find({underlying, T});
+    if (it == vol_nodes_.end())
+        throw std::invalid_argument("PortfolioRiskGraph::set_vol: no " + underlying + " positions at that expiry");
+    graph_.set_input(it->second, {sigma});
+}
+
+PositionValuation PortfolioRiskGraph::position(std::size_t index) {
+    if (index >= positions_.size()) throw std::out_of_range("PortfolioRiskGraph::position: index out of range");
+    const auto& slot = slot_of_position_[index];
+    const double* v = graph_.value(slot.first).data() + slot.second * kFields;
+    return PositionValuation{v[0], v[1], v[2], v[3], v[4], v[5]};
+}
+
+PortfolioRiskTotals PortfolioRiskGraph::underlying_totals(const std::string& underlying) {
+    const auto it = underlying_nodes_.find(underlying);
+    if (it == underlying_nodes_.end())
+        throw std::invalid_argument("PortfolioRiskGraph::underlying_totals: unknown underlying " + underlying);
+    return from_values(graph_.value(it->second.total));
+}
+
+PortfolioRiskTotals PortfolioRiskGraph::totals() {
+    if (positions_.empty()) return {};
+    return from_values(graph_.value(book_));
+}
+
+}
@@ -0,0 +1,368 @@
+/**
+ * @file shm_cache.cpp
+ * @brief Shared-memory region, seqlock slots and the process-wide attachment
+ *
+ * @author LN697
+ * @version 1.0
+ */
+
+#include "shm_cache.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <thread>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace bsm {
+
+namespace {
+
+constexpr std::uint64_t kMagic = 0x314548434D534231ULL;   // "1BSMCHE1"
+constexpr std::uint64_t kLayoutVersion = 1;
+
+std::uint64_t splitmix(std::uint64_t x) {
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+std::size_t round_up_pow2(std::size_t n) {
+    std::size_t p = SharedPricingCache::kProbeWindow;
+    while (p < n) p <<= 1;
+    return p;
+}
+
+std::string system_error(const std::string& what) {
+    return "SharedPricingCache: " + what + ": " + std::strerror(errno);
+}
+
+}
+
+// --- CacheKey ---------------------------------------------------------------
+
+void CacheKey::mix(std::uint64_t word) {
+    h1_ = splitmix(h1_ ^ word);
+    h2_ = splitmix(h2_ + (word ^ 0xD1B54A32D192ED03ULL)) * 0x9E3779B97F4A7C15ULL;
+}
+
+CacheKey& CacheKey::add(double value) {
+    if (value == 0.0) value = 0.0;                                     // -0.0
+    if (std::isnan(value)) value = std::numeric_limits<double>::quiet_NaN();
+    std::uint64_t bits;
+    std::memcpy(&bits, &value, sizeof bits);
+    mix(bits);
+    return *this;
+}
+
+CacheKey& CacheKey::add(long long value) {
+    mix(static_cast<std::uint64_t>(value));
+    return *this;
+}
+
+CacheKey& CacheKey::add(std::string_view value) {
+    mix(value.size());
+    for (std::size_t i = 0; i < value.size(); i += 8) {
+        std::uint64_t word = 0;
+        std::memcpy(&word, value.data() + i, std::min<std::size_t>(8, value.size() - i));
+        mix(word);
+    }
+    return *this;
+}
+
+std::uint64_t CacheKey::hash() const { return h1_ ? h1_ : 1; }
+
+std::uint64_t CacheKey::check() const { return h2_; }
+
+// --- Region layout ----------------------------------------------------------
+
+struct SharedPricingCache::Header {
+    std::atomic<std::uint64_t> magic;     ///< Written last by the creator
+    std::atomic<std::uint64_t> version;
+    std::atomic<std::uint64_t> slots;
+    std::atomic<std::uint64_t> epoch;
+    std::atomic<std::uint64_t> stores;
+    std::uint64_t reserved[3];
+};
+
+struct SharedPricingCache::Slot {
+    std::atomic<std::uint64_t> seq;       ///< Odd while a writer owns the slot
+    std::atomic<std::uint64_t> key;       ///< 0 = never used
+    std::atomic<std::uint64_t> check;
+    std::atomic<std::uint64_t> epoch;     ///< Last store or hit
+    std::atomic<std::uint64_t> count;
+    std::atomic<std::uint64_t> values[kMaxValues];   ///< Bit patterns of the doubles
+};
+
+static_assert(sizeof(std::atomic<std::uint64_t>) == 8 && std::atomic<std::uint64_t>::is_always_lock_free,
+              "the shared region needs lock-free 64-bit atomics");
+
+// --- SharedPricingCache -----------------------------------------------------
+
+#if defined(__unix__) || defined(__APPLE__)
+
+SharedPricingCache::SharedPricingCache(const std::string& name, std::size_t slots) : name_(name) {
+    static_assert(sizeof(Header) == 64 && sizeof(Slot) == 128, "unexpected shared layout");
+    if (name.size() < 2 || name[0] != '/' || name.find('/', 1) != std::string::npos)
+        throw std::runtime_error("SharedPricingCache: name must look like \"/name\"");
+
+    bool creator = true;
+    int fd = ::shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd < 0 && errno == EEXIST) {
+        creator = false;
+        fd = ::shm_open(name.c_str(), O_RDWR, 0600);
+    }
+    if (fd < 0) throw std::runtime_error(system_error("cannot open " + name));
+
+    if (creator) {
+        slots_ = round_up_pow2(slots);
+        bytes_ = sizeof(Header) + slots_ * sizeof(Slot);
+        if (::ftruncate(fd, static_cast<off_t>(bytes_)) != 0) {
+            const std::string message = system_error("cannot size " + name);
+            ::close(fd);
+            ::shm_unlink(name.c_str());
+            throw std::runtime_error(message);
+        }
+    } else {
+        // The creator sizes the region before it maps it; wait for both steps
+        struct stat st{};
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+        while (::fstat(fd, &st) == 0 && static_cast<std::size_t>(st.st_size) < sizeof(Header) &&
+               std::chrono::steady_clock::now() < deadline)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        if (static_cast<std::size_t>(st.st_size) < sizeof(Header)) {
+            ::close(fd);
+            throw std::runtime_error("SharedPricingCache: " + name + " is not a pricing cache");
+        }
+        bytes_ = static_cast<std::size_t>(st.st_size);
+    }
+
+    map_ = ::mmap(nullptr, bytes_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (map_ == MAP_FAILED) {
+        map_ = nullptr;
+        const std::string message = system_error("cannot map " + name);
+        if (creator) ::shm_unlink(name.c_str());
+        throw std::runtime_error(message);
+    }
+    header_ = static_cast<Header*>(map_);
+
+    if (creator) {
+        // ftruncate zero-fills, which is every slot's initial state
+        new (header_) Header{};
+        header_->version.store(kLayoutVersion, std::memory_order_relaxed);
+        header_->slots.store(slots_, std::memory_order_relaxed);
+        header_->epoch.store(1, std::memory_order_relaxed);
+        header_->magic.store(kMagic, std::memory_order_release);
+    } else {
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+        while (header_->magic.load(std::memory_order_acquire) != kMagic &&
+               std::chrono::steady_clock::now() < deadline)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        const std::uint64_t n = header_->slots.load(std::memory_order_relaxed);
+        if (header_->magic.load(std::memory_order_acquire) != kMagic ||
+            header_->version.load(std::memory_order_relaxed) != kLayoutVersion ||
+            n < static_cast<std::uint64_t>(kProbeWindow) || (n & (n - 1)) != 0 ||
+            sizeof(Header) + n * sizeof(Slot) > bytes_) {
+            ::munmap(map_, bytes_);
+            map_ = nullptr;
+            throw std::runtime_error("SharedPricingCache: " + name + " is not a pricing cache");
+        }
+        slots_ = static_cast<std::size_t>(n);
+    }
+    table_ = reinterpret_cast<Slot*>(static_cast<char*>(map_) + sizeof(Header));
+}
+
+SharedPricingCache::~SharedPricingCache() {
+    if (map_) ::munmap(map_, bytes_);
+}
+
+bool SharedPricingCache::remove(const std::string& name) {
+    return ::shm_unlink(name.c_str()) == 0;
+}
+
+#else
+
+SharedPricingCache::SharedPricingCache(const std::string& name, std::size_t) : name_(name) {
+    throw std::runtime_error("SharedPricingCache: POSIX shared memory is not available");
+}
+
+SharedPricingCache::~SharedPricingCache() = default;
+
+bool SharedPricingCache::remove(const std::string&) { return false; }
+
+#endif
+
+int SharedPricingCache::lookup(const CacheKey& key, double* values, int capacity) {
+    const std::uint64_t h = key.hash();
+    const std::uint64_t c = key.check();
+    const std::size_t mask = slots_ - 1;
+
+    for (int p = 0; p < kProbeWindow; ++p) {
+        Slot& slot = table_[(h + p) & mask];
+        const std::uint64_t seq = slot.seq.load(std::memory_order_acquire);
+        if (seq & 1) continue;                       // Being written; may not be ours
+        const std::uint64_t k = slot.key.load(std::memory_order_relaxed);
+        if (k == 0) break;                           // Keys never move, so the probe ends here
+        if (k != h) continue;
+
+        const std::uint64_t found_check = slot.check.load(std::memory_order_relaxed);
+        const int n = static_cast<int>(slot.count.load(std::memory_order_relaxed));
+        double copy[kMaxValues];
+        for (int i = 0; i < n && i < kMaxValues; ++i) {
+            const std::uint64_t bits = slot.values[i].load(std::memory_order_relaxed);
+            std::memcpy(&copy[i], &bits, sizeof bits);
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.seq.load(std::memory_order_relaxed) != seq) continue;   // Torn read
+        if (found_check != c || n <= 0 || n > kMaxValues) continue;
+
+        slot.epoch.store(header_->epoch.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        const int copied = std::min(n, capacity);
+        std::memcpy(values, copy, sizeof(double) * static_cast<std::size_t>(copied));
+        hits_.fetch_add(1, std::memory_order_relaxed);
+        return copied;
+    }
+    misses_.fetch_add(1, std::memory_order_relaxed);
+    return 0;
+}
+
+bool SharedPricingCache::store(const CacheKey& key, const double* values, int count) {
+    if (count < 1 || count > kMaxValues)
+        throw std::invalid_argument("SharedPricingCache::store: count must be in [1, kMaxValues]");
+    const std::uint64_t h = key.hash();
+    const std::size_t mask = slots_ - 1;
+
+    // Same key, else the first empty slot, else the least recently used
+    Slot* target = nullptr;
+    Slot* oldest = nullptr;
+    std::uint64_t oldest_epoch = ~std::uint64_t(0);
+    for (int p = 0; p < kProbeWindow; ++p) {
+        Slot& slot = table_[(h + p) & mask];
+        const std::uint64_t k = slot.key.load(std::memory_order_relaxed);
+        if (k == h || k == 0) {
+            target = &slot;
+            break;
+        }
+        const std::uint64_t e = slot.epoch.load(std::memory_order_relaxed);
+        if (e < oldest_epoch) {
+            oldest_epoch = e;
+            oldest = &slot;
+        }
+    }
+    const bool evicting = target == nullptr;
+    if (evicting) target = oldest;
+
+    std::uint64_t seq = target->seq.load(std::memory_order_relaxed);
+    if ((seq & 1) || !target->seq.compare_exchange_strong(seq, seq + 1, std::memory_order_acquire,
+                                                          std::memory_order_relaxed)) {
+        busy_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+
+    const std::uint64_t epoch = header_->epoch.load(std::memory_order_relaxed);
+    target->key.store(h, std::memory_order_relaxed);
+    target->check.store(key.check(), std::memory_order_relaxed);
+    target->count.store(static_cast<std::uint64_t>(count), std::memory_order_relaxed);
+    for (int i = 0; i < count; ++i) {
+        std::uint64_t bits;
+        std::memcpy(&bits, &values[i], sizeof bits);
+        target->values[i].store(bits, std::memory_order_relaxed);
+    }
+    target->epoch.store(epoch, std::memory_order_relaxed);
+    target->seq.store(seq + 2, std::memory_order_release);
+
+    const std::uint64_t total = header_->stores.fetch_add(1, std::memory_order_relaxed) + 1;
+    if (total % std::max<std::uint64_t>(1, slots_ / 4) == 0)
+        header_->epoch.fetch_add(1, std::memory_order_relaxed);
+
+    stores_.fetch_add(1, std::memory_order_relaxed);
+    if (evicting) evictions_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+std::uint64_t SharedPricingCache::epoch() const {
+    return header_->epoch.load(std::memory_order_relaxed);
+}
+
+SharedCacheStats SharedPricingCache::stats() const {
+    SharedCacheStats s;
+    s.hits = hits_.load(std::memory_order_relaxed);
+    s.misses = misses_.load(std::memory_order_relaxed);
+    s.stores = stores_.load(std::memory_order_relaxed);
+    s.evictions = evictions_.load(std::memory_order_relaxed);
+    s.busy = busy_.load(std::memory_order_relaxed);
+    return s;
+}
+
+// --- Process-wide attachment ------------------------------------------------
+
+namespace {
+
+struct Attachment {
+    std::mutex mutex;
+    std::unique_ptr<SharedPricingCache> owned;
+    std::atomic<SharedPricingCache*> current{nullptr};
+    std::once_flag environment;
+};
+
+Attachment& attachment() {
+    static Attachment a;
+    return a;
+}
+
+// A cache that cannot be attached must not stop the engines, so failures are ignored
+void attach_from_environment() {
+    const char* name = std::getenv("BSM_SHM_CACHE");
+    if (!name || !*name) return;
+    Attachment& a = attachment();
+    try {
+        auto cache = std::make_unique<SharedPricingCache>(name);
+        std::lock_guard<std::mutex> lock(a.mutex);
+        a.owned = std::move(cache);
+        a.current.store(a.owned.get(), std::memory_order_release);
+    } catch (const std::exception&) {
+    }
+}
+
+}
+
+SharedPricingCache* shared_pricing_cache() {
+    Attachment& a = attachment();
+    std::call_once(a.environment, attach_from_environment);
+    return a.current.load(std::memory_order_acquire);
+}
+
+void attach_shared_pricing_cache(const std::string& name, std::size_t slots) {
+    Attachment& a = attachment();
+    std::call_once(a.environment, [] {});   // An explicit attach wins over the environment
+    auto cache = std::make_unique<SharedPricingCache>(name, slots);
+    std::lock_guard<std::mutex> lock(a.mutex);
+    a.current.store(cache.get(), std::memory_order_release);
+    a.owned = std::move(cache);
+}
+
+void detach_shared_pricing_cache() {
+    Attachment& a = attachment();
+    std::call_once(a.environment, [] {});
+    std::lock_guard<std::mutex> lock(a.mutex);
+    a.current.store(nullptr, std::memory_order_release);
+    a.owned.reset();
+}
+
+}
@@ -2,6 +2,7 @@
 #include "math_utils.hpp"
 #include <algorithm>
 #include <cmath>
+#include <limits>
 
 namespace bsm {
 
@@ -9,100 +10,149 @@ static inline double payoff(double ST, double K, OptionType type) {
     return (type == OptionType::Call) ? std::max(ST - K, 0.0) : std::max(K - ST, 0.0);
 }
 
-MCResult mc_slv_price(double S0, double K, double r, double T,
-                      long num_paths, long num_steps, OptionType type,
-                      const HestonParams& h, const LocalVolFn& lv,
-                      unsigned long seed, bool antithetic, bool use_andersen_qe) {
+namespace {
+
+// Heston variance update over a fixed dt (Andersen QE or full-truncation Euler),
+// with the dt-dependent constants hoisted out of the path loop. Both branches are
+// driven by the correlated normal z2, so the spot/variance correlation is kept.
+// Real is the precision of the path state (see Precision).
+template <typename Real = double>
+struct VarianceStep {
+    Real kappa, theta, xi;
+    Real dt, sqrt_dt;
+    Real ekdt;          // exp(-kappa dt)
+    Real s2_v;          // coefficient of v in the conditional variance
+    Real s2_const;      // constant part of the conditional variance
+    bool use_qe;
+
+    VarianceStep(const HestonParams& h, double step, bool qe) : use_qe(qe) {
+        const double e = std::exp(-h.kappa * step);
+        kappa = static_cast<Real>(h.kappa);
+        theta = static_cast<Real>(h.theta);
+        xi = static_cast<Real>(h.xi);
+        dt = static_cast<Real>(step);
+        sqrt_dt = static_cast<Real>(std::sqrt(step));
+        ekdt = static_cast<Real>(e);
+        s2_v = static_cast<Real>(h.xi * h.xi * e * (1.0 - e) / h.kappa);
+        s2_const = static_cast<Real>(h.theta * h.xi * h.xi * 0.5 / h.kappa * (1.0 - e) * (1.0 - e));
+    }
+
+    Real advance(Real v, Real z2) const {
+        if (use_qe) {
+            const Real m = theta + (v - theta) * ekdt;
+            const Real s2 = v * s2_v + s2_const;
+            const Real psi = s2 / (m * m);
+            if (psi < Real(1.5)) {
+                const Real b2 = Real(2) / psi - Real(1) + std::sqrt(Real(2) / psi) * std::sqrt(Real(2) / psi - Real(1));
+                const Real a = m / (Real(1) + b2);
+                const Real x = std::sqrt(b2) + z2;
+                return a * x * x;
+            }
+            const Real p = (psi - Real(1)) / (psi + Real(1));
+            const Real beta = (Real(1) - p) / m;
+            const Real U = static_cast<Real>(norm_cdf(z2));
+            return (U > p) ? std::log((Real(1) - p) / std::max(Real(1) - U, std::numeric_limits<Real>::min())) / beta
+                           : Real(0);
+        }
+        const Real v_pos = std::max(v, Real(0));
+        const Real v_next = v + kappa * (theta - v_pos) * dt + xi * std::sqrt(v_pos) * z2 * sqrt_dt;
+        return std::max(v_next, Real(0));
+    }
+};
+
+// Log-Euler spot step over [t, t+dt]; v must be the variance at the start of the
+// step, since using the updated variance correlates the volatility with z1
+template <typename Real>
+inline Real advance_spot(Real S, Real v, Real sigma_loc, Real z1, Real r, Real dt, Real sqrt_dt) {
+    const Real vol_inst = sigma_loc * std::sqrt(std::max(v, Real(0)));
+    const Real drift = (r - Real(0.5) * vol_inst * vol_inst) * dt;
+    return S * std::exp(drift + vol_inst * z1 * sqrt_dt);
+}
+
+// Sums of the (antithetic-averaged) payoff and its square over num_paths paths,
+// with the path state in precision Real and the sums in double. Paths advance
+// in blocks, in lock step, so the local vol is one batch call per step; each
+// path's normals are drawn up front in path order, which keeps the stream of a
+// path-by-path loop.
+template <typename Real>
+void slv_payoff_sums(double S0, double K, double r, double T, long num_paths, long num_steps,
+                     OptionType type, const HestonParams& h, const LocalVolBatchFn& lv,
+                     unsigned long seed, bool antithetic, bool use_andersen_qe,
+                     double& sum, double& sum2) {
     RNG rng(seed);
     const double dt = T / static_cast<double>(num_steps);
-    const double sqrt_dt = std::sqrt(dt);
+    const VarianceStep<Real> var_step(h, dt, use_andersen_qe);
+    const Real r_r = static_cast<Real>(r);
+    const Real S_init = static_cast<Real>(S0);
+    const Real v_init = static_cast<Real>(std::max(h.v0, 1e-12));
 
-    double sum = 0.0, sum2 = 0.0;
+    constexpr long kPathBlock = 64;
+    std::vector<double> z(2 * static_cast<std::size_t>(kPathBlock) * std::max(num_steps, 0L));
+    std::vector<Real> S(kPathBlock), v(kPathBlock), Sa(kPathBlock), va(kPathBlock);
+    std::vector<double> spot(kPathBlock), sig(kPathBlock), sig_a(kPathBlock);
 
-    auto one_path = [&](unsigned long s) {
-        (void)s;
-        double S = S0;
-        double v = std::max(h.v0, 1e-12);
+    // The antithetic path is driven by the negated normals of the same draws
+    for (long p0 = 0; p0 < num_paths; p0 += kPathBlock) {
+        const long m = std::min(kPathBlock, num_paths - p0);
+        for (long i = 0; i < m; ++i) {
+            double* zi = z.data() + 2 * i * num_steps;
+            for (long n = 0; n < num_steps; ++n) correlated_gaussians(h.rho, rng, zi[2 * n], zi[2 * n + 1]);
+            S[i] = Sa[i] = S_init;
+            v[i] = va[i] = v_init;
+        }
         for (long n = 0; n < num_steps; ++n) {
-            double z1, z2; correlated_gaussians(h.rho, rng, z1, z2);
-            if (use_andersen_qe) {
-                double m = h.theta + (v - h.theta) * std::exp(-h.kappa * dt);
-                double s2 = v * (h.xi * h.xi) * std::exp(-h.kappa * dt) * (1.0 - std::exp(-h.kappa * dt)) / h.kappa
-                          + h.theta * (h.xi * h.xi) * 0.5 / h.kappa * (1.0 - std::exp(-h.kappa * dt)) * (1.0 - std::exp(-h.kappa * dt));
-                double psi = s2 / (m * m);
-                double U = 0.5 * (z2 + 1.0);
-                U = std::min(std::max(U, 1e-6), 1.0 - 1e-6);
-                if (psi < 1.5) {
-                    double b2 = 2.0 / psi - 1.0 + std::sqrt(2.0 / psi) * std::sqrt(2.0 / psi - 1.0);
-                    double a = m / (1.0 + b2);
-                    double chi2 = rng.gauss();
-                    chi2 = chi2 * chi2;
-                    v = a * (std::sqrt(b2) + std::sqrt(chi2)) * (std::sqrt(b2) + std::sqrt(chi2));
-                } else {
-                    double p = (psi - 1.0) / (psi + 1.0);
-                    double beta = (1.0 - p) / m;
-                    v = (U > p) ? -std::log((1.0 - U) / (1.0 - p)) / beta : 0.0;
+            const double t = n * dt;
+            for (long i = 0; i < m; ++i) spot[i] = static_cast<double>(S[i]);
+            lv(t, m, spot.data(), sig.data());
+            if (antithetic) {
+                for (long i = 0; i < m; ++i) spot[i] = static_cast<double>(Sa[i]);
+                lv(t, m, spot.data(), sig_a.data());
+            }
+            for (long i = 0; i < m; ++i) {
+                const Real z1 = static_cast<Real>(z[2 * (i * num_steps + n)]);
+                const Real z2 = static_cast<Real>(z[2 * (i * num_steps + n) + 1]);
+                S[i] = advance_spot(S[i], v[i], static_cast<Real>(sig[i]), z1, r_r, var_step.dt, var_step.sqrt_dt);
+                v[i] = var_step.advance(v[i], z2);
+                if (antithetic) {
+                    Sa[i] = advance_spot(Sa[i], va[i], static_cast<Real>(sig_a[i]), -z1, r_r, var_step.dt,
+                                         var_step.sqrt_dt);
+                    va[i] = var_step.advance(va[i], -z2);
                 }
-            } else {
-                double dW2 = z2 * sqrt_dt;
-                double v_sqrt = std::sqrt(std::max(v, 0.0));
-                double v_next = v + h.kappa * (h.theta - std::max(v, 0.0)) * dt + h.xi * v_sqrt * dW2;
-                v = std::max(v_next, 0.0);
             }
-
-            double sigma_loc = lv(S, n * dt);
-            double vol_inst = sigma_loc * std::sqrt(std::max(v, 0.0));
-            double dW1 = z1 * sqrt_dt;
-            double drift = (r - 0.5 * vol_inst * vol_inst) * dt;
-            double diff = vol_inst * dW1;
-            S = S * std::exp(drift + diff);
         }
-        return payoff(S, K, type);
+        for (long i = 0; i < m; ++i) {
+            double p = payoff(S[i], K, type);
+            if (antithetic) p = 0.5 * (p + payoff(Sa[i], K, type));
+            sum += p;
+            sum2 += p * p;
+        }
+    }
+}
+
+} // namespace
+
+MCResult mc_slv_price(double S0, double K, double r, double T,
+                      long num_paths, long num_steps, OptionType type,
+                      const HestonParams& h, const LocalVolFn& lv,
+                      unsigned long seed, bool antithetic, bool use_andersen_qe, Precision precision) {
+    const LocalVolBatchFn batch = [&lv](double t, std::size_t n, const double* S, double* sigma) {
+        for (std::size_t i = 0; i < n; ++i) sigma[i] = lv(S[i], t);
     };
+    return mc_slv_price(S0, K, r, T, num_paths, num_steps, type, h, batch, seed, antithetic, use_andersen_qe,
+                        precision);
+}
 
-    for (long i = 0; i < num_paths; ++i) {
-        double p = one_path(seed + i);
-        if (antithetic) {
-            double S = S0, v = std::max(h.v0, 1e-12);
-            for (long n = 0; n < num_steps; ++n) {
-                double z1, z2; correlated_gaussians(h.rho, rng, z1, z2);
-                z1 = -z1; z2 = -z2;
-                if (use_andersen_qe) {
-                    double m = h.theta + (v - h.theta) * std::exp(-h.kappa * dt);
-                    double s2 = v * (h.xi * h.xi) * std::exp(-h.kappa * dt) * (1.0 - std::exp(-h.kappa * dt)) / h.kappa
-                              + h.theta * (h.xi * h.xi) * 0.5 / h.kappa * (1.0 - std::exp(-h.kappa * dt)) * (1.0 - std::exp(-h.kappa * dt));
-                    double psi = s2 / (m * m);
-                    double U = 0.5 * (z2 + 1.0);
-                    U = std::min(std::max(U, 1e-6), 1.0 - 1e-6);
-                    if (psi < 1.5) {
-                        double b2 = 2.0 / psi - 1.0 + std::sqrt(2.0 / psi) * std::sqrt(2.0 / psi - 1.0);
-                        double a = m / (1.0 + b2);
-                        double chi2 = rng.gauss();
-                        chi2 = chi2 * chi2;
-                        v = a * (std::sqrt(b2) + std::sqrt(chi2)) * (std::sqrt(b2) + std::sqrt(chi2));
-                    } else {
-                        double p = (psi - 1.0) / (psi + 1.0);
-                        double beta = (1.0 - p) / m;
-                        v = (U > p) ? -std::log((1.0 - U) / (1.0 - p)) / beta : 0.0;
-                    }
-                } else {
-                    double dW2 = z2 * sqrt_dt;
-                    double v_sqrt = std::sqrt(std::max(v, 0.0));
-                    double v_next = v + h.kappa * (h.theta - std::max(v, 0.0)) * dt + h.xi * v_sqrt * dW2;
-                    v = std::max(v_next, 0.0);
-                }
-                double sigma_loc = lv(S, n * dt);
-                double vol_inst = sigma_loc * std::sqrt(std::max(v, 0.0));
-                double dW1 = z1 * sqrt_dt;
-                double drift = (r - 0.5 * vol_inst * vol_inst) * dt;
-                double diff = vol_inst * dW1;
-                S = S * std::exp(drift + diff);
-            }
-            double pa = payoff(S, K, type);
-            p = 0.5 * (p + pa);
-        }
-        sum += p;
-        sum2 += p * p;
+MCResult mc_slv_price(double S0, double K, double r, double T,
+                      long num_paths, long num_steps, OptionType type,
+                      const HestonParams& h, const LocalVolBatchFn& lv,
+                      unsigned long seed, bool antithetic, bool use_andersen_qe, Precision precision) {
+    double sum = 0.0, sum2 = 0.0;
+    if (precision == Precision::Float) {
+        slv_payoff_sums<float>(S0, K, r, T, num_paths, num_steps, type, h, lv, seed, antithetic,
+                               use_andersen_qe, sum, sum2);
+    } else {
+        slv_payoff_sums<double>(S0, K, r, T, num_paths, num_steps, type, h, lv, seed, antithetic,
+                                use_andersen_qe, sum, sum2);
     }
 
     double disc = std::exp(-r * T);
@@ -116,6 +166,67 @@ MCResult mc_slv_price(double S0, double K, double r, double T,
     return res;
 }
 
+MCResult mc_slv_barrier_price(double S0, double K, double r, double T,
+                              long num_paths, long num_steps, OptionType type,
+                              const HestonParams& h, const LocalVolFn& lv,
+                              const BarrierSpec& barrier, unsigned long seed,
+                              bool antithetic, bool use_andersen_qe, int monitoring_dates) {
+    const bool continuous = monitoring_dates <= 0;
+    const long steps_per_date = continuous ? 1
+        : std::max(1L, (num_steps + monitoring_dates - 1) / monitoring_dates);
+    const long steps = continuous ? std::max(1L, num_steps) : steps_per_date * monitoring_dates;
+    RNG rng(seed);
+    const double dt = T / static_cast<double>(steps);
+    const VarianceStep var_step(h, dt, use_andersen_qe);
+    const double disc_T = std::exp(-r * T);
+    const BarrierPathTracker start = barrier_breached(S0, barrier) ? BarrierPathTracker{0.0, 1.0}
+                                                                   : BarrierPathTracker{};
+
+    double sum = 0.0, sum2 = 0.0;
+
+    for (long i = 0; i < num_paths; ++i) {
+        double S = S0, Sa = S0;
+        double v = std::max(h.v0, 1e-12), va = v;
+        BarrierPathTracker up = start, dn = start;
+        for (long n = 0; n < steps; ++n) {
+            double z1, z2; correlated_gaussians(h.rho, rng, z1, z2);
+            const bool monitored = continuous || (n + 1) % steps_per_date == 0;
+            const double step_disc = std::exp(-r * (n + 1) * dt);
+            const double sig = lv(S, n * dt);
+            const double S_next = advance_spot(S, v, sig, z1, r, dt, var_step.sqrt_dt);
+            if (monitored) {
+                up.step(barrier_step_hit_probability(S, S_next, sig * sig * std::max(v, 0.0) * dt,
+                                                     barrier, continuous), step_disc);
+            }
+            S = S_next;
+            v = var_step.advance(v, z2);
+            if (antithetic) {
+                const double sig_a = lv(Sa, n * dt);
+                const double Sa_next = advance_spot(Sa, va, sig_a, -z1, r, dt, var_step.sqrt_dt);
+                if (monitored) {
+                    dn.step(barrier_step_hit_probability(Sa, Sa_next, sig_a * sig_a * std::max(va, 0.0) * dt,
+                                                         barrier, continuous), step_disc);
+                }
+                Sa = Sa_next;
+                va = var_step.advance(va, -z2);
+            }
+        }
+        double p = up.value(payoff(S, K, type), disc_T, barrier);
+        if (antithetic) p = 0.5 * (p + dn.value(payoff(Sa, K, type), disc_T, barrier));
+        sum += p;
+        sum2 += p * p;
+    }
+
+    const double n = static_cast<double>(num_paths);
+    MCResult res;
+    res.price = sum / n;
+    res.std_error = std::sqrt(std::max(0.0, sum2 / n - res.price * res.price) / n);
+    res.num_paths = num_paths;
+    res.num_steps = steps;
+    res.seed = seed;
+    return res;
+}
+
 std::vector<MCResult> mc_slv_multi_seeds(double S0, double K, double r, double T,
                                          long num_paths, long num_steps, OptionType type,
                                          const HestonParams& h, const LocalVolFn& lv,
@@ -129,4 +240,112 @@ std::vector<MCResult> mc_slv_multi_seeds(double S0, double K, double r, double T
     return out;
 }
 
+MCResultGrid mc_slv_price_grid(double S0, const std::vector<double>& strikes,
+                               const std::vector<double>& expiries, double r,
+                               long num_paths, long num_steps, OptionType type,
+                               const HestonParams& h, const LocalVolFn& lv,
+                               unsigned long seed, bool antithetic, bool use_andersen_qe) {
+    MCResultGrid grid;
+    grid.strikes = strikes;
+    for (double t : expiries) if (t > 0.0) grid.expiries.push_back(t);
+    std::sort(grid.expiries.begin(), grid.expiries.end());
+    grid.expiries.erase(std::unique(grid.expiries.begin(), grid.expiries.end()), grid.expiries.end());
+    const std::size_t nK = grid.strikes.size(), nE = grid.expiries.size();
+    grid.results.resize(nK * nE);
+    if (nK == 0 || nE == 0 || num_paths <= 0) return grid;
+
+    // Spread the steps over the expiry intervals so every expiry falls on a step
+    const double T_last = grid.expiries.back();
+    std::vector<long> interval_steps(nE);
+    std::vector<VarianceStep<>> var_steps;
+    var_steps.reserve(nE);
+    for (std::size_t e = 0; e < nE; ++e) {
+        const double len = grid.expiries[e] - (e ? grid.expiries[e - 1] : 0.0);
+        interval_steps[e] = std::max(1L, std::lround(static_cast<double>(std::max(num_steps, 1L)) * len / T_last));
+        var_steps.emplace_back(h, len / static_cast<double>(interval_steps[e]), use_andersen_qe);
+    }
+
+    const double s = (type == OptionType::Call) ? 1.0 : -1.0;
+    constexpr long kBlock = 512;
+    const long num_blocks = (num_paths + kBlock - 1) / kBlock;
+    const std::size_t cells = nK * nE;
+    std::vector<double> acc(2 * cells, 0.0);   // sum X, sum X^2 per cell
+    double* acc_ptr = acc.data();
+    const std::size_t acc_len = acc.size();
+    (void)acc_len;
+
+    #ifdef _OPENMP
+    #pragma omp parallel for schedule(dynamic) reduction(+:acc_ptr[:acc_len])
+    #endif
+    for (long blk = 0; blk < num_blocks; ++blk) {
+        const long n = std::min(kBlock, num_paths - blk * kBlock);
+        RNG rng(seed + 0x9E3779B97F4A7C15ULL * static_cast<unsigned long>(blk + 1));
+        std::vector<double> S(n, S0), v(n, std::max(h.v0, 1e-12));
+        std::vector<double> Sa(n, S0), va(n, std::max(h.v0, 1e-12));
+        // Recorded terminal states, expiry-major
+        std::vector<double> rec(nE * n), rec_a(nE * n);
+
+        double t = 0.0;
+        for (std::size_t e = 0; e < nE; ++e) {
+            const VarianceStep<>& vs = var_steps[e];
+            for (long step = 0; step < interval_steps[e]; ++step) {
+                for (long i = 0; i < n; ++i) {
+                    double z1, z2; correlated_gaussians(h.rho, rng, z1, z2);
+                    S[i] = advance_spot(S[i], v[i], lv(S[i], t), z1, r, vs.dt, vs.sqrt_dt);
+                    v[i] = vs.advance(v[i], z2);
+                    if (antithetic) {
+                        Sa[i] = advance_spot(Sa[i], va[i], lv(Sa[i], t), -z1, r, vs.dt, vs.sqrt_dt);
+                        va[i] = vs.advance(va[i], -z2);
+                    }
+                }
+                t += vs.dt;
+            }
+            std::copy(S.begin(), S.end(), rec.begin() + e * n);
+            if (antithetic) std::copy(Sa.begin(), Sa.end(), rec_a.begin() + e * n);
+        }
+
+        for (std::size_t e = 0; e < nE; ++e) {
+            const double* Su = &rec[e * n];
+            const double* Sd = &rec_a[e * n];
+            for (std::size_t k = 0; k < nK; ++k) {
+                const double K = grid.strikes[k];
+                double sx = 0.0, sxx = 0.0;
+                if (antithetic) {
+                    for (long i = 0; i < n; ++i) {
+                        const double x = 0.5 * (std::max(s * (Su[i] - K), 0.0) + std::max(s * (Sd[i] - K), 0.0));
+                        sx += x;
+                        sxx += x * x;
+                    }
+                } else {
+                    for (long i = 0; i < n; ++i) {
+                        const double x = std::max(s * (Su[i] - K), 0.0);
+                        sx += x;
+                        sxx += x * x;
+                    }
+                }
+                acc_ptr[2 * (e * nK + k)] += sx;
+                acc_ptr[2 * (e * nK + k) + 1] += sxx;
+            }
+        }
+    }
+
+    const double n = static_cast<double>(num_paths);
+    long steps_so_far = 0;
+    for (std::size_t e = 0; e < nE; ++e) {
+        steps_so_far += interval_steps[e];
+        const double disc = std::exp(-r * grid.expiries[e]);
+        for (std::size_t k = 0; k < nK; ++k) {
+            const double mX = acc[2 * (e * nK + k)] / n;
+            const double vX = std::max(0.0, acc[2 * (e * nK + k) + 1] / n - mX * mX);
+            MCResult& res = grid.at(e, k);
+            res.price = disc * mX;
+            res.std_error = disc * std::sqrt(vX / n);
+            res.num_paths = num_paths;
+            res.num_steps = steps_so_far;
+            res.seed = seed;
+        }
+    }
+    return grid;
+}
+
 }
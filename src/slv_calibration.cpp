@@ -51,10 +51,10 @@ double estimate_model_implied_volatility_mc(
         return 0.2; // Default for expired options
     }
     
-    // Create a leverage-based local volatility function
-    auto leverage_local_vol = [&leverage](double St, double tt) -> double {
-        double L_val = leverage.interpolate(St, tt);
-        return 0.2 * L_val; // Base volatility * leverage
+    // Create a leverage-based local volatility function, evaluated per path block
+    const LocalVolBatchFn leverage_local_vol = [&leverage](double tt, std::size_t n, const double* St, double* out) {
+        leverage.interpolate_batch(tt, n, St, out);
+        for (std::size_t i = 0; i < n; ++i) out[i] *= 0.2; // Base volatility * leverage
     };
     
     // Run SLV Monte Carlo to get option price
@@ -0,0 +1,255 @@
+/**
+ * @file svi.cpp
+ * @brief Quasi-explicit raw SVI calibration
+ *
+ * @author LN697
+ * @version 1.0
+ */
+
+#include "svi.hpp"
+#include "implied_forward.hpp"
+#include "math_utils.hpp"
+#include <array>
+#include <limits>
+#include <map>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace bsm {
+
+namespace {
+
+// Inner problem for fixed (m, s): w ~ a + d y + c z with y = (k - m)/s, z = sqrt(y^2 + 1),
+// c = b s and d = rho b s, over 0 <= c <= 2s, |d| <= c, |d| <= 2s - c
+struct InnerFit {
+    double a{0.0}, c{0.0}, d{0.0};
+    double sse{std::numeric_limits<double>::infinity()};
+};
+
+struct Moments {
+    // Weighted sums of products of {1, y, z} and w
+    double s11{0}, s1y{0}, s1z{0}, syy{0}, syz{0}, szz{0}, s1w{0}, syw{0}, szw{0};
+};
+
+// Residuals are summed directly: expanding the square in the moments cancels
+// catastrophically when z is nearly constant (large s) and the fit is tight
+double sse_of(const std::vector<double>& k, const std::vector<double>& w, const std::vector<double>& wt,
+              double m, double s, double a, double c, double d) {
+    double sse = 0.0;
+    for (std::size_t i = 0; i < k.size(); ++i) {
+        const double y = (k[i] - m) / s, e = a + d * y + c * std::sqrt(y * y + 1.0) - w[i];
+        sse += (wt.empty() ? 1.0 : wt[i]) * e * e;
+    }
+    return sse;
+}
+
+bool solve3(std::array<double, 9> A, std::array<double, 3> b, std::array<double, 3>& x) {
+    for (int i = 0; i < 3; ++i) {
+        int piv = i;
+        for (int r = i + 1; r < 3; ++r) if (std::abs(A[r * 3 + i]) > std::abs(A[piv * 3 + i])) piv = r;
+        if (std::abs(A[piv * 3 + i]) < 1e-300) return false;
+        if (piv != i) {
+            for (int c = 0; c < 3; ++c) std::swap(A[i * 3 + c], A[piv * 3 + c]);
+            std::swap(b[i], b[piv]);
+        }
+        for (int r = i + 1; r < 3; ++r) {
+            const double f = A[r * 3 + i] / A[i * 3 + i];
+            for (int c = i; c < 3; ++c) A[r * 3 + c] -= f * A[i * 3 + c];
+            b[r] -= f * b[i];
+        }
+    }
+    for (int i = 2; i >= 0; --i) {
+        double s = b[i];
+        for (int c = i + 1; c < 3; ++c) s -= A[i * 3 + c] * x[c];
+        x[i] = s / A[i * 3 + i];
+    }
+    return true;
+}
+
+InnerFit inner_fit(const std::vector<double>& k, const std::vector<double>& w, const std::vector<double>& wt,
+                   double m, double s) {
+    Moments M;
+    for (std::size_t i = 0; i < k.size(); ++i) {
+        const double y = (k[i] - m) / s, z = std::sqrt(y * y + 1.0), q = wt.empty() ? 1.0 : wt[i];
+        M.s11 += q; M.s1y += q * y; M.s1z += q * z; M.syy += q * y * y; M.syz += q * y * z; M.szz += q * z * z;
+        M.s1w += q * w[i]; M.syw += q * y * w[i]; M.szw += q * z * w[i];
+    }
+    // Candidates are made feasible for a as well: the minimum total variance
+    // a + sqrt(c^2 - d^2) must not be negative
+    InnerFit best;
+    auto consider = [&](double a, double c, double d) {
+        a = std::max(a, -std::sqrt(std::max(c * c - d * d, 0.0)));
+        const double sse = sse_of(k, w, wt, m, s, a, c, d);
+        if (sse < best.sse) best = {a, c, d, sse};
+    };
+    std::array<double, 3> x{};
+    if (solve3({M.s11, M.s1y, M.s1z, M.s1y, M.syy, M.syz, M.s1z, M.syz, M.szz}, {M.s1w, M.syw, M.szw}, x)) {
+        const double a = x[0], d = x[1], c = x[2];
+        if (c >= 0.0 && c <= 2.0 * s && std::abs(d) <= c && std::abs(d) <= 2.0 * s - c) {
+            consider(a, c, d);
+            if (a >= -std::sqrt(std::max(c * c - d * d, 0.0))) return best;
+        }
+    }
+    // Optimum on an edge of the (c, d) diamond: d = alpha + beta c, c in [lo, hi]
+    const double edges[4][4] = {{0.0, 1.0, 0.0, s}, {0.0, -1.0, 0.0, s},
+                                {2.0 * s, -1.0, s, 2.0 * s}, {-2.0 * s, 1.0, s, 2.0 * s}};
+    for (const auto& e : edges) {
+        const double alpha = e[0], beta = e[1];
+        // Regressor u = beta y + z for c, target w - alpha y, intercept a
+        const double suu = beta * beta * M.syy + 2.0 * beta * M.syz + M.szz;
+        const double s1u = beta * M.s1y + M.s1z;
+        const double s1t = M.s1w - alpha * M.s1y;
+        const double sut = beta * M.syw + M.szw - alpha * (beta * M.syy + M.syz);
+        const double det = M.s11 * suu - s1u * s1u;
+        double c = det > 0.0 ? (M.s11 * sut - s1u * s1t) / det : e[2];
+        c = std::min(std::max(c, e[2]), e[3]);
+        const double a = (s1t - c * s1u) / M.s11;
+        consider(a, c, alpha + beta * c);
+    }
+    return best;
+}
+
+// Nelder-Mead over (m, ln s), with the vertex m kept inside the quoted range so
+// that the wings are not bent beyond the data
+SVIParams minimise_outer(const std::vector<double>& k, const std::vector<double>& w, const std::vector<double>& wt) {
+    const double k_lo = *std::min_element(k.begin(), k.end()), k_hi = *std::max_element(k.begin(), k.end());
+    const double span = std::max(k_hi - k_lo, 1e-3);
+    auto objective = [&](const std::array<double, 2>& p) {
+        if (p[0] < k_lo || p[0] > k_hi || p[1] < std::log(1e-4) || p[1] > std::log(10.0)) {
+            return std::numeric_limits<double>::infinity();
+        }
+        return inner_fit(k, w, wt, p[0], std::exp(p[1])).sse;
+    };
+
+    // Restarted from the variance minimum and the middle of the strike range;
+    // narrow or nearly linear smiles leave shallow local minima
+    const std::size_t i_min = static_cast<std::size_t>(std::min_element(w.begin(), w.end()) - w.begin());
+    double best_m = k[i_min], best_s = 0.1, best_f = std::numeric_limits<double>::infinity();
+    for (double m0 : {k[i_min], 0.5 * (k_lo + k_hi)}) {
+        std::array<std::array<double, 2>, 3> simplex = {{{m0, std::log(0.1)},
+                                                         {std::min(m0 + 0.1 * span, k_hi), std::log(0.1)},
+                                                         {m0, std::log(0.3)}}};
+        if (simplex[1][0] == m0) simplex[1][0] = m0 - 0.1 * span;
+        std::array<double, 3> f;
+        for (int i = 0; i < 3; ++i) f[i] = objective(simplex[i]);
+        for (int it = 0; it < 400; ++it) {
+            std::array<int, 3> o = {0, 1, 2};
+            std::sort(o.begin(), o.end(), [&](int x, int y) { return f[x] < f[y]; });
+            const int best = o[0], mid = o[1], worst = o[2];
+            if (std::abs(f[worst] - f[best]) <= 1e-14 * (std::abs(f[best]) + 1e-20) &&
+                std::abs(simplex[worst][0] - simplex[best][0]) + std::abs(simplex[worst][1] - simplex[best][1]) < 1e-10) {
+                break;
+            }
+            std::array<double, 2> centre, trial;
+            for (int j = 0; j < 2; ++j) centre[j] = 0.5 * (simplex[best][j] + simplex[mid][j]);
+            auto along = [&](double t) {
+                std::array<double, 2> p;
+                for (int j = 0; j < 2; ++j) p[j] = centre[j] + t * (simplex[worst][j] - centre[j]);
+                return p;
+            };
+            trial = along(-1.0);
+            const double fr = objective(trial);
+            if (fr < f[best]) {
+                const std::array<double, 2> expanded = along(-2.0);
+                const double fe = objective(expanded);
+                if (fe < fr) { simplex[worst] = expanded; f[worst] = fe; }
+                else { simplex[worst] = trial; f[worst] = fr; }
+            } else if (fr < f[mid]) {
+                simplex[worst] = trial; f[worst] = fr;
+            } else {
+                const std::array<double, 2> contracted = along(fr < f[worst] ? -0.5 : 0.5);
+                const double fc = objective(contracted);
+                if (fc < std::min(fr, f[worst])) {
+                    simplex[worst] = contracted; f[worst] = fc;
+                } else {
+                    for (int i : {mid, worst}) {
+                        for (int j = 0; j < 2; ++j) simplex[i][j] = 0.5 * (simplex[i][j] + simplex[best][j]);
+                        f[i] = objective(simplex[i]);
+                    }
+                }
+            }
+        }
+        const int best = static_cast<int>(std::min_element(f.begin(), f.end()) - f.begin());
+        if (f[best] < best_f) { best_f = f[best]; best_m = simplex[best][0]; best_s = std::exp(simplex[best][1]); }
+    }
+    const double m = best_m, s = best_s;
+    const InnerFit in = inner_fit(k, w, wt, m, s);
+    SVIParams p;
+    p.m = m;
+    p.sigma = s;
+    p.a = in.a;
+    p.b = in.c / s;
+    p.rho = in.c > 0.0 ? in.d / in.c : 0.0;
+    return p;
+}
+
+} // namespace
+
+SVIParams fit_svi(const std::vector<double>& k, const std::vector<double>& w, const std::vector<double>& weights) {
+    if (k.size() != w.size() || (!weights.empty() && weights.size() != k.size())) {
+        throw std::invalid_argument("fit_svi: k, w and weights must have the same length");
+    }
+    if (k.size() < 5) throw std::invalid_argument("fit_svi: at least five points are needed");
+    return minimise_outer(k, w, weights);
+}
+
+std::vector<SVISlice> fit_svi_surface(const std::vector<OptionQuote>& quotes,
+                                      const std::vector<ImpliedForward>& forwards) {
+    const std::vector<double> vols = implied_vols_from_forwards(quotes, forwards);
+
+    std::map<std::pair<std::string, double>, std::size_t> slot;
+    for (std::size_t f = 0; f < forwards.size(); ++f) slot[{forwards[f].underlying, forwards[f].T}] = f;
+    std::vector<std::vector<std::size_t>> members(forwards.size());
+    for (std::size_t i = 0; i < quotes.size(); ++i) {
+        const auto it = slot.find({quotes[i].underlying, quotes[i].T});
+        if (it == slot.end() || !std::isfinite(vols[i])) continue;
+        // A zero bid only bounds the price; its mid says little about the vol
+        if (!(quotes[i].bid > 0.0)) continue;
+        const ImpliedForward& f = forwards[it->second];
+        const bool otm = is_call(quotes[i].type) ? quotes[i].strike >= f.forward : quotes[i].strike < f.forward;
+        if (otm) members[it->second].push_back(i);
+    }
+
+    std::vector<SVISlice> out(forwards.size());
+    const long num = static_cast<long>(forwards.size());
+    #ifdef _OPENMP
+    #pragma omp parallel for schedule(dynamic)
+    #endif
+    for (long f = 0; f < num; ++f) {
+        const ImpliedForward& fwd = forwards[f];
+        SVISlice& s = out[f];
+        s.underlying = fwd.underlying;
+        s.T = fwd.T;
+        s.forward = fwd.forward;
+        s.discount = fwd.discount;
+        s.points = members[f].size();
+        if (!fwd.valid || s.points < 5) continue;
+
+        std::vector<double> k, w;
+        for (std::size_t i : members[f]) {
+            k.push_back(std::log(quotes[i].strike / fwd.forward));
+            w.push_back(vols[i] * vols[i] * fwd.T);
+        }
+        s.params = minimise_outer(k, w, {});
+        double ss = 0.0;
+        for (std::size_t i = 0; i < k.size(); ++i) {
+            const double e = std::sqrt(std::max(s.params.total_variance(k[i]), 0.0) / fwd.T) - vols[members[f][i]];
+            ss += e * e;
+        }
+        s.rms_vol_error = std::sqrt(ss / k.size());
+        s.valid = true;
+    }
+    return out;
+}
+
+void black_otm_normalized_batch(std::size_t n, const double* k, const double* w, double* out) {
+    for (std::size_t i = 0; i < n; ++i) {
+        const double sd = std::sqrt(std::max(w[i], 0.0));
+        if (sd <= 0.0) { out[i] = 0.0; continue; }
+        const double d1 = -k[i] / sd + 0.5 * sd, d2 = d1 - sd;
+        out[i] = k[i] >= 0.0 ? norm_cdf(d1) - std::exp(k[i]) * norm_cdf(d2)
+                             : std::exp(k[i]) * norm_cdf(-d2) - norm_cdf(-d1);
+    }
+}
+
+}
@@ -0,0 +1,216 @@
+/**
+ * @file variance_swap.cpp
+ * @brief Variance swap replication on SVI smiles and discrete VIX-style strips
+ *
+ * @author LN697
+ * @version 1.0
+ */
+
+#include "variance_swap.hpp"
+#include "implied_forward.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <utility>
+
+namespace bsm {
+
+namespace {
+
+// 15-point Kronrod nodes on [-1, 1] (non-negative half) and weights; the odd
+// entries are the embedded 7-point Gauss nodes
+constexpr double kXgk[8] = {0.991455371120812639206854697526329, 0.949107912342758524526189684047851,
+                            0.864864423359769072789712788640926, 0.741531185599394439863864773280788,
+                            0.586087235467691130294144845693013, 0.405845151377397166906606412076961,
+                            0.207784955007898467600689403773245, 0.0};
+constexpr double kWgk[8] = {0.022935322010529224963732008058970, 0.063092092629978553290700663189204,
+                            0.104790010322250183839876322541518, 0.140653259715525918745189590510238,
+                            0.169004726639267902826583426598550, 0.190350578064785409913256402421014,
+                            0.204432940075298892414161999234649, 0.209482141084727828012999174891714};
+constexpr double kWg[4] = {0.129484966168869693270611432679082, 0.279705391489276667901467771423780,
+                           0.381830050505118944950369775488975, 0.417959183673469387755102040816327};
+
+struct Panel {
+    double lo, hi, value, error;
+};
+
+// Replication integrand on t in [0, 1): k = +-t/(1 - t) for the call and put
+// wings, otm(k) e^{-k} dk/dt. All 15 nodes of a panel (30 prices) in one batch.
+Panel integrate_panel(const SVIParams& smile, double lo, double hi) {
+    const double half = 0.5 * (hi - lo), mid = 0.5 * (hi + lo);
+    double t[15];
+    for (int j = 0; j < 7; ++j) {
+        t[2 * j] = mid - half * kXgk[j];
+        t[2 * j + 1] = mid + half * kXgk[j];
+    }
+    t[14] = mid;
+
+    double k[30], w[30], otm[30], jac[15];
+    for (int j = 0; j < 15; ++j) {
+        const double u = 1.0 - t[j];
+        jac[j] = 1.0 / (u * u);
+        k[j] = t[j] / u;
+        k[15 + j] = -k[j];
+    }
+    for (int j = 0; j < 30; ++j) w[j] = smile.total_variance(k[j]);
+    black_otm_normalized_batch(30, k, w, otm);
+
+    double f[15];
+    for (int j = 0; j < 15; ++j) {
+        double g = 0.0;
+        for (int side = 0; side < 2; ++side) {
+            const int i = 15 * side + j;
+            if (otm[i] > 0.0 && k[i] > -700.0) g += otm[i] * std::exp(-k[i]);
+        }
+        f[j] = g * jac[j];
+    }
+
+    double kronrod = kWgk[7] * f[14], gauss = kWg[3] * f[14];
+    for (int j = 0; j < 7; ++j) {
+        const double pair = f[2 * j] + f[2 * j + 1];
+        kronrod += kWgk[j] * pair;
+        if (j % 2 == 1) gauss += kWg[j / 2] * pair;
+    }
+    return {lo, hi, kronrod * half, std::abs(kronrod - gauss) * half};
+}
+
+std::pair<double, double> replicate(const SVIParams& smile, double tol) {
+    std::vector<Panel> panels;
+    for (int i = 0; i < 8; ++i) panels.push_back(integrate_panel(smile, i / 8.0, (i + 1) / 8.0));
+    auto totals = [&]() {
+        double v = 0.0, e = 0.0;
+        for (const Panel& p : panels) { v += p.value; e += p.error; }
+        return std::make_pair(v, e);
+    };
+    std::pair<double, double> sum = totals();
+    while (sum.second > tol && panels.size() < 500) {
+        const auto worst = std::max_element(panels.begin(), panels.end(),
+                                            [](const Panel& a, const Panel& b) { return a.error < b.error; });
+        const double lo = worst->lo, hi = worst->hi, c = 0.5 * (lo + hi);
+        *worst = integrate_panel(smile, lo, c);
+        panels.push_back(integrate_panel(smile, c, hi));
+        sum = totals();
+    }
+    return sum;
+}
+
+} // namespace
+
+double svi_fair_variance(const SVIParams& smile, double T, double tol, double* error) {
+    // A put wing at Lee's bound makes E[-log S_T] infinite; the call wing
+    // integrand is damped by e^{-k} for any slope
+    if (smile.b * (1.0 - smile.rho) >= 2.0) {
+        if (error) *error = 0.0;
+        return std::numeric_limits<double>::infinity();
+    }
+    const std::pair<double, double> r = replicate(smile, tol);
+    if (error) *error = 2.0 * r.second / T;
+    return 2.0 * r.first / T;
+}
+
+double discrete_fair_variance(const std::vector<OptionQuote>& quotes, double forward, double discount,
+                              double T, std::size_t* strikes_used) {
+    // Best bid and ask per strike: {call bid, call ask, put bid, put ask}
+    const double inf = std::numeric_limits<double>::infinity();
+    std::map<double, std::array<double, 4>> book;
+    for (const OptionQuote& q : quotes) {
+        auto it = book.emplace(q.strike, std::array<double, 4>{-inf, inf, -inf, inf}).first;
+        const int side = is_call(q.type) ? 0 : 2;
+        it->second[side] = std::max(it->second[side], q.bid);
+        it->second[side + 1] = std::min(it->second[side + 1], q.ask);
+    }
+    if (strikes_used) *strikes_used = 0;
+    auto k0 = book.upper_bound(forward);
+    if (k0 == book.begin()) return 0.0;
+    --k0;
+
+    // Out-of-the-money strip outwards from K0, stopping after two consecutive zero bids
+    std::vector<std::pair<double, double>> strip;   // (strike, mid)
+    const auto& q0 = k0->second;
+    if (std::isfinite(q0[1]) && std::isfinite(q0[3])) {
+        strip.emplace_back(k0->first, 0.25 * (q0[0] + q0[1] + q0[2] + q0[3]));
+    }
+    int zeros = 0;
+    for (auto it = std::make_reverse_iterator(k0); it != book.rend() && zeros < 2; ++it) {
+        const double bid = it->second[2], ask = it->second[3];
+        if (!(bid > 0.0) || !std::isfinite(ask)) { ++zeros; continue; }
+        zeros = 0;
+        strip.emplace_back(it->first, 0.5 * (bid + ask));
+    }
+    zeros = 0;
+    for (auto it = std::next(k0); it != book.end() && zeros < 2; ++it) {
+        const double bid = it->second[0], ask = it->second[1];
+        if (!(bid > 0.0) || !std::isfinite(ask)) { ++zeros; continue; }
+        zeros = 0;
+        strip.emplace_back(it->first, 0.5 * (bid + ask));
+    }
+    if (strip.size() < 2) return 0.0;
+    std::sort(strip.begin(), strip.end());
+
+    double sum = 0.0;
+    const std::size_t n = strip.size();
+    for (std::size_t i = 0; i < n; ++i) {
+        const double dK = i == 0 ? strip[1].first - strip[0].first
+                        : i == n - 1 ? strip[n - 1].first - strip[n - 2].first
+                        : 0.5 * (strip[i + 1].first - strip[i - 1].first);
+        const double K = strip[i].first;
+        sum += dK / (K * K) * strip[i].second;
+    }
+    if (strikes_used) *strikes_used = n;
+    const double adj = forward / k0->first - 1.0;
+    return 2.0 / T * sum / discount - adj * adj / T;
+}
+
+std::vector<VarianceSwapQuote> variance_term_structure(const std::vector<OptionQuote>& quotes,
+                                                       const std::vector<ImpliedForward>& forwards,
+                                                       const std::vector<SVISlice>& slices) {
+    std::map<std::pair<std::string, double>, std::size_t> slot;
+    for (std::size_t f = 0; f < forwards.size(); ++f) slot[{forwards[f].underlying, forwards[f].T}] = f;
+    std::vector<std::vector<OptionQuote>> members(forwards.size());
+    for (const OptionQuote& q : quotes) {
+        const auto it = slot.find({q.underlying, q.T});
+        if (it != slot.end()) members[it->second].push_back(q);
+    }
+
+    std::vector<VarianceSwapQuote> out(forwards.size());
+    const long num = static_cast<long>(forwards.size());
+    #ifdef _OPENMP
+    #pragma omp parallel for schedule(dynamic)
+    #endif
+    for (long f = 0; f < num; ++f) {
+        const ImpliedForward& fwd = forwards[f];
+        VarianceSwapQuote& v = out[f];
+        v.underlying = fwd.underlying;
+        v.T = fwd.T;
+        if (!fwd.valid) continue;
+        v.discrete_variance = discrete_fair_variance(members[f], fwd.forward, fwd.discount, fwd.T, &v.strikes_used);
+        if (static_cast<std::size_t>(f) < slices.size() && slices[f].valid) {
+            v.fair_variance = svi_fair_variance(slices[f].params, fwd.T, 1e-12, &v.integration_error);
+            v.valid = true;
+        }
+    }
+    return out;
+}
+
+double vix_style_index(const std::vector<VarianceSwapQuote>& term, const std::string& underlying,
+                       double target_T, bool use_discrete) {
+    std::vector<std::pair<double, double>> pts;   // (T, annualised variance)
+    for (const VarianceSwapQuote& v : term) {
+        const double var = use_discrete ? v.discrete_variance : (v.valid ? v.fair_variance : 0.0);
+        if (v.underlying == underlying && std::isfinite(var) && var > 0.0) pts.emplace_back(v.T, var);
+    }
+    if (pts.empty()) return std::numeric_limits<double>::quiet_NaN();
+    std::sort(pts.begin(), pts.end());
+    if (pts.size() == 1) return 100.0 * std::sqrt(pts[0].second);
+
+    std::size_t j = 1;
+    while (j + 1 < pts.size() && pts[j].first < target_T) ++j;
+    const double T1 = pts[j - 1].first, T2 = pts[j].first;
+    const double w1 = T1 * pts[j - 1].second, w2 = T2 * pts[j].second;
+    const double w = w1 + (w2 - w1) * (target_T - T1) / (T2 - T1);
+    return 100.0 * std::sqrt(std::max(w, 0.0) / target_T);
+}
+
+}
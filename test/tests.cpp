@@ -19,9 +19,22 @@
 #include <cmath>
 #include <iostream>
 #include <vector>
+#include <algorithm>
 #include <random>
 #include <chrono>
+#include <stdexcept>
 #include <string>
+#include <cstdio>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <thread>
+#include <future>
+#include <mutex>
+#include <numeric>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 #include "analytic_bs.hpp"
 #include "monte_carlo_gbm.hpp"
@@ -32,6 +45,26 @@
 #include "iv_solve.hpp"
 #include "math_utils.hpp"
 #include "stats.hpp"
+#include "portfolio.hpp"
+#include "pde_heston_adi.hpp"
+#include "pde_multi_asset.hpp"
+#include "barrier.hpp"
+#include "asian.hpp"
+#include "lsm.hpp"
+#include "path_store.hpp"
+#include "arbitrage.hpp"
+#include "implied_forward.hpp"
+#include "variance_swap.hpp"
+#include "isa_dispatch.hpp"
+#include "tridiagonal.hpp"
+#include "dupire.hpp"
+#include "engine_tuning.hpp"
+#include "accuracy_harness.hpp"
+#include "result_writer.hpp"
+#include "shm_cache.hpp"
+#include "async_pricing.hpp"
+#include "risk_graph.hpp"
+#include "pnl_explain.hpp"
 
 #ifdef USE_PERFORMANCE_UTILS
 #include "performance_utils.hpp"
@@ -587,6 +620,1912 @@ void test_numerical_stability() {
                 "Small parameter changes produce stable results");
 }
 
+/**
+ * @brief Test grouped portfolio pricing against per-position pricing
+ */
+void test_portfolio_grouping() {
+    print_section("Grouped Portfolio Pricing");
+
+    const double r = 0.05;
+    std::vector<PositionSpec> book = generate_sample_portfolio(2000, 7);
+    const auto groups = plan_pricing_groups(book);
+
+    size_t grouped_members = 0;
+    for (const auto& g : groups) grouped_members += g.members.size();
+    test_assert(grouped_members == book.size(), "Every position is assigned to exactly one group");
+    test_assert(groups.size() < book.size() / 2, "Sample book clusters into shared pricing groups");
+
+    PortfolioPricingConfig cfg;
+    cfg.r = r;
+    const auto grouped = price_portfolio(book, cfg);
+    double max_err = 0.0;
+    for (size_t i = 0; i < book.size(); ++i) {
+        const auto& p = book[i];
+        max_err = std::max(max_err, std::abs(grouped.positions[i].price -
+                  black_scholes_price(p.spot, p.strike, r, p.T, p.sigma, p.type)));
+    }
+    test_assert(max_err < 1e-10, "Grouped analytic prices match per-position formulas");
+
+    // One shared grid / path set per group vs one per position
+    std::vector<PositionSpec> ladder;
+    for (double K : {80.0, 90.0, 100.0, 110.0, 120.0}) {
+        for (OptionType type : {OptionType::Call, OptionType::Put}) {
+            ladder.push_back(PositionSpec{"X", 1.0, 100.0, K, 0.5, 0.25, type, PricingModel::PDE});
+        }
+    }
+    const auto pde = price_portfolio(ladder, cfg);
+    cfg.group_positions = false;
+    const auto pde_single = price_portfolio(ladder, cfg);
+    cfg.group_positions = true;
+    bool pde_ok = pde.num_groups == 1 && pde_single.num_groups == ladder.size();
+    for (size_t i = 0; i < ladder.size(); ++i) {
+        const auto& p = ladder[i];
+        const double bs = black_scholes_price(p.spot, p.strike, r, p.T, p.sigma, p.type);
+        const double bs_delta = black_scholes_delta(p.spot, p.strike, r, p.T, p.sigma, p.type);
+        const double bs_vega = black_scholes_vega(p.spot, p.strike, r, p.T, p.sigma);
+        pde_ok = pde_ok && std::abs(pde.positions[i].price - bs) < 0.02
+                       && std::abs(pde.positions[i].delta - bs_delta) < 0.005
+                       && std::abs(pde.positions[i].vega - bs_vega) < 0.1
+                       && std::abs(pde_single.positions[i].price - bs) < 0.02;
+    }
+    test_assert(pde_ok, "Shared PDE grid prices all strikes of a group accurately");
+
+    for (auto& p : ladder) p.model = PricingModel::MonteCarlo;
+    cfg.mc_paths = 200000;
+    const auto mc = price_portfolio(ladder, cfg);
+    bool mc_ok = true;
+    for (size_t i = 0; i < ladder.size(); ++i) {
+        const auto& p = ladder[i];
+        const double bs = black_scholes_price(p.spot, p.strike, r, p.T, p.sigma, p.type);
+        const double bs_gamma = black_scholes_gamma(p.spot, p.strike, r, p.T, p.sigma);
+        mc_ok = mc_ok && mc.positions[i].std_error > 0.0
+                      && std::abs(mc.positions[i].price - bs) < 4.0 * mc.positions[i].std_error + 1e-3
+                      && std::abs(mc.positions[i].gamma - bs_gamma) < 0.1 * bs_gamma + 1e-3;
+    }
+    test_assert(mc_ok, "Shared MC path set prices all strikes within statistical error");
+}
+
+/**
+ * @brief Test multi-strike, multi-expiry Monte Carlo on a single path set
+ */
+void test_mc_price_grid() {
+    print_section("Multi-Strike / Multi-Expiry Monte Carlo");
+
+    const double S0 = 100.0, r = 0.05, sigma = 0.2;
+    const std::vector<double> strikes{80.0, 90.0, 100.0, 110.0, 120.0};
+    const std::vector<double> expiries{1.0, 0.25, 0.5};
+
+    const MCResultGrid gbm = mc_gbm_price_grid(S0, strikes, expiries, r, sigma, 200000, OptionType::Call);
+    test_assert(gbm.expiries.size() == 3 && gbm.expiries.front() == 0.25,
+                "Grid expiries are sorted ascending");
+    bool within_se = true, greeks_ok = true;
+    for (size_t e = 0; e < gbm.expiries.size(); ++e) {
+        for (size_t k = 0; k < strikes.size(); ++k) {
+            const double T = gbm.expiries[e];
+            const MCResult& cell = gbm.at(e, k);
+            const double bs = black_scholes_price(S0, strikes[k], r, T, sigma, OptionType::Call);
+            within_se = within_se && std::abs(cell.price - bs) < 4.0 * cell.std_error + 1e-3;
+            greeks_ok = greeks_ok
+                && std::abs(cell.delta - black_scholes_delta(S0, strikes[k], r, T, sigma, OptionType::Call)) < 0.01
+                && std::abs(cell.vega - black_scholes_vega(S0, strikes[k], r, T, sigma)) < 0.5;
+        }
+    }
+    test_assert(within_se, "GBM grid prices agree with Black-Scholes within 4 standard errors");
+    test_assert(greeks_ok, "GBM grid pathwise delta and vega agree with Black-Scholes");
+
+    // Shared paths: the calendar spread is more precise than either leg
+    HestonParams heston{1.5, 0.04, 0.3, -0.7, 0.04};
+    auto lv = CEVLocalVol{1.0, 1.0, S0}.to_fn();
+    const MCResultGrid slv = mc_slv_price_grid(S0, strikes, expiries, r, 20000, 50, OptionType::Put,
+                                               heston, lv, 2024UL);
+    bool slv_ok = true;
+    for (size_t e = 0; e < slv.expiries.size(); ++e) {
+        for (size_t k = 0; k < strikes.size(); ++k) {
+            const MCResult single = mc_slv_price(S0, strikes[k], r, slv.expiries[e], 20000,
+                                                 std::max(1L, slv.at(e, k).num_steps), OptionType::Put,
+                                                 heston, lv, 99UL + k);
+            const double tol = 5.0 * std::sqrt(single.std_error * single.std_error +
+                                               slv.at(e, k).std_error * slv.at(e, k).std_error) + 1e-3;
+            slv_ok = slv_ok && std::abs(single.price - slv.at(e, k).price) < tol;
+        }
+    }
+    test_assert(slv_ok, "SLV grid cells agree with single-contract SLV pricing");
+
+    bool monotone = true;
+    for (size_t e = 0; e < slv.expiries.size(); ++e) {
+        for (size_t k = 1; k < strikes.size(); ++k) {
+            monotone = monotone && slv.at(e, k).price >= slv.at(e, k - 1).price;
+        }
+    }
+    test_assert(monotone, "Shared-path put prices are monotone in strike");
+}
+
+/**
+ * @brief Test the Heston/SLV ADI PDE against Black-Scholes limits, barriers and Monte Carlo
+ */
+void test_heston_adi_pde() {
+    print_section("Heston/SLV ADI PDE");
+
+    const double S0 = 100.0, K = 100.0, r = 0.05, T = 1.0;
+
+    // Vanishing vol-of-vol with v0 = theta collapses to Black-Scholes at sqrt(theta)
+    const HestonParams flat{1.5, 0.04, 0.01, 0.0, 0.04};
+    const PDEResult bs_like = pde_heston_adi(S0, K, r, T, OptionType::Call, flat);
+    test_assert(std::abs(bs_like.price - black_scholes_price(S0, K, r, T, 0.2, OptionType::Call)) < 0.01,
+                "Heston PDE reduces to Black-Scholes as xi -> 0");
+    test_assert(std::abs(bs_like.delta - black_scholes_delta(S0, K, r, T, 0.2, OptionType::Call)) < 0.003,
+                "Heston PDE delta matches Black-Scholes as xi -> 0");
+
+    LeverageGrid constant;
+    constant.t = {0.0};
+    constant.S = {50.0, 200.0};
+    constant.L = {{1.5, 1.5}};
+    const PDEResult levered = pde_heston_adi(S0, K, r, T, OptionType::Call, flat, &constant);
+    test_assert(std::abs(levered.price - black_scholes_price(S0, K, r, T, 0.3, OptionType::Call)) < 0.02,
+                "Constant leverage scales the volatility");
+
+    // Up-and-out call under Black-Scholes dynamics (reflection principle value)
+    const BarrierSpec up_out{BarrierType::UpOut, 130.0, 0.0};
+    const PDEResult uo_bs = pde_heston_adi(S0, K, r, T, OptionType::Call, flat, nullptr,
+                                           ExerciseStyle::European, up_out);
+    test_assert(std::abs(uo_bs.price - 3.33286) < 0.01, "Up-and-out call matches the closed form");
+
+    const HestonParams heston{1.5, 0.04, 0.3, -0.9, 0.04};
+    const double ref = pde_heston_adi(S0, K, 0.025, T, OptionType::Call, heston).price;
+    test_assert(std::abs(ref - 8.8948) < 0.01, "Heston call matches the reference value");
+    bool schemes_agree = true;
+    for (ADIScheme s : {ADIScheme::CraigSneyd, ADIScheme::ModifiedCraigSneyd}) {
+        HestonADIConfig cfg;
+        cfg.scheme = s;
+        const double p = pde_heston_adi(S0, K, 0.025, T, OptionType::Call, heston, nullptr,
+                                        ExerciseStyle::European, {}, cfg).price;
+        schemes_agree = schemes_agree && std::abs(p - ref) < 0.01;
+    }
+    test_assert(schemes_agree, "Craig-Sneyd variants agree with Hundsdorfer-Verwer");
+
+    const double euro_put = pde_heston_adi(S0, K, r, T, OptionType::Put, heston).price;
+    const double amer_put = pde_heston_adi(S0, K, r, T, OptionType::Put, heston, nullptr,
+                                           ExerciseStyle::American).price;
+    test_assert(amer_put > euro_put, "American put carries an early exercise premium");
+
+    const double vanilla = pde_heston_adi(S0, K, r, T, OptionType::Call, heston).price;
+    const double out = pde_heston_adi(S0, K, r, T, OptionType::Call, heston, nullptr,
+                                      ExerciseStyle::European, up_out).price;
+    const double in = pde_heston_adi(S0, K, r, T, OptionType::Call, heston, nullptr, ExerciseStyle::European,
+                                     {BarrierType::UpIn, 130.0, 0.0}).price;
+    test_assert(out > 0.0 && out < vanilla, "Knock-out is cheaper than the vanilla");
+    test_assert(std::abs(in + out - vanilla) < 1e-8, "Knock-in + knock-out = vanilla");
+
+    bool threw = false;
+    try {
+        (void)pde_heston_adi(S0, K, r, T, OptionType::Put, heston, nullptr, ExerciseStyle::American,
+                             {BarrierType::DownIn, 80.0, 0.0});
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    test_assert(threw, "American knock-in is rejected");
+
+    // SLV: time-dependent leverage, compared with the Monte Carlo engine
+    LeverageGrid smile;
+    smile.t = {0.0, 0.5, 1.0};
+    for (int i = 0; i <= 20; ++i) smile.S.push_back(40.0 + 10.0 * i);
+    for (double t : smile.t) {
+        std::vector<double> row;
+        for (double S : smile.S) row.push_back(1.0 + 0.2 * std::log(K / S) + 0.1 * t);
+        smile.L.push_back(row);
+    }
+    const double slv_pde = pde_heston_adi(S0, K, r, T, OptionType::Put, heston, &smile).price;
+    const MCResult slv_mc = mc_slv_price(S0, K, r, T, 40000, 100, OptionType::Put, heston,
+                                         [&smile](double S, double t) { return smile.interpolate(S, t); });
+    test_assert(std::abs(slv_pde - slv_mc.price) < 4.0 * slv_mc.std_error + 0.03,
+                "SLV PDE agrees with SLV Monte Carlo");
+}
+
+/**
+ * @brief Test two- and three-asset ADI against Margrabe, Black-Scholes and Monte Carlo
+ */
+void test_multi_asset_adi() {
+    print_section("Multi-Asset ADI PDE");
+
+    const double r = 0.05, T = 1.0;
+    const std::vector<std::vector<double>> corr2{{1.0, 0.5}, {0.5, 1.0}};
+
+    // Exchange option max(S1 - S2, 0) against Margrabe's formula
+    const double s_ex = std::sqrt(0.3 * 0.3 + 0.2 * 0.2 - 2.0 * 0.5 * 0.3 * 0.2);
+    const double d1 = (std::log(100.0 / 95.0) + 0.5 * s_ex * s_ex * T) / (s_ex * std::sqrt(T));
+    const double margrabe = 100.0 * norm_cdf(d1) - 95.0 * norm_cdf(d1 - s_ex * std::sqrt(T));
+    const MultiAssetPDEResult ex = pde_multi_asset_adi({100.0, 95.0}, {0.3, 0.2}, corr2, r, T, {1.0, -1.0},
+                                                       0.0, OptionType::Call);
+    test_assert(std::abs(ex.price - margrabe) < 0.01, "Exchange option matches Margrabe");
+    test_assert(ex.delta.size() == 2 && ex.delta[0] > 0.0 && ex.delta[1] < 0.0, "Spread deltas have opposite signs");
+
+    bool schemes_agree = true;
+    for (ADIScheme s : {ADIScheme::CraigSneyd, ADIScheme::HundsdorferVerwer}) {
+        MultiAssetADIConfig cfg;
+        cfg.scheme = s;
+        const double p = pde_multi_asset_adi({100.0, 95.0}, {0.3, 0.2}, corr2, r, T, {1.0, -1.0}, 0.0,
+                                             OptionType::Call, cfg).price;
+        schemes_agree = schemes_agree && std::abs(p - ex.price) < 0.005;
+    }
+    test_assert(schemes_agree, "ADI schemes agree on the exchange option");
+
+    // A zero weight reduces the basket to a single-asset option
+    const MultiAssetPDEResult single = pde_multi_asset_adi({100.0, 100.0}, {0.2, 0.3}, corr2, r, T, {1.0, 0.0},
+                                                           100.0, OptionType::Put);
+    test_assert(std::abs(single.price - black_scholes_price(100.0, 100.0, r, T, 0.2, OptionType::Put)) < 0.01,
+                "Degenerate basket matches Black-Scholes");
+    test_assert(std::abs(single.delta[0] - black_scholes_delta(100.0, 100.0, r, T, 0.2, OptionType::Put)) < 0.002,
+                "Degenerate basket delta matches Black-Scholes");
+
+    // Put-call parity on a spread
+    const double call = pde_multi_asset_adi({100.0, 95.0}, {0.3, 0.2}, corr2, r, T, {1.0, -1.0}, 5.0,
+                                            OptionType::Call).price;
+    const double put = pde_multi_asset_adi({100.0, 95.0}, {0.3, 0.2}, corr2, r, T, {1.0, -1.0}, 5.0,
+                                           OptionType::Put).price;
+    test_assert(std::abs(call - put - (5.0 - 5.0 * std::exp(-r * T))) < 0.01, "Spread put-call parity");
+
+    // Three-asset basket against a terminal Monte Carlo estimate
+    const std::vector<std::vector<double>> corr3{{1.0, 0.5, 0.3}, {0.5, 1.0, 0.4}, {0.3, 0.4, 1.0}};
+    const std::vector<double> S3{100.0, 90.0, 110.0}, vol3{0.2, 0.25, 0.3};
+    const double basket = pde_multi_asset_adi(S3, vol3, corr3, r, T, {1.0 / 3, 1.0 / 3, 1.0 / 3}, 100.0,
+                                              OptionType::Call).price;
+    const double l21 = 0.5, l22 = std::sqrt(1.0 - 0.25);
+    const double l31 = 0.3, l32 = (0.4 - 0.3 * 0.5) / l22, l33 = std::sqrt(1.0 - l31 * l31 - l32 * l32);
+    RNG rng(2718);
+    const long paths = 200000;
+    double sum = 0.0, sum2 = 0.0;
+    for (long p = 0; p < paths; ++p) {
+        const double z1 = rng.gauss(), z2 = rng.gauss(), z3 = rng.gauss();
+        const double e[3] = {z1, l21 * z1 + l22 * z2, l31 * z1 + l32 * z2 + l33 * z3};
+        double b = 0.0;
+        for (int k = 0; k < 3; ++k) b += S3[k] * std::exp((r - 0.5 * vol3[k] * vol3[k]) * T + vol3[k] * std::sqrt(T) * e[k]) / 3.0;
+        const double payoff = std::max(b - 100.0, 0.0);
+        sum += payoff;
+        sum2 += payoff * payoff;
+    }
+    const double mc = std::exp(-r * T) * sum / paths;
+    const double se = std::exp(-r * T) * std::sqrt((sum2 / paths - (sum / paths) * (sum / paths)) / paths);
+    test_assert(std::abs(basket - mc) < 4.0 * se + 0.01, "3D basket agrees with Monte Carlo");
+
+    bool threw = false;
+    try {
+        (void)pde_multi_asset_adi({100.0}, {0.2}, {{1.0}}, r, T, {1.0}, 100.0, OptionType::Call);
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    test_assert(threw, "Single-asset input is rejected");
+}
+
+/**
+ * @brief Test barrier option engines against each other and known values
+ */
+void test_barrier_engines() {
+    print_section("Barrier Option Engines");
+
+    const double S0 = 100.0, r = 0.05, T = 1.0, sigma = 0.2;
+    const BarrierType kinds[] = {BarrierType::DownOut, BarrierType::UpOut, BarrierType::DownIn, BarrierType::UpIn};
+
+    // Without rebate, knock-in + knock-out = vanilla for every case of the formula table
+    bool parity = true;
+    BarrierBatch batch;
+    for (OptionType type : {OptionType::Call, OptionType::Put}) {
+        for (double K : {90.0, 110.0}) {
+            for (double H : {80.0, 95.0, 105.0, 120.0}) {
+                const bool down = H < S0;
+                const BarrierSpec out{down ? BarrierType::DownOut : BarrierType::UpOut, H, 0.0};
+                const BarrierSpec in{down ? BarrierType::DownIn : BarrierType::UpIn, H, 0.0};
+                const double sum = barrier_price_analytic(S0, K, r, T, sigma, type, out)
+                                 + barrier_price_analytic(S0, K, r, T, sigma, type, in);
+                parity = parity && std::abs(sum - black_scholes_price(S0, K, r, T, sigma, type)) < 1e-10;
+                batch.push_back(S0, K, T, sigma, type, BarrierSpec{out.type, H, 2.0});
+                batch.push_back(S0, K, T, sigma, type, BarrierSpec{in.type, H, 2.0});
+            }
+        }
+    }
+    test_assert(parity, "Analytic knock-in + knock-out = vanilla");
+    test_assert(std::abs(barrier_price_analytic(S0, 100.0, r, T, sigma, OptionType::Call,
+                                                BarrierSpec{BarrierType::UpOut, 130.0, 0.0}) - 3.33286) < 1e-4,
+                "Analytic up-and-out call matches the reference value");
+
+    std::vector<double> batch_prices;
+    barrier_price_batch(batch, r, batch_prices);
+    bool batch_matches = batch_prices.size() == batch.size();
+    for (std::size_t i = 0; batch_matches && i < batch.size(); ++i) {
+        const double scalar = barrier_price_analytic(batch.spot[i], batch.strike[i], r, batch.T[i], batch.sigma[i],
+                                                     batch.type[i], BarrierSpec{batch.barrier[i], batch.level[i], batch.rebate[i]});
+        batch_matches = std::abs(batch_prices[i] - scalar) < 1e-12;
+    }
+    test_assert(batch_matches, "Batch kernel matches scalar prices");
+
+    // Expired and zero-vol rows take the scalar intrinsic-or-rebate value
+    BarrierBatch degenerate;
+    for (double t : {0.0, T}) {
+        const double vol = t > 0.0 ? 0.0 : sigma;
+        for (double H : {80.0, 95.0, 105.0, 120.0}) {
+            const bool down = H < S0;
+            for (BarrierType b : {down ? BarrierType::DownOut : BarrierType::UpOut,
+                                  down ? BarrierType::DownIn : BarrierType::UpIn}) {
+                degenerate.push_back(S0, 90.0, t, vol, OptionType::Call, BarrierSpec{b, H, 2.0});
+                degenerate.push_back(S0, 110.0, t, vol, OptionType::Put, BarrierSpec{b, H, 2.0});
+            }
+        }
+    }
+    barrier_price_batch(degenerate, r, batch_prices);
+    bool degenerate_matches = batch_prices.size() == degenerate.size();
+    for (std::size_t i = 0; degenerate_matches && i < degenerate.size(); ++i) {
+        const double scalar = barrier_price_analytic(degenerate.spot[i], degenerate.strike[i], r, degenerate.T[i],
+                                                     degenerate.sigma[i], degenerate.type[i],
+                                                     BarrierSpec{degenerate.barrier[i], degenerate.level[i],
+                                                                 degenerate.rebate[i]});
+        degenerate_matches = batch_prices[i] == scalar;
+    }
+    test_assert(degenerate_matches, "Batch expired and zero-vol rows match the scalar price");
+
+    // Continuous monitoring: barrier-edge CN and bridged MC against the closed form
+    bool pde_ok = true, mc_ok = true;
+    for (BarrierType kind : kinds) {
+        const BarrierSpec b{kind, is_down_barrier(kind) ? 95.0 : 115.0, 3.0};
+        const double exact = barrier_price_analytic(S0, 100.0, r, T, sigma, OptionType::Call, b);
+        const double pde = pde_crank_nicolson_barrier(S0, 100.0, r, T, sigma, 400, 200, OptionType::Call, b);
+        const MCResult mc = mc_gbm_barrier_price(S0, 100.0, r, T, sigma, 40000, 25, OptionType::Call, b);
+        pde_ok = pde_ok && std::abs(pde - exact) < 0.01;
+        mc_ok = mc_ok && std::abs(mc.price - exact) < 4.0 * mc.std_error + 1e-3;
+    }
+    test_assert(pde_ok, "Barrier CN matches the closed form");
+    test_assert(mc_ok, "Bridged MC matches the closed form despite coarse steps");
+
+    // Discrete monitoring: aligned CN against date-checked MC, and the continuity correction
+    const BarrierSpec down_out{BarrierType::DownOut, 95.0, 0.0};
+    const double pde_disc = pde_crank_nicolson_barrier(S0, 90.0, r, T, sigma, 800, 480, OptionType::Call, down_out, 12);
+    const MCResult mc_disc = mc_gbm_barrier_price(S0, 90.0, r, T, sigma, 100000, 12, OptionType::Call, down_out,
+                                                  12345, true, 12);
+    test_assert(std::abs(pde_disc - mc_disc.price) < 4.0 * mc_disc.std_error, "Discrete barrier CN matches MC");
+    test_assert(std::abs(barrier_price_analytic(S0, 90.0, r, T, sigma, OptionType::Call, down_out, 12) - pde_disc) < 0.05,
+                "Continuity-corrected closed form is close to the discrete value");
+    test_assert(pde_disc > barrier_price_analytic(S0, 90.0, r, T, sigma, OptionType::Call, down_out),
+                "Discrete knock-out is worth more than continuous");
+
+    // Already knocked: knock-out pays the rebate, knock-in is the vanilla
+    const BarrierSpec hit{BarrierType::DownIn, 105.0, 1.0};
+    test_assert(std::abs(barrier_price_analytic(S0, 100.0, r, T, sigma, OptionType::Put, hit)
+                         - black_scholes_price(S0, 100.0, r, T, sigma, OptionType::Put)) < 1e-12,
+                "Breached knock-in is the vanilla");
+    test_assert(pde_crank_nicolson_barrier(S0, 100.0, r, T, sigma, 100, 50, OptionType::Put,
+                                           BarrierSpec{BarrierType::DownOut, 105.0, 1.0}) == 1.0,
+                "Breached knock-out pays the rebate");
+
+    // SLV with negligible vol-of-vol and unit leverage reduces to Black-Scholes
+    const HestonParams flat{1.5, 0.04, 1e-4, 0.0, 0.04};
+    const BarrierSpec slv_b{BarrierType::DownOut, 90.0, 2.0};
+    const MCResult slv = mc_slv_barrier_price(S0, 100.0, r, T, 20000, 50, OptionType::Call, flat,
+                                              [](double, double) { return 1.0; }, slv_b);
+    test_assert(std::abs(slv.price - barrier_price_analytic(S0, 100.0, r, T, sigma, OptionType::Call, slv_b))
+                < 4.0 * slv.std_error, "SLV bridged MC reduces to the closed form");
+}
+
+/**
+ * @brief Test Asian closed forms, approximations and the control-variate MC
+ */
+void test_asian_options() {
+    print_section("Asian Options");
+
+    const double S0 = 100.0, K = 100.0, r = 0.05, T = 1.0, sigma = 0.2;
+
+    // Kemna-Vorst continuous geometric call
+    test_assert(std::abs(asian_geometric_price(S0, K, r, T, sigma, OptionType::Call) - 5.5468) < 1e-3,
+                "Continuous geometric Asian matches Kemna-Vorst");
+
+    // A single fixing at expiry is the vanilla for every formula
+    const double vanilla = black_scholes_price(S0, K, r, T, sigma, OptionType::Put);
+    test_assert(std::abs(asian_geometric_price(S0, K, r, T, sigma, OptionType::Put, 1) - vanilla) < 1e-10 &&
+                std::abs(asian_arithmetic_approx(S0, K, r, T, sigma, OptionType::Put, 1) - vanilla) < 1e-10,
+                "One-fixing Asian is the vanilla");
+
+    // Levy's discrete moments converge to the continuous (Turnbull-Wakeman) moments
+    const double tw = asian_arithmetic_approx(S0, K, r, T, sigma, OptionType::Call, 0, AsianFormula::TurnbullWakeman);
+    test_assert(std::abs(asian_arithmetic_approx(S0, K, r, T, sigma, OptionType::Call, 5000) - tw) < 2e-3,
+                "Levy approximation converges to Turnbull-Wakeman");
+
+    AsianBatch batch;
+    for (int n : {0, 4, 12, 52, 252}) {
+        for (double k : {90.0, 100.0, 110.0}) {
+            batch.push_back(S0, k, T, sigma, n, OptionType::Call);
+            batch.push_back(S0, k, 0.5, 0.3, n, OptionType::Put);
+        }
+    }
+    bool batch_ok = true;
+    for (AsianFormula f : {AsianFormula::Geometric, AsianFormula::TurnbullWakeman, AsianFormula::Levy}) {
+        std::vector<double> prices;
+        asian_price_batch(batch, r, f, prices);
+        for (std::size_t i = 0; i < batch.size(); ++i) {
+            batch_ok = batch_ok && std::abs(prices[i] - asian_arithmetic_approx(batch.spot[i], batch.strike[i], r, batch.T[i],
+                                                                               batch.sigma[i], batch.type[i],
+                                                                               batch.num_fixings[i], f)) < 1e-12;
+        }
+    }
+    test_assert(batch_ok, "Asian batch matches scalar prices");
+
+    // Arithmetic MC: the geometric control variate agrees with plain MC and cuts the variance
+    const MCResult cv = mc_gbm_asian_price(S0, K, r, T, sigma, 20000, 52, OptionType::Call);
+    const MCResult plain = mc_gbm_asian_price(S0, K, r, T, sigma, 20000, 52, OptionType::Call, 777, true, false);
+    test_assert(std::abs(cv.price - plain.price) < 4.0 * std::hypot(cv.std_error, plain.std_error),
+                "Control-variate Asian MC agrees with plain MC");
+    test_assert(plain.std_error > 10.0 * cv.std_error, "Geometric control variate reduces variance by over 100x");
+    test_assert(std::abs(cv.price - asian_arithmetic_approx(S0, K, r, T, sigma, OptionType::Call, 52)) < 0.05,
+                "Levy approximation is close to the arithmetic MC");
+    const MCResult one = mc_gbm_asian_price(S0, K, r, T, sigma, 2000, 1, OptionType::Call);
+    test_assert(std::abs(one.price - black_scholes_price(S0, K, r, T, sigma, OptionType::Call)) < 1e-8,
+                "One-fixing MC is exact through the control variate");
+}
+
+/**
+ * @brief Test LSM lower bound and Andersen-Broadie dual upper bound
+ */
+void test_lsm_dual_bounds() {
+    print_section("LSM Duality Bounds");
+
+    const double S0 = 36.0, K = 40.0, r = 0.06, T = 1.0, sigma = 0.2;
+    const double american = pde_crank_nicolson_american(S0, K, r, T, sigma, 800, 800, OptionType::Put);
+
+    LSMParams p;
+    p.steps = 50;
+    p.paths = 50000;
+    test_assert(std::abs(lsm_american_put(S0, K, r, T, sigma, p) - american) < 0.05,
+                "LSM in-sample price is close to the American PDE");
+
+    // Bermudan with 10 dates: lower <= true value <= upper, and a small gap for a quadratic basis
+    p.steps = 10;
+    LSMDualParams dual;
+    dual.outer_paths = 300;
+    dual.inner_paths = 100;
+    const LSMBounds b = lsm_american_put_bounds(S0, K, r, T, sigma, p, dual);
+    test_assert(b.upper > b.lower && b.gap() < 0.1, "Dual gap is positive and small");
+    test_assert(b.interval().first < american && b.lower < american, "Lower bound is below the American value");
+    test_assert(b.nested_steps > 0 && b.upper_se > 0.0, "Upper bound reports nested work and error");
+
+    // Skipping nested runs on early dates via the schedule keeps a valid (looser) bound
+    LSMDualParams sparse = dual;
+    sparse.inner_schedule = {1, 1, 1, 1, 1};
+    const LSMBounds bs = lsm_american_put_bounds(S0, K, r, T, sigma, p, sparse);
+    test_assert(bs.nested_steps < b.nested_steps && bs.upper > b.lower,
+                "Sub-path schedule cuts nested work and stays above the lower bound");
+}
+
+/**
+ * @brief Test LSM standard errors and variance reduction
+ */
+void test_lsm_variance_reduction() {
+    print_section("LSM Variance Reduction");
+
+    const double S0 = 36.0, K = 40.0, r = 0.06, T = 1.0, sigma = 0.2;
+    const double american = pde_crank_nicolson_american(S0, K, r, T, sigma, 800, 800, OptionType::Put);
+
+    LSMParams p;
+    p.steps = 50;
+    p.paths = 20000;
+    const LSMResult plain = lsm_american_put_estimate(S0, K, r, T, sigma, p);
+    test_assert(plain.price == lsm_american_put(S0, K, r, T, sigma, p) && plain.std_error > 0.0,
+                "Plain estimate matches lsm_american_put and reports an error");
+
+    p.antithetic = true;
+    p.control_variate = true;
+    const LSMResult vr = lsm_american_put_estimate(S0, K, r, T, sigma, p);
+    test_assert(vr.std_error * 5.0 < plain.std_error, "Antithetics and European control variate cut the error");
+    test_assert(std::abs(vr.price - american) < 0.03 && vr.cv_beta > 0.5,
+                "Variance-reduced price is close to the American PDE");
+
+    p.use_qmc = true;
+    const LSMResult qmc = lsm_american_put_estimate(S0, K, r, T, sigma, p);
+    test_assert(qmc.std_error > 0.0 && qmc.std_error < plain.std_error && std::abs(qmc.price - american) < 0.03,
+                "Scrambled QMC replicates give a price and error");
+
+    p.paths = 6;
+    p.qmc_replicates = 8;
+    const LSMResult sparse = lsm_american_put_estimate(S0, K, r, T, sigma, p);
+    test_assert(std::isfinite(sparse.std_error), "More QMC replicates than paths keep a finite error");
+}
+
+/**
+ * @brief Test single-run LSM Greeks against bumped American PDE prices
+ */
+void test_lsm_greeks() {
+    print_section("LSM Pathwise Greeks");
+
+    const double S0 = 36.0, K = 40.0, r = 0.06, T = 1.0, sigma = 0.2;
+    auto pde = [&](double S, double vol) {
+        return pde_crank_nicolson_american(S, K, r, T, vol, 800, 800, OptionType::Put);
+    };
+    const double h = 0.5, dv = 0.005;
+    const double up = pde(S0 + h, sigma), mid = pde(S0, sigma), dn = pde(S0 - h, sigma);
+    const double delta = (up - dn) / (2.0 * h), gamma = (up - 2.0 * mid + dn) / (h * h);
+    const double vega = (pde(S0, sigma + dv) - pde(S0, sigma - dv)) / (2.0 * dv);
+
+    LSMParams p;
+    p.steps = 50;
+    p.paths = 50000;
+    p.poly_degree = 3;
+    p.antithetic = true;
+    p.control_variate = true;
+    const MCResult g = lsm_american_put_greeks(S0, K, r, T, sigma, p);
+    test_assert(g.price == lsm_american_put_estimate(S0, K, r, T, sigma, p).price,
+                "Greeks run prices like lsm_american_put_estimate");
+    test_assert(std::abs(g.delta - delta) < 0.015 && g.delta_se > 0.0 && g.delta_se < 0.005,
+                "Pathwise delta matches the PDE");
+    test_assert(std::abs(g.gamma - gamma) < 0.15 * gamma && g.gamma_se > 0.0, "Likelihood-ratio gamma matches the PDE");
+    test_assert(std::abs(g.vega - vega) < 0.03 * vega && g.vega_se > 0.0, "Pathwise vega matches the PDE");
+}
+
+/**
+ * @brief Test float path state against double on the same random streams
+ */
+void test_float_precision_engines() {
+    print_section("Float Path Precision");
+
+    const double S0 = 100.0, K = 100.0, r = 0.05, T = 1.0, sigma = 0.2;
+    const MCResult ad = mc_gbm_asian_price(S0, K, r, T, sigma, 20000, 52, OptionType::Call);
+    const MCResult af = mc_gbm_asian_price(S0, K, r, T, sigma, 20000, 52, OptionType::Call, 12345, true, true,
+                                           Precision::Float);
+    test_assert(std::abs(af.price - ad.price) < 0.01 * ad.std_error, "Float Asian matches double within rounding");
+
+    const HestonParams heston{1.5, 0.04, 0.5, -0.7, 0.04};
+    const LocalVolFn lv = CEVLocalVol{0.25, 0.9, S0}.to_fn();
+    const MCResult sd = mc_slv_price(S0, K, r, T, 4000, 50, OptionType::Call, heston, lv);
+    const MCResult sf = mc_slv_price(S0, K, r, T, 4000, 50, OptionType::Call, heston, lv, 987654321UL, true, true,
+                                     Precision::Float);
+    test_assert(std::abs(sf.price - sd.price) < 0.01 * sd.std_error, "Float SLV matches double within rounding");
+
+    LSMParams p;
+    p.paths = 20000;
+    const LSMResult ld = lsm_american_put_estimate(36.0, 40.0, 0.06, 1.0, 0.2, p);
+    p.precision = Precision::Float;
+    const LSMResult lf = lsm_american_put_estimate(36.0, 40.0, 0.06, 1.0, 0.2, p);
+    test_assert(std::abs(lf.price - ld.price) < 0.2 * ld.std_error && lf.std_error > 0.0,
+                "Float LSM paths keep the price well inside its error");
+}
+
+/**
+ * @brief Test out-of-core LSM paths against the in-memory run
+ */
+void test_lsm_out_of_core() {
+    print_section("LSM Out-of-Core Paths");
+
+    LSMParams p;
+    p.steps = 50;
+    p.paths = 20000;
+    const LSMResult in_memory = lsm_american_put_estimate(36.0, 40.0, 0.06, 1.0, 0.2, p);
+    test_assert(!in_memory.spill.spilled, "No spill without a memory budget");
+
+    p.memory_budget = 1 << 20;   // 1 MB against an 8 MB path store
+    const LSMResult spilled = lsm_american_put_estimate(36.0, 40.0, 0.06, 1.0, 0.2, p);
+    const LSMSpillStats& io = spilled.spill;
+    test_assert(io.spilled && spilled.price == in_memory.price && spilled.std_error == in_memory.std_error,
+                "Spilled paths reproduce the in-memory price exactly");
+    test_assert(io.bytes_written >= io.store_bytes && io.bytes_read >= io.store_bytes,
+                "Every slice is written once and streamed back");
+    test_assert(io.peak_resident_bytes <= p.memory_budget + (256u << 10),
+                "Resident path slices stay within the budget");
+
+    p.use_qmc = true;
+    bool rejected = false;
+    try {
+        (void)lsm_american_put_estimate(36.0, 40.0, 0.06, 1.0, 0.2, p);
+    } catch (const std::invalid_argument&) {
+        rejected = true;
+    }
+    test_assert(rejected, "QMC paths are not spilled");
+}
+
+/**
+ * @brief Test PathStore alignment, layouts and quantised encodings
+ */
+void test_path_store() {
+    print_section("Path Store Encodings");
+
+    const long paths = 1000;
+    const int dates = 13;
+    std::vector<double> row(paths), back(paths);
+    for (long m = 0; m < paths; ++m) row[m] = 100.0 * std::exp(0.5 * std::sin(0.37 * m));
+
+    PathStore f64(paths, dates), f32(paths, dates, PathLayout::TimeMajor, PathEncoding::Float32);
+    PathStore q16(paths, dates, PathLayout::TimeMajor, PathEncoding::LogReturn16, 100.0);
+    for (int t = 0; t < dates; ++t) q16.set_log_range(t, 0.6);
+    bool aligned = true;
+    for (int t = 0; t < dates; ++t) {
+        aligned = aligned && reinterpret_cast<std::uintptr_t>(q16.row_data(t)) % PathStore::kAlignment == 0
+                          && reinterpret_cast<std::uintptr_t>(f32.row_data(t)) % PathStore::kAlignment == 0;
+    }
+    test_assert(aligned, "Time-major rows start on 64-byte boundaries");
+    test_assert(f64.payload_bytes() == 2 * f32.payload_bytes() && f64.payload_bytes() == 4 * q16.payload_bytes(),
+                "Float32 halves and LogReturn16 quarters the double store");
+
+    f64.store_date(7, row.data());
+    f64.load_date(7, back.data());
+    test_assert(back == row, "Float64 dates round-trip exactly");
+
+    q16.store_date(7, row.data());
+    q16.load_date(7, back.data());
+    double worst = 0.0;
+    for (long m = 0; m < paths; ++m) worst = std::max(worst, std::abs(back[m] / row[m] - 1.0));
+    test_assert(worst <= 0.6 / 65534.0 * 1.01, "LogReturn16 relative error within half a quantisation step");
+
+    PathStore pm(paths, dates, PathLayout::PathMajor, PathEncoding::Float32);
+    std::vector<double> path(dates), path_back(dates);
+    for (int t = 0; t < dates; ++t) path[t] = 100.0 + t;
+    pm.store_path(3, path.data());
+    pm.load_path(3, path_back.data());
+    test_assert(path_back == path && pm.get(3, 5) == 105.0, "Path-major rows hold whole paths");
+
+    // LSM on quantised paths: a quarter of the memory, price within a fraction of its error
+    LSMParams p;
+    p.paths = 50000;
+    const LSMResult exact = lsm_american_put_estimate(36.0, 40.0, 0.06, 1.0, 0.2, p);
+    p.quantize_paths = true;
+    const LSMResult quant = lsm_american_put_estimate(36.0, 40.0, 0.06, 1.0, 0.2, p);
+    test_assert(quant.spill.store_bytes * 4 == exact.spill.store_bytes, "Quantised LSM store is 4x smaller");
+    test_assert(std::abs(quant.price - exact.price) < 0.1 * exact.std_error,
+                "Quantised LSM price matches the double-path price");
+}
+
+/**
+ * @brief Test the option-chain arbitrage scanner on clean and broken chains
+ */
+void test_arbitrage_scanner() {
+    print_section("Option Chain Arbitrage Scanner");
+
+    const std::vector<UnderlyingMarket> markets = {{"XYZ", 100.0, 0.05, 0.0}};
+    std::vector<OptionQuote> chain;
+    for (double T : {0.5, 1.0}) {
+        for (double K : {90.0, 95.0, 100.0, 105.0, 110.0}) {
+            for (OptionType type : {OptionType::Call, OptionType::Put}) {
+                const double mid = black_scholes_price(100.0, K, 0.05, T, 0.2, type);
+                chain.push_back({"XYZ", T, K, type, mid - 0.05, mid + 0.05});
+            }
+        }
+    }
+    // Quote index of (expiry slot, strike slot, type)
+    auto idx = [](int e, int k, OptionType type) { return static_cast<std::size_t>(10 * e + 2 * k + (type == OptionType::Put)); };
+
+    const ArbitrageScanResult clean = scan_option_chain(chain, markets);
+    test_assert(clean.violations.empty() && clean.num_slices == 2, "Arbitrage-free chain has no violations");
+
+    auto find = [](const ArbitrageScanResult& res, ArbitrageCheck check, std::size_t leg) {
+        for (const auto& v : res.violations) {
+            if (v.check == check && std::find(v.legs.begin(), v.legs.end(), leg) != v.legs.end()) return v.size;
+        }
+        return 0.0;
+    };
+
+    // Near 100 call bid above the chord of the 95/105 asks
+    std::vector<OptionQuote> fly = chain;
+    const std::size_t mid = idx(0, 2, OptionType::Call);
+    fly[mid].bid = 0.5 * (fly[idx(0, 1, OptionType::Call)].ask + fly[idx(0, 3, OptionType::Call)].ask) + 0.5;
+    fly[mid].ask = fly[mid].bid + 0.1;
+    test_assert(std::abs(find(scan_option_chain(fly, markets), ArbitrageCheck::CallButterfly, mid) - 0.5) < 1e-9,
+                "Butterfly violation reported with its size");
+
+    // Far 105 call offered below the near 105 call bid
+    std::vector<OptionQuote> cal = chain;
+    const std::size_t far = idx(1, 3, OptionType::Call);
+    cal[far].ask = cal[idx(0, 3, OptionType::Call)].bid - 0.3;
+    cal[far].bid = cal[far].ask - 0.1;
+    test_assert(std::abs(find(scan_option_chain(cal, markets), ArbitrageCheck::Calendar, far) - 0.3) < 1e-9,
+                "Calendar violation reported with its size");
+
+    // Parity against a spot 2 above the quoted forward; only checked with a market
+    const std::vector<UnderlyingMarket> moved = {{"XYZ", 102.0, 0.05, 0.0}};
+    const ArbitrageScanResult parity = scan_option_chain(chain, moved);
+    const double expected = 2.0 - 0.1;   // spot move less the call-ask/put-bid spreads
+    test_assert(parity.violations.size() == 10 &&
+                std::abs(find(parity, ArbitrageCheck::PutCallParity, idx(0, 2, OptionType::Call)) - expected) < 1e-9,
+                "Put-call parity uses the call ask and put bid");
+    test_assert(scan_option_chain(chain).violations.empty(), "Parity is skipped without a market");
+
+    // Put spread: lower strike bid above higher strike ask; crossed quotes
+    std::vector<OptionQuote> bad = chain;
+    bad[idx(1, 0, OptionType::Put)].bid = bad[idx(1, 1, OptionType::Put)].ask + 0.2;
+    bad[idx(1, 0, OptionType::Put)].ask = bad[idx(1, 0, OptionType::Put)].bid + 0.1;
+    bad.push_back({"XYZ", 0.5, 110.0, OptionType::Put, 20.0, 9.0});
+    const ArbitrageScanResult bad_res = scan_option_chain(bad, markets);
+    test_assert(std::abs(find(bad_res, ArbitrageCheck::PutSpread, idx(1, 0, OptionType::Put)) - 0.2) < 1e-9,
+                "Put spread monotonicity violation");
+    test_assert(find(bad_res, ArbitrageCheck::CrossedQuote, bad.size() - 1) > 0.0,
+                "Duplicate quotes merge into a crossed market");
+
+    std::vector<UnderlyingMarket> sample_markets;
+    const auto sample = generate_sample_option_chain(20, 30, 7, &sample_markets);
+    test_assert(scan_option_chain(sample, sample_markets).violations.empty(),
+                "Synthetic snapshot is arbitrage-free");
+}
+
+/**
+ * @brief Test implied forward and discount extraction from put-call parity
+ */
+void test_implied_forward() {
+    print_section("Implied Forward and Batch Implied Vol");
+
+    // Underlying with a 3% rate and a 2% dividend-plus-borrow yield, 25% flat vol
+    const double S0 = 100.0, r = 0.03, q = 0.02, sigma = 0.25;
+    auto black = [](double F, double D, double K, double T, double vol, OptionType type) {
+        const double s = vol * std::sqrt(T), d1 = std::log(F / K) / s + 0.5 * s, d2 = d1 - s;
+        return is_call(type) ? D * (F * norm_cdf(d1) - K * norm_cdf(d2))
+                             : D * (K * norm_cdf(-d2) - F * norm_cdf(-d1));
+    };
+    std::vector<OptionQuote> quotes;
+    for (double T : {0.25, 1.0}) {
+        const double F = S0 * std::exp((r - q) * T), D = std::exp(-r * T);
+        for (int k = 0; k <= 12; ++k) {
+            const double K = 70.0 + 5.0 * k;
+            for (OptionType type : {OptionType::Call, OptionType::Put}) {
+                const double mid = black(F, D, K, T, sigma, type);
+                quotes.push_back({"XYZ", T, K, type, mid - 0.02, mid + 0.02});
+            }
+        }
+    }
+    // A stale put quoted 1.5 too high; plain weighted least squares is pulled off by it
+    quotes[2 * 3 + 1].bid += 1.5;
+    quotes[2 * 3 + 1].ask += 1.5;
+
+    const std::vector<ImpliedForward> fwd = implied_forwards(quotes);
+    test_assert(fwd.size() == 2 && fwd[0].valid && fwd[1].valid && fwd[1].strikes_used == 13,
+                "One parity fit per expiry");
+    const ImpliedForward& f1 = fwd[1];
+    test_assert(std::abs(f1.forward / (S0 * std::exp(r - q)) - 1.0) < 1e-6 && std::abs(f1.rate() - r) < 1e-6,
+                "Forward and discount recovered from clean strikes");
+    ImpliedForwardConfig plain;
+    plain.max_iterations = 1;
+    const double F0 = S0 * std::exp((r - q) * 0.25);
+    test_assert(std::abs(implied_forwards(quotes, plain)[0].forward / F0 - 1.0) > 5e-4 &&
+                std::abs(fwd[0].forward / F0 - 1.0) < 1e-8 && std::abs(fwd[0].carry_yield(S0) - q) < 1e-6,
+                "Huber reweighting removes the stale strike");
+
+    const std::vector<double> vols = implied_vols_from_forwards(quotes, fwd);
+    double worst = 0.0;
+    for (std::size_t i = 26; i < quotes.size(); ++i) worst = std::max(worst, std::abs(vols[i] - sigma));
+    test_assert(worst < 1e-8, "Calls and puts share one implied vol on the implied forward");
+
+    // The same chain through the spot-and-rate solver without carry: puts and calls disagree
+    const OptionQuote& call = quotes[26 + 12], &put = quotes[26 + 13];
+    auto iv_spot = [&](const OptionQuote& o) {
+        return implied_vol(o.mid(), [&](double v) { return black_scholes_price(S0, o.strike, r, 1.0, v, o.type); });
+    };
+    test_assert(std::abs(iv_spot(call) - iv_spot(put)) > 0.01, "Spot-and-rate vols carry a call/put bias");
+
+    const double nan_price[1] = {0.0}, strike[1] = {100.0};
+    const OptionType type[1] = {OptionType::Call};
+    double v[1];
+    black_implied_vol_batch(100.0, 1.0, 1.0, 1, strike, nan_price, type, v);
+    test_assert(std::isnan(v[0]), "Price without time value has no implied vol");
+}
+
+/**
+ * @brief Test SVI fitting and variance swap replication
+ */
+void test_variance_swap() {
+    print_section("SVI Smile and Variance Swap Replication");
+
+    // Quasi-explicit fit recovers a skewed smile exactly and a flat one with b = 0
+    SVIParams truth;
+    truth.a = 0.02; truth.b = 0.15; truth.rho = -0.4; truth.m = 0.05; truth.sigma = 0.15;
+    std::vector<double> k, w, flat;
+    for (int i = 0; i <= 40; ++i) {
+        k.push_back(-1.0 + 0.05 * i);
+        w.push_back(truth.total_variance(k.back()));
+        flat.push_back(0.04);
+    }
+    const SVIParams fit = fit_svi(k, w);
+    test_assert(std::abs(fit.a - truth.a) < 1e-8 && std::abs(fit.b - truth.b) < 1e-8 &&
+                std::abs(fit.rho - truth.rho) < 1e-8 && std::abs(fit.m - truth.m) < 1e-8 &&
+                std::abs(fit.sigma - truth.sigma) < 1e-8, "SVI parameters recovered from exact total variances");
+    const SVIParams level = fit_svi(k, flat);
+    test_assert(std::abs(level.b) < 1e-10 && std::abs(level.a - 0.04) < 1e-10, "Flat smile fits with b = 0");
+
+    // Replication of a flat smile is the Black-Scholes variance
+    SVIParams bs;
+    bs.a = 0.25 * 0.25 * 0.5;
+    bs.b = 0.0;
+    double err = 1.0;
+    test_assert(std::abs(svi_fair_variance(bs, 0.5, 1e-12, &err) - 0.0625) < 1e-10 && err < 1e-10,
+                "Flat smile replicates sigma^2");
+
+    // Skewed smile against a fine trapezoid rule in log-moneyness
+    auto trapezoid = [](const SVIParams& smile) {
+        double sum = 0.0;
+        const int n = 400000;
+        const double lo = -25.0, h = 50.0 / n;
+        for (int i = 0; i <= n; ++i) {
+            const double x = lo + i * h, wx = smile.total_variance(x);
+            double otm;
+            black_otm_normalized_batch(1, &x, &wx, &otm);
+            sum += (i == 0 || i == n ? 0.5 : 1.0) * otm * std::exp(-x);
+        }
+        return 2.0 * h * sum;
+    };
+    test_assert(std::abs(svi_fair_variance(truth, 1.0) - trapezoid(truth)) < 1e-8,
+                "Gauss-Kronrod replication of a skew");
+    SVIParams steep = truth;
+    steep.b = 1.5;
+    test_assert(std::isinf(svi_fair_variance(steep, 1.0)), "Wing beyond Lee's bound has infinite variance");
+    // Only the put wing can diverge: a call wing past the bound still replicates
+    SVIParams right = truth;
+    right.b = 1.2;
+    right.rho = 0.9;
+    const double right_var = svi_fair_variance(right, 1.0);
+    test_assert(std::isfinite(right_var) && std::abs(right_var - trapezoid(right)) < 1e-6 * right_var,
+                "Steep call wing keeps a finite variance");
+    std::vector<VarianceSwapQuote> wings(2);
+    wings[0].underlying = wings[1].underlying = "XYZ";
+    wings[0].T = 0.25;
+    wings[1].T = 0.5;
+    wings[0].fair_variance = 0.04;
+    wings[1].fair_variance = svi_fair_variance(steep, 0.5);
+    wings[0].valid = wings[1].valid = true;
+    test_assert(std::abs(vix_style_index(wings, "XYZ", 0.4, false) - 20.0) < 1e-12,
+                "Index skips expiries with infinite variance");
+
+    // Dense flat-vol chain: surface fit, both estimators and the 30-day index
+    const double S0 = 100.0, r = 0.02, sigma = 0.3;
+    std::vector<OptionQuote> quotes;
+    for (double T : {20.0 / 365.0, 45.0 / 365.0}) {
+        for (int i = 0; i <= 400; ++i) {
+            const double K = 40.0 + 0.25 * i;
+            for (OptionType type : {OptionType::Call, OptionType::Put}) {
+                const double mid = black_scholes_price(S0, K, r, T, sigma, type);
+                if (mid < 1e-4) continue;
+                quotes.push_back({"XYZ", T, K, type, mid * 0.999, mid * 1.001});
+            }
+        }
+    }
+    const std::vector<ImpliedForward> fwd = implied_forwards(quotes);
+    const std::vector<SVISlice> slices = fit_svi_surface(quotes, fwd);
+    test_assert(slices.size() == 2 && slices[0].valid && slices[1].valid && slices[1].rms_vol_error < 1e-3,
+                "SVI surface fits each expiry");
+    const std::vector<VarianceSwapQuote> term = variance_term_structure(quotes, fwd, slices);
+    bool close = term.size() == 2;
+    for (const VarianceSwapQuote& v : term) {
+        close = close && v.valid && std::abs(v.fair_vol() - sigma) < 2e-3 &&
+                std::abs(std::sqrt(v.discrete_variance) - sigma) < 2e-3 && v.strikes_used > 100;
+    }
+    test_assert(close, "Replicated and discrete variance strikes match the flat vol");
+    test_assert(std::abs(vix_style_index(term, "XYZ") - 100.0 * sigma) < 0.2 &&
+                std::isnan(vix_style_index(term, "ABC")), "30-day index interpolates the term structure");
+}
+
+/**
+ * @brief Test every supported ISA variant of the dispatched kernels against scalar code
+ */
+void test_isa_dispatch() {
+    print_section("Instruction-Set Dispatch");
+
+    const std::vector<KernelISA> isas = supported_isas();
+    test_assert(!isas.empty() && isas.front() == KernelISA::Generic && isas.back() == detected_isa(),
+                "Supported variants run from generic to the detected one");
+    KernelISA parsed;
+    test_assert(parse_isa("AVX2", parsed) && parsed == KernelISA::AVX2 && !parse_isa("neon", parsed),
+                "ISA names parse case-insensitively");
+
+    const std::size_t n = 203;      // not a multiple of any vector width or block
+    std::vector<double> S(n), K(n), T(n), sigma(n), ref(n), out(n);
+    std::vector<OptionType> types(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        S[i] = 100.0;
+        K[i] = 50.0 + 0.5 * i;
+        T[i] = i % 17 == 0 ? 0.0 : 0.02 + 0.01 * i;
+        sigma[i] = i % 23 == 0 ? 0.0 : 0.1 + 0.002 * i;
+        types[i] = i % 2 ? OptionType::Call : OptionType::Put;
+        ref[i] = black_scholes_price(S[i], K[i], 0.03, T[i], sigma[i], types[i]);
+    }
+
+    // Tridiagonal batch and surface interpolation inputs
+    const int rows = 40, lines = 13;
+    std::vector<double> a(rows * lines), b(rows * lines), c(rows * lines), rhs(rows * lines), scratch(rows * lines);
+    for (int i = 0; i < rows * lines; ++i) {
+        a[i] = -1.0 - 0.01 * (i % 7);
+        c[i] = -1.0 + 0.01 * (i % 5);
+        b[i] = 4.0 + 0.1 * (i % 3);
+        rhs[i] = std::sin(0.1 * i);
+    }
+    std::vector<double> grid(50), row0(50), row1(50), x(n);
+    for (std::size_t j = 0; j < grid.size(); ++j) {
+        grid[j] = 40.0 + j * (1.0 + 0.1 * j);
+        row0[j] = 0.3 - 0.002 * j;
+        row1[j] = 0.2 + 0.001 * j * j;
+    }
+    for (std::size_t i = 0; i < n; ++i) x[i] = 41.0 + 1.4 * i;
+
+    std::vector<double> normals_ref(1001);
+    kernel_variant(KernelISA::Generic).normal_fill(99, 5, normals_ref.size(), normals_ref.data());
+    std::vector<double> tri_ref;
+
+    for (KernelISA isa : isas) {
+        const std::string tag = std::string(" (") + isa_name(isa) + ")";
+        const KernelTable& k = kernel_variant(isa);
+
+        k.black_scholes(n, S.data(), K.data(), 0.03, T.data(), sigma.data(), types.data(), out.data());
+        double worst = 0.0;
+        for (std::size_t i = 0; i < n; ++i) worst = std::max(worst, std::abs(out[i] - ref[i]));
+        test_assert(worst < 1e-12, "Batch prices match black_scholes_price" + tag);
+
+        // Greeks of one strike column (a portfolio group) against the scalar closed forms
+        std::vector<double> sgn(n), greeks(5 * n);
+        for (std::size_t i = 0; i < n; ++i) sgn[i] = types[i] == OptionType::Call ? 1.0 : -1.0;
+        double* g = greeks.data();
+        k.black_scholes_greeks(n, 100.0, 0.03, 0.8, 0.25, K.data(), sgn.data(), g, g + n, g + 2 * n, g + 3 * n,
+                               g + 4 * n);
+        worst = 0.0;
+        for (std::size_t i = 0; i < n; ++i) {
+            const double expect[5] = {black_scholes_price(100.0, K[i], 0.03, 0.8, 0.25, types[i]),
+                                      black_scholes_delta(100.0, K[i], 0.03, 0.8, 0.25, types[i]),
+                                      black_scholes_gamma(100.0, K[i], 0.03, 0.8, 0.25),
+                                      black_scholes_vega(100.0, K[i], 0.03, 0.8, 0.25),
+                                      black_scholes_theta(100.0, K[i], 0.03, 0.8, 0.25, types[i])};
+            for (int q = 0; q < 5; ++q)
+                worst = std::max(worst, std::abs(g[q * n + i] - expect[q]) / std::max(1.0, std::abs(expect[q])));
+        }
+        test_assert(worst < 1e-12, "Column Greeks match the scalar closed forms" + tag);
+
+        // Implied vols of forward prices recover the input volatility
+        const double F = 100.0, D = 0.97, Texp = 0.75;
+        std::vector<double> prices(n), vols(n);
+        for (std::size_t i = 0; i < n; ++i)
+            prices[i] = D * black_scholes_price(F, 80.0 + 0.25 * i, 0.0, Texp, 0.1 + 0.002 * i, types[i]);
+        prices[7] = 0.0;
+        std::vector<double> strikes(n);
+        for (std::size_t i = 0; i < n; ++i) strikes[i] = 80.0 + 0.25 * i;
+        k.implied_vol(F, D, Texp, n, strikes.data(), prices.data(), types.data(), vols.data(), 1e-12, 100);
+        worst = 0.0;
+        for (std::size_t i = 0; i < n; ++i)
+            if (i != 7) worst = std::max(worst, std::abs(vols[i] - (0.1 + 0.002 * i)));
+        test_assert(worst < 1e-8 && std::isnan(vols[7]), "Implied vol round trip" + tag);
+
+        // Counter-based normals: any sub-range reproduces the full stream
+        std::vector<double> z(normals_ref.size());
+        k.normal_fill(99, 5, 400, z.data());
+        k.normal_fill(99, 405, z.size() - 400, z.data() + 400);
+        worst = 0.0;
+        for (std::size_t i = 0; i < z.size(); ++i) worst = std::max(worst, std::abs(z[i] - normals_ref[i]));
+        test_assert(worst < 1e-12, "Normal sub-ranges reproduce the stream" + tag);
+
+        // Payoff moments against a plain loop
+        double sum = 0.0, sum_sq = 0.0, sum_ref = 0.0, sum_sq_ref = 0.0;
+        k.payoff_moments(z.size(), z.data(), 100.0, -0.02, 0.25, 105.0, OptionType::Put, true, &sum, &sum_sq);
+        for (double zi : z) {
+            const double y = 0.5 * (std::max(105.0 - 100.0 * std::exp(-0.02 + 0.25 * zi), 0.0) +
+                                    std::max(105.0 - 100.0 * std::exp(-0.02 - 0.25 * zi), 0.0));
+            sum_ref += y;
+            sum_sq_ref += y * y;
+        }
+        test_assert(std::abs(sum - sum_ref) < 1e-9 * sum_ref && std::abs(sum_sq - sum_sq_ref) < 1e-9 * sum_sq_ref,
+                    "Antithetic payoff moments" + tag);
+
+        // Payoff and Greek sums of several strikes against a plain loop
+        const double pg_K[3] = {90.0, 100.0, 110.0}, pg_sign[3] = {1.0, -1.0, 1.0};
+        const double sqrt_T = std::sqrt(0.5), sigma_T = 0.3 * 0.5, vol = 0.3 * sqrt_T, drift = -0.01;
+        std::vector<double> pg_scratch(2 * z.size()), pg(15);
+        k.payoff_greeks(z.size(), z.data(), 100.0, drift, vol, sqrt_T, sigma_T, 3, pg_K, pg_sign, pg_scratch.data(),
+                        pg.data());
+        worst = 0.0;
+        for (int m = 0; m < 3; ++m) {
+            double expect[5] = {};
+            for (double zi : z) {
+                const double up = 100.0 * std::exp(drift + vol * zi), dn = 100.0 * std::exp(drift - vol * zi);
+                const double pu = std::max(pg_sign[m] * (up - pg_K[m]), 0.0);
+                const double pd = std::max(pg_sign[m] * (dn - pg_K[m]), 0.0);
+                const double iu = pu > 0.0 ? pg_sign[m] * up : 0.0, id = pd > 0.0 ? pg_sign[m] * dn : 0.0;
+                const double p = 0.5 * (pu + pd);
+                expect[0] += p;
+                expect[1] += p * p;
+                expect[2] += 0.5 * (iu + id);
+                expect[3] += 0.5 * (iu * (zi * sqrt_T - sigma_T) + id * (-zi * sqrt_T - sigma_T));
+                expect[4] += 0.5 * (iu * (zi / vol - 1.0) + id * (-zi / vol - 1.0));
+            }
+            for (int q = 0; q < 5; ++q)
+                worst = std::max(worst, std::abs(pg[q * 3 + m] - expect[q]) / std::max(1.0, std::abs(expect[q])));
+        }
+        test_assert(worst < 1e-9, "Antithetic payoff and Greek sums per strike" + tag);
+
+        std::vector<double> d = rhs;
+        k.tridiagonal(rows, lines, a.data(), b.data(), c.data(), d.data(), scratch.data(), lines);
+        double resid = 0.0;
+        for (int i = 0; i < rows; ++i)
+            for (int l = 0; l < lines; ++l) {
+                const int e = i * lines + l;
+                double lhs = b[e] * d[e];
+                if (i > 0) lhs += a[e] * d[e - lines];
+                if (i + 1 < rows) lhs += c[e] * d[e + lines];
+                resid = std::max(resid, std::abs(lhs - rhs[e]));
+            }
+        if (tri_ref.empty()) tri_ref = d;
+        worst = 0.0;
+        for (std::size_t i = 0; i < d.size(); ++i) worst = std::max(worst, std::abs(d[i] - tri_ref[i]));
+        test_assert(resid < 1e-13 && worst < 1e-14, "Interleaved tridiagonal solve" + tag);
+
+        // Factorised sweep: line 0's coefficients shared by every right-hand side
+        std::vector<double> fa(rows), fb(rows), fc(rows);
+        for (int i = 0; i < rows; ++i) {
+            fa[i] = a[i * lines];
+            fb[i] = b[i * lines];
+            fc[i] = c[i * lines];
+        }
+        const TridiagonalFactor factor(fa, fb, fc);
+        std::vector<double> fac_inv_beta(rows), fac_cp(rows, 0.0);
+        fac_inv_beta[0] = 1.0 / fb[0];
+        for (int i = 1; i < rows; ++i) {
+            fac_cp[i - 1] = fc[i - 1] * fac_inv_beta[i - 1];
+            fac_inv_beta[i] = 1.0 / (fb[i] - fa[i] * fac_cp[i - 1]);
+        }
+        d = rhs;
+        k.factored_tridiagonal(rows, lines, fa.data(), fac_inv_beta.data(), fac_cp.data(), d.data(), lines);
+        resid = 0.0;
+        for (int i = 0; i < rows; ++i)
+            for (int l = 0; l < lines; ++l) {
+                const int e = i * lines + l;
+                double lhs = fb[i] * d[e];
+                if (i > 0) lhs += fa[i] * d[e - lines];
+                if (i + 1 < rows) lhs += fc[i] * d[e + lines];
+                resid = std::max(resid, std::abs(lhs - rhs[e]));
+            }
+        std::vector<double> via_factor = rhs;
+        factor.solve(via_factor.data(), lines, lines);
+        worst = 0.0;
+        for (std::size_t i = 0; i < d.size(); ++i) worst = std::max(worst, std::abs(d[i] - via_factor[i]));
+        test_assert(resid < 1e-13 && worst < 1e-14, "Factorised tridiagonal sweep" + tag);
+
+        DupireSurface surface;
+        surface.t = {0.5, 1.0};
+        surface.S = grid;
+        surface.sigma = {row0, row1};
+        k.interp_rows(grid.size(), grid.data(), row0.data(), row1.data(), 0.4, n, x.data(), out.data());
+        worst = 0.0;
+        for (std::size_t i = 0; i < n; ++i) worst = std::max(worst, std::abs(out[i] - surface.bilinear(x[i], 0.7)));
+        const double outside[2] = {10.0, 1000.0};
+        double flat[2];
+        k.interp_rows(grid.size(), grid.data(), row0.data(), row1.data(), 0.4, 2, outside, flat);
+        test_assert(worst < 1e-14 && std::abs(flat[0] - (0.6 * row0.front() + 0.4 * row1.front())) < 1e-15 &&
+                    std::abs(flat[1] - (0.6 * row0.back() + 0.4 * row1.back())) < 1e-15,
+                    "Surface interpolation matches bilinear, flat outside the grid" + tag);
+    }
+
+    // Dispatched entry points follow the selection; unsupported variants are rejected
+    const KernelISA before = kernel_isa(Kernel::SurfaceInterpolation);
+    set_isa(KernelISA::Generic);
+    test_assert(kernel_isa(Kernel::Tridiagonal) == KernelISA::Generic, "set_isa selects every kernel");
+    set_isa(before);
+    black_scholes_price_batch(n, S.data(), K.data(), 0.03, T.data(), sigma.data(), types.data(), out.data());
+    test_assert(std::abs(out[100] - ref[100]) < 1e-12, "Dispatched batch pricing");
+
+    // SLV with a batched local vol: a scalar function through the batch overload
+    // reproduces the path-by-path engine, and a leverage grid batch matches its
+    // scalar interpolation
+    const HestonParams heston{1.5, 0.04, 0.5, -0.7, 0.04};
+    const LocalVolFn cev = CEVLocalVol{0.25, 0.9, 100.0}.to_fn();
+    const LocalVolBatchFn cev_batch = [&cev](double t, std::size_t m, const double* spot, double* vol) {
+        for (std::size_t i = 0; i < m; ++i) vol[i] = cev(spot[i], t);
+    };
+    const MCResult slv_scalar = mc_slv_price(100.0, 100.0, 0.03, 1.0, 1000, 20, OptionType::Call, heston, cev, 7UL);
+    const MCResult slv_batch = mc_slv_price(100.0, 100.0, 0.03, 1.0, 1000, 20, OptionType::Call, heston, cev_batch, 7UL);
+    test_assert(slv_scalar.price == slv_batch.price && slv_scalar.std_error == slv_batch.std_error,
+                "Batched SLV local vol keeps the path-by-path stream");
+    LeverageGrid lev;
+    lev.t = {0.25, 0.5, 1.0};
+    lev.S = grid;
+    lev.L = {row0, row1, row0};
+    double worst = 0.0;
+    for (double tt : {0.1, 0.3, 0.75, 2.0}) {
+        lev.interpolate_batch(tt, n, x.data(), out.data());
+        for (std::size_t i = 0; i < n; ++i) worst = std::max(worst, std::abs(out[i] - lev.interpolate(x[i], tt)));
+    }
+    test_assert(worst < 1e-14, "Leverage grid batch matches its scalar interpolation");
+    bool threw = false;
+    if (detected_isa() != KernelISA::AVX512) {
+        try { set_kernel_isa(Kernel::NormalFill, KernelISA::AVX512); } catch (const std::invalid_argument&) { threw = true; }
+    } else {
+        threw = true;
+    }
+    test_assert(threw, "Unsupported variant is rejected");
+}
+
+/**
+ * @brief Test tuning profile round trips, validation and result invariance
+ */
+void test_engine_tuning() {
+    print_section("Engine Tuning");
+
+    const EngineTuning saved = engine_tuning();
+    const std::string path = "test_tuning_profile.ini";
+    std::remove(path.c_str());
+
+    EngineTuning a, b, loaded;
+    a.threads = 4; a.heston_line_block = 16; a.batch_chunk = 64;
+    b.basket_column_chunk = 128;
+    test_assert(!load_tuning_profile(path, "node-a", loaded), "Missing profile leaves settings alone");
+    save_tuning_profile(path, "node-a", a);
+    save_tuning_profile(path, "node-b [x86]", b);
+    a.basket_line_block = 32;
+    save_tuning_profile(path, "node-a", a);    // replaces node-a, keeps node-b
+    test_assert(load_tuning_profile(path, "node-a", loaded) && loaded == a, "Profile round-trips a machine's section");
+    test_assert(load_tuning_profile(path, "node-b [x86]", loaded) && loaded == b, "Other machines' sections survive a save");
+    test_assert(!load_tuning_profile(path, "node-c", loaded), "Unknown fingerprint is not found");
+    const std::string fingerprint = hardware_fingerprint();
+    const std::string logical = "_" + std::to_string(std::thread::hardware_concurrency()) + "t";
+    test_assert(fingerprint.size() > logical.size() &&
+                fingerprint.compare(fingerprint.size() - logical.size(), logical.size(), logical) == 0,
+                "Fingerprint is the CPU model and logical core count");
+    {
+        std::ofstream out(path, std::ios::app);
+        out << "\n[bad]\nbatch_chunk = 12x\n";
+    }
+    bool threw = false;
+    try { load_tuning_profile(path, "bad", loaded); } catch (const std::invalid_argument&) { threw = true; }
+    test_assert(threw, "Malformed profile value is rejected");
+    std::remove(path.c_str());
+
+    // Simultaneous saves from several tuners keep every machine's section
+    {
+        std::vector<std::thread> savers;
+        for (int t = 0; t < 8; ++t) {
+            savers.emplace_back([&path, t] {
+                EngineTuning mine;
+                mine.batch_chunk = 32 + t;
+                for (int rep = 0; rep < 5; ++rep) save_tuning_profile(path, "node-" + std::to_string(t), mine);
+            });
+        }
+        for (auto& s : savers) s.join();
+        bool all_kept = true;
+        for (int t = 0; t < 8; ++t) {
+            EngineTuning got;
+            all_kept = all_kept && load_tuning_profile(path, "node-" + std::to_string(t), got) &&
+                       got.batch_chunk == 32 + t;
+        }
+        test_assert(all_kept, "Concurrent profile saves keep every section");
+        std::remove(path.c_str());
+        std::remove((path + ".lock").c_str());
+    }
+
+    threw = false;
+    EngineTuning invalid;
+    invalid.batch_chunk = kMaxBatchChunk + 1;
+    try { set_engine_tuning(invalid); } catch (const std::invalid_argument&) { threw = true; }
+    test_assert(threw && engine_tuning() == saved, "Oversized batch chunk is rejected");
+
+    // The knobs only regroup independent lines and options: results must not move
+    HestonParams h;
+    HestonADIConfig hc;
+    hc.num_S = 60; hc.num_v = 30; hc.num_t = 20;
+    MultiAssetADIConfig mc;
+    mc.num_S = 24; mc.num_t = 10;
+    const std::vector<std::vector<double>> corr = {{1.0, 0.5, 0.3}, {0.5, 1.0, 0.4}, {0.3, 0.4, 1.0}};
+    BarrierBatch bb;
+    for (int i = 0; i < 300; ++i)
+        bb.push_back(100.0, 80.0 + 0.15 * i, 0.5 + 0.01 * i, 0.25, i % 2 ? OptionType::Put : OptionType::Call,
+                     BarrierSpec{BarrierType::DownOut, 70.0, 0.5});
+    auto run = [&](double& heston, double& basket, std::vector<double>& barrier) {
+        heston = pde_heston_adi(100.0, 100.0, 0.03, 1.0, OptionType::Put, h, nullptr, ExerciseStyle::European,
+                                {}, hc).price;
+        basket = pde_multi_asset_adi({100.0, 100.0, 100.0}, {0.2, 0.3, 0.25}, corr, 0.03, 1.0,
+                                     {1.0 / 3, 1.0 / 3, 1.0 / 3}, 100.0, OptionType::Call, mc).price;
+        barrier_price_batch(bb, 0.03, barrier);
+    };
+    double h0, b0, h1, b1;
+    std::vector<double> r0, r1;
+    set_engine_tuning(EngineTuning{});
+    run(h0, b0, r0);
+    EngineTuning odd;
+    odd.heston_line_block = 3; odd.heston_column_chunk = 5;
+    odd.basket_line_block = 7; odd.basket_column_chunk = 11;
+    odd.batch_chunk = 17;
+    set_engine_tuning(odd);
+    run(h1, b1, r1);
+    set_engine_tuning(saved);
+    double worst = 0.0;
+    for (std::size_t i = 0; i < r0.size(); ++i) worst = std::max(worst, std::abs(r0[i] - r1[i]));
+    test_assert(std::abs(h0 - h1) < 1e-12 && std::abs(b0 - b1) < 1e-12 && worst < 1e-12,
+                "Tuned block sizes leave engine results unchanged");
+}
+
+/**
+ * @brief Test the engine accuracy harness and its saved-result comparison
+ */
+void test_accuracy_harness() {
+    print_section("Accuracy Harness");
+
+    AccuracyHarnessConfig config;
+    config.scale = 0.5;
+    const std::vector<EngineAccuracy> results = run_accuracy_harness(config);
+    bool all_passed = !results.empty();
+    for (const auto& e : results) {
+        if (!e.passed()) std::cout << "  " << e.engine << ": " << e.check << " " << e.error << "\n";
+        all_passed = all_passed && e.passed() && !e.values.empty();
+    }
+    test_assert(all_passed, "Every engine passes its reference check");
+    test_assert(std::any_of(results.begin(), results.end(), [](const EngineAccuracy& e) { return e.engine == "slv"; }) &&
+                std::any_of(results.begin(), results.end(), [](const EngineAccuracy& e) { return e.engine == "svi"; }),
+                "Harness names engines after their units");
+
+    const std::string path = "test_accuracy_results.txt";
+    save_accuracy_results(path, results);
+    const std::vector<EngineAccuracy> loaded = load_accuracy_results(path);
+    std::remove(path.c_str());
+    bool same = loaded.size() == results.size();
+    for (std::size_t i = 0; same && i < results.size(); ++i) {
+        same = loaded[i].engine == results[i].engine && loaded[i].values.size() == results[i].values.size();
+        for (std::size_t j = 0; same && j < results[i].values.size(); ++j)
+            same = loaded[i].values[j] == results[i].values[j] ||
+                   (std::isnan(loaded[i].values[j]) && std::isnan(results[i].values[j]));
+    }
+    test_assert(same, "Saved results round-trip at full precision");
+
+    const std::vector<EngineAccuracyDelta> self = compare_accuracy_results(loaded, results);
+    test_assert(self.size() == results.size() &&
+                std::all_of(self.begin(), self.end(), [](const EngineAccuracyDelta& d) { return d.max_rel_delta == 0.0 && d.passed; }),
+                "A run compared with itself has no deltas");
+
+    std::vector<EngineAccuracy> perturbed(results.begin(), results.begin() + 2);
+    perturbed[0].values[0] *= 1.0 + 1e-7;
+    const std::vector<EngineAccuracyDelta> deltas = compare_accuracy_results(results, perturbed);
+    test_assert(std::abs(deltas[0].max_rel_delta - 1e-7) < 1e-9 && deltas[1].max_rel_delta == 0.0 &&
+                std::isinf(deltas.back().max_rel_delta),
+                "Deltas are relative and missing engines are reported");
+
+    bool threw = false;
+    try { load_accuracy_results("no_such_accuracy_file.txt"); } catch (const std::runtime_error&) { threw = true; }
+    test_assert(threw, "Missing results file is rejected");
+}
+
+/**
+ * @brief Test the CSV, NDJSON and columnar binary result writers
+ */
+void test_result_writer() {
+    print_section("Result Writers");
+
+    const ResultSchema schema = {{"symbol", ColumnType::Text},
+                                 {"count", ColumnType::Integer},
+                                 {"price", ColumnType::Real},
+                                 {"delta", ColumnType::Real, 2}};
+    auto fill = [](ResultWriter& w) {
+        w.text("AAPL").integer(-3).real(0.1).real(0.4567);
+        w.end_row();
+        w.text("a,\"b\"").integer(7).real(1e300).real(std::numeric_limits<double>::quiet_NaN());
+        w.end_row();
+        w.finish();
+    };
+
+    std::ostringstream csv;
+    {
+        ResultWriter w(schema, ResultFormat::CSV, csv, 16);   // tiny buffer exercises flushing
+        fill(w);
+        test_assert(w.rows() == 2 && w.bytes_written() == csv.str().size(), "CSV writer counts rows and bytes");
+    }
+    test_assert(csv.str() == "symbol,count,price,delta\nAAPL,-3,0.1,0.46\n\"a,\"\"b\"\"\",7,1e+300,nan\n",
+                "CSV writer quotes text and formats reals shortest or fixed");
+
+    std::ostringstream json;
+    {
+        ResultWriter w(schema, ResultFormat::NDJSON, json);
+        fill(w);
+    }
+    test_assert(json.str() == "{\"symbol\":\"AAPL\",\"count\":-3,\"price\":0.1,\"delta\":0.46}\n"
+                              "{\"symbol\":\"a,\\\"b\\\"\",\"count\":7,\"price\":1e+300,\"delta\":null}\n",
+                "NDJSON writer escapes text and writes non-finite reals as null");
+
+    // Shortest form round-trips every double
+    std::mt19937_64 rng(7);
+    std::uniform_real_distribution<double> u(-1e6, 1e6);
+    std::vector<double> values(1000);
+    for (auto& v : values) v = u(rng) * std::pow(10.0, static_cast<int>(u(rng)) % 40);
+    std::ostringstream reals;
+    {
+        ResultWriter w({{"x", ColumnType::Real}}, ResultFormat::CSV, reals);
+        for (double v : values) { w.real(v); w.end_row(); }
+    }
+    std::istringstream back(reals.str());
+    std::string line;
+    std::getline(back, line);
+    bool exact = true;
+    for (double v : values) exact = exact && std::getline(back, line) && std::stod(line) == v;
+    test_assert(exact, "Shortest real formatting reads back exactly");
+
+    // Binary: several row groups, read back column by column
+    const std::string path = "test_results.bin";
+    const std::size_t n = ResultWriter::kBinaryRowGroup * 2 + 17;
+    {
+        ResultWriter w(schema, ResultFormat::Binary, path, 4096);
+        for (std::size_t i = 0; i < n; ++i) {
+            w.text(i % 3 ? "SPX" : "").integer(static_cast<long long>(i)).real(values[i % values.size()]).real(0.5 * i);
+            w.end_row();
+        }
+    }
+    const ColumnarResults cols = read_columnar_results(path);
+    std::remove(path.c_str());
+    bool same = cols.rows == n && cols.schema.size() == schema.size() && cols.schema[3].precision == 2 &&
+                cols.texts[0].size() == n && cols.integers[1].size() == n && cols.reals[2].size() == n;
+    for (std::size_t i = 0; same && i < n; ++i) {
+        same = cols.texts[0][i] == (i % 3 ? "SPX" : "") && cols.integers[1][i] == static_cast<long long>(i) &&
+               cols.reals[2][i] == values[i % values.size()] && cols.reals[3][i] == 0.5 * i;
+    }
+    test_assert(same, "Binary columnar results round-trip across row groups");
+
+    std::ostringstream sink;
+    ResultWriter w(schema, ResultFormat::CSV, sink);
+    bool wrong_type = false, short_row = false;
+    try { w.real(1.0); } catch (const std::invalid_argument&) { wrong_type = true; }
+    w.text("X");
+    try { w.end_row(); } catch (const std::invalid_argument&) { short_row = true; }
+    test_assert(wrong_type && short_row, "Cells must match the schema");
+    bool missing = false;
+    try { read_columnar_results("no_such_results.bin"); } catch (const std::runtime_error&) { missing = true; }
+    test_assert(missing, "Missing binary results file is rejected");
+
+    std::string escaped;
+    append_json_escaped(escaped, "desk \"A\"\\fx\n\x01");
+    test_assert(escaped == "desk \\\"A\\\"\\\\fx\\n\\u0001", "JSON escaping of free text");
+}
+
+/**
+ * @brief Test the shared-memory pricing cache and cached portfolio groups
+ */
+void test_shm_cache() {
+    print_section("Shared-Memory Pricing Cache");
+
+    const std::string name = "/bsm_test_cache_" + std::to_string(std::random_device{}());
+    SharedPricingCache::remove(name);
+    {
+        SharedPricingCache a(name, 1000);
+        SharedPricingCache b(name, 64);   // Attaches; keeps the creator's size
+        test_assert(a.slots() == 1024 && b.slots() == 1024, "Cache rounds slots up and attachers keep the region's size");
+
+        CacheKey key("engine");
+        key.add(100.0).add(-0.0).add(7LL).add("call");
+        CacheKey same("engine");
+        same.add(100.0).add(0.0).add(7LL).add("call");
+        CacheKey other("engine");
+        other.add(100.0).add(0.0).add(7LL).add("put");
+        test_assert(key.hash() == same.hash() && key.check() == same.check() && key.hash() != other.hash(),
+                    "Cache keys normalise -0.0 and separate different fields");
+
+        const double stored[3] = {1.5, -2.25, 1e-300};
+        double got[SharedPricingCache::kMaxValues] = {};
+        test_assert(b.lookup(key, got, 3) == 0, "Cache misses before a store");
+        test_assert(a.store(key, stored, 3), "Cache stores a value");
+        test_assert(b.lookup(same, got, SharedPricingCache::kMaxValues) == 3 && got[0] == 1.5 &&
+                    got[1] == -2.25 && got[2] == 1e-300,
+                    "A second mapping of the region sees the stored values");
+        test_assert(b.lookup(other, got, 3) == 0 && b.stats().hits == 1 && b.stats().misses == 2,
+                    "Cache counts hits and misses per instance");
+
+        bool rejected = false;
+        try {
+            double many[SharedPricingCache::kMaxValues + 1] = {};
+            a.store(key, many, SharedPricingCache::kMaxValues + 1);
+        } catch (const std::invalid_argument&) {
+            rejected = true;
+        }
+        test_assert(rejected, "Cache rejects values longer than kMaxValues");
+
+        // Concurrent writers and readers never see a torn entry: every value of
+        // a key's entry encodes the key
+        std::atomic<int> torn{0};
+        auto worker = [&](int id) {
+            SharedPricingCache& c = id % 2 ? a : b;
+            for (int i = 0; i < 20000; ++i) {
+                const long long k = (i * 7 + id) % 64;
+                CacheKey ck("stress");
+                ck.add(k);
+                double v[SharedPricingCache::kMaxValues];
+                const int n = c.lookup(ck, v, SharedPricingCache::kMaxValues);
+                for (int j = 0; j < n; ++j)
+                    if (v[j] != static_cast<double>(k * 100 + j)) torn.fetch_add(1);
+                if (n == 0) {
+                    for (int j = 0; j < SharedPricingCache::kMaxValues; ++j) v[j] = static_cast<double>(k * 100 + j);
+                    c.store(ck, v, SharedPricingCache::kMaxValues);
+                }
+            }
+        };
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t) threads.emplace_back(worker, t);
+        for (auto& t : threads) t.join();
+        test_assert(torn.load() == 0, "Concurrent stores and lookups never return torn entries");
+    }
+    test_assert(SharedPricingCache::remove(name) && !SharedPricingCache::remove(name),
+                "Cache regions are removed by name");
+
+    // A full probe window evicts the least recently used slot
+    {
+        SharedPricingCache tiny(name, 16);
+        const double v = 1.0;
+        for (long long k = 0; k < 200; ++k) {
+            CacheKey ck("evict");
+            tiny.store(ck.add(k), &v, 1);
+        }
+        CacheKey last("evict");
+        double got = 0.0;
+        test_assert(tiny.stats().evictions >= 184 && tiny.lookup(last.add(199LL), &got, 1) == 1,
+                    "A full table evicts old entries and keeps the newest");
+    }
+    SharedPricingCache::remove(name);
+
+    // Portfolio groups priced through the cache match a cold run exactly
+    attach_shared_pricing_cache(name, 4096);
+    PortfolioPricingConfig config;
+    config.mc_paths = 4000;
+    config.pde_S_steps = 100;
+    config.pde_T_steps = 50;
+    bool identical = true;
+    std::uint64_t hits = 0;
+    for (PricingModel model : {PricingModel::PDE, PricingModel::MonteCarlo}) {
+        const auto book = generate_sample_portfolio(300, 5, model);
+        const PortfolioValuation cold = price_portfolio(book, config);
+        attach_shared_pricing_cache(name);
+        const PortfolioValuation warm = price_portfolio(book, config);
+        hits += shared_pricing_cache()->stats().hits;
+        for (std::size_t i = 0; i < book.size(); ++i)
+            identical = identical && cold.positions[i].price == warm.positions[i].price &&
+                        cold.positions[i].gamma == warm.positions[i].gamma &&
+                        cold.positions[i].std_error == warm.positions[i].std_error;
+    }
+    // MC groups are keyed and seeded by their contents, so the same groups in
+    // another order (other group indices) all hit the cache
+    {
+        const auto book = generate_sample_portfolio(300, 5, PricingModel::MonteCarlo);
+        const std::vector<PositionSpec> reversed(book.rbegin(), book.rend());
+        const PortfolioValuation first = price_portfolio(book, config);
+        const SharedCacheStats before = shared_pricing_cache()->stats();
+        const PortfolioValuation second = price_portfolio(reversed, config);
+        const SharedCacheStats after = shared_pricing_cache()->stats();
+        bool same = true;
+        for (std::size_t i = 0; i < book.size(); ++i)
+            same = same && first.positions[i].price == second.positions[book.size() - 1 - i].price;
+        test_assert(same && after.hits > before.hits && after.misses == before.misses,
+                    "MC groups hit the cache from another book");
+    }
+    detach_shared_pricing_cache();
+    SharedPricingCache::remove(name);
+    test_assert(identical && hits > 0 && shared_pricing_cache() == nullptr,
+                "Portfolio PDE and MC groups are reused from the shared cache");
+
+#ifdef _OPENMP
+    // Cached MC values must not depend on the thread count that produced them
+    {
+        PortfolioPricingConfig blocks = config;
+        blocks.mc_paths = 20000;   // several path blocks per group
+        const auto book = generate_sample_portfolio(400, 9, PricingModel::MonteCarlo);
+        const int threads = omp_get_max_threads();
+        omp_set_num_threads(1);
+        const PortfolioValuation one = price_portfolio(book, blocks);
+        omp_set_num_threads(4);
+        const PortfolioValuation four = price_portfolio(book, blocks);
+        omp_set_num_threads(threads);
+        std::size_t differ = 0;
+        for (std::size_t i = 0; i < book.size(); ++i)
+            differ += one.positions[i].price != four.positions[i].price ||
+                      one.positions[i].gamma != four.positions[i].gamma ||
+                      one.positions[i].std_error != four.positions[i].std_error;
+        test_assert(differ == 0, "Portfolio MC values are identical on 1 and 4 threads");
+    }
+#endif
+}
+
+/**
+ * @brief Test async job ordering, cancellation and sliced portfolio pricing
+ */
+void test_async_pricing() {
+    print_section("Async Pricing");
+
+    PricingExecutor executor(1);
+
+    // price -> Greeks -> aggregate without blocking in between
+    const double S = 100.0, r = 0.05, T = 0.5, sigma = 0.2;
+    std::vector<PricingFuture<double>> legs;
+    for (double K : {90.0, 100.0, 110.0}) {
+        legs.push_back(executor.submit([=] { return black_scholes_price(S, K, r, T, sigma, OptionType::Call); })
+                           .then([=](double price) { return price + 100.0 * black_scholes_delta(S, K, r, T, sigma, OptionType::Call); }));
+    }
+    const double total = when_all(legs).then([](const std::vector<double>& v) {
+        return std::accumulate(v.begin(), v.end(), 0.0);
+    }).get();
+    double expected = 0.0;
+    for (double K : {90.0, 100.0, 110.0})
+        expected += black_scholes_price(S, K, r, T, sigma, OptionType::Call) + 100.0 * black_scholes_delta(S, K, r, T, sigma, OptionType::Call);
+    test_assert(std::abs(total - expected) < 1e-12, "Continuations chain price, Greeks and aggregate");
+
+    // With the only worker held, queued jobs run by priority, then submission order
+    std::promise<void> gate;
+    std::shared_future<void> opened = gate.get_future().share();
+    std::mutex order_mutex;
+    std::vector<int> order;
+    auto record = [&](int id) {
+        return [&, id] {
+            std::lock_guard<std::mutex> lock(order_mutex);
+            order.push_back(id);
+            return id;
+        };
+    };
+    std::promise<void> running;
+    auto blocker = executor.submit([opened, &running] { running.set_value(); opened.wait(); return 0; });
+    running.get_future().wait();
+    std::vector<PricingFuture<int>> jobs;
+    jobs.push_back(executor.submit(record(1), {JobPriority::Batch, {}}));
+    jobs.push_back(executor.submit(record(2), {JobPriority::Batch, {}}));
+    jobs.push_back(executor.submit(record(3), {JobPriority::Normal, {}}));
+    jobs.push_back(executor.submit(record(4), {JobPriority::Interactive, {}}));
+    JobOptions cancelled_options{JobPriority::Interactive, {}};
+    auto cancelled = executor.submit(record(5), cancelled_options);
+    auto after_cancelled = cancelled.then([](int v) { return v + 1; });
+    cancelled_options.cancel.cancel();
+    test_assert(executor.pending() == 5, "Jobs queue behind a running one");
+    gate.set_value();
+    for (auto& j : jobs) j.wait();
+    test_assert(order == std::vector<int>({4, 3, 1, 2}), "Higher-priority jobs run first");
+
+    bool cancelled_thrown = false, propagated = false;
+    try { cancelled.get(); } catch (const PricingCancelled&) { cancelled_thrown = true; }
+    try { after_cancelled.get(); } catch (const PricingCancelled&) { propagated = true; }
+    test_assert(cancelled_thrown && propagated, "Cancelled jobs do not run and fail their continuations");
+
+    bool error_propagated = false;
+    auto failing = executor.submit([]() -> double { throw std::invalid_argument("bad input"); });
+    try { when_all(std::vector<PricingFuture<double>>{legs[0], failing}).get(); }
+    catch (const std::invalid_argument&) { error_propagated = true; }
+    test_assert(error_propagated, "Job exceptions propagate through when_all");
+
+    // Sliced portfolio pricing matches the synchronous result exactly
+    PortfolioPricingConfig config;
+    config.mc_paths = 4000;
+    config.pde_S_steps = 100;
+    config.pde_T_steps = 50;
+    auto book = generate_sample_portfolio(400, 9, PricingModel::MonteCarlo);
+    const auto pde = generate_sample_portfolio(400, 10, PricingModel::PDE);
+    book.insert(book.end(), pde.begin(), pde.end());
+    const PortfolioValuation sync = price_portfolio(book, config);
+    const PortfolioValuation async = price_portfolio_async(executor, book, config, {JobPriority::Batch, {}}, 50).get();
+    bool identical = async.num_groups == sync.num_groups;
+    for (std::size_t i = 0; i < book.size(); ++i)
+        identical = identical && async.positions[i].price == sync.positions[i].price &&
+                    async.positions[i].std_error == sync.positions[i].std_error;
+    test_assert(identical, "Sliced async portfolio pricing matches price_portfolio");
+
+    JobOptions book_options{JobPriority::Batch, {}};
+    book_options.cancel.cancel();
+    bool book_cancelled = false;
+    try { price_portfolio_async(executor, book, config, book_options).get(); }
+    catch (const PricingCancelled&) { book_cancelled = true; }
+    test_assert(book_cancelled, "A cancelled book stops at the next slice");
+}
+
+/**
+ * @brief Test incremental recomputation of the generic and portfolio risk graphs
+ */
+void test_risk_graph() {
+    print_section("Risk Graph");
+
+    // Generic graph: memoised values, version stamps and early cut-off
+    RiskGraph graph;
+    const RiskNodeId a = graph.add_input("a", {1.0, 2.0});
+    const RiskNodeId b = graph.add_input("b", {10.0});
+    int sum_calls = 0, sign_calls = 0;
+    const RiskNodeId sum = graph.add_node("sum", {a, b}, [&](const std::vector<const RiskValues*>& in, RiskValues& out) {
+        ++sum_calls;
+        out = {(*in[0])[0] + (*in[0])[1] + (*in[1])[0]};
+    });
+    const RiskNodeId sign = graph.add_node("sign", {sum}, [&](const std::vector<const RiskValues*>& in, RiskValues& out) {
+        ++sign_calls;
+        out = {(*in[0])[0] >= 0.0 ? 1.0 : -1.0};
+    });
+    test_assert(graph.value(sum)[0] == 13.0 && sum_calls == 1 && sign_calls == 1, "Risk graph computes nodes when added");
+
+    const std::uint64_t sign_version = graph.version(sign);
+    graph.set_input(a, 1, 5.0);
+    const RiskRecalcStats stats = graph.recalculate();
+    test_assert(graph.value(sum)[0] == 16.0 && stats.recomputed == 2 && stats.changed == 1 && stats.levels == 2 &&
+                graph.version(sign) == sign_version,
+                "Unchanged results keep their version and stop propagating");
+    graph.set_input(b, {10.0});
+    test_assert(!graph.pending() && graph.recalculate().visited == 0 && sum_calls == 2,
+                "Setting an input to its current value is a no-op");
+
+    bool rejected = false;
+    try { graph.set_input(sum, {0.0}); } catch (const std::invalid_argument&) { rejected = true; }
+    test_assert(rejected, "Only input nodes can be set");
+
+    // Portfolio graph matches price_portfolio and only reprices what a change reaches
+    PortfolioPricingConfig config;
+    config.pde_S_steps = 100;
+    config.pde_T_steps = 50;
+    const auto book = generate_sample_portfolio(2000, 21, PricingModel::PDE);
+    PortfolioRiskGraph risk(book, config);
+    auto matches = [&](const std::vector<PositionSpec>& specs, const PortfolioPricingConfig& cfg) {
+        const PortfolioValuation ref = price_portfolio(specs, cfg);
+        double total = 0.0;
+        bool same = true;
+        for (std::size_t i = 0; i < specs.size(); ++i) {
+            same = same && risk.position(i).price == ref.positions[i].price &&
+                   risk.position(i).gamma == ref.positions[i].gamma;
+            total += specs[i].quantity * ref.positions[i].price;
+        }
+        return same && std::abs(risk.totals().value - total) < 1e-9 * std::max(1.0, std::abs(total));
+    };
+    test_assert(matches(book, config), "Portfolio risk graph matches price_portfolio");
+
+    const std::string und = book.front().underlying;
+    const double und_spot = book.front().spot;
+    std::size_t groups_of_und = 0;
+    for (const auto& g : plan_pricing_groups(book)) groups_of_und += g.underlying == und;
+    auto bumped = book;
+    for (auto& p : bumped) if (p.underlying == und) p.spot = und_spot * 1.01;
+    risk.set_spot(und, und_spot * 1.01);
+    const RiskRecalcStats spot_stats = risk.recalculate();
+    test_assert(spot_stats.recomputed == groups_of_und + 2 && matches(bumped, config),
+                "A spot bump reprices only that underlying's groups and aggregates");
+
+    const PositionSpec p0 = bumped.front();
+    for (auto& p : bumped) if (p.underlying == p0.underlying && p.T == p0.T) p.sigma = p0.sigma + 0.01;
+    risk.set_vol(p0.underlying, p0.T, p0.sigma + 0.01);
+    test_assert(risk.recalculate().recomputed == 3 && matches(bumped, config), "A vol node bump reprices one group");
+
+    PortfolioPricingConfig moved = config;
+    moved.r = 0.03;
+    risk.set_rate(0.03);
+    test_assert(risk.recalculate().recomputed == risk.num_groups() + risk.underlyings().size() + 1 &&
+                matches(bumped, moved),
+                "A rate change reprices the whole book");
+
+    // Monte Carlo groups run inside the level's parallel loop and still match
+    PortfolioPricingConfig mc_config;
+    mc_config.mc_paths = 20000;
+    const auto mc_book = generate_sample_portfolio(400, 22, PricingModel::MonteCarlo);
+#ifdef _OPENMP
+    const int threads = omp_get_max_threads();
+    omp_set_num_threads(4);
+#endif
+    PortfolioRiskGraph mc_risk(mc_book, mc_config);
+    auto mc_matches = [&](const std::vector<PositionSpec>& specs) {
+        const PortfolioValuation ref = price_portfolio(specs, mc_config);
+        bool same = true;
+        for (std::size_t i = 0; i < specs.size(); ++i)
+            same = same && mc_risk.position(i).price == ref.positions[i].price &&
+                   mc_risk.position(i).gamma == ref.positions[i].gamma &&
+                   mc_risk.position(i).std_error == ref.positions[i].std_error;
+        return same;
+    };
+    const bool mc_base = mc_matches(mc_book);
+    auto mc_bumped = mc_book;
+    const std::string mc_und = mc_book.front().underlying;
+    for (auto& p : mc_bumped) if (p.underlying == mc_und) p.spot *= 1.01;
+    mc_risk.set_spot(mc_und, mc_book.front().spot * 1.01);
+    mc_risk.recalculate();
+    const bool mc_moved = mc_matches(mc_bumped);
+#ifdef _OPENMP
+    omp_set_num_threads(threads);
+#endif
+    test_assert(mc_base && mc_moved, "Monte Carlo risk graph matches price_portfolio exactly");
+}
+
+/**
+ * @brief Test position netting, per-account totals and netted pricing
+ */
+void test_position_netting() {
+    print_section("Position Netting");
+
+    // Two accounts holding overlapping contracts
+    PositionSpec a{"AAA", 10.0, 100.0, 100.0, 0.5, 0.2, OptionType::Call, PricingModel::Analytic};
+    PositionSpec b{"AAA", -4.0, 100.0, 110.0, 0.5, 0.2, OptionType::Put, PricingModel::Analytic};
+    PositionSpec c = a;
+    c.quantity = -3.0;
+    PositionSpec d = a;
+    d.quantity = 5.0;
+    const std::vector<PositionSpec> rows = {a, b, c, d};
+    const CompressedBook book = compress_positions(rows, {"F1", "F1", "F2", "F1"});
+    test_assert(book.contracts.size() == 2 && book.contracts[0].quantity == 12.0 && book.contracts[1].quantity == -4.0 &&
+                book.contract_of_row == std::vector<std::size_t>({0, 1, 0, 0}) && book.compression_ratio() == 2.0,
+                "Rows with identical terms net into one contract");
+    test_assert(book.accounts == std::vector<std::string>({"F1", "F2"}) &&
+                book.account_offsets == std::vector<std::size_t>({0, 2, 3}) &&
+                book.entry_quantity == std::vector<double>({15.0, -4.0, -3.0}),
+                "Holdings are netted per account");
+
+    // Netted pricing matches row-by-row pricing
+    const auto sample = generate_sample_portfolio(20000, 17, PricingModel::Analytic);
+    std::vector<std::string> accounts;
+    for (std::size_t i = 0; i < sample.size(); ++i) accounts.push_back("A" + std::to_string(i % 5));
+    const CompressedBook netted = compress_positions(sample, accounts);
+    const PortfolioValuation per_row = price_portfolio(sample);
+    const PortfolioValuation per_contract = price_compressed(netted);
+    const auto expanded = expand_valuations(netted, per_contract.positions);
+    double max_diff = 0.0;
+    std::vector<double> account_value(5, 0.0);
+    for (std::size_t i = 0; i < sample.size(); ++i) {
+        max_diff = std::max(max_diff, std::abs(expanded[i].price - per_row.positions[i].price));
+        account_value[i % 5] += sample[i].quantity * per_row.positions[i].price;
+    }
+    test_assert(netted.contracts.size() < sample.size() && max_diff < 1e-9,
+                "Scattered contract prices match per-row pricing");
+    const auto totals = account_totals(netted, per_contract.positions);
+    double max_account_diff = 0.0;
+    for (std::size_t k = 0; k < 5; ++k)
+        max_account_diff = std::max(max_account_diff, std::abs(totals[k].value - account_value[k]));
+    test_assert(totals.size() == 5 && max_account_diff < 1e-6 * (1.0 + std::abs(account_value[0])),
+                "Account totals match the sum of their rows");
+
+    // Groups keep their plan index, so Monte Carlo streams match too
+    PortfolioPricingConfig mc;
+    mc.mc_paths = 2000;
+    const auto mc_rows = generate_sample_portfolio(400, 5, PricingModel::MonteCarlo);
+    const CompressedBook mc_book = compress_positions(mc_rows);
+    const auto mc_expanded = expand_valuations(mc_book, price_compressed(mc_book, mc).positions);
+    const PortfolioValuation mc_reference = price_portfolio(mc_rows, mc);
+    bool mc_same = true;
+    for (std::size_t i = 0; i < mc_rows.size(); ++i)
+        mc_same = mc_same && mc_expanded[i].price == mc_reference.positions[i].price;
+    test_assert(mc_same, "Netted Monte Carlo pricing reproduces per-row results");
+
+    bool rejected = false;
+    try { compress_positions(rows, {"F1"}); } catch (const std::invalid_argument&) { rejected = true; }
+    test_assert(rejected, "compress_positions needs one account per row");
+}
+
+/**
+ * @brief Test Taylor P&L explain against closed forms and full revaluation
+ */
+void test_pnl_explain() {
+    print_section("P&L Explain");
+
+    // Analytic coefficients match the closed forms and bumped Greeks
+    const std::vector<PositionSpec> pair = {
+        {"AAA", 10.0, 100.0, 105.0, 0.5, 0.25, OptionType::Call, PricingModel::Analytic},
+        {"BBB", -7.0, 50.0, 45.0, 0.25, 0.4, OptionType::Put, PricingModel::Analytic}};
+    const double r = 0.03;
+    PortfolioPricingConfig config;
+    config.r = r;
+    PnlExplainer explainer(pair, config);
+    const auto& c = explainer.coefficients();
+    bool closed_form = true, bumped = true;
+    for (std::size_t i = 0; i < pair.size(); ++i) {
+        const auto& p = pair[i];
+        const double h = 1e-4;
+        auto close = [](double a, double b, double tol) { return std::abs(a - b) <= tol * (1.0 + std::abs(b)); };
+        closed_form = closed_form && close(c.price[i], black_scholes_price(p.spot, p.strike, r, p.T, p.sigma, p.type), 1e-12) &&
+                      close(c.theta[i], black_scholes_theta(p.spot, p.strike, r, p.T, p.sigma, p.type), 1e-12) &&
+                      close(c.rho[i], black_scholes_rho(p.spot, p.strike, r, p.T, p.sigma, p.type), 1e-12) &&
+                      close(c.vega[i], black_scholes_vega(p.spot, p.strike, r, p.T, p.sigma), 1e-12);
+        const double vanna = (black_scholes_delta(p.spot, p.strike, r, p.T, p.sigma + h, p.type) -
+                              black_scholes_delta(p.spot, p.strike, r, p.T, p.sigma - h, p.type)) / (2.0 * h);
+        const double volga = (black_scholes_vega(p.spot, p.strike, r, p.T, p.sigma + h) -
+                              black_scholes_vega(p.spot, p.strike, r, p.T, p.sigma - h)) / (2.0 * h);
+        bumped = bumped && close(c.vanna[i], vanna, 1e-6) && close(c.volga[i], volga, 1e-6);
+    }
+    test_assert(closed_form, "Fused kernel matches the closed-form price and Greeks");
+    test_assert(bumped, "Vanna and volga match bumped delta and vega");
+
+    // Small moves are explained to second order; a full sample measures the residual exactly
+    const auto book = generate_sample_portfolio(5000, 31, PricingModel::Analytic);
+    PnlExplainer analytic(book);
+    MarketMove move;
+    for (const auto& name : analytic.underlyings()) {
+        move.spot[name] = 0.002 * name.size();
+        move.vol[name] = -0.001;
+    }
+    move.spot["UND3"] = -0.5;
+    move.rate = 0.0005;
+    move.dt = 1.0 / 365.0;
+    const PnlExplain e = analytic.explain(move, book.size());
+    double explained_sum = 0.0;
+    for (double x : e.positions) explained_sum += x;
+    test_assert(std::abs(explained_sum - e.explained()) < 1e-6 * (1.0 + std::abs(e.explained())),
+                "Per-position explain sums to the term totals");
+    test_assert(e.sampled == book.size() && std::abs(e.sample_explained - e.explained()) < 1e-6 * (1.0 + std::abs(e.explained())) &&
+                std::abs(e.residual_estimate) < 0.05 * std::abs(e.sample_actual),
+                "Taylor explain tracks full revaluation of a small move");
+    const PnlExplain sampled = analytic.explain(move, 500, 7);
+    test_assert(sampled.sampled == 500 && sampled.max_abs_residual <= e.max_abs_residual + 1e-9,
+                "Residual is measured on a sample");
+
+    // Numerical engines: grid Greeks plus group bumps
+    PortfolioPricingConfig pde;
+    pde.pde_S_steps = 400;
+    pde.pde_T_steps = 100;
+    std::vector<PositionSpec> grid_book = pair;
+    for (auto& p : grid_book) p.model = PricingModel::PDE;
+    PnlExplainer numerical(grid_book, pde);
+    PnlExplainer closed(pair, pde);
+    bool grid_close = true;
+    for (std::size_t i = 0; i < grid_book.size(); ++i) {
+        const auto& x = numerical.coefficients();
+        const auto& y = closed.coefficients();
+        grid_close = grid_close && std::abs(x.rho[i] - y.rho[i]) < 0.02 * std::abs(y.rho[i]) &&
+                     std::abs(x.vanna[i] - y.vanna[i]) < 0.05 * (0.1 + std::abs(y.vanna[i])) &&
+                     std::abs(x.volga[i] - y.volga[i]) < 0.05 * (1.0 + std::abs(y.volga[i]));
+    }
+    test_assert(grid_close, "PDE rho, vanna and volga from group bumps match the closed form");
+
+    bool rejected = false;
+    MarketMove unknown;
+    unknown.spot["NOPE"] = 1.0;
+    try { analytic.explain(unknown); } catch (const std::invalid_argument&) { rejected = true; }
+    test_assert(rejected, "Unknown underlyings are rejected");
+}
+
+/**
+ * @brief Test Dupire local vol extraction from SVI slices
+ */
+void test_dupire_extraction() {
+    print_section("Dupire Extraction");
+
+    auto slice = [](double T, double forward, SVIParams p) {
+        SVISlice s;
+        s.underlying = "AAA";
+        s.T = T;
+        s.forward = forward;
+        s.params = p;
+        s.valid = true;
+        return s;
+    };
+
+    // Flat smiles: local vol is the forward vol between expiries
+    const std::vector<SVISlice> flat = {slice(1.0, 100.0, SVIParams{0.0625, 0.0, 0.0, 0.0, 0.1}),
+                                        slice(0.5, 100.0, SVIParams{0.02, 0.0, 0.0, 0.0, 0.1})};
+    DupireSurface surface;
+    surface.t = {0.25, 0.75, 1.5};
+    surface.S = {60.0, 100.0, 140.0};
+    const DupireExtractionStats stats = extract_dupire_surface(flat, surface);
+    bool forward_vols = stats.points == 9 && stats.regularised == 0;
+    for (size_t j = 0; j < 3; ++j) {
+        forward_vols = forward_vols && std::abs(surface.sigma[0][j] - 0.2) < 1e-12 &&
+                       std::abs(surface.sigma[1][j] - std::sqrt((0.0625 - 0.02) / 0.5)) < 1e-12 &&
+                       std::abs(surface.sigma[2][j] - 0.25) < 1e-12;
+    }
+    test_assert(forward_vols, "Flat smiles give forward vols, slices in any order");
+
+    // Skewed surface: matches Dupire's formula on finite-differenced Black call prices
+    const SVIParams near{0.02, 0.1, -0.4, 0.0, 0.2}, far{0.045, 0.12, -0.4, 0.02, 0.25};
+    const std::vector<SVISlice> skew = {slice(0.5, 100.0, near), slice(1.0, 100.0, far)};
+    surface.t = {0.75};
+    surface.S = {110.0};
+    extract_dupire_surface(skew, surface);
+    auto call = [&](double K, double T) {
+        const double k = std::log(K / 100.0), x = (T - 0.5) / 0.5;
+        const double w = (1.0 - x) * near.total_variance(k) + x * far.total_variance(k);
+        double c = 0.0;
+        black_otm_normalized_batch(1, &k, &w, &c);
+        return 100.0 * c;
+    };
+    const double hT = 1e-4, hK = 0.05, K = 110.0, T = 0.75;
+    const double dC_dT = (call(K, T + hT) - call(K, T - hT)) / (2.0 * hT);
+    const double d2C_dK2 = (call(K + hK, T) - 2.0 * call(K, T) + call(K - hK, T)) / (hK * hK);
+    const double dupire = std::sqrt(2.0 * dC_dT / (K * K * d2C_dK2));
+    test_assert(std::abs(surface.sigma[0][0] - dupire) < 1e-4, "Gatheral form matches Dupire on call prices");
+
+    // Calendar arbitrage is floored and the surface clamped; reruns reuse the rows
+    surface.t = {0.6, 0.8};
+    surface.S = {50.0, 100.0, 200.0};
+    extract_dupire_surface(skew, surface);
+    const double* row = surface.sigma[1].data();
+    const std::vector<SVISlice> inverted = {slice(0.5, 100.0, far), slice(1.0, 100.0, near)};
+    DupireExtractionConfig bounds;
+    bounds.max_vol = 1.0;
+    const DupireExtractionStats clamped = extract_dupire_surface(inverted, surface, bounds);
+    bool bounded = clamped.regularised > 0 && surface.sigma[1].data() == row;
+    for (const auto& r : surface.sigma)
+        for (double v : r) bounded = bounded && v >= bounds.min_vol && v <= bounds.max_vol;
+    test_assert(bounded, "Arbitrageable regions are regularised in place");
+
+    // Fitted market surface
+    const std::vector<OptionQuote> chain = generate_sample_option_chain(1, 80, 11);
+    const std::vector<SVISlice> fitted = fit_svi_surface(chain, implied_forwards(chain));
+    surface.t.clear();
+    surface.S.clear();
+    for (int i = 1; i <= 40; ++i) surface.t.push_back(0.05 * i);
+    for (int j = 0; j < 101; ++j) surface.S.push_back(50.0 + 2.0 * j);
+    const DupireExtractionStats market = extract_dupire_surface(fitted, surface);
+    bool finite = market.points == 40 * 101;
+    for (const auto& r : surface.sigma)
+        for (double v : r) finite = finite && std::isfinite(v) && v > 0.0;
+    test_assert(finite, "Fitted SVI surface extracts to a finite local vol grid");
+
+    bool rejected = false;
+    surface.S = {100.0, 90.0};
+    try { extract_dupire_surface(skew, surface); } catch (const std::invalid_argument&) { rejected = true; }
+    test_assert(rejected, "Unsorted grids are rejected");
+}
+
 /**
  * @brief Main test runner
  */
@@ -605,6 +2544,31 @@ int main() {
         test_math_utils();
         test_statistics();
         test_edge_cases();
+        test_portfolio_grouping();
+        test_mc_price_grid();
+        test_heston_adi_pde();
+        test_multi_asset_adi();
+        test_barrier_engines();
+        test_asian_options();
+        test_lsm_dual_bounds();
+        test_lsm_variance_reduction();
+        test_lsm_greeks();
+        test_float_precision_engines();
+        test_lsm_out_of_core();
+        test_path_store();
+        test_arbitrage_scanner();
+        test_implied_forward();
+        test_variance_swap();
+        test_isa_dispatch();
+        test_engine_tuning();
+        test_accuracy_harness();
+        test_result_writer();
+        test_shm_cache();
+        test_async_pricing();
+        test_risk_graph();
+        test_position_netting();
+        test_pnl_explain();
+        test_dupire_extraction();
         
         // Performance and optimization tests
         test_performance_optimization();
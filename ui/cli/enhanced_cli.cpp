@@ -4,6 +4,13 @@
 #include "slv.hpp"
 #include "stats.hpp"
 #include "iv_solve.hpp"
+#include "implied_forward.hpp"
+#include "portfolio.hpp"
+#include "engine_tuning.hpp"
+#include "result_writer.hpp"
+#include "shm_cache.hpp"
+#include "pnl_explain.hpp"
+#include "risk_graph.hpp"
 #include <iostream>
 #include <iomanip>
 #include <sstream>
@@ -37,6 +44,7 @@ EnhancedCLI::EnhancedCLI() : running_(false) {
     register_command(std::make_unique<MonteCarloCommand>());
     register_command(std::make_unique<VolatilityCommand>());
     register_command(std::make_unique<ConfigCommand>());
+    register_command(std::make_unique<TuneCommand>());
     register_command(std::make_unique<HelpCommand>(this));
 }
 
@@ -73,6 +81,27 @@ int EnhancedCLI::run(int argc, char* argv[]) {
         return 0;
     }
     
+    // Share results with other workers on this host through a named region
+    if (command_name == "--shm-cache") {
+        if (args.empty()) {
+            print_error("--shm-cache needs a region name, e.g. /bsm_cache");
+            return 1;
+        }
+        try {
+            attach_shared_pricing_cache(args[0]);
+        } catch (const std::exception& e) {
+            print_error(e.what());
+            return 1;
+        }
+        args.erase(args.begin());
+        if (args.empty()) {
+            print_help();
+            return 0;
+        }
+        command_name = args[0];
+        args.erase(args.begin());
+    }
+    
     if (command_name == "--interactive" || command_name == "-i") {
         start_interactive_mode();
         return 0;
@@ -167,6 +196,7 @@ void EnhancedCLI::print_help() const {
     std::cout << "  --help, -h          Show this help message" << std::endl;
     std::cout << "  --version, -v       Show version information" << std::endl;
     std::cout << "  --interactive, -i   Start interactive mode" << std::endl;
+    std::cout << "  --shm-cache <name>  Share PDE/MC and implied-vol results with other workers" << std::endl;
     std::cout << std::endl;
     std::cout << colorize("Examples:", colors::BOLD) << std::endl;
     std::cout << "  bsm price --spot 100 --strike 105 --rate 0.05 --time 0.25 --vol 0.2 --type call" << std::endl;
@@ -554,13 +584,28 @@ std::string PortfolioCommand::usage() const {
            "    --risk-free <rate>    Risk-free rate (default: 0.05)\n"
            "    --confidence <level>  Confidence level for VaR (default: 0.95)\n"
            "    --time-horizon <days> Time horizon for risk calculations (default: 1)\n"
-           "    --monte-carlo <paths> Use Monte Carlo for portfolio simulation (default: 100000)\n"
+           "    --monte-carlo <paths> Paths per group for the mc model (default: 100000)\n"
            "    --correlations <file> Correlation matrix file (optional)\n"
+           "    --model <model>       Pricing model: analytic, pde, mc (default: analytic)\n"
+           "    --ungrouped           Price every position on its own instead of per group\n"
+           "    --benchmark           Report grouped vs per-position and netted vs per-row pricing time;\n"
+           "                          with --rows, also the output rows/s of each formatting path\n"
+           "    --synthetic <n>       Use a generated n-position book instead of a file\n"
+           "    --rows <format>       Stream per-position rows instead of the summary: csv, ndjson, binary\n"
+           "    --out <file>          Destination of --rows (default: standard output)\n"
+           "    --bump <change>       Revalue incrementally after a market move (repeatable):\n"
+           "                          spot:SYMBOL=<spot>, vol:SYMBOL:<days>=<vol> or rate=<rate>\n"
+           "    --explain <change>    Explain the P&L of a move from cached Taylor coefficients (repeatable):\n"
+           "                          spot:SYMBOL=<dS>, vol:SYMBOL=<dvol>, rate=<dr> or days=<elapsed>\n"
+           "    --explain-sample <n>  Positions fully revalued to measure the residual (default: 1000)\n"
+           "  \n"
            "  \n"
-           "  Portfolio file format (CSV):\n"
-           "    symbol,position,spot,strike,expiry,volatility,option_type\n"
-           "    AAPL,100,150,155,30,0.25,call\n"
-           "    MSFT,-50,300,290,45,0.30,put";
+           "  Rows with identical terms are netted and each unique contract is priced once.\n"
+           "  \n"
+           "  Portfolio file format (CSV, account column optional):\n"
+           "    symbol,position,spot,strike,expiry,volatility,option_type,account\n"
+           "    AAPL,100,150,155,30,0.25,call,FUND1\n"
+           "    MSFT,-50,300,290,45,0.30,put,FUND2";
 }
 
 struct PortfolioPosition {
@@ -571,6 +616,7 @@ struct PortfolioPosition {
     double days_to_expiry;
     double volatility;
     std::string option_type;
+    std::string account;    // Empty if the file has no account column
     
     double value;
     double delta;
@@ -579,6 +625,188 @@ struct PortfolioPosition {
     double theta;
 };
 
+namespace {
+
+/// Row schema of portfolio --rows (per-position values are quantity-weighted)
+const ResultSchema& portfolio_row_schema() {
+    static const ResultSchema schema = {
+        {"symbol", ColumnType::Text}, {"position", ColumnType::Real}, {"spot", ColumnType::Real},
+        {"strike", ColumnType::Real}, {"days_to_expiry", ColumnType::Real}, {"volatility", ColumnType::Real},
+        {"option_type", ColumnType::Text}, {"value", ColumnType::Real}, {"delta", ColumnType::Real},
+        {"gamma", ColumnType::Real}, {"vega", ColumnType::Real}, {"theta", ColumnType::Real}};
+    return schema;
+}
+
+void write_portfolio_rows(ResultWriter& out, const std::vector<PortfolioPosition>& positions) {
+    for (const auto& pos : positions) {
+        out.text(pos.symbol).real(pos.position).real(pos.spot_price).real(pos.strike).real(pos.days_to_expiry)
+           .real(pos.volatility).text(pos.option_type).real(pos.value).real(pos.delta).real(pos.gamma)
+           .real(pos.vega).real(pos.theta);
+        out.end_row();
+    }
+    out.finish();
+}
+
+/**
+ * @brief Rows per second of the stream, TableFormatter and ResultWriter paths, written to /dev/null
+ *
+ * TableFormatter recomputes its column widths on every row, so it is timed
+ * on at most 5,000 rows.
+ */
+void benchmark_portfolio_output(const std::vector<PortfolioPosition>& positions) {
+    using Clock = std::chrono::steady_clock;
+    auto rate = [](std::size_t rows, Clock::time_point start) {
+        const double s = std::chrono::duration<double>(Clock::now() - start).count();
+        return s > 0.0 ? rows / s : 0.0;
+    };
+    const char* null_device = "/dev/null";
+    std::cout << "\n" << colors::BLUE << "=== Output Formatting Benchmark ===" << colors::RESET << "\n";
+    std::cout << std::fixed << std::setprecision(0);
+
+    {
+        std::ofstream sink(null_device);
+        const auto start = Clock::now();
+        sink << "symbol,position,spot,strike,days_to_expiry,volatility,option_type,value,delta,gamma,vega,theta\n";
+        for (const auto& pos : positions) {
+            sink << pos.symbol << "," << std::setprecision(17) << pos.position << "," << pos.spot_price << ","
+                 << pos.strike << "," << pos.days_to_expiry << "," << pos.volatility << "," << pos.option_type << ","
+                 << pos.value << "," << pos.delta << "," << pos.gamma << "," << pos.vega << "," << pos.theta << "\n";
+        }
+        sink.flush();
+        std::cout << "  ostream CSV (precision 17): " << std::setw(12) << rate(positions.size(), start) << " rows/s\n";
+    }
+    {
+        const std::size_t n = std::min<std::size_t>(positions.size(), 5000);
+        std::ofstream sink(null_device);
+        const auto start = Clock::now();
+        TableFormatter table;
+        table.set_headers({"Symbol", "Position", "Value", "Delta", "Gamma", "Vega", "Theta"});
+        for (std::size_t i = 0; i < n; ++i) {
+            const auto& pos = positions[i];
+            auto cell = [](double v, int digits) {
+                std::ostringstream ss;
+                ss << std::fixed << std::setprecision(digits) << v;
+                return ss.str();
+            };
+            table.add_row({pos.symbol, cell(pos.position, 0), cell(pos.value, 2), cell(pos.delta, 4),
+                           cell(pos.gamma, 6), cell(pos.vega, 2), cell(pos.theta, 2)});
+        }
+        sink << table.format_table();
+        sink.flush();
+        std::cout << "  TableFormatter (" << n << " rows): " << std::setw(12) << rate(n, start) << " rows/s\n";
+    }
+    const std::pair<const char*, ResultFormat> formats[] = {
+        {"csv", ResultFormat::CSV}, {"ndjson", ResultFormat::NDJSON}, {"binary", ResultFormat::Binary}};
+    for (const auto& f : formats) {
+        const auto start = Clock::now();
+        ResultWriter out(portfolio_row_schema(), f.second, null_device);
+        write_portfolio_rows(out, positions);
+        const double rows_per_s = rate(positions.size(), start);
+        std::cout << "  ResultWriter " << std::left << std::setw(14) << f.first << std::right << std::setw(12)
+                  << rows_per_s << " rows/s, " << std::setprecision(1)
+                  << static_cast<double>(out.bytes_written()) / positions.size() << " bytes/row\n"
+                  << std::setprecision(0);
+    }
+    std::cout << std::defaultfloat << "\n";
+}
+
+/**
+ * @brief Apply each --bump in turn to a risk graph of the book and report the
+ *        change, so only positions the move reaches are repriced
+ */
+int revalue_portfolio_bumps(const std::vector<PositionSpec>& specs, const PortfolioPricingConfig& pricing,
+                            const std::vector<std::string>& bumps) {
+    PortfolioRiskGraph risk(specs, pricing);
+    PortfolioRiskTotals previous = risk.totals();
+    std::cout << "\n" << colors::BLUE << "=== Incremental Revaluation ===" << colors::RESET << "\n";
+    std::cout << std::fixed << std::setprecision(2) << "  Base value: " << previous.value << ", delta: "
+              << previous.delta << " (" << risk.num_groups() << " pricing groups)\n";
+    for (const std::string& bump : bumps) {
+        const auto eq = bump.find('=');
+        if (eq == std::string::npos) {
+            std::cout << "Error: --bump expects <input>=<value>: " << bump << std::endl;
+            return 1;
+        }
+        const std::string target = bump.substr(0, eq);
+        const double value = std::stod(bump.substr(eq + 1));
+        if (target == "rate") {
+            risk.set_rate(value);
+        } else if (target.rfind("spot:", 0) == 0) {
+            risk.set_spot(target.substr(5), value);
+        } else if (target.rfind("vol:", 0) == 0 && target.find(':', 4) != std::string::npos) {
+            const auto colon = target.find(':', 4);
+            risk.set_vol(target.substr(4, colon - 4), std::stod(target.substr(colon + 1)) / 365.0, value);
+        } else {
+            std::cout << "Error: Unknown --bump input: " << target << " (spot:SYMBOL, vol:SYMBOL:DAYS or rate)"
+                      << std::endl;
+            return 1;
+        }
+        const RiskRecalcStats stats = risk.recalculate();
+        const PortfolioRiskTotals now = risk.totals();
+        std::cout << "  " << std::left << std::setw(24) << bump << std::right << " value " << std::setw(14)
+                  << now.value << " (" << std::showpos << now.value - previous.value << std::noshowpos
+                  << "), delta " << std::setw(12) << now.delta << ", " << stats.recomputed << " nodes in "
+                  << stats.elapsed_ms << " ms\n";
+        previous = now;
+    }
+    std::cout << std::defaultfloat << "\n";
+    return 0;
+}
+
+/**
+ * @brief Explain the P&L of the --explain changes from cached Taylor
+ *        coefficients and check it on a fully revalued sample
+ */
+int explain_portfolio_move(const std::vector<PositionSpec>& specs, const PortfolioPricingConfig& pricing,
+                           const std::vector<std::string>& changes, std::size_t sample) {
+    MarketMove move;
+    for (const std::string& change : changes) {
+        const auto eq = change.find('=');
+        if (eq == std::string::npos) {
+            std::cout << "Error: --explain expects <input>=<change>: " << change << std::endl;
+            return 1;
+        }
+        const std::string target = change.substr(0, eq);
+        const double value = std::stod(change.substr(eq + 1));
+        if (target == "rate") {
+            move.rate = value;
+        } else if (target == "days") {
+            move.dt = value / 365.0;
+        } else if (target.rfind("spot:", 0) == 0) {
+            move.spot[target.substr(5)] = value;
+        } else if (target.rfind("vol:", 0) == 0) {
+            move.vol[target.substr(4)] = value;
+        } else {
+            std::cout << "Error: Unknown --explain input: " << target << " (spot:SYMBOL, vol:SYMBOL, rate or days)"
+                      << std::endl;
+            return 1;
+        }
+    }
+
+    const PnlExplainer explainer(specs, pricing);
+    const PnlExplain e = explainer.explain(move, sample);
+    std::cout << "\n" << colors::BLUE << "=== P&L Explain ===" << colors::RESET << "\n";
+    std::cout << std::fixed << std::setprecision(2);
+    const std::pair<const char*, double> terms[] = {{"Delta", e.delta}, {"Gamma", e.gamma}, {"Vega", e.vega},
+                                                    {"Vanna", e.vanna}, {"Volga", e.volga}, {"Theta", e.theta},
+                                                    {"Rho", e.rho}};
+    for (const auto& term : terms) {
+        std::cout << "  " << std::left << std::setw(12) << term.first << std::right << std::setw(14) << term.second
+                  << "\n";
+    }
+    std::cout << "  " << std::left << std::setw(12) << "Explained" << std::right << std::setw(14) << e.explained()
+              << "\n";
+    if (e.sampled > 0) {
+        std::cout << "  Residual:   " << std::setw(14) << e.residual_estimate << " (from " << e.sampled
+                  << " fully revalued positions, worst " << e.max_abs_residual << ")\n";
+    }
+    std::cout << "  Coefficients: " << explainer.setup_ms() << " ms, explain: " << std::setprecision(3)
+              << e.elapsed_ms << " ms" << std::defaultfloat << "\n\n";
+    return 0;
+}
+
+} // namespace
+
 struct PortfolioSummary {
     double total_value = 0.0;
     double total_delta = 0.0;
@@ -605,6 +833,15 @@ int PortfolioCommand::execute(const std::vector<std::string>& args) {
     int time_horizon = 1;
     long monte_carlo_paths = 100000;
     std::string correlations_file;
+    std::string model_name = "analytic";
+    bool grouped = true;
+    bool benchmark = false;
+    long synthetic_positions = 0;
+    std::string rows_format;
+    std::string rows_path = "-";
+    std::vector<std::string> bumps;
+    std::vector<std::string> explain_changes;
+    long explain_sample = 1000;
     
     for (size_t i = 0; i < args.size(); ++i) {
         if (args[i] == "--file" && i + 1 < args.size()) {
@@ -623,25 +860,79 @@ int PortfolioCommand::execute(const std::vector<std::string>& args) {
             monte_carlo_paths = std::stol(args[++i]);
         } else if (args[i] == "--correlations" && i + 1 < args.size()) {
             correlations_file = args[++i];
+        } else if (args[i] == "--model" && i + 1 < args.size()) {
+            model_name = args[++i];
+        } else if (args[i] == "--ungrouped") {
+            grouped = false;
+        } else if (args[i] == "--benchmark") {
+            benchmark = true;
+        } else if (args[i] == "--synthetic" && i + 1 < args.size()) {
+            synthetic_positions = std::stol(args[++i]);
+        } else if (args[i] == "--rows" && i + 1 < args.size()) {
+            rows_format = args[++i];
+        } else if (args[i] == "--out" && i + 1 < args.size()) {
+            rows_path = args[++i];
+        } else if (args[i] == "--bump" && i + 1 < args.size()) {
+            bumps.push_back(args[++i]);
+        } else if (args[i] == "--explain" && i + 1 < args.size()) {
+            explain_changes.push_back(args[++i]);
+        } else if (args[i] == "--explain-sample" && i + 1 < args.size()) {
+            explain_sample = std::stol(args[++i]);
         }
     }
     
-    if (portfolio_file.empty()) {
+    ResultFormat row_format = ResultFormat::CSV;
+    if (!rows_format.empty() && !parse_result_format(rows_format, row_format)) {
+        std::cout << "Error: Unknown row format: " << rows_format << " (csv, ndjson or binary)" << std::endl;
+        return 1;
+    }
+    
+    PricingModel model = PricingModel::Analytic;
+    if (model_name == "pde") {
+        model = PricingModel::PDE;
+    } else if (model_name == "mc" || model_name == "montecarlo") {
+        model = PricingModel::MonteCarlo;
+    } else if (model_name != "analytic") {
+        std::cout << "Error: Unknown pricing model: " << model_name << std::endl;
+        return 1;
+    }
+    
+    if (portfolio_file.empty() && synthetic_positions <= 0) {
         std::cout << "Error: Portfolio file required. Use --file <filename>" << std::endl;
         return 1;
     }
     
     // Load portfolio from file
     std::vector<PortfolioPosition> positions;
-    std::ifstream file(portfolio_file);
-    if (!file.is_open()) {
-        std::cout << "Error: Cannot open portfolio file: " << portfolio_file << std::endl;
-        return 1;
+    std::vector<PositionSpec> specs;
+    if (synthetic_positions > 0) {
+        specs = generate_sample_portfolio(static_cast<size_t>(synthetic_positions), 42, model);
+        for (const auto& spec : specs) {
+            PortfolioPosition pos{};
+            pos.symbol = spec.underlying;
+            pos.position = spec.quantity;
+            pos.spot_price = spec.spot;
+            pos.strike = spec.strike;
+            pos.days_to_expiry = spec.T * 365.0;
+            pos.volatility = spec.sigma;
+            pos.option_type = spec.type == OptionType::Call ? "call" : "put";
+            pos.account = "ACCT" + std::to_string(positions.size() % 8);
+            positions.push_back(pos);
+        }
+    }
+    
+    std::ifstream file;
+    if (synthetic_positions <= 0) {
+        file.open(portfolio_file);
+        if (!file.is_open()) {
+            std::cout << "Error: Cannot open portfolio file: " << portfolio_file << std::endl;
+            return 1;
+        }
     }
     
     std::string line;
     bool first_line = true;
-    while (std::getline(file, line)) {
+    while (file.is_open() && std::getline(file, line)) {
         if (first_line) {
             first_line = false;
             continue; // Skip header
@@ -649,7 +940,7 @@ int PortfolioCommand::execute(const std::vector<std::string>& args) {
         
         if (line.empty()) continue;
         
-        // Parse CSV line: symbol,position,spot,strike,expiry,volatility,option_type
+        // Parse CSV line: symbol,position,spot,strike,expiry,volatility,option_type[,account]
         std::istringstream ss(line);
         std::string token;
         PortfolioPosition pos;
@@ -662,20 +953,21 @@ int PortfolioCommand::execute(const std::vector<std::string>& args) {
             std::getline(ss, token, ','); pos.days_to_expiry = std::stod(token);
             std::getline(ss, token, ','); pos.volatility = std::stod(token);
             std::getline(ss, pos.option_type, ',');
+            std::getline(ss, pos.account, ',');
             
-            // Calculate option value and Greeks
-            double T = pos.days_to_expiry / 365.0;
-            OptionType opt_type = (pos.option_type == "call" || pos.option_type == "Call") ? 
-                                  OptionType::Call : OptionType::Put;
-            
-            double option_price = black_scholes_price(pos.spot_price, pos.strike, risk_free_rate, T, pos.volatility, opt_type);
-            pos.value = pos.position * option_price;
-            pos.delta = pos.position * black_scholes_delta(pos.spot_price, pos.strike, risk_free_rate, T, pos.volatility, opt_type);
-            pos.gamma = pos.position * black_scholes_gamma(pos.spot_price, pos.strike, risk_free_rate, T, pos.volatility);
-            pos.vega = pos.position * black_scholes_vega(pos.spot_price, pos.strike, risk_free_rate, T, pos.volatility);
-            pos.theta = pos.position * black_scholes_theta(pos.spot_price, pos.strike, risk_free_rate, T, pos.volatility, opt_type);
+            PositionSpec spec;
+            spec.underlying = pos.symbol;
+            spec.quantity = pos.position;
+            spec.spot = pos.spot_price;
+            spec.strike = pos.strike;
+            spec.T = pos.days_to_expiry / 365.0;
+            spec.sigma = pos.volatility;
+            spec.type = (pos.option_type == "call" || pos.option_type == "Call") ? 
+                        OptionType::Call : OptionType::Put;
+            spec.model = model;
             
             positions.push_back(pos);
+            specs.push_back(spec);
         } catch (const std::exception& e) {
             std::cout << "Warning: Skipping invalid line: " << line << " (" << e.what() << ")" << std::endl;
         }
@@ -686,6 +978,82 @@ int PortfolioCommand::execute(const std::vector<std::string>& args) {
         return 1;
     }
     
+    // Net rows with identical terms, then price each unique contract once,
+    // one shared computation per pricing group
+    using Clock = std::chrono::steady_clock;
+    const auto netting_start = Clock::now();
+    std::vector<std::string> row_accounts;
+    row_accounts.reserve(positions.size());
+    for (const auto& pos : positions) row_accounts.push_back(pos.account);
+    const CompressedBook book = compress_positions(specs, row_accounts);
+    
+    PortfolioPricingConfig pricing;
+    pricing.r = risk_free_rate;
+    pricing.mc_paths = monte_carlo_paths;
+    pricing.group_positions = grouped;
+    const PortfolioValuation valuation = price_compressed(book, pricing);
+    const std::vector<PositionValuation> row_values = expand_valuations(book, valuation.positions);
+    const double netted_ms = std::chrono::duration<double, std::milli>(Clock::now() - netting_start).count();
+    const std::vector<PortfolioRiskTotals> per_account = account_totals(book, valuation.positions);
+    
+    for (size_t i = 0; i < positions.size(); ++i) {
+        const auto& v = row_values[i];
+        auto& pos = positions[i];
+        pos.value = pos.position * v.price;
+        pos.delta = pos.position * v.delta;
+        pos.gamma = pos.position * v.gamma;
+        pos.vega = pos.position * v.vega;
+        pos.theta = pos.position * v.theta;
+    }
+    
+    if (benchmark) {
+        PortfolioPricingConfig reference = pricing;
+        reference.group_positions = !grouped;
+        const PortfolioValuation other = price_compressed(book, reference);
+        const PortfolioValuation& g = grouped ? valuation : other;
+        const PortfolioValuation& u = grouped ? other : valuation;
+        
+        double max_diff = 0.0;
+        for (size_t i = 0; i < book.contracts.size(); ++i) {
+            max_diff = std::max(max_diff, std::abs(g.positions[i].price - u.positions[i].price));
+        }
+        
+        std::cout << "\n" << colors::BLUE << "=== Grouped Pricing Benchmark ===" << colors::RESET << "\n";
+        std::cout << "  Contracts:        " << book.contracts.size() << " (model: " << model_name << ")\n";
+        std::cout << "  Pricing groups:   " << g.num_groups << "\n";
+        std::cout << "  Per-position:     " << std::fixed << std::setprecision(2) << u.elapsed_ms << " ms\n";
+        std::cout << "  Grouped:          " << g.elapsed_ms << " ms\n";
+        std::cout << "  Speedup:          " << std::setprecision(1)
+                  << (g.elapsed_ms > 0.0 ? u.elapsed_ms / g.elapsed_ms : 0.0) << "x\n";
+        std::cout << "  Max |price diff|: " << std::scientific << std::setprecision(3) << max_diff
+                  << std::defaultfloat << "\n";
+        
+        // The same book priced row by row, then netted again, both warm
+        const PortfolioValuation unnetted = price_portfolio(specs, pricing);
+        const auto rerun_start = Clock::now();
+        const CompressedBook renetted = compress_positions(specs, row_accounts);
+        expand_valuations(renetted, price_compressed(renetted, pricing).positions);
+        const double renetted_ms = std::chrono::duration<double, std::milli>(Clock::now() - rerun_start).count();
+        std::cout << "\n" << colors::BLUE << "=== Position Netting Benchmark ===" << colors::RESET << "\n";
+        std::cout << "  Rows:             " << book.rows() << " -> " << book.contracts.size() << " contracts ("
+                  << std::fixed << std::setprecision(2) << book.compression_ratio() << "x)\n";
+        std::cout << "  Per-row:          " << unnetted.elapsed_ms << " ms\n";
+        std::cout << "  Netted:           " << renetted_ms << " ms (including netting and scatter)\n";
+        std::cout << "  Time saved:       " << unnetted.elapsed_ms - renetted_ms << " ms" << std::defaultfloat << "\n\n";
+    }
+    
+    if (!bumps.empty()) return revalue_portfolio_bumps(book.contracts, pricing, bumps);
+    if (!explain_changes.empty())
+        return explain_portfolio_move(book.contracts, pricing, explain_changes,
+                                      static_cast<std::size_t>(std::max(0L, explain_sample)));
+    
+    if (!rows_format.empty()) {
+        if (benchmark) benchmark_portfolio_output(positions);
+        ResultWriter out(portfolio_row_schema(), row_format, rows_path);
+        write_portfolio_rows(out, positions);
+        return 0;
+    }
+    
     // Calculate portfolio summary
     PortfolioSummary summary;
     summary.num_positions = positions.size();
@@ -729,8 +1097,22 @@ int PortfolioCommand::execute(const std::vector<std::string>& args) {
         std::cout << "    \"var_95\": " << summary.var_95 << ",\n";
         std::cout << "    \"var_99\": " << summary.var_99 << ",\n";
         std::cout << "    \"expected_shortfall\": " << summary.expected_shortfall << ",\n";
-        std::cout << "    \"num_positions\": " << summary.num_positions << "\n";
-        std::cout << "  }\n";
+        std::cout << "    \"num_positions\": " << summary.num_positions << ",\n";
+        std::cout << "    \"unique_contracts\": " << book.contracts.size() << ",\n";
+        std::cout << "    \"compression_ratio\": " << book.compression_ratio() << ",\n";
+        std::cout << "    \"pricing_ms\": " << netted_ms << "\n";
+        std::cout << "  },\n";
+        std::cout << "  \"accounts\": [";
+        for (size_t a = 0; a < book.accounts.size(); ++a) {
+            const auto& t = per_account[a];
+            std::string name;
+            append_json_escaped(name, book.accounts[a]);
+            std::cout << (a ? ",\n" : "\n") << "    {\"account\": \"" << name << "\", \"holdings\": "
+                      << book.account_offsets[a + 1] - book.account_offsets[a] << ", \"value\": " << t.value
+                      << ", \"delta\": " << t.delta << ", \"gamma\": " << t.gamma << ", \"vega\": " << t.vega
+                      << ", \"theta\": " << t.theta << "}";
+        }
+        std::cout << "\n  ]\n";
         std::cout << "}\n";
     } else if (output_format == "csv") {
         std::cout << "metric,value\n";
@@ -743,6 +1125,13 @@ int PortfolioCommand::execute(const std::vector<std::string>& args) {
         std::cout << "var_99," << summary.var_99 << "\n";
         std::cout << "expected_shortfall," << summary.expected_shortfall << "\n";
         std::cout << "num_positions," << summary.num_positions << "\n";
+        std::cout << "unique_contracts," << book.contracts.size() << "\n";
+        std::cout << "compression_ratio," << book.compression_ratio() << "\n";
+        std::cout << "pricing_ms," << netted_ms << "\n";
+        for (size_t a = 0; a < book.accounts.size(); ++a) {
+            std::cout << "account_value:" << book.accounts[a] << "," << per_account[a].value << "\n";
+            std::cout << "account_delta:" << book.accounts[a] << "," << per_account[a].delta << "\n";
+        }
     } else {
         // Table format (default)
         std::cout << "\n" << colors::BLUE << "=== Portfolio Analysis ===" << colors::RESET << "\n\n";
@@ -784,6 +1173,33 @@ int PortfolioCommand::execute(const std::vector<std::string>& args) {
         }
         std::cout << "  Expected Shortfall: " << summary.expected_shortfall << "\n";
         std::cout << "  Time Horizon: " << time_horizon << " day(s)\n\n";
+        
+        std::cout << "Pricing:\n";
+        std::cout << "  Rows: " << book.rows() << ", unique contracts: " << book.contracts.size()
+                  << " (compression " << book.compression_ratio() << "x)\n";
+        std::cout << "  Time: " << netted_ms << " ms\n\n";
+        
+        if (book.accounts.size() > 1 || !book.accounts.front().empty()) {
+            std::cout << std::left << std::setw(12) << "Account"
+                      << std::right << std::setw(10) << "Holdings"
+                      << std::setw(12) << "Value"
+                      << std::setw(10) << "Delta"
+                      << std::setw(10) << "Gamma"
+                      << std::setw(10) << "Vega"
+                      << std::setw(10) << "Theta" << "\n";
+            std::cout << std::string(74, '-') << "\n";
+            for (size_t a = 0; a < book.accounts.size(); ++a) {
+                const auto& t = per_account[a];
+                std::cout << std::left << std::setw(12) << book.accounts[a]
+                          << std::right << std::setw(10) << book.account_offsets[a + 1] - book.account_offsets[a]
+                          << std::setw(12) << std::setprecision(2) << t.value
+                          << std::setw(10) << std::setprecision(4) << t.delta
+                          << std::setw(10) << std::setprecision(6) << t.gamma
+                          << std::setw(10) << std::setprecision(2) << t.vega
+                          << std::setw(10) << std::setprecision(2) << t.theta << "\n";
+            }
+            std::cout << "\n";
+        }
     }
     
     return 0;
@@ -1031,7 +1447,7 @@ std::string VolatilityCommand::usage() const {
     return "volatility [mode] [options]\n"
            "  Modes:\n"
            "    implied --price <p> --spot <S> --strike <K> --rate <r> --time <T> --type <call|put>\n"
-           "    surface --file <csv_file> [--output <format>]\n"
+           "    surface --file <csv_file> [--output <format>] [--implied-forward]\n"
            "    smile --spot <S> --time <T> --strikes <K1,K2,...> --ivs <v1,v2,...>\n"
            "    term-structure --spot <S> --strike <K> --times <T1,T2,...> --ivs <v1,v2,...>\n"
            "  \n"
@@ -1040,6 +1456,10 @@ std::string VolatilityCommand::usage() const {
            "    --max-iterations <n>  Maximum solver iterations (default: 100)\n"
            "    --output <format>     Output format: table, csv, json (default: table)\n"
            "    --plot                Generate plot data for visualization\n"
+           "    --implied-forward     Surface vols on the forward and discount implied by\n"
+           "                          put-call parity per expiry (needs calls and puts)\n"
+           "    --rows <format>       Surface mode: stream points as csv, ndjson or binary rows\n"
+           "    --out <file>          Destination of --rows (default: standard output)\n"
            "  \n"
            "  CSV file format for surface mode:\n"
            "    strike,expiry,market_price,spot,rate,option_type";
@@ -1177,15 +1597,24 @@ int VolatilityCommand::execute_volatility_surface(const std::vector<std::string>
     std::string filename;
     std::string output_format = "table";
     bool plot = false;
+    bool use_implied_forward = false;
+    std::string rows_format;
+    std::string rows_path = "-";
     
     // Parse arguments
     for (size_t i = 1; i < args.size(); ++i) {
         if (args[i] == "--file" && i + 1 < args.size()) {
             filename = args[++i];
+        } else if (args[i] == "--rows" && i + 1 < args.size()) {
+            rows_format = args[++i];
+        } else if (args[i] == "--out" && i + 1 < args.size()) {
+            rows_path = args[++i];
         } else if (args[i] == "--output" && i + 1 < args.size()) {
             output_format = args[++i];
         } else if (args[i] == "--plot") {
             plot = true;
+        } else if (args[i] == "--implied-forward") {
+            use_implied_forward = true;
         }
     }
     
@@ -1194,6 +1623,12 @@ int VolatilityCommand::execute_volatility_surface(const std::vector<std::string>
         return 1;
     }
     
+    ResultFormat row_format = ResultFormat::CSV;
+    if (!rows_format.empty() && !parse_result_format(rows_format, row_format)) {
+        std::cout << "Error: Unknown row format: " << rows_format << " (csv, ndjson or binary)" << std::endl;
+        return 1;
+    }
+    
     try {
         // Read CSV file
         std::ifstream file(filename);
@@ -1228,11 +1663,18 @@ int VolatilityCommand::execute_volatility_surface(const std::vector<std::string>
                 point.rate = std::stod(tokens[4]);
                 point.option_type = (tokens[5] == "put" || tokens[5] == "Put") ? OptionType::Put : OptionType::Call;
                 
-                // Calculate implied volatility
-                auto price_fn = [&](double sigma) {
-                    return black_scholes_price(point.spot, point.strike, point.rate, point.expiry, sigma, point.option_type);
-                };
-                point.implied_vol = bsm::implied_vol(point.market_price, price_fn);
+                // Calculate implied volatility, reusing other workers' solves of the same quote
+                SharedPricingCache* cache = shared_pricing_cache();
+                CacheKey key("iv");
+                key.add(point.market_price).add(point.spot).add(point.strike).add(point.rate)
+                   .add(point.expiry).add(static_cast<long long>(point.option_type));
+                if (!cache || cache->lookup(key, &point.implied_vol, 1) != 1) {
+                    auto price_fn = [&](double sigma) {
+                        return black_scholes_price(point.spot, point.strike, point.rate, point.expiry, sigma, point.option_type);
+                    };
+                    point.implied_vol = bsm::implied_vol(point.market_price, price_fn);
+                    if (cache) cache->store(key, &point.implied_vol, 1);
+                }
                 
                 surface_points.push_back(point);
             }
@@ -1242,9 +1684,37 @@ int VolatilityCommand::execute_volatility_surface(const std::vector<std::string>
             std::cout << "Error: No valid data points found in file." << std::endl;
             return 1;
         }
+
+        // Replace the spot-and-rate vols by Black vols on each expiry's implied
+        // forward; expiries without a usable parity fit keep the former
+        std::vector<ImpliedForward> forwards;
+        if (use_implied_forward) {
+            std::vector<OptionQuote> quotes;
+            quotes.reserve(surface_points.size());
+            for (const auto& point : surface_points) {
+                quotes.push_back({"SURFACE", point.expiry, point.strike, point.option_type,
+                                  point.market_price, point.market_price});
+            }
+            forwards = implied_forwards(quotes);
+            const std::vector<double> forward_ivs = implied_vols_from_forwards(quotes, forwards);
+            for (size_t i = 0; i < surface_points.size(); ++i) {
+                if (std::isfinite(forward_ivs[i])) surface_points[i].implied_vol = forward_ivs[i];
+            }
+        }
         
         // Output results
-        if (output_format == "json") {
+        if (!rows_format.empty()) {
+            const ResultSchema schema = {{"strike", ColumnType::Real}, {"expiry", ColumnType::Real},
+                                         {"option_type", ColumnType::Text}, {"market_price", ColumnType::Real},
+                                         {"implied_volatility", ColumnType::Real}, {"moneyness", ColumnType::Real}};
+            ResultWriter out(schema, row_format, rows_path);
+            for (const auto& point : surface_points) {
+                out.real(point.strike).real(point.expiry).text(point.option_type == OptionType::Call ? "call" : "put")
+                   .real(point.market_price).real(point.implied_vol).real(point.strike / point.spot);
+                out.end_row();
+            }
+            out.finish();
+        } else if (output_format == "json") {
             std::cout << "{\n";
             std::cout << "  \"volatility_surface\": [\n";
             for (size_t i = 0; i < surface_points.size(); ++i) {
@@ -1268,6 +1738,21 @@ int VolatilityCommand::execute_volatility_surface(const std::vector<std::string>
         } else {
             std::cout << "\n" << colors::BLUE << "=== Volatility Surface Analysis ===" << colors::RESET << "\n\n";
             std::cout << "Data Points: " << surface_points.size() << "\n\n";
+            if (!forwards.empty()) {
+                std::cout << std::setw(8) << "Expiry" << std::setw(12) << "Forward" << std::setw(10) << "Discount"
+                          << std::setw(10) << "Rate %" << std::setw(10) << "Strikes" << "\n";
+                for (const auto& f : forwards) {
+                    std::cout << std::fixed << std::setprecision(2) << std::setw(8) << f.T;
+                    if (f.valid) {
+                        std::cout << std::setw(12) << f.forward << std::setprecision(5) << std::setw(10) << f.discount
+                                  << std::setprecision(3) << std::setw(10) << f.rate() * 100;
+                    } else {
+                        std::cout << std::setw(32) << "no parity fit";
+                    }
+                    std::cout << std::setw(10) << f.strikes_used << "\n";
+                }
+                std::cout << "\n";
+            }
             
             std::cout << std::setw(8) << "Strike" << std::setw(8) << "Expiry" 
                       << std::setw(12) << "Impl Vol %" << std::setw(12) << "Market Price"
@@ -1663,6 +2148,100 @@ int ConfigCommand::load_config(const std::string& filename) {
     }
 }
 
+// Engine tuning implementation
+std::string TuneCommand::usage() const {
+    return "tune [action] [options]\n"
+           "  Actions:\n"
+           "    run                   Sweep the engine knobs and save the best settings (default)\n"
+           "    show                  Display this machine's fingerprint and active settings\n"
+           "  \n"
+           "  Options:\n"
+           "    --quick               Smaller benchmark problems\n"
+           "    --profile <file>      Tuning profile (default $BSM_TUNING_PROFILE or ~/.bsm_tuning.ini)\n"
+           "  \n"
+           "  Profiles hold one section per hardware fingerprint; the engines load\n"
+           "  their machine's section at startup.\n"
+           "  \n"
+           "  Examples:\n"
+           "    tune\n"
+           "    tune run --quick --profile /shared/bsm_tuning.ini\n"
+           "    tune show";
+}
+
+int TuneCommand::execute(const std::vector<std::string>& args) {
+    std::string action = "run";
+    std::string profile = default_tuning_profile_path();
+    bool quick = false;
+    for (size_t i = 0; i < args.size(); ++i) {
+        if (args[i] == "--quick") {
+            quick = true;
+        } else if (args[i] == "--profile" && i + 1 < args.size()) {
+            profile = args[++i];
+        } else if (i == 0 && (args[i] == "run" || args[i] == "show")) {
+            action = args[i];
+        } else {
+            std::cout << "Error: Unknown argument '" << args[i] << "'. Use --help for usage information." << std::endl;
+            return 1;
+        }
+    }
+    return (action == "show") ? show_tuning(profile) : run_tuning(profile, quick);
+}
+
+namespace {
+
+void print_tuning(const EngineTuning& t) {
+    std::cout << "  threads:             " << (t.threads > 0 ? std::to_string(t.threads) : "runtime default") << "\n";
+    std::cout << "  heston_line_block:   " << t.heston_line_block << "\n";
+    std::cout << "  heston_column_chunk: " << t.heston_column_chunk << "\n";
+    std::cout << "  basket_line_block:   " << t.basket_line_block << "\n";
+    std::cout << "  basket_column_chunk: " << t.basket_column_chunk << "\n";
+    std::cout << "  batch_chunk:         " << t.batch_chunk << "\n";
+}
+
+} // namespace
+
+int TuneCommand::show_tuning(const std::string& profile) {
+    const std::string fingerprint = hardware_fingerprint();
+    EngineTuning stored;
+    bool found = false;
+    try {
+        found = load_tuning_profile(profile, fingerprint, stored);
+    } catch (const std::exception& e) {
+        std::cout << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+
+    std::cout << "\n" << colors::BLUE << "=== Engine Tuning ===" << colors::RESET << "\n\n";
+    std::cout << "Machine: " << fingerprint << "\n";
+    std::cout << "Profile: " << profile << (found ? "" : " (no entry for this machine)") << "\n\n";
+    std::cout << colors::GREEN << "Active Settings:" << colors::RESET << "\n";
+    print_tuning(engine_tuning());
+    std::cout << "\n";
+    return 0;
+}
+
+int TuneCommand::run_tuning(const std::string& profile, bool quick) {
+    try {
+        const std::string fingerprint = hardware_fingerprint();
+        std::cout << colors::YELLOW << "Tuning engines for " << fingerprint << "..." << colors::RESET << "\n";
+        std::cout << std::fixed << std::setprecision(2);
+
+        TuneOptions options;
+        options.quick = quick;
+        const EngineTuning tuned = tune_engines(options, &std::cout);
+        save_tuning_profile(profile, fingerprint, tuned);
+
+        std::cout << "\n" << colors::GREEN << "Tuned Settings:" << colors::RESET << "\n";
+        print_tuning(tuned);
+        std::cout << colors::GREEN << "*" << colors::RESET << " Saved to '" << profile << "'" << std::endl;
+        return 0;
+
+    } catch (const std::exception& e) {
+        std::cout << "Error: Tuning failed: " << e.what() << std::endl;
+        return 1;
+    }
+}
+
 std::string HelpCommand::usage() const {
     return "Show help information for commands";
 }
@@ -178,6 +178,21 @@ private:
     int load_config(const std::string& filename);
 };
 
+/**
+ * @brief Per-machine engine tuning command
+ */
+class TuneCommand : public Command {
+public:
+    std::string name() const override { return "tune"; }
+    std::string description() const override { return "Tune engine block sizes and threads for this machine"; }
+    std::string usage() const override;
+    int execute(const std::vector<std::string>& args) override;
+
+private:
+    int show_tuning(const std::string& profile);
+    int run_tuning(const std::string& profile, bool quick);
+};
+
 /**
  * @brief Help command
  */